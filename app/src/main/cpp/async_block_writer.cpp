@@ -0,0 +1,218 @@
+#include "async_block_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "logging.h"
+
+#define LOG_TAG "AsyncBlockWriter"
+
+static constexpr size_t kBlockAlignment = 4096;
+
+AsyncBlockWriter::AsyncBlockWriter(std::unique_ptr<DataWriter> writer, const AsyncWriterOptions& options)
+    : writer_(std::move(writer))
+    , options_(options)
+    , pool_(nullptr)
+    , freeBlocks_(options.blockCount * sizeof(uint32_t))
+    , fullBlocks_(options.blockCount * sizeof(BlockRef))
+    , currentBlock_(kNoBlock)
+    , currentFill_(0)
+    , closing_(false)
+    , preallocatedEnd_(0)
+    , bytesSinceSync_(0)
+    , maxQueueDepth_(0)
+    , droppedBytes_(0)
+    , bytesWritten_(0)
+    , writeCount_(0)
+    , totalWriteNanos_(0)
+    , maxWriteNanos_(0) {
+    sem_init(&blocksReady_, 0, 0);
+
+    void* pool = nullptr;
+    if (posix_memalign(&pool, kBlockAlignment, options_.blockSize * options_.blockCount) != 0) {
+        LOGE("Failed to allocate block pool");
+        return;
+    }
+    pool_ = static_cast<uint8_t*>(pool);
+    // 预先触碰所有页，避免回调中首次写入时缺页
+    memset(pool_, 0, options_.blockSize * options_.blockCount);
+
+    for (uint32_t i = 0; i < options_.blockCount; ++i) {
+        freeBlocks_.write(&i, sizeof(i));
+    }
+}
+
+AsyncBlockWriter::~AsyncBlockWriter() {
+    close();
+    sem_destroy(&blocksReady_);
+    free(pool_);
+}
+
+bool AsyncBlockWriter::start() {
+    if (!pool_ || !writer_ || !writer_->isOpen()) {
+        return false;
+    }
+    if (options_.preallocateBytes > 0 && writer_->preallocate(0, options_.preallocateBytes)) {
+        preallocatedEnd_ = options_.preallocateBytes;
+    }
+    closing_ = false;
+    ioThread_ = std::make_unique<std::thread>(&AsyncBlockWriter::ioThreadFunc, this);
+    return true;
+}
+
+void AsyncBlockWriter::write(const void* data, size_t size) {
+    if (!pool_) {
+        return;
+    }
+    const auto* src = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        if (currentBlock_ == kNoBlock) {
+            uint32_t index;
+            if (freeBlocks_.read(&index, sizeof(index)) != sizeof(index)) {
+                // 块池耗尽：I/O线程严重落后，只能丢弃，绝不在回调中等待
+                droppedBytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+                return;
+            }
+            currentBlock_ = index;
+            currentFill_ = 0;
+        }
+
+        const size_t toCopy = std::min(size, options_.blockSize - currentFill_);
+        memcpy(pool_ + currentBlock_ * options_.blockSize + currentFill_, src, toCopy);
+        currentFill_ += toCopy;
+        src += toCopy;
+        size -= toCopy;
+
+        if (currentFill_ == options_.blockSize) {
+            submitCurrentBlock();
+        }
+    }
+}
+
+void AsyncBlockWriter::submitCurrentBlock() {
+    if (currentBlock_ == kNoBlock || currentFill_ == 0) {
+        return;
+    }
+    BlockRef ref{currentBlock_, static_cast<uint32_t>(currentFill_)};
+    // 队列容量等于块数量，不会写满
+    fullBlocks_.write(&ref, sizeof(ref));
+    currentBlock_ = kNoBlock;
+    currentFill_ = 0;
+
+    const size_t depth = fullBlocks_.size() / sizeof(BlockRef);
+    if (depth > maxQueueDepth_.load(std::memory_order_relaxed)) {
+        maxQueueDepth_.store(depth, std::memory_order_relaxed);
+    }
+    sem_post(&blocksReady_);
+}
+
+void AsyncBlockWriter::close() {
+    if (!ioThread_) {
+        return;
+    }
+    submitCurrentBlock();
+    closing_ = true;
+    sem_post(&blocksReady_);
+    if (ioThread_->joinable()) {
+        ioThread_->join();
+    }
+    ioThread_.reset();
+
+    const AsyncWriterStats stats = getStats();
+    LOGI("writer closed: bytes=%lld writes=%lld avg=%.2fms max=%.2fms maxQueue=%zu/%zu dropped=%lld",
+         static_cast<long long>(stats.bytesWritten), static_cast<long long>(stats.writeCount),
+         stats.avgWriteLatencyMs, stats.maxWriteLatencyMs, stats.maxQueueDepth, options_.blockCount,
+         static_cast<long long>(stats.droppedBytes));
+}
+
+void AsyncBlockWriter::ioThreadFunc() {
+    std::vector<BlockRef> batch(options_.maxCoalesceBlocks);
+
+    while (true) {
+        if (sem_wait(&blocksReady_) != 0 && errno == EINTR) {
+            continue;
+        }
+        const bool closing = closing_;
+
+        // 一次取出尽可能多的已满块，合并写入
+        while (true) {
+            size_t count = fullBlocks_.read(batch.data(), batch.size() * sizeof(BlockRef)) / sizeof(BlockRef);
+            if (count == 0) break;
+            writeBatch(batch.data(), count);
+        }
+
+        if (closing) break;
+    }
+
+    if (options_.syncPolicy != AsyncWriterOptions::SyncPolicy::None) {
+        writer_->sync();
+    }
+}
+
+void AsyncBlockWriter::writeBatch(const BlockRef* blocks, size_t count) {
+    std::vector<struct iovec> iov;
+    iov.reserve(count);
+    size_t batchBytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t* base = pool_ + blocks[i].index * options_.blockSize;
+        // 池中相邻的块地址连续，合并为同一段
+        if (!iov.empty() && static_cast<uint8_t*>(iov.back().iov_base) + iov.back().iov_len == base) {
+            iov.back().iov_len += blocks[i].size;
+        } else {
+            iov.push_back({base, blocks[i].size});
+        }
+        batchBytes += blocks[i].size;
+    }
+
+    // 写入位置接近预分配末尾时继续预分配
+    const int64_t offset = writer_->bytesWritten();
+    if (options_.preallocateBytes > 0 && offset + static_cast<int64_t>(batchBytes) > preallocatedEnd_) {
+        if (writer_->preallocate(preallocatedEnd_, options_.preallocateBytes)) {
+            preallocatedEnd_ += options_.preallocateBytes;
+        }
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    if (!writer_->writev(iov.data(), static_cast<int>(iov.size()))) {
+        LOGE("writev failed: %s", strerror(errno));
+    }
+    // 每批数据落盘后更新文件头，异常退出时已写入的数据仍然完整可读
+    writer_->updateHeader();
+    const int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+
+    bytesWritten_.store(writer_->bytesWritten(), std::memory_order_relaxed);
+    writeCount_.fetch_add(1, std::memory_order_relaxed);
+    totalWriteNanos_.fetch_add(elapsed, std::memory_order_relaxed);
+    if (elapsed > maxWriteNanos_.load(std::memory_order_relaxed)) {
+        maxWriteNanos_.store(elapsed, std::memory_order_relaxed);
+    }
+
+    // 归还块
+    for (size_t i = 0; i < count; ++i) {
+        freeBlocks_.write(&blocks[i].index, sizeof(blocks[i].index));
+    }
+
+    bytesSinceSync_ += static_cast<int64_t>(batchBytes);
+    if (options_.syncPolicy == AsyncWriterOptions::SyncPolicy::Periodic
+            && bytesSinceSync_ >= options_.syncIntervalBytes) {
+        writer_->sync();
+        bytesSinceSync_ = 0;
+    }
+}
+
+AsyncWriterStats AsyncBlockWriter::getStats() const {
+    AsyncWriterStats stats;
+    stats.queueDepth = fullBlocks_.size() / sizeof(BlockRef);
+    stats.maxQueueDepth = maxQueueDepth_.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    stats.droppedBytes = droppedBytes_.load(std::memory_order_relaxed);
+    stats.writeCount = writeCount_.load(std::memory_order_relaxed);
+    if (stats.writeCount > 0) {
+        stats.avgWriteLatencyMs = totalWriteNanos_.load(std::memory_order_relaxed) / 1e6 / stats.writeCount;
+    }
+    stats.maxWriteLatencyMs = maxWriteNanos_.load(std::memory_order_relaxed) / 1e6;
+    return stats;
+}
@@ -0,0 +1,137 @@
+#ifndef ASYNC_BLOCK_WRITER_H
+#define ASYNC_BLOCK_WRITER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <semaphore.h>
+#include "audio_sink.h"
+#include "data_writer.h"
+#include "spsc_ring_buffer.h"
+
+/**
+ * @brief 异步写入器配置
+ */
+struct AsyncWriterOptions {
+    /**
+     * @brief 刷盘策略
+     */
+    enum class SyncPolicy {
+        None,      // 从不主动刷盘，交给内核回写
+        Periodic,  // 每写入syncIntervalBytes字节刷盘一次
+        OnClose    // 仅在关闭时刷盘
+    };
+
+    size_t blockSize = 64 * 1024;              // 块大小（字节），按页对齐
+    size_t blockCount = 64;                    // 预分配的块数量
+    size_t maxCoalesceBlocks = 16;             // 单次聚集写最多合并的块数
+    int64_t preallocateBytes = 8 * 1024 * 1024; // 每次fallocate预分配的长度，0表示不预分配
+    SyncPolicy syncPolicy = SyncPolicy::Periodic;
+    int64_t syncIntervalBytes = 4 * 1024 * 1024;
+};
+
+/**
+ * @brief 异步写入器统计信息
+ */
+struct AsyncWriterStats {
+    size_t queueDepth = 0;          // 当前等待写入的块数
+    size_t maxQueueDepth = 0;       // 历史最大等待写入的块数
+    int64_t bytesWritten = 0;       // 已写入文件的字节数
+    int64_t droppedBytes = 0;       // 块池耗尽时丢弃的字节数
+    int64_t writeCount = 0;         // 写入系统调用次数
+    double avgWriteLatencyMs = 0;   // 平均单次写入耗时
+    double maxWriteLatencyMs = 0;   // 最大单次写入耗时
+};
+
+/**
+ * @brief 异步块写入器
+ * 音频回调把数据拷贝到预分配块池中的空闲块，写满后通过无锁队列交给专用I/O线程；
+ * I/O线程把多个块合并成一次大的聚集写，写完后将块归还到空闲队列。
+ * 回调线程上不会发生文件I/O、加锁或内存分配，存储卡顿只会体现为队列变深。
+ */
+class AsyncBlockWriter : public AudioSink {
+public:
+    /**
+     * @brief 构造函数
+     * @param writer 实际的文件写入器，由I/O线程独占使用
+     * @param options 配置
+     */
+    AsyncBlockWriter(std::unique_ptr<DataWriter> writer, const AsyncWriterOptions& options);
+
+    /**
+     * @brief 析构函数，未关闭时自动关闭
+     */
+    ~AsyncBlockWriter() override;
+
+    AsyncBlockWriter(const AsyncBlockWriter&) = delete;
+    AsyncBlockWriter& operator=(const AsyncBlockWriter&) = delete;
+
+    /**
+     * @brief 启动I/O线程
+     * @return 文件是否可写
+     */
+    bool start() override;
+
+    /**
+     * @brief 写入数据（仅单个生产者线程调用，可在音频回调中调用）
+     * 块池耗尽时丢弃数据并计入统计
+     * @param data 数据指针
+     * @param size 数据大小（字节）
+     */
+    void write(const void* data, size_t size) override;
+
+    /**
+     * @brief 提交未写满的当前块，写完剩余数据并停止I/O线程
+     * 调用前生产者必须已停止写入
+     */
+    void close() override;
+
+    /**
+     * @brief 获取统计信息（任意线程调用）
+     */
+    AsyncWriterStats getStats() const;
+
+private:
+    struct BlockRef {
+        uint32_t index;
+        uint32_t size;
+    };
+
+    static constexpr uint32_t kNoBlock = UINT32_MAX;
+
+    void ioThreadFunc();
+    void submitCurrentBlock();
+    void writeBatch(const BlockRef* blocks, size_t count);
+
+    std::unique_ptr<DataWriter> writer_;
+    const AsyncWriterOptions options_;
+    uint8_t* pool_;
+
+    // 空闲块队列：I/O线程生产，写入线程消费；已满块队列：写入线程生产，I/O线程消费
+    SpscRingBuffer freeBlocks_;
+    SpscRingBuffer fullBlocks_;
+    sem_t blocksReady_;
+
+    // 写入线程私有状态
+    uint32_t currentBlock_;
+    size_t currentFill_;
+
+    std::unique_ptr<std::thread> ioThread_;
+    std::atomic<bool> closing_;
+
+    // I/O线程私有状态
+    int64_t preallocatedEnd_;
+    int64_t bytesSinceSync_;
+
+    // 统计
+    std::atomic<size_t> maxQueueDepth_;
+    std::atomic<int64_t> droppedBytes_;
+    std::atomic<int64_t> bytesWritten_;
+    std::atomic<int64_t> writeCount_;
+    std::atomic<int64_t> totalWriteNanos_;
+    std::atomic<int64_t> maxWriteNanos_;
+};
+
+#endif // ASYNC_BLOCK_WRITER_H
@@ -0,0 +1,33 @@
+#ifndef AUDIO_SINK_H
+#define AUDIO_SINK_H
+
+#include <cstddef>
+
+/**
+ * @brief 录音数据的去向
+ * write在音频回调线程中调用，实现必须是实时安全的：不能阻塞、加锁、分配内存或做文件I/O
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    /**
+     * @brief 启动后台线程、打开输出
+     * @return 是否成功
+     */
+    virtual bool start() = 0;
+
+    /**
+     * @brief 写入交错排列的PCM数据（仅单个生产者线程调用）
+     * @param data 数据指针
+     * @param size 数据大小（字节）
+     */
+    virtual void write(const void* data, size_t size) = 0;
+
+    /**
+     * @brief 写完剩余数据并关闭输出，调用前生产者必须已停止写入
+     */
+    virtual void close() = 0;
+};
+
+#endif // AUDIO_SINK_H
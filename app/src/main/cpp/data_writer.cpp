@@ -1,15 +1,97 @@
 #include "data_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
 
-DataWriter::DataWriter(const char* filePath) : file_(fopen(filePath, "wb")) {}
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE 0x01
+#endif
+
+DataWriter::DataWriter(const char* filePath)
+    : fd_(open(filePath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644))
+    , bytesWritten_(0) {}
 
 DataWriter::~DataWriter() {
-    if (file_) {
-        fclose(file_);
+    if (fd_ >= 0) {
+        close(fd_);
     }
 }
 
 void DataWriter::write(const void* data, size_t size) {
-    if (file_) {
-        fwrite(data, 1, size, file_);
+    if (fd_ < 0) {
+        return;
+    }
+    const auto* src = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = ::write(fd_, src, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        src += n;
+        size -= static_cast<size_t>(n);
+        bytesWritten_ += n;
+    }
+}
+
+bool DataWriter::writev(const struct iovec* iov, int count) {
+    if (fd_ < 0) {
+        return false;
+    }
+    std::vector<struct iovec> pending(iov, iov + count);
+    size_t index = 0;
+    while (index < pending.size()) {
+        const int batch = static_cast<int>(std::min<size_t>(pending.size() - index, IOV_MAX));
+        ssize_t n = ::writev(fd_, pending.data() + index, batch);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytesWritten_ += n;
+        // 处理部分写入：跳过已完整写入的段，调整剩余段的起点
+        auto remaining = static_cast<size_t>(n);
+        while (index < pending.size() && remaining >= pending[index].iov_len) {
+            remaining -= pending[index].iov_len;
+            ++index;
+        }
+        if (remaining > 0) {
+            pending[index].iov_base = static_cast<uint8_t*>(pending[index].iov_base) + remaining;
+            pending[index].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+bool DataWriter::preallocate(int64_t offset, int64_t length) {
+    if (fd_ < 0 || length <= 0) {
+        return false;
     }
-} 
\ No newline at end of file
+    return fallocate(fd_, FALLOC_FL_KEEP_SIZE, offset, length) == 0;
+}
+
+void DataWriter::sync() {
+    if (fd_ >= 0) {
+        fdatasync(fd_);
+    }
+}
+
+bool DataWriter::writeAt(int64_t offset, const void* data, size_t size) {
+    if (fd_ < 0) {
+        return false;
+    }
+    const auto* src = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        ssize_t n = pwrite(fd_, src, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        src += n;
+        offset += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
@@ -1,11 +1,13 @@
 #ifndef DATA_WRITER_H
 #define DATA_WRITER_H
 
-#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <sys/uio.h>
 
 /**
  * @brief 文件写入器类
- * 用于将音频数据写入文件
+ * 用于将音频数据写入文件。直接基于文件描述符，便于批量写入与预分配
  */
 class DataWriter {
 public:
@@ -18,7 +20,15 @@ public:
     /**
      * @brief 析构函数
      */
-    ~DataWriter();
+    virtual ~DataWriter();
+
+    DataWriter(const DataWriter&) = delete;
+    DataWriter& operator=(const DataWriter&) = delete;
+
+    /**
+     * @brief 文件是否成功打开
+     */
+    bool isOpen() const { return fd_ >= 0; }
     
     /**
      * @brief 写入数据到文件
@@ -26,9 +36,49 @@ public:
      * @param size 数据大小
      */
     void write(const void* data, size_t size);
-    
+
+    /**
+     * @brief 一次系统调用写入多段数据（聚集写）
+     * @param iov 数据段数组
+     * @param count 数据段个数
+     * @return 是否全部写入成功
+     */
+    bool writev(const struct iovec* iov, int count);
+
+    /**
+     * @brief 预分配磁盘空间（不改变文件大小），减少写入时的块分配开销
+     * @param offset 起始偏移
+     * @param length 预分配长度
+     * @return 是否成功
+     */
+    bool preallocate(int64_t offset, int64_t length);
+
+    /**
+     * @brief 将已写入的数据刷到存储设备
+     */
+    void sync();
+
+    /**
+     * @brief 已写入的字节数
+     */
+    int64_t bytesWritten() const { return bytesWritten_; }
+
+    /**
+     * @brief 根据已写入的数据更新文件头，由写线程在每批数据落盘后调用
+     * 裸PCM文件没有文件头，默认不做任何事
+     */
+    virtual void updateHeader() {}
+
+protected:
+    /**
+     * @brief 在指定偏移处写入数据，不改变当前写入位置与已写入字节数
+     * @return 是否全部写入成功
+     */
+    bool writeAt(int64_t offset, const void* data, size_t size);
+
 private:
-    FILE* file_;
+    int fd_;
+    int64_t bytesWritten_;
 };
 
-#endif // DATA_WRITER_H 
\ No newline at end of file
+#endif // DATA_WRITER_H
@@ -1,4 +1,5 @@
 #include <jni.h>
+#include <algorithm>
 #include "oboe_recorder.h"
 #include "oboe_player.h"
 #include "logging.h"
@@ -7,11 +8,12 @@
 
 // 全局变量
 JavaVM* javaVm = nullptr;
-jmethodID onAudioDataMethodId = nullptr;
 jmethodID onErrorMethodId = nullptr;
 jobject recorderViewModel = nullptr;
 
 static std::unique_ptr<OboeRecorder> gRecorder;
+// 录音数据共享通道，生命周期长于录音器，保证Kotlin持有的DirectByteBuffer始终指向有效内存
+static std::shared_ptr<SharedAudioChannel> gAudioChannel;
 
 extern "C" JNIEXPORT jint JNICALL
 JNI_OnLoad(JavaVM* vm, void* reserved) {
@@ -27,12 +29,6 @@ JNI_OnLoad(JavaVM* vm, void* reserved) {
         return JNI_ERR;
     }
 
-    // 获取onAudioData方法ID
-    onAudioDataMethodId = env->GetMethodID(viewModelClass, "onAudioData", "([BI)V");
-    if (onAudioDataMethodId == nullptr) {
-        return JNI_ERR;
-    }
-
     // 获取onError方法ID
     onErrorMethodId = env->GetMethodID(viewModelClass, "onError", "(Ljava/lang/String;)V");
     if (onErrorMethodId == nullptr) {
@@ -52,14 +48,18 @@ Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1start_1record(
         jboolean isFloat,
         jint deviceId,
         jint audioSource,
-        jint audioApi) {
+        jint audioApi,
+        jint framesPerPoint,
+        jint prerollMs,
+        jfloat triggerLevel) {
     // 保存RecorderViewModel的全局引用
     recorderViewModel = env->NewGlobalRef(thiz);
     
     const char* str = env->GetStringUTFChars(path, nullptr);
     gRecorder = std::make_unique<OboeRecorder>(str, sampleRate, isStereo, isFloat, deviceId, 
-                                              audioSource, audioApi);
+                                              audioSource, audioApi, framesPerPoint, prerollMs, triggerLevel);
     env->ReleaseStringUTFChars(path, str);
+    gAudioChannel = gRecorder->getAudioChannel();
 
     return gRecorder->start();
 }
@@ -78,3 +78,50 @@ Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1stop_1record(
         recorderViewModel = nullptr;
     }
 }
+
+// 预录模式下手动触发一次事件，非预录模式返回false
+extern "C" JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1trigger_1capture(
+        JNIEnv* env,
+        jobject thiz) {
+    return gRecorder && gRecorder->triggerCapture() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jobject JNICALL
+Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1get_1audio_1buffer(
+        JNIEnv* env,
+        jobject thiz) {
+    if (!gAudioChannel) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(gAudioChannel->data(), static_cast<jlong>(gAudioChannel->mappedSize()));
+}
+
+// state: [0]可读区域偏移 [1]可读字节数 [2]累计丢失的波形点数
+extern "C" JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1poll_1audio(
+        JNIEnv* env,
+        jobject thiz,
+        jlongArray state) {
+    jlong values[3] = {0, 0, 0};
+    if (gAudioChannel) {
+        size_t offset = 0;
+        values[1] = static_cast<jlong>(gAudioChannel->poll(offset));
+        values[0] = static_cast<jlong>(offset);
+        values[2] = gAudioChannel->lostPoints();
+    }
+    env->SetLongArrayRegion(state, 0, 3, values);
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_RecorderViewModel_native_1commit_1audio(
+        JNIEnv* env,
+        jobject thiz,
+        jint size) {
+    if (!gAudioChannel || size <= 0) {
+        return;
+    }
+    size_t offset = 0;
+    const size_t available = gAudioChannel->poll(offset);
+    gAudioChannel->commit(std::min(static_cast<size_t>(size), available));
+}
@@ -0,0 +1,335 @@
+#include "flac_encoder_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include <unistd.h>
+#include "logging.h"
+#include "wav_data_writer.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/channel_layout.h>
+}
+
+#define LOG_TAG "FlacEncoderSink"
+
+// 浮点转换为24位整数的满量程
+static constexpr float kInt24Scale = 8388608.0f;
+
+static std::string makeFallbackPath(const std::string& filePath) {
+    const std::string suffix(".flac");
+    std::string base = filePath;
+    if (base.size() >= suffix.size() && base.compare(base.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        base.resize(base.size() - suffix.size());
+    }
+    return base + "_fallback.wav";
+}
+
+static int64_t threadCpuNanos() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+FlacEncoderSink::FlacEncoderSink(const char* filePath, int32_t sampleRate, int32_t channelCount, bool isFloat,
+                                 int32_t queueMs)
+    : filePath_(filePath)
+    , fallbackPath_(makeFallbackPath(filePath_))
+    , sampleRate_(sampleRate)
+    , channelCount_(channelCount)
+    , isFloat_(isFloat)
+    , bytesPerFrame_(channelCount * (isFloat ? sizeof(float) : sizeof(int16_t)))
+    , queue_(static_cast<size_t>(sampleRate) * queueMs / 1000 * bytesPerFrame_)
+    , degraded_(false)
+    , formatContext_(nullptr)
+    , codecContext_(nullptr)
+    , stream_(nullptr)
+    , frame_(nullptr)
+    , packet_(nullptr)
+    , frameSize_(0)
+    , closing_(false)
+    , encodedFrames_(0)
+    , cpuNanos_(0)
+    , maxQueueBytes_(0)
+    , fallbackBytes_(0)
+    , outputBytes_(0) {
+    sem_init(&dataReady_, 0, 0);
+}
+
+FlacEncoderSink::~FlacEncoderSink() {
+    close();
+    releaseEncoder();
+    sem_destroy(&dataReady_);
+}
+
+bool FlacEncoderSink::start() {
+    // 降级文件提前打开，回调线程切换时只需要往块池里拷贝
+    WavFormat format;
+    format.sampleRate = sampleRate_;
+    format.channelCount = channelCount_;
+    format.isFloat = isFloat_;
+    AsyncWriterOptions options;
+    options.preallocateBytes = 0;  // 多数情况下用不到，不占用磁盘空间
+    fallback_ = std::make_unique<AsyncBlockWriter>(
+            std::make_unique<WavDataWriter>(fallbackPath_.c_str(), format), options);
+    if (!fallback_->start()) {
+        LOGE("Failed to open fallback file: %s", fallbackPath_.c_str());
+        fallback_.reset();
+        return false;
+    }
+
+    degraded_ = false;
+    closing_ = false;
+    if (!openEncoder()) {
+        // 编码器不可用时直接写原始PCM，保证录音不丢失
+        LOGW("FLAC encoder unavailable, recording raw PCM to %s", fallbackPath_.c_str());
+        releaseEncoder();
+        unlink(filePath_.c_str());
+        degraded_ = true;
+        return true;
+    }
+
+    encoderThread_ = std::make_unique<std::thread>(&FlacEncoderSink::encoderThreadFunc, this);
+    return true;
+}
+
+void FlacEncoderSink::write(const void* data, size_t size) {
+    if (!fallback_) {
+        return;
+    }
+    if (!degraded_.load(std::memory_order_relaxed)) {
+        if (queue_.write(data, size)) {
+            const size_t queued = queue_.size();
+            if (queued > maxQueueBytes_.load(std::memory_order_relaxed)) {
+                maxQueueBytes_.store(queued, std::memory_order_relaxed);
+            }
+            sem_post(&dataReady_);
+            return;
+        }
+        // 编码跟不上：之后的数据全部写入降级文件，队列中已有的数据照常编码
+        degraded_.store(true, std::memory_order_relaxed);
+    }
+    fallback_->write(data, size);
+    fallbackBytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+void FlacEncoderSink::close() {
+    if (!fallback_) {
+        return;
+    }
+    if (encoderThread_) {
+        closing_ = true;
+        sem_post(&dataReady_);
+        if (encoderThread_->joinable()) {
+            encoderThread_->join();
+        }
+        encoderThread_.reset();
+    }
+
+    fallback_->close();
+    fallback_.reset();
+    if (fallbackBytes_.load() == 0) {
+        unlink(fallbackPath_.c_str());
+    } else {
+        LOGW("encoder fell behind, %lld bytes recorded as raw PCM in %s",
+             static_cast<long long>(fallbackBytes_.load()), fallbackPath_.c_str());
+    }
+
+    const FlacSinkStats stats = getStats();
+    LOGI("flac closed: frames=%lld ratio=%.2f cpu=%.2fms per audio second maxQueue=%zu/%zu fallback=%lld",
+         static_cast<long long>(stats.encodedFrames), stats.compressionRatio, stats.cpuMsPerAudioSecond,
+         stats.maxQueueBytes, queue_.capacity(), static_cast<long long>(stats.fallbackBytes));
+}
+
+bool FlacEncoderSink::openEncoder() {
+    const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_FLAC);
+    if (!codec) {
+        LOGE("flac encoder not found");
+        return false;
+    }
+    if (avformat_alloc_output_context2(&formatContext_, nullptr, "flac", filePath_.c_str()) < 0 || !formatContext_) {
+        LOGE("alloc flac output ctx failed");
+        return false;
+    }
+    stream_ = avformat_new_stream(formatContext_, nullptr);
+    codecContext_ = avcodec_alloc_context3(codec);
+    if (!stream_ || !codecContext_) {
+        LOGE("alloc stream/codec ctx failed");
+        return false;
+    }
+
+    av_channel_layout_default(&codecContext_->ch_layout, channelCount_);
+    codecContext_->sample_rate = sampleRate_;
+    // FLAC只支持整数样本：浮点输入编码为24位，放在32位样本的高位
+    codecContext_->sample_fmt = isFloat_ ? AV_SAMPLE_FMT_S32 : AV_SAMPLE_FMT_S16;
+    codecContext_->bits_per_raw_sample = isFloat_ ? 24 : 16;
+    codecContext_->time_base = {1, sampleRate_};
+    stream_->time_base = codecContext_->time_base;
+    if (avcodec_open2(codecContext_, codec, nullptr) < 0) {
+        LOGE("avcodec_open2 failed");
+        return false;
+    }
+    if (avcodec_parameters_from_context(stream_->codecpar, codecContext_) < 0) {
+        LOGE("parameters_from_context failed");
+        return false;
+    }
+    if (avio_open(&formatContext_->pb, filePath_.c_str(), AVIO_FLAG_WRITE) < 0) {
+        LOGE("avio_open failed: %s", filePath_.c_str());
+        return false;
+    }
+    if (avformat_write_header(formatContext_, nullptr) < 0) {
+        LOGE("write_header failed");
+        return false;
+    }
+
+    frameSize_ = codecContext_->frame_size > 0 ? codecContext_->frame_size : 4096;
+    frame_ = av_frame_alloc();
+    packet_ = av_packet_alloc();
+    if (!frame_ || !packet_) {
+        return false;
+    }
+    frame_->format = codecContext_->sample_fmt;
+    frame_->sample_rate = sampleRate_;
+    frame_->nb_samples = frameSize_;
+    av_channel_layout_copy(&frame_->ch_layout, &codecContext_->ch_layout);
+    if (av_frame_get_buffer(frame_, 0) < 0) {
+        LOGE("alloc frame buffer failed");
+        return false;
+    }
+    LOGI("flac encoder opened: %s rate=%d channels=%d bits=%d frameSize=%d", filePath_.c_str(),
+         sampleRate_, channelCount_, codecContext_->bits_per_raw_sample, frameSize_);
+    return true;
+}
+
+void FlacEncoderSink::encoderThreadFunc() {
+    const size_t chunkBytes = static_cast<size_t>(frameSize_) * bytesPerFrame_;
+    std::vector<uint8_t> staging(chunkBytes);
+
+    while (true) {
+        if (sem_wait(&dataReady_) != 0 && errno == EINTR) {
+            continue;
+        }
+        const bool closing = closing_;
+
+        // 每次编码一个完整的FLAC帧，数据在环形缓冲区中连续时直接编码，避免拷贝
+        while (queue_.size() >= chunkBytes) {
+            size_t contiguous = 0;
+            const uint8_t* data = queue_.peekRead(contiguous);
+            if (contiguous >= chunkBytes) {
+                encodeFrames(data, frameSize_);
+                queue_.commitRead(chunkBytes);
+            } else {
+                queue_.read(staging.data(), chunkBytes);
+                encodeFrames(staging.data(), frameSize_);
+            }
+        }
+        updateCpuTime();
+
+        if (closing) {
+            // 最后不足一帧的数据
+            const size_t tail = queue_.read(staging.data(), chunkBytes) / bytesPerFrame_ * bytesPerFrame_;
+            if (tail > 0) {
+                encodeFrames(staging.data(), static_cast<int32_t>(tail / bytesPerFrame_));
+            }
+            break;
+        }
+    }
+
+    finishEncoder();
+    updateCpuTime();
+    releaseEncoder();
+}
+
+void FlacEncoderSink::encodeFrames(const uint8_t* data, int32_t frames) {
+    if (av_frame_make_writable(frame_) < 0) {
+        LOGE("frame not writable");
+        return;
+    }
+    frame_->nb_samples = frames;
+    const size_t samples = static_cast<size_t>(frames) * channelCount_;
+    if (isFloat_) {
+        const auto* in = reinterpret_cast<const float*>(data);
+        auto* out = reinterpret_cast<int32_t*>(frame_->data[0]);
+        for (size_t i = 0; i < samples; ++i) {
+            const float v = std::max(-kInt24Scale, std::min(in[i] * kInt24Scale, kInt24Scale - 1.0f));
+            out[i] = static_cast<int32_t>(lrintf(v)) * 256;
+        }
+    } else {
+        memcpy(frame_->data[0], data, samples * sizeof(int16_t));
+    }
+    frame_->pts = encodedFrames_.load(std::memory_order_relaxed);
+
+    int ret = avcodec_send_frame(codecContext_, frame_);
+    if (ret < 0) {
+        char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        LOGE("send_frame error: %s", av_make_error_string(buf, sizeof(buf), ret));
+        return;
+    }
+    encodedFrames_.fetch_add(frames, std::memory_order_relaxed);
+    drainPackets();
+}
+
+void FlacEncoderSink::drainPackets() {
+    while (true) {
+        int ret = avcodec_receive_packet(codecContext_, packet_);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+            break;
+        }
+        if (ret < 0) {
+            char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+            LOGE("receive_packet error: %s", av_make_error_string(buf, sizeof(buf), ret));
+            break;
+        }
+        packet_->stream_index = stream_->index;
+        av_packet_rescale_ts(packet_, codecContext_->time_base, stream_->time_base);
+        av_interleaved_write_frame(formatContext_, packet_);
+        av_packet_unref(packet_);
+    }
+}
+
+void FlacEncoderSink::finishEncoder() {
+    avcodec_send_frame(codecContext_, nullptr);
+    drainPackets();
+    // 写尾时回填STREAMINFO中的总帧数与MD5
+    av_write_trailer(formatContext_);
+    outputBytes_ = avio_size(formatContext_->pb);
+}
+
+void FlacEncoderSink::releaseEncoder() {
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    avcodec_free_context(&codecContext_);
+    if (formatContext_) {
+        if (formatContext_->pb) {
+            avio_closep(&formatContext_->pb);
+        }
+        avformat_free_context(formatContext_);
+        formatContext_ = nullptr;
+    }
+    stream_ = nullptr;
+}
+
+void FlacEncoderSink::updateCpuTime() {
+    cpuNanos_.store(threadCpuNanos(), std::memory_order_relaxed);
+}
+
+FlacSinkStats FlacEncoderSink::getStats() const {
+    FlacSinkStats stats;
+    stats.encodedFrames = encodedFrames_.load(std::memory_order_relaxed);
+    stats.encodedInputBytes = stats.encodedFrames * static_cast<int64_t>(bytesPerFrame_);
+    stats.outputBytes = outputBytes_.load(std::memory_order_relaxed);
+    if (stats.outputBytes > 0) {
+        stats.compressionRatio = static_cast<double>(stats.encodedInputBytes) / stats.outputBytes;
+    }
+    if (stats.encodedFrames > 0) {
+        const double audioSeconds = static_cast<double>(stats.encodedFrames) / sampleRate_;
+        stats.cpuMsPerAudioSecond = cpuNanos_.load(std::memory_order_relaxed) / 1e6 / audioSeconds;
+    }
+    stats.maxQueueBytes = maxQueueBytes_.load(std::memory_order_relaxed);
+    stats.fallbackBytes = fallbackBytes_.load(std::memory_order_relaxed);
+    return stats;
+}
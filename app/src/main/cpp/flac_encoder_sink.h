@@ -0,0 +1,118 @@
+#ifndef FLAC_ENCODER_SINK_H
+#define FLAC_ENCODER_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <semaphore.h>
+#include "audio_sink.h"
+#include "async_block_writer.h"
+#include "spsc_ring_buffer.h"
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+
+/**
+ * @brief FLAC录音统计信息
+ */
+struct FlacSinkStats {
+    int64_t encodedFrames = 0;        // 已编码的音频帧数
+    int64_t encodedInputBytes = 0;    // 已编码部分对应的原始PCM字节数
+    int64_t outputBytes = 0;          // FLAC文件大小，关闭后有效
+    double compressionRatio = 0;      // 原始PCM字节数 / FLAC文件大小，关闭后有效
+    double cpuMsPerAudioSecond = 0;   // 每秒音频消耗的编码线程CPU时间（毫秒）
+    size_t maxQueueBytes = 0;         // 编码队列历史最大积压
+    int64_t fallbackBytes = 0;        // 降级后写入原始PCM文件的字节数
+};
+
+/**
+ * @brief FLAC无损压缩录音
+ * 回调线程把PCM写入有界的无锁队列，编码线程通过libavcodec编码并由libavformat写入.flac文件。
+ * 浮点输入转换为24位整数编码（FLAC不支持浮点），16位输入原样编码。
+ * 编码跟不上导致队列写满时不丢数据：从该时刻起改为把原始PCM写入同名的_fallback.wav文件，
+ * 队列中已有的数据仍会编码进FLAC文件，两个文件首尾相接即为完整录音。
+ */
+class FlacEncoderSink : public AudioSink {
+public:
+    /**
+     * @brief 构造函数
+     * @param filePath .flac文件路径
+     * @param sampleRate 采样率
+     * @param channelCount 声道数
+     * @param isFloat 输入是否为32位浮点
+     * @param queueMs 编码队列能容纳的音频时长（毫秒）
+     */
+    FlacEncoderSink(const char* filePath, int32_t sampleRate, int32_t channelCount, bool isFloat,
+                    int32_t queueMs = 2000);
+
+    ~FlacEncoderSink() override;
+
+    FlacEncoderSink(const FlacEncoderSink&) = delete;
+    FlacEncoderSink& operator=(const FlacEncoderSink&) = delete;
+
+    bool start() override;
+
+    /**
+     * @brief 写入PCM（可在音频回调中调用）
+     * 队列空间不足时切换到原始PCM降级文件
+     */
+    void write(const void* data, size_t size) override;
+
+    void close() override;
+
+    /**
+     * @brief 获取统计信息（任意线程调用）
+     */
+    FlacSinkStats getStats() const;
+
+    /**
+     * @brief 降级文件路径
+     */
+    const std::string& fallbackPath() const { return fallbackPath_; }
+
+private:
+    bool openEncoder();
+    void finishEncoder();
+    void releaseEncoder();
+    void encoderThreadFunc();
+    void encodeFrames(const uint8_t* data, int32_t frames);
+    void drainPackets();
+    void updateCpuTime();
+
+    const std::string filePath_;
+    const std::string fallbackPath_;
+    const int32_t sampleRate_;
+    const int32_t channelCount_;
+    const bool isFloat_;
+    const size_t bytesPerFrame_;
+
+    SpscRingBuffer queue_;
+    sem_t dataReady_;
+    std::unique_ptr<AsyncBlockWriter> fallback_;
+    std::atomic<bool> degraded_;
+
+    // FFmpeg对象，只在编码线程和start/close中访问
+    AVFormatContext* formatContext_;
+    AVCodecContext* codecContext_;
+    AVStream* stream_;
+    AVFrame* frame_;
+    AVPacket* packet_;
+    int32_t frameSize_;
+
+    std::unique_ptr<std::thread> encoderThread_;
+    std::atomic<bool> closing_;
+
+    // 统计
+    std::atomic<int64_t> encodedFrames_;
+    std::atomic<int64_t> cpuNanos_;
+    std::atomic<size_t> maxQueueBytes_;
+    std::atomic<int64_t> fallbackBytes_;
+    std::atomic<int64_t> outputBytes_;
+};
+
+#endif // FLAC_ENCODER_SINK_H
@@ -0,0 +1,55 @@
+#include "history_ring_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+constexpr uint64_t HistoryRingBuffer::kNoRetain;
+
+static size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+HistoryRingBuffer::HistoryRingBuffer(size_t capacity)
+    : storage_(roundUpToPowerOfTwo(capacity))
+    , capacity_(storage_.capacity())
+    , mask_(capacity_ - 1)
+    , buffer_(storage_.data())
+    , writeIndex_(0) {
+    // 提前触碰所有页面，避免第一次写入时在音频回调里产生缺页
+    std::memset(buffer_, 0, capacity_);
+}
+
+bool HistoryRingBuffer::write(const void* data, size_t size, uint64_t retainFrom) {
+    const uint64_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+    if (retainFrom != kNoRetain && writeIndex + size - retainFrom > capacity_) {
+        return false;
+    }
+
+    // 单次写入超过容量时只保留最后capacity字节
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    uint64_t index = writeIndex;
+    if (size > capacity_) {
+        src += size - capacity_;
+        index += size - capacity_;
+    }
+    const size_t length = std::min(size, capacity_);
+    const size_t offset = static_cast<size_t>(index) & mask_;
+    const size_t firstPart = storage_.contiguous(offset, length);
+    std::memcpy(buffer_ + offset, src, firstPart);
+    if (length > firstPart) {
+        std::memcpy(buffer_, src + firstPart, length - firstPart);
+    }
+
+    writeIndex_.store(writeIndex + size, std::memory_order_release);
+    return true;
+}
+
+const uint8_t* HistoryRingBuffer::peek(uint64_t index, size_t& size) const {
+    const uint64_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    const size_t offset = static_cast<size_t>(index) & mask_;
+    size = index < writeIndex ? storage_.contiguous(offset, static_cast<size_t>(writeIndex - index)) : 0;
+    return buffer_ + offset;
+}
@@ -0,0 +1,58 @@
+#ifndef HISTORY_RING_BUFFER_H
+#define HISTORY_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "mirrored_buffer.h"
+
+/**
+ * @brief 固定容量的历史环形缓冲区
+ * 与SpscRingBuffer不同，写入端默认覆盖最旧的数据，始终保留最近capacity字节；
+ * 需要把一段历史交给读者时，写入端传入retainFrom，此后不会覆盖该位置之后尚未读走的数据。
+ * 索引为64位单调递增的字节位置，读者用绝对位置访问，不维护读索引。
+ * 存储预先分配，优先双重映射，读写都不需要处理环绕。
+ */
+class HistoryRingBuffer {
+public:
+    static constexpr uint64_t kNoRetain = UINT64_MAX;
+
+    /**
+     * @brief 构造函数
+     * @param capacity 期望容量（字节），实际容量向上取整为2的幂
+     */
+    explicit HistoryRingBuffer(size_t capacity);
+
+    HistoryRingBuffer(const HistoryRingBuffer&) = delete;
+    HistoryRingBuffer& operator=(const HistoryRingBuffer&) = delete;
+
+    /**
+     * @brief 写入数据（仅单个写入线程调用，实时安全）
+     * @param retainFrom 需要保留的最早位置，kNoRetain表示可以覆盖任何旧数据
+     * @return 是否写入；会覆盖retainFrom之后的数据时不写入并返回false
+     */
+    bool write(const void* data, size_t size, uint64_t retainFrom = kNoRetain);
+
+    /**
+     * @brief 从绝对位置index开始的可连续访问区域（读线程调用）
+     * index必须仍在缓冲区中（不早于writeIndex() - capacity()），并由写入端通过retainFrom保护
+     * @param size 输出参数，区域大小（字节）
+     */
+    const uint8_t* peek(uint64_t index, size_t& size) const;
+
+    /**
+     * @brief 已写入的总字节数，即下一次写入的位置
+     */
+    uint64_t writeIndex() const { return writeIndex_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    MirroredBuffer storage_;
+    const size_t capacity_;
+    const size_t mask_;
+    uint8_t* buffer_;
+    std::atomic<uint64_t> writeIndex_;
+};
+
+#endif // HISTORY_RING_BUFFER_H
@@ -0,0 +1,142 @@
+// AsyncBlockWriter测试：用每批人为延迟的DataWriter模拟慢速存储，
+// 按音频回调节奏调用write()，检查
+//  1. 存储偶尔卡顿但块池够用时：write()耗时只有内存拷贝、不丢数据、文件内容完整；
+//  2. 存储长时间卡住导致块池耗尽时：write()仍立即返回，丢弃的字节如实计入统计，
+//     已写入文件的字节数与丢弃数之和等于提交总量。
+
+#include "host_test.h"
+#include "async_block_writer.h"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// 每写完一批（updateHeader在每次聚集写之后调用）停顿固定时长
+class SlowDataWriter : public DataWriter {
+public:
+    SlowDataWriter(const char* path, int delayMs) : DataWriter(path), delayMs_(delayMs) {}
+
+    void updateHeader() override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs_));
+    }
+
+private:
+    const int delayMs_;
+};
+
+std::string makeTempPath() {
+    char path[] = "/tmp/async_block_writer_test_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) close(fd);
+    return path;
+}
+
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::vector<uint8_t> data;
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return data;
+    uint8_t chunk[65536];
+    ssize_t n;
+    while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    close(fd);
+    return data;
+}
+
+// 48kHz立体声16位，每1ms回调一次
+constexpr size_t kCallbackBytes = 48 * 2 * sizeof(int16_t);
+
+struct RunResult {
+    LatencyStats writeLatency;
+    AsyncWriterStats stats;
+    int64_t submittedBytes = 0;
+    std::vector<uint8_t> file;
+};
+
+RunResult runCallbacks(const AsyncWriterOptions& options, int delayMs, int callbacks) {
+    RunResult result;
+    const std::string path = makeTempPath();
+    {
+        AsyncBlockWriter writer(std::make_unique<SlowDataWriter>(path.c_str(), delayMs), options);
+        HOST_CHECK(writer.start(), "start() failed for %s", path.c_str());
+
+        std::vector<uint8_t> chunk(kCallbackBytes);
+        uint8_t sequence = 0;
+        auto next = std::chrono::steady_clock::now();
+        for (int i = 0; i < callbacks; ++i) {
+            for (auto& byte : chunk) byte = sequence++;
+            next += std::chrono::milliseconds(1);
+            std::this_thread::sleep_until(next);
+            const int64_t start = nowNanos();
+            writer.write(chunk.data(), chunk.size());
+            result.writeLatency.add(nowNanos() - start);
+            result.submittedBytes += static_cast<int64_t>(chunk.size());
+        }
+        writer.close();
+        result.stats = writer.getStats();
+    }
+    result.file = readFile(path);
+    unlink(path.c_str());
+    return result;
+}
+
+void testSlowStorage() {
+    AsyncWriterOptions options;
+    options.blockSize = 16 * 1024;
+    options.preallocateBytes = 0;
+    options.syncPolicy = AsyncWriterOptions::SyncPolicy::None;
+    // 每批卡400ms：约85ms写满一个16KB块，期间队列堆积几个块，64块的池仍然够用
+    RunResult run = runCallbacks(options, 400, 2000);
+
+    const double maxMs = run.writeLatency.max() / 1e6;
+    std::printf("slow storage: write() p99 %.1f us max %.3f ms, batches %lld, maxQueue %zu/%zu, dropped %lld\n",
+                run.writeLatency.percentile(0.99) / 1e3, maxMs, static_cast<long long>(run.stats.writeCount),
+                run.stats.maxQueueDepth, options.blockCount, static_cast<long long>(run.stats.droppedBytes));
+
+    HOST_CHECK(maxMs < 5.0, "write() took %.3f ms", maxMs);
+    HOST_CHECK(run.stats.droppedBytes == 0, "dropped %lld bytes", static_cast<long long>(run.stats.droppedBytes));
+    HOST_CHECK(static_cast<int64_t>(run.file.size()) == run.submittedBytes,
+               "file has %zu bytes, submitted %lld", run.file.size(), static_cast<long long>(run.submittedBytes));
+    size_t mismatches = 0;
+    for (size_t i = 0; i < run.file.size(); ++i) {
+        if (run.file[i] != static_cast<uint8_t>(i)) ++mismatches;
+    }
+    HOST_CHECK(mismatches == 0, "%zu corrupted bytes in file", mismatches);
+}
+
+void testPoolExhaustion() {
+    AsyncWriterOptions options;
+    options.blockSize = 16 * 1024;
+    options.blockCount = 4;
+    options.maxCoalesceBlocks = 2;
+    options.preallocateBytes = 0;
+    options.syncPolicy = AsyncWriterOptions::SyncPolicy::None;
+    // 每批300ms，而4个16KB块只够约0.34秒，块池必然耗尽
+    RunResult run = runCallbacks(options, 300, 1000);
+
+    const double maxMs = run.writeLatency.max() / 1e6;
+    std::printf("pool exhausted: write() p99 %.1f us max %.3f ms, written %lld, dropped %lld of %lld bytes\n",
+                run.writeLatency.percentile(0.99) / 1e3, maxMs, static_cast<long long>(run.stats.bytesWritten),
+                static_cast<long long>(run.stats.droppedBytes), static_cast<long long>(run.submittedBytes));
+
+    HOST_CHECK(maxMs < 5.0, "write() blocked for %.3f ms with the pool exhausted", maxMs);
+    HOST_CHECK(run.stats.droppedBytes > 0, "expected drops with a %zu-block pool", options.blockCount);
+    HOST_CHECK(run.stats.bytesWritten + run.stats.droppedBytes == run.submittedBytes,
+               "written %lld + dropped %lld != submitted %lld", static_cast<long long>(run.stats.bytesWritten),
+               static_cast<long long>(run.stats.droppedBytes), static_cast<long long>(run.submittedBytes));
+    HOST_CHECK(static_cast<int64_t>(run.file.size()) == run.stats.bytesWritten,
+               "file has %zu bytes, stats say %lld", run.file.size(), static_cast<long long>(run.stats.bytesWritten));
+}
+
+} // namespace
+
+int main() {
+    testSlowStorage();
+    testPoolExhaustion();
+    return testResult("async_block_writer_test");
+}
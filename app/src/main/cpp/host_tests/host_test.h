@@ -0,0 +1,64 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// 主机测试与基准共用的小工具：断言失败打印位置并计数，main最后用testResult()作为退出码
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+inline int& hostTestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define HOST_CHECK(cond, ...)                                                   \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::fprintf(stderr, "%s:%d CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            std::fprintf(stderr, __VA_ARGS__);                                  \
+            std::fputc('\n', stderr);                                           \
+            ++hostTestFailures();                                               \
+        }                                                                       \
+    } while (0)
+
+inline int testResult(const char* name) {
+    if (hostTestFailures() == 0) {
+        std::printf("%s: PASS\n", name);
+        return 0;
+    }
+    std::printf("%s: FAIL (%d)\n", name, hostTestFailures());
+    return 1;
+}
+
+inline int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 耗时统计（纳秒），用于报告最大值与分位数
+ */
+class LatencyStats {
+public:
+    void add(int64_t nanos) { samples_.push_back(nanos); }
+    size_t count() const { return samples_.size(); }
+
+    int64_t max() const {
+        return samples_.empty() ? 0 : *std::max_element(samples_.begin(), samples_.end());
+    }
+
+    int64_t percentile(double p) {
+        if (samples_.empty()) return 0;
+        const size_t index = std::min(samples_.size() - 1, static_cast<size_t>(p * samples_.size()));
+        std::nth_element(samples_.begin(), samples_.begin() + index, samples_.end());
+        return samples_[index];
+    }
+
+private:
+    std::vector<int64_t> samples_;
+};
+
+#endif // HOST_TEST_H
@@ -0,0 +1,93 @@
+// computeNccSums / computeEnergy 与double参考值比较，检查分块成对求和在float下的精度：
+// 长度覆盖空输入、不足一个SIMD步长、块边界前后和十秒的窗口，指针故意不对齐。
+// 点积的误差相对于 sqrt(energyA*energyB)，即归一化相关度的误差；能量的误差为相对误差。
+// 信号带直流偏置，逐个float顺序累加时误差随长度线性增长，对照打印。
+// 主机上测试的是运行时选中的x86内核（avx2或sse），NEON内核需在设备上运行。
+
+#include "host_test.h"
+#include "ncc_kernels.h"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+// float下各量的相对误差上限：成对求和的误差几乎不随长度增长，实测在1.3e-7以内；
+// 顺序累加在十万样本时已超过1e-6
+constexpr double kMaxRelativeError = 5e-7;
+
+struct Errors {
+    double dot = 0.0;
+    double energyA = 0.0;
+    double energyB = 0.0;
+    double energy = 0.0;
+    double naive = 0.0;  // 逐个float顺序累加的能量
+};
+
+Errors check(size_t n, size_t misalign, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.2f);
+    std::vector<float> bufferA(n + misalign);
+    std::vector<float> bufferB(n + misalign);
+    float* a = bufferA.data() + misalign;
+    float* b = bufferB.data() + misalign;
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = 0.3f + noise(rng);
+        b[i] = 0.5f * a[i] + noise(rng);
+    }
+
+    double dot = 0.0;
+    double energyA = 0.0;
+    double energyB = 0.0;
+    float naive = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        dot += static_cast<double>(a[i]) * b[i];
+        energyA += static_cast<double>(a[i]) * a[i];
+        energyB += static_cast<double>(b[i]) * b[i];
+        naive += a[i] * a[i];
+    }
+
+    const NccSums sums = computeNccSums(a, b, n);
+    const float energy = computeEnergy(a, n);
+    Errors errors;
+    if (n == 0) {
+        HOST_CHECK(sums.dot == 0.0f && sums.energyA == 0.0f && sums.energyB == 0.0f && energy == 0.0f,
+                   "empty input: dot %g energyA %g energyB %g energy %g", sums.dot, sums.energyA, sums.energyB,
+                   energy);
+        return errors;
+    }
+    errors.dot = std::fabs(sums.dot - dot) / std::sqrt(energyA * energyB);
+    errors.energyA = std::fabs(sums.energyA - energyA) / energyA;
+    errors.energyB = std::fabs(sums.energyB - energyB) / energyB;
+    errors.energy = std::fabs(energy - energyA) / energyA;
+    errors.naive = std::fabs(naive - energyA) / energyA;
+
+    std::printf("  n %6zu +%zu: dot %.2e  energyA %.2e  energyB %.2e  energy %.2e  (sequential float %.2e)\n", n,
+                misalign, errors.dot, errors.energyA, errors.energyB, errors.energy, errors.naive);
+    HOST_CHECK(errors.dot < kMaxRelativeError, "n %zu: dot %.9g, reference %.9g", n, sums.dot, dot);
+    HOST_CHECK(errors.energyA < kMaxRelativeError, "n %zu: energyA %.9g, reference %.9g", n, sums.energyA, energyA);
+    HOST_CHECK(errors.energyB < kMaxRelativeError, "n %zu: energyB %.9g, reference %.9g", n, sums.energyB, energyB);
+    HOST_CHECK(errors.energy < kMaxRelativeError, "n %zu: energy %.9g, reference %.9g", n, energy, energyA);
+    return errors;
+}
+
+} // namespace
+
+int main() {
+    std::printf("ncc kernels: %s, block %zu\n", nccKernelName(), kNccBlock);
+    const size_t lengths[] = {0, 1, 7, 15, 16, 17, 255, 256, 257, 1000, 4096, 33600, 100000, 480000};
+    Errors worst;
+    uint32_t seed = 1;
+    for (const size_t n : lengths) {
+        for (const size_t misalign : {size_t{0}, size_t{3}}) {
+            const Errors errors = check(n, misalign, seed++);
+            worst.dot = std::max(worst.dot, errors.dot);
+            worst.energyA = std::max(worst.energyA, errors.energyA);
+            worst.energyB = std::max(worst.energyB, errors.energyB);
+            worst.energy = std::max(worst.energy, errors.energy);
+        }
+    }
+    std::printf("worst relative error: dot %.2e  energyA %.2e  energyB %.2e  energy %.2e\n", worst.dot,
+                worst.energyA, worst.energyB, worst.energy);
+    return testResult("ncc_kernels_test");
+}
@@ -0,0 +1,125 @@
+// OboeMixer基准：不经过模拟设备线程，直接以192帧为一次回调驱动onAudioReady，
+// 统计1~32条音轨时每次回调的耗时和占回调周期的比例。
+// 两种音轨组合：全部与设备同为48kHz立体声s16（只有读取和混音）；一半为44.1kHz单声道f32（每条各自重采样）。
+// 同时检查重新启动：播放完或stop()之后再次start()，所有音轨从头播放。
+
+#include "host_test.h"
+#include "test_wav.h"
+
+#include "oboe_mixer.h"
+
+namespace {
+
+constexpr int32_t kDeviceRate = 48000;
+constexpr int32_t kCallbackFrames = oboe::AudioStream::kBurstFrames;
+constexpr int kCallbacks = 2000;  // 每种配置约8秒音频
+
+oboe::AudioStream& outputStream() {
+    static oboe::AudioStream stream([] {
+        oboe::StreamConfig config;
+        config.sampleRate = kDeviceRate;
+        config.channelCount = 2;
+        return config;
+    }());
+    return stream;
+}
+
+// 驱动一次回调，返回输出的峰值
+float renderOnce(OboeMixer& mixer, std::vector<float>& out, oboe::DataCallbackResult* result = nullptr) {
+    const oboe::DataCallbackResult r = mixer.onAudioReady(&outputStream(), out.data(), kCallbackFrames);
+    if (result) *result = r;
+    float peak = 0.0f;
+    for (const float sample : out) {
+        peak = std::max(peak, std::fabs(sample));
+    }
+    return peak;
+}
+
+void benchmark(const std::string& native, const std::string& resampled, int tracks, bool mixRates) {
+    OboeMixer mixer(0, 0);
+    for (int i = 0; i < tracks; ++i) {
+        const bool useResampled = mixRates && i % 2 == 1;
+        HOST_CHECK(mixer.addTrack((useResampled ? resampled : native).c_str(), 0, false, false) == i,
+                   "addTrack %d failed", i);
+        mixer.setTrackGain(i, 1.0f / tracks);
+        mixer.setTrackPan(i, tracks > 1 ? -1.0f + 2.0f * i / (tracks - 1) : 0.0f);
+    }
+    HOST_CHECK(mixer.start(), "mixer start failed");
+
+    std::vector<float> out(static_cast<size_t>(kCallbackFrames) * 2);
+    LatencyStats stats;
+    for (int call = 0; call < kCallbacks; ++call) {
+        const int64_t begin = nowNanos();
+        mixer.onAudioReady(&outputStream(), out.data(), kCallbackFrames);
+        stats.add(nowNanos() - begin);
+    }
+    const MixerStats mixerStats = mixer.getStats();
+    mixer.stop();
+
+    HOST_CHECK(mixerStats.callCount == kCallbacks, "mixer counted %lld callbacks",
+               static_cast<long long>(mixerStats.callCount));
+    const double periodMicros = 1e6 * kCallbackFrames / kDeviceRate;
+    std::printf("  %2d tracks %-9s avg %7.1f us (%5.2f%%)  p99 %7.1f us  max %7.1f us  per track %5.2f us\n",
+                tracks, mixRates ? "48k+44.1k" : "48k", mixerStats.avgMicros,
+                100.0 * mixerStats.avgMicros / periodMicros, stats.percentile(0.99) / 1e3, stats.max() / 1e3,
+                mixerStats.avgMicrosPerTrack);
+}
+
+// 播放完后再次start()，以及中途stop()后再次start()，第一次回调都应输出开头的数据
+void checkRestart(const std::string& shortNative, const std::string& shortResampled) {
+    OboeMixer mixer(0, 0);
+    HOST_CHECK(mixer.addTrack(shortNative.c_str(), 0, false, false) == 0, "addTrack failed");
+    HOST_CHECK(mixer.addTrack(shortResampled.c_str(), 0, false, false) == 1, "addTrack failed");
+    std::vector<float> out(static_cast<size_t>(kCallbackFrames) * 2);
+
+    for (int run = 0; run < 3; ++run) {
+        HOST_CHECK(mixer.start(), "start failed on run %d", run);
+        HOST_CHECK(!mixer.isFinished(), "mixer still finished after start on run %d", run);
+        // 第一个回调包含重采样器的预热，取前两个回调的峰值
+        float peak = renderOnce(mixer, out);
+        peak = std::max(peak, renderOnce(mixer, out));
+        HOST_CHECK(peak > 0.1f, "run %d starts silent (peak %.3f)", run, peak);
+
+        if (run == 1) {
+            // 中途停止后重新开始
+            mixer.stop();
+            continue;
+        }
+        oboe::DataCallbackResult result = oboe::DataCallbackResult::Continue;
+        int calls = 0;
+        while (result == oboe::DataCallbackResult::Continue && calls++ < 1000) {
+            renderOnce(mixer, out, &result);
+        }
+        HOST_CHECK(result == oboe::DataCallbackResult::Stop && mixer.isFinished(),
+                   "run %d did not finish", run);
+    }
+    mixer.stop();
+}
+
+} // namespace
+
+int main() {
+    oboe::AudioStream::manualCallbacks() = true;
+    oboe::AudioStream::deviceSampleRate() = kDeviceRate;
+
+    const std::string native = writeTestWav(kDeviceRate, 2, false, 10.0);
+    const std::string resampled = writeTestWav(44100, 1, true, 10.0, 660.0);
+    const std::string shortNative = writeTestWav(kDeviceRate, 2, false, 0.2);
+    const std::string shortResampled = writeTestWav(44100, 1, true, 0.2, 660.0);
+
+    checkRestart(shortNative, shortResampled);
+
+    std::printf("mixer, %d Hz, %d-frame callbacks (%.1f us budget), %d callbacks per case\n", kDeviceRate,
+                kCallbackFrames, 1e6 * kCallbackFrames / kDeviceRate, kCallbacks);
+    for (const bool mixRates : {false, true}) {
+        for (const int tracks : {1, 2, 4, 8, 16, 32}) {
+            benchmark(native, resampled, tracks, mixRates);
+        }
+    }
+
+    unlink(native.c_str());
+    unlink(resampled.c_str());
+    unlink(shortNative.c_str());
+    unlink(shortResampled.c_str());
+    return testResult("oboe_mixer_bench");
+}
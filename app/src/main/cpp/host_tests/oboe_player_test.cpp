@@ -0,0 +1,134 @@
+// OboePlayer的主机测试：文件播完后流保持运行，此时跳转应从新位置继续播放。
+// 映射模式和缓冲模式各测一次，由模拟设备线程驱动回调。
+// 缓冲模式下播放中跳转：测试直接驱动回调，新位置的数据就绪前应继续输出已缓冲的数据，不输出静音也不计欠载。
+// 测试程序替换fread，跳转期间每次读取延迟20ms，模拟慢速存储，使新数据明显晚于跳转请求就绪。
+
+#include "host_test.h"
+#include "test_wav.h"
+
+#include <atomic>
+#include <cmath>
+#include <dlfcn.h>
+#include <thread>
+#include "oboe_player.h"
+
+namespace {
+
+std::atomic<int> slowReadMs{0};
+
+} // namespace
+
+// 可执行文件中的定义优先于libc，被测代码的fread都经过这里
+extern "C" size_t fread(void* ptr, size_t size, size_t count, FILE* stream) {
+    using FreadFn = size_t (*)(void*, size_t, size_t, FILE*);
+    static const auto realFread = reinterpret_cast<FreadFn>(dlsym(RTLD_NEXT, "fread"));
+    if (const int ms = slowReadMs.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    return realFread(ptr, size, count, stream);
+}
+
+namespace {
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// 等待播放进度到达终点，超时返回false
+bool waitForEnd(OboePlayer& player, int timeoutMs) {
+    for (int waited = 0; waited < timeoutMs; waited += 10) {
+        if (player.getPlaybackProgress() >= 1.0f) return true;
+        sleepMs(10);
+    }
+    return false;
+}
+
+void seekAfterEnd(const std::string& path, bool useMmap) {
+    const char* mode = useMmap ? "mmap" : "buffered";
+    OboePlayer player(path.c_str(), 48000, true, false, 0, 0, useMmap);
+    HOST_CHECK(player.start(), "player start failed (%s)", mode);
+    HOST_CHECK(waitForEnd(player, 2000), "playback did not reach the end (%s)", mode);
+
+    // 播完后等待几个回调周期，再跳回开头
+    sleepMs(50);
+    player.seekToFrame(0);
+    sleepMs(100);
+    const float progress = player.getPlaybackProgress();
+    HOST_CHECK(progress > 0.0f && progress < 1.0f, "seek after the end was not played (%s): progress=%.3f",
+               mode, progress);
+    const SeekStats stats = player.getSeekStats();
+    HOST_CHECK(stats.seekCount == 1, "seek after the end was not rendered (%s): count=%d", mode, stats.seekCount);
+
+    // 跳转后再次播完
+    HOST_CHECK(waitForEnd(player, 2000), "playback did not reach the end again (%s)", mode);
+    player.stop();
+    std::printf("%s: seek after the end resumed at progress %.3f, latency %.1f ms\n", mode, progress,
+                stats.lastLatencyMs);
+}
+
+// 缓冲模式播放中反复跳转，每次跳转生效前后的每个回调都应有声音
+void seekWhilePlaying(const std::string& path) {
+    oboe::AudioStream::manualCallbacks() = true;
+    oboe::StreamConfig config;
+    config.sampleRate = 48000;
+    config.channelCount = 2;
+    oboe::AudioStream stream(config);
+    std::vector<float> out(static_cast<size_t>(oboe::AudioStream::kBurstFrames) * 2);
+    OboePlayer player(path.c_str(), 48000, true, true, 0, 0, false);
+    HOST_CHECK(player.start(), "player start failed");
+    sleepMs(100);  // 生产者预读
+
+    // 回调间隔1ms（实时的4倍速），给生产者线程留出运行时间
+    auto renderPeak = [&]() {
+        sleepMs(1);
+        player.onAudioReady(&stream, out.data(), oboe::AudioStream::kBurstFrames);
+        float peak = 0.0f;
+        for (const float sample : out) peak = std::max(peak, std::fabs(sample));
+        return peak;
+    };
+    for (int call = 0; call < 25; ++call) renderPeak();
+
+    constexpr int kSeeks = 20;
+    int silentCallbacks = 0;
+    slowReadMs = 20;
+    for (int seek = 0; seek < kSeeks; ++seek) {
+        const int64_t target = seek % 2 == 0 ? 48000 : 9600;
+        player.seekToFrame(target);
+        // 跳转生效并输出新位置的数据之前一直驱动回调，再多输出几个回调
+        int calls = 0;
+        while (player.getSeekStats().seekCount <= seek && calls < 20000) {
+            if (renderPeak() < 0.1f) ++silentCallbacks;
+            ++calls;
+        }
+        for (int call = 0; call < 5; ++call) {
+            if (renderPeak() < 0.1f) ++silentCallbacks;
+        }
+        const float progress = player.getPlaybackProgress();
+        const float expected = static_cast<float>(target) / (48000 * 2);
+        HOST_CHECK(std::fabs(progress - expected) < 0.05f, "seek %d to %.3f landed at %.3f", seek, expected, progress);
+    }
+    slowReadMs = 0;
+    const PrefetchStats prefetch = player.getPrefetchStats();
+    player.stop();
+    oboe::AudioStream::manualCallbacks() = false;
+
+    HOST_CHECK(player.getSeekStats().seekCount == kSeeks, "seekCount=%d", player.getSeekStats().seekCount);
+    HOST_CHECK(silentCallbacks == 0, "%d silent callbacks around %d seeks", silentCallbacks, kSeeks);
+    HOST_CHECK(prefetch.underrunCount == 0, "%d underruns around %d seeks", prefetch.underrunCount, kSeeks);
+    std::printf("buffered: %d seeks while playing, %d silent callbacks, %d underruns\n", kSeeks, silentCallbacks,
+                prefetch.underrunCount);
+}
+
+} // namespace
+
+int main() {
+    const std::string path = writeTestWav(48000, 2, false, 0.3);
+    seekAfterEnd(path, true);
+    seekAfterEnd(path, false);
+    unlink(path.c_str());
+
+    const std::string longPath = writeTestWav(48000, 2, true, 2.0);
+    seekWhilePlaying(longPath);
+    unlink(longPath.c_str());
+    return testResult("oboe_player_test");
+}
@@ -0,0 +1,176 @@
+// PeakDecimator微基准：与逐样本的标量参考实现比较
+//  - 正确性：单/双声道、s16/f32、不同段长，并把输入切成不规则的批次（覆盖向量尾部与跨批分段），
+//    要求SIMD内核输出与参考实现逐点完全相同；
+//  - 性能：60秒立体声音频的处理耗时与加速比。
+// 主机上走的是SSE2内核；NEON内核需在设备或ARM主机上运行本程序。
+
+#include "host_test.h"
+#include "peak_decimator.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace {
+
+// 参考实现：与PeakDecimator文档描述的规则相同，逐帧逐声道更新最值
+class ScalarReference {
+public:
+    ScalarReference(int32_t channels, bool isFloat, int32_t framesPerPoint)
+        : channels_(channels), isFloat_(isFloat), framesPerPoint_(framesPerPoint) {}
+
+    size_t process(const void* data, int32_t numFrames, float* points) {
+        size_t count = 0;
+        for (int32_t frame = 0; frame < numFrames; ++frame) {
+            for (int32_t ch = 0; ch < channels_; ++ch) {
+                const size_t index = static_cast<size_t>(frame) * channels_ + ch;
+                const float value = isFloat_ ? static_cast<const float*>(data)[index]
+                                             : static_cast<const int16_t*>(data)[index] / 32768.0f;
+                min_[ch] = std::min(min_[ch], value);
+                max_[ch] = std::max(max_[ch], value);
+            }
+            if (++accumulated_ == framesPerPoint_) {
+                const float* peak = positive_ ? max_ : min_;
+                points[count * 2] = std::min(std::max(peak[0], -1.0f), 1.0f);
+                points[count * 2 + 1] = channels_ == 2 ? std::min(std::max(peak[1], -1.0f), 1.0f) : NAN;
+                ++count;
+                accumulated_ = 0;
+                positive_ = !positive_;
+                min_[0] = min_[1] = max_[0] = max_[1] = 0.0f;
+            }
+        }
+        return count;
+    }
+
+private:
+    const int32_t channels_;
+    const bool isFloat_;
+    const int32_t framesPerPoint_;
+    int32_t accumulated_ = 0;
+    bool positive_ = true;
+    float min_[2] = {0.0f, 0.0f};
+    float max_[2] = {0.0f, 0.0f};
+};
+
+struct Signal {
+    std::vector<int16_t> s16;
+    std::vector<float> f32;
+};
+
+// 随机噪声叠加正弦，偶尔插入满幅与超出[-1, 1]的浮点样本，检验截断
+Signal makeSignal(size_t samples, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-0.3f, 0.3f);
+    std::uniform_int_distribution<int> spike(0, 4999);
+    Signal signal;
+    signal.s16.resize(samples);
+    signal.f32.resize(samples);
+    for (size_t i = 0; i < samples; ++i) {
+        float value = 0.6f * std::sin(static_cast<float>(i) * 0.013f) + noise(rng);
+        const int roll = spike(rng);
+        if (roll == 0) value = 1.5f;
+        if (roll == 1) value = -1.25f;
+        signal.f32[i] = value;
+        signal.s16[i] = static_cast<int16_t>(std::lrint(std::min(std::max(value, -1.0f), 32767.0f / 32768.0f) * 32768.0f));
+    }
+    signal.s16[samples / 2] = INT16_MIN;
+    return signal;
+}
+
+bool samePoint(float a, float b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+void testMatchesReference() {
+    const int32_t kFrames = 48000 * 2;
+    const Signal signal = makeSignal(static_cast<size_t>(kFrames) * 2, 1);
+    const int32_t batchSizes[] = {1, 3, 7, 31, 480, 1023, 4096};
+
+    size_t comparedPoints = 0;
+    for (int32_t channels = 1; channels <= 2; ++channels) {
+        for (const bool isFloat : {false, true}) {
+            for (const int32_t framesPerPoint : {1, 5, 64, 441, 1000}) {
+                PeakDecimator decimator(channels, isFloat, framesPerPoint);
+                ScalarReference reference(channels, isFloat, framesPerPoint);
+                const void* base = isFloat ? static_cast<const void*>(signal.f32.data())
+                                           : static_cast<const void*>(signal.s16.data());
+                const size_t sampleBytes = isFloat ? sizeof(float) : sizeof(int16_t);
+
+                std::vector<float> got(decimator.maxPointsFor(4096) * 2);
+                std::vector<float> want(got.size());
+                int32_t frame = 0;
+                size_t batch = 0;
+                size_t mismatches = 0;
+                while (frame < kFrames) {
+                    const int32_t frames = std::min(batchSizes[batch++ % 7], kFrames - frame);
+                    const auto* data = static_cast<const uint8_t*>(base) + static_cast<size_t>(frame) * channels * sampleBytes;
+                    const size_t n = decimator.process(data, frames, got.data(), got.size() / 2);
+                    const size_t m = reference.process(data, frames, want.data());
+                    if (n != m) {
+                        ++mismatches;
+                    } else {
+                        for (size_t i = 0; i < n * 2; ++i) {
+                            if (!samePoint(got[i], want[i])) ++mismatches;
+                        }
+                    }
+                    comparedPoints += m;
+                    frame += frames;
+                }
+                HOST_CHECK(mismatches == 0, "channels=%d %s framesPerPoint=%d: %zu mismatches", channels,
+                           isFloat ? "f32" : "s16", framesPerPoint, mismatches);
+            }
+        }
+    }
+    std::printf("correctness: %zu points compared against the scalar reference\n", comparedPoints);
+}
+
+void benchmark() {
+    constexpr int32_t kChannels = 2;
+    constexpr int32_t kFrames = 48000 * 60;
+    constexpr int32_t kFramesPerPoint = 256;
+    constexpr int32_t kBatch = 960;
+    const Signal signal = makeSignal(static_cast<size_t>(kFrames) * kChannels, 2);
+    std::vector<float> points((kBatch / kFramesPerPoint + 1) * 2);
+
+    for (const bool isFloat : {false, true}) {
+        const void* base = isFloat ? static_cast<const void*>(signal.f32.data())
+                                   : static_cast<const void*>(signal.s16.data());
+        const size_t frameBytes = kChannels * (isFloat ? sizeof(float) : sizeof(int16_t));
+
+        auto timeRun = [&](auto& decimator) {
+            int64_t best = INT64_MAX;
+            for (int repeat = 0; repeat < 3; ++repeat) {
+                const int64_t start = nowNanos();
+                for (int32_t frame = 0; frame < kFrames; frame += kBatch) {
+                    decimator.process(static_cast<const uint8_t*>(base) + frame * frameBytes, kBatch, points.data());
+                }
+                best = std::min(best, nowNanos() - start);
+            }
+            return best;
+        };
+
+        struct SimdAdapter {
+            PeakDecimator decimator;
+            size_t capacity;
+            size_t process(const void* data, int32_t frames, float* out) {
+                return decimator.process(data, frames, out, capacity);
+            }
+        } simd{PeakDecimator(kChannels, isFloat, kFramesPerPoint), points.size() / 2};
+        ScalarReference scalar(kChannels, isFloat, kFramesPerPoint);
+
+        const int64_t simdNanos = timeRun(simd);
+        const int64_t scalarNanos = timeRun(scalar);
+        std::printf("%s stereo, 60 s: simd %.2f ms (%.0f MB/s), scalar %.2f ms (%.0f MB/s), speedup %.1fx\n",
+                    isFloat ? "f32" : "s16", simdNanos / 1e6, kFrames * frameBytes / (simdNanos / 1e3),
+                    scalarNanos / 1e6, kFrames * frameBytes / (scalarNanos / 1e3),
+                    static_cast<double>(scalarNanos) / simdNanos);
+    }
+}
+
+} // namespace
+
+int main() {
+    testMatchesReference();
+    benchmark();
+    return testResult("peak_decimator_bench");
+}
@@ -0,0 +1,93 @@
+// PolyphaseResampler的主机测试：输入正弦，按回调大小（192帧）取输出，与理想的输出率正弦逐样本比较。
+// 重采样器让第一个输出帧对准第一个输入帧，因此期望输出为 A*sin(2πf·n/outputRate)，相位为0：
+// 比例错误会使相位逐渐漂移，回调之间或输入块之间的相位跳变会在对应位置产生大的误差。
+// 输入按不规则的大小读取，覆盖输入块边界落在任意位置的情况。
+
+#include "host_test.h"
+#include "polyphase_resampler.h"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+constexpr size_t kCallbackFrames = 192;
+constexpr double kToneHz = 1000.0;
+constexpr double kAmplitude = 0.5;
+
+void checkTone(int32_t inputRate, int32_t outputRate, int32_t channels, bool isFloat) {
+    PolyphaseResampler resampler(inputRate, outputRate, channels, isFloat);
+    const size_t sampleBytes = isFloat ? sizeof(float) : sizeof(int16_t);
+    std::mt19937 rng(static_cast<uint32_t>(inputRate + outputRate + channels));
+    int64_t inputFrame = 0;
+    auto reader = [&](void* dst, size_t maxFrames) {
+        const size_t count = std::min<size_t>(maxFrames, 1 + rng() % 97);
+        for (size_t i = 0; i < count; ++i, ++inputFrame) {
+            const double value = kAmplitude * std::sin(2 * M_PI * kToneHz * inputFrame / inputRate);
+            for (int32_t ch = 0; ch < channels; ++ch) {
+                // 第二声道反相，检查声道没有串扰
+                const double sample = ch == 0 ? value : -value;
+                if (isFloat) {
+                    static_cast<float*>(dst)[i * channels + ch] = static_cast<float>(sample);
+                } else {
+                    static_cast<int16_t*>(dst)[i * channels + ch] = static_cast<int16_t>(std::lrint(sample * 32767.0));
+                }
+            }
+        }
+        return count;
+    };
+
+    const size_t callbacks = static_cast<size_t>(outputRate) / kCallbackFrames;  // 约1秒
+    std::vector<uint8_t> out(kCallbackFrames * channels * sampleBytes);
+    double maxError = 0.0;
+    int64_t worstFrame = 0;
+    int64_t outputFrame = 0;
+    for (size_t call = 0; call < callbacks; ++call) {
+        const size_t frames = resampler.render(out.data(), kCallbackFrames, reader);
+        HOST_CHECK(frames == kCallbackFrames, "%d -> %d: short render %zu", inputRate, outputRate, frames);
+        for (size_t i = 0; i < frames; ++i, ++outputFrame) {
+            // 开头半个滤波器长度内包含预置的静音
+            if (outputFrame < PolyphaseResampler::kTaps) continue;
+            const double expected = kAmplitude * std::sin(2 * M_PI * kToneHz * outputFrame / outputRate);
+            for (int32_t ch = 0; ch < channels; ++ch) {
+                const double actual = isFloat ? reinterpret_cast<const float*>(out.data())[i * channels + ch]
+                                              : reinterpret_cast<const int16_t*>(out.data())[i * channels + ch] / 32768.0;
+                const double error = std::fabs(actual - (ch == 0 ? expected : -expected));
+                if (error > maxError) {
+                    maxError = error;
+                    worstFrame = outputFrame;
+                }
+            }
+        }
+    }
+
+    // 输入消耗与输出之比等于采样率之比：已读入的输入 = 已输出对应的输入 + 尚未输出的部分
+    const double consumedPerOutput = (inputFrame - resampler.pendingInputFrames()) / static_cast<double>(outputFrame);
+    const double expectedRatio = static_cast<double>(inputRate) / outputRate;
+
+    std::printf("  %6d -> %6d Hz, %d ch %s: max error %.5f (frame %lld), input/output %.6f (expected %.6f)\n",
+                inputRate, outputRate, channels, isFloat ? "f32" : "s16", maxError,
+                static_cast<long long>(worstFrame), consumedPerOutput, expectedRatio);
+    // 1kHz处的通带误差和s16的量化误差都在1e-4以下，相位跳变或比例错误的误差在0.01以上
+    HOST_CHECK(maxError < 5e-4, "%d -> %d Hz %d ch %s: max error %.5f at output frame %lld", inputRate, outputRate,
+               channels, isFloat ? "f32" : "s16", maxError, static_cast<long long>(worstFrame));
+    HOST_CHECK(std::fabs(consumedPerOutput - expectedRatio) < 1e-3 * expectedRatio,
+               "%d -> %d Hz: input/output %.6f, expected %.6f", inputRate, outputRate, consumedPerOutput,
+               expectedRatio);
+}
+
+} // namespace
+
+int main() {
+    std::printf("polyphase resampler, %.0f Hz tone, %zu-frame callbacks\n", kToneHz, kCallbackFrames);
+    const int32_t rates[][2] = {{44100, 48000}, {48000, 44100}, {22050, 48000}, {96000, 48000}, {48000, 48000},
+                                {32000, 44100}};
+    for (const auto& rate : rates) {
+        for (const int32_t channels : {1, 2}) {
+            for (const bool isFloat : {true, false}) {
+                checkTone(rate[0], rate[1], channels, isFloat);
+            }
+        }
+    }
+    return testResult("polyphase_resampler_test");
+}
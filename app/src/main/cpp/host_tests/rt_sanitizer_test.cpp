@@ -0,0 +1,133 @@
+// 实时安全检查的主机测试：以 LD_PRELOAD=librt_sanitizer.so 运行（由ctest设置），
+// 通过模拟设备线程驱动录音、播放和混音的音频回调，覆盖各自的主要模式和运行中的参数调整，
+// 要求回调范围内的违规次数为0。最后在标记范围内故意分配一次内存，确认拦截确实生效。
+
+#include "host_test.h"
+#include "test_wav.h"
+
+#include <cstdlib>
+#include <thread>
+#include "oboe_mixer.h"
+#include "oboe_player.h"
+#include "oboe_recorder.h"
+#include "rt_sanitizer.h"
+
+extern "C" __attribute__((weak)) uint64_t rt_sanitizer_violation_count();
+
+namespace {
+
+void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+int64_t fileSize(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) return -1;
+    fseeko(file, 0, SEEK_END);
+    const int64_t size = ftello(file);
+    fclose(file);
+    return size;
+}
+
+bool sanitizerCatchesAllocations() {
+    const uint64_t before = rt_sanitizer_violation_count();
+    {
+        RT_CALLBACK_SCOPE("rt_sanitizer_test self-check");
+        void* volatile block = malloc(64);
+        free(block);
+    }
+    return rt_sanitizer_violation_count() >= before + 2;
+}
+
+void runRecorder() {
+    const std::string plain = tempPath(".wav");
+    {
+        OboeRecorder recorder(plain.c_str(), 48000, true, false, 0, 0, 0, 256, 0, 0.0f);
+        HOST_CHECK(recorder.start(), "recorder start failed");
+        sleepMs(400);
+        recorder.stop();
+    }
+    HOST_CHECK(fileSize(plain) > static_cast<int64_t>(kWavHeaderSize), "recorder wrote nothing");
+
+    // 预录模式：触发后历史数据与后续数据写入事件文件
+    const std::string preroll = tempPath(".wav");
+    {
+        OboeRecorder recorder(preroll.c_str(), 48000, false, true, 0, 0, 0, 256, 200, 0.0f);
+        HOST_CHECK(recorder.start(), "preroll recorder start failed");
+        sleepMs(300);
+        recorder.triggerCapture();
+        sleepMs(300);
+        recorder.stop();
+    }
+    unlink(plain.c_str());
+    unlink((plain + ".peaks").c_str());
+    unlink(preroll.c_str());
+}
+
+void runPlayer(const std::string& path, const std::string& next, bool useMmap, float speed) {
+    OboePlayer player(path.c_str(), 48000, true, false, 0, 0, useMmap);
+    HOST_CHECK(player.start(), "player start failed (%s)", useMmap ? "mmap" : "buffered");
+    if (!next.empty()) {
+        player.enqueue(next.c_str());
+    }
+    sleepMs(100);
+    player.setPlaybackSpeed(speed);
+    player.seekToFrame(2000);
+    sleepMs(100);
+    player.setLoop(4800, 9600);
+    sleepMs(150);
+    player.setLoop(0, 0);
+    player.getPresentationPosition();
+    sleepMs(500);
+    HOST_CHECK(player.getPlaybackProgress() > 0.0f, "player made no progress (%s)", useMmap ? "mmap" : "buffered");
+    player.stop();
+}
+
+void runMixer(const std::vector<std::string>& files) {
+    OboeMixer mixer(0, 0);
+    for (size_t i = 0; i < files.size(); ++i) {
+        HOST_CHECK(mixer.addTrack(files[i].c_str(), 48000, true, false) >= 0, "addTrack %zu failed", i);
+    }
+    HOST_CHECK(mixer.start(), "mixer start failed");
+    std::vector<float> peaks(files.size());
+    for (int step = 0; step < 10 && !mixer.isFinished(); ++step) {
+        sleepMs(100);
+        mixer.setTrackGain(step % mixer.trackCount(), 0.5f + 0.1f * step);
+        mixer.setTrackPan(step % mixer.trackCount(), step % 2 ? -0.5f : 0.5f);
+        mixer.setTrackMute((step + 1) % mixer.trackCount(), step % 3 == 0);
+        mixer.setMasterGain(step % 2 ? 0.8f : 1.0f);
+        mixer.readPeaks(peaks.data());
+    }
+    HOST_CHECK(mixer.getStats().callCount > 0, "mixer callback never ran");
+    mixer.stop();
+}
+
+} // namespace
+
+int main() {
+    if (!rt_sanitizer_violation_count) {
+        std::fprintf(stderr, "librt_sanitizer.so is not preloaded\n");
+        return 1;
+    }
+    const std::string stereo48k = writeTestWav(48000, 2, false, 0.8);
+    const std::string stereo48kNext = writeTestWav(48000, 2, false, 0.3, 660.0);
+    const std::string mono44k = writeTestWav(44100, 1, true, 0.8);
+
+    runRecorder();
+    runPlayer(stereo48k, stereo48kNext, true, 1.5f);
+    runPlayer(mono44k, std::string(), false, 0.75f);
+    runMixer({stereo48k, mono44k, stereo48kNext, mono44k});
+
+    const uint64_t violations = rt_sanitizer_violation_count();
+    std::printf("real-time violations in recorder/player/mixer callbacks: %llu\n",
+                static_cast<unsigned long long>(violations));
+    HOST_CHECK(violations == 0, "see the RtSanitizer report above");
+
+    // 自检放在最后，退出时的汇总报告只会列出这一处
+    HOST_CHECK(sanitizerCatchesAllocations(), "allocation inside a callback scope was not detected");
+
+    unlink(stereo48k.c_str());
+    unlink(stereo48kNext.c_str());
+    unlink(mono44k.c_str());
+    return testResult("rt_sanitizer_test");
+}
@@ -0,0 +1,37 @@
+#ifndef HOST_TESTS_ANDROID_LOG_H
+#define HOST_TESTS_ANDROID_LOG_H
+
+/* 主机测试用的 <android/log.h> 替身：警告及以上级别输出到stderr，其余丢弃。C与C++均可包含 */
+#include <stdarg.h>
+#include <stdio.h>
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT
+};
+
+static inline int __android_log_write(int prio, const char* tag, const char* text) {
+    if (prio < ANDROID_LOG_WARN) return 0;
+    return fprintf(stderr, "[%s] %s\n", tag, text);
+}
+
+__attribute__((format(printf, 3, 4)))
+static inline int __android_log_print(int prio, const char* tag, const char* fmt, ...) {
+    if (prio < ANDROID_LOG_WARN) return 0;
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[%s] ", tag);
+    const int written = vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+    va_end(args);
+    return written;
+}
+
+#endif /* HOST_TESTS_ANDROID_LOG_H */
@@ -0,0 +1,183 @@
+// 主机测试用的 libavutil 替身：只实现 FftCorrelator 用到的双精度实数FFT（AV_TX_DOUBLE_RDFT）
+// 和内存函数。语义与 libavutil/tx.h 的说明一致：正变换把N个实数变为N/2+1个复数，
+// 逆变换反之，两者都不归一化，结果乘以scale（为空时为1）。
+// 实数变换按常规做法打包为N/2点的基2复数FFT再拆分，只支持2的幂长度，FftCorrelator只会请求这种长度。
+// 只求结果正确、速度过得去，没有FFmpeg的SIMD优化，基准中的FFT耗时明显偏高。
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/tx.h>
+}
+
+struct AVTXContext {
+    int len = 0;  // 实数长度N
+    bool inverse = false;
+    double scale = 1.0;
+    std::vector<double> re;         // N/2点复数工作区
+    std::vector<double> im;
+    std::vector<double> cosTable;   // cos(2πk/N)，k < N/2
+    std::vector<double> sinTable;   // sin(2πk/N)
+    std::vector<uint32_t> bitReverse;  // N/2点的位反转置换
+};
+
+namespace {
+
+// N/2点原地基2 FFT，inverse为false时是正变换exp(-i...)，为true时是逆变换exp(+i...)
+// N/2点变换第len级的旋转因子exp(∓2πik/len)取实数长度N的表中第k*(N/len)项
+void fft(AVTXContext* s, bool inverse) {
+    double* re = s->re.data();
+    double* im = s->im.data();
+    const size_t n = s->re.size();
+    for (size_t i = 0; i < n; ++i) {
+        const size_t j = s->bitReverse[i];
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    const double sign = inverse ? 1.0 : -1.0;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = 2 * n / len;
+        for (size_t block = 0; block < n; block += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const double wr = s->cosTable[k * step];
+                const double wi = sign * s->sinTable[k * step];
+                const size_t i = block + k;
+                const size_t j = i + half;
+                const double vr = re[j] * wr - im[j] * wi;
+                const double vi = re[j] * wi + im[j] * wr;
+                re[j] = re[i] - vr;
+                im[j] = im[i] - vi;
+                re[i] += vr;
+                im[i] += vi;
+            }
+        }
+    }
+}
+
+// 偶数样本作实部、奇数样本作虚部做N/2点变换，再拆成实数序列的N/2+1个频点：
+// X[k] = (Z[k] + conj(Z[N/2-k]))/2 + exp(-2πik/N) (Z[k] - conj(Z[N/2-k]))/(2i)
+void rdftForward(AVTXContext* s, void* out, void* in, ptrdiff_t stride) {
+    const auto* input = static_cast<const double*>(in);
+    const size_t half = s->re.size();
+    const ptrdiff_t step = stride / static_cast<ptrdiff_t>(sizeof(double));
+    for (size_t i = 0; i < half; ++i) {
+        s->re[i] = input[(2 * i) * step];
+        s->im[i] = input[(2 * i + 1) * step];
+    }
+    fft(s, false);
+    auto* output = static_cast<AVComplexDouble*>(out);
+    for (size_t k = 0; k <= half; ++k) {
+        const size_t a = k % half;
+        const size_t b = (half - k) % half;
+        const double evenRe = 0.5 * (s->re[a] + s->re[b]);
+        const double evenIm = 0.5 * (s->im[a] - s->im[b]);
+        const double oddRe = 0.5 * (s->im[a] + s->im[b]);
+        const double oddIm = -0.5 * (s->re[a] - s->re[b]);
+        const double c = k < half ? s->cosTable[k] : -1.0;
+        const double sn = k < half ? -s->sinTable[k] : 0.0;
+        output[k].re = (evenRe + c * oddRe - sn * oddIm) * s->scale;
+        output[k].im = (evenIm + c * oddIm + sn * oddRe) * s->scale;
+    }
+}
+
+// 正变换拆分的逆过程：由X[k]与X[N/2-k]恢复Z[k]，N/2点逆变换后交错为实数
+void rdftInverse(AVTXContext* s, void* out, void* in, ptrdiff_t stride) {
+    const auto* input = static_cast<const uint8_t*>(in);
+    const size_t half = s->re.size();
+    auto bin = [&](size_t k) { return reinterpret_cast<const AVComplexDouble*>(input + k * stride); };
+    for (size_t k = 0; k < half; ++k) {
+        const AVComplexDouble* x = bin(k);
+        const AVComplexDouble* y = bin(half - k);
+        // E = (X[k] + conj(X[N/2-k]))，O = (X[k] - conj(X[N/2-k])) * exp(+2πik/N)
+        const double evenRe = x->re + y->re;
+        const double evenIm = x->im - y->im;
+        const double diffRe = x->re - y->re;
+        const double diffIm = x->im + y->im;
+        const double c = s->cosTable[k];
+        const double sn = s->sinTable[k];
+        const double oddRe = diffRe * c - diffIm * sn;
+        const double oddIm = diffRe * sn + diffIm * c;
+        // Z = E + i*O
+        s->re[k] = evenRe - oddIm;
+        s->im[k] = evenIm + oddRe;
+    }
+    fft(s, true);
+    auto* output = static_cast<double*>(out);
+    for (size_t i = 0; i < half; ++i) {
+        output[2 * i] = s->re[i] * s->scale;
+        output[2 * i + 1] = s->im[i] * s->scale;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+int av_tx_init(AVTXContext** ctx, av_tx_fn* tx, enum AVTXType type, int inv, int len, const void* scale,
+               uint64_t flags) {
+    if (type != AV_TX_DOUBLE_RDFT || len < 4 || (len & (len - 1)) != 0) {
+        return -22;  // AVERROR(EINVAL)
+    }
+    auto* s = new AVTXContext();
+    s->len = len;
+    s->inverse = inv != 0;
+    s->scale = scale ? *static_cast<const double*>(scale) : 1.0;
+    const size_t half = static_cast<size_t>(len) / 2;
+    s->re.resize(half);
+    s->im.resize(half);
+    s->cosTable.resize(half);
+    s->sinTable.resize(half);
+    for (size_t k = 0; k < half; ++k) {
+        s->cosTable[k] = std::cos(2.0 * M_PI * k / len);
+        s->sinTable[k] = std::sin(2.0 * M_PI * k / len);
+    }
+    s->bitReverse.resize(half);
+    int bits = 0;
+    while ((size_t{1} << bits) < half) ++bits;
+    for (size_t i = 0; i < half; ++i) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (size_t{1} << b)) r |= 1u << (bits - 1 - b);
+        }
+        s->bitReverse[i] = r;
+    }
+    *ctx = s;
+    *tx = s->inverse ? rdftInverse : rdftForward;
+    return 0;
+}
+
+void av_tx_uninit(AVTXContext** ctx) {
+    delete *ctx;
+    *ctx = nullptr;
+}
+
+void* av_malloc(size_t size) {
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, 64, size ? size : 1) == 0 ? ptr : nullptr;
+}
+
+void* av_malloc_array(size_t nmemb, size_t size) {
+    if (size != 0 && nmemb > SIZE_MAX / size) return nullptr;
+    return av_malloc(nmemb * size);
+}
+
+void av_free(void* ptr) {
+    free(ptr);
+}
+
+void av_freep(void* arg) {
+    void* ptr;
+    memcpy(&ptr, arg, sizeof(ptr));
+    av_free(ptr);
+    ptr = nullptr;
+    memcpy(arg, &ptr, sizeof(ptr));
+}
+
+} // extern "C"
@@ -0,0 +1,56 @@
+// 主机上没有FFmpeg：依赖它的类以"不可用"实现链接，压缩格式在主机测试中一律打开失败
+
+#include "DecoderSource.h"
+#include "flac_encoder_sink.h"
+
+DecoderSource::DecoderSource() {
+    sem_init(&wake_, 0, 0);
+}
+
+DecoderSource::~DecoderSource() {
+    sem_destroy(&wake_);
+}
+
+bool DecoderSource::isCompressedFile(const char*) { return false; }
+bool DecoderSource::open(const char*) { return false; }
+bool DecoderSource::start() { return false; }
+void DecoderSource::stop() {}
+void DecoderSource::close() {}
+size_t DecoderSource::read(void*, size_t, bool*) { return 0; }
+bool DecoderSource::finished() const { return true; }
+void DecoderSource::seek(int64_t) {}
+void DecoderSource::setLoop(int64_t, int64_t) {}
+
+FlacEncoderSink::FlacEncoderSink(const char* filePath, int32_t sampleRate, int32_t channelCount, bool isFloat,
+                                 int32_t)
+    : filePath_(filePath)
+    , fallbackPath_(filePath)
+    , sampleRate_(sampleRate)
+    , channelCount_(channelCount)
+    , isFloat_(isFloat)
+    , bytesPerFrame_(0)
+    , queue_(0)
+    , degraded_(true)
+    , formatContext_(nullptr)
+    , codecContext_(nullptr)
+    , stream_(nullptr)
+    , frame_(nullptr)
+    , packet_(nullptr)
+    , frameSize_(0)
+    , closing_(false)
+    , encodedFrames_(0)
+    , cpuNanos_(0)
+    , maxQueueBytes_(0)
+    , fallbackBytes_(0)
+    , outputBytes_(0) {
+    sem_init(&dataReady_, 0, 0);
+}
+
+FlacEncoderSink::~FlacEncoderSink() {
+    sem_destroy(&dataReady_);
+}
+
+bool FlacEncoderSink::start() { return false; }
+void FlacEncoderSink::write(const void*, size_t) {}
+void FlacEncoderSink::close() {}
+FlacSinkStats FlacEncoderSink::getStats() const { return {}; }
@@ -0,0 +1,56 @@
+#ifndef HOST_TESTS_JNI_H
+#define HOST_TESTS_JNI_H
+
+// 主机测试用的 <jni.h> 替身：只声明被测代码用到的类型与方法，没有JVM，所有调用都返回失败或空操作
+
+#include <cstdint>
+
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef int8_t jbyte;
+typedef uint8_t jboolean;
+typedef int16_t jshort;
+typedef uint16_t jchar;
+typedef float jfloat;
+typedef double jdouble;
+typedef jint jsize;
+
+class _jobject {};
+class _jclass : public _jobject {};
+class _jstring : public _jobject {};
+typedef _jobject* jobject;
+typedef _jclass* jclass;
+typedef _jstring* jstring;
+struct _jmethodID;
+typedef _jmethodID* jmethodID;
+
+#define JNI_OK 0
+#define JNI_ERR (-1)
+#define JNI_EDETACHED (-2)
+#define JNI_VERSION_1_6 0x00010006
+
+struct JavaVMAttachArgs {
+    jint version;
+    const char* name;
+    jobject group;
+};
+
+struct _JNIEnv {
+    jstring NewStringUTF(const char*) { return nullptr; }
+    void CallVoidMethod(jobject, jmethodID, ...) {}
+    void DeleteLocalRef(jobject) {}
+    void DeleteGlobalRef(jobject) {}
+    jboolean ExceptionCheck() { return 0; }
+    void ExceptionDescribe() {}
+    void ExceptionClear() {}
+};
+typedef _JNIEnv JNIEnv;
+
+struct _JavaVM {
+    jint GetEnv(void**, jint) { return JNI_ERR; }
+    jint AttachCurrentThread(JNIEnv**, void*) { return JNI_ERR; }
+    jint DetachCurrentThread() { return JNI_OK; }
+};
+typedef _JavaVM JavaVM;
+
+#endif // HOST_TESTS_JNI_H
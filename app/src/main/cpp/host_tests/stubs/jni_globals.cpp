@@ -0,0 +1,7 @@
+// 被测代码引用的JNI全局变量（定义在demo_jni.cpp中），主机上没有JVM，全部为空
+#include <jni.h>
+
+JavaVM* javaVm = nullptr;
+jmethodID onErrorMethodId = nullptr;
+jmethodID onPlaybackCompleteMethodId = nullptr;
+jobject recorderViewModel = nullptr;
@@ -0,0 +1,210 @@
+#ifndef HOST_TESTS_OBOE_H
+#define HOST_TESTS_OBOE_H
+
+// 主机测试用的 <oboe/Oboe.h> 替身：只实现被测代码用到的接口。
+// requestStart() 启动一个模拟设备线程，按真实时间每 kBurstFrames 帧调用一次数据回调；
+// 输入流的缓冲区填入正弦波，输出流的数据被丢弃。回调返回 Stop 或调用 stop() 后线程退出。
+// 基准可以打开 manualCallbacks()，此时不启动设备线程，由测试自己直接调用回调。
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace oboe {
+
+constexpr int32_t kUnspecified = 0;
+
+enum class Result : int32_t { OK = 0, ErrorInvalidState = -895, ErrorUnimplemented = -890 };
+enum class DataCallbackResult : int32_t { Continue, Stop };
+enum class Direction { Output, Input };
+enum class AudioFormat { Invalid, Unspecified, I16, Float };
+enum class PerformanceMode { None, PowerSaving, LowLatency };
+enum class SharingMode { Exclusive, Shared };
+enum class AudioApi { Unspecified, OpenSLES, AAudio };
+enum class InputPreset { Generic, Camcorder, VoiceRecognition, VoiceCommunication, Unprocessed, VoicePerformance };
+enum class SampleRateConversionQuality { None, Fastest, Low, Medium, High, Best };
+
+struct FrameTimestamp {
+    int64_t position;
+    int64_t timestamp;
+};
+
+template <typename T>
+class ResultWithValue {
+public:
+    ResultWithValue(Result error) : value_(), error_(error) {}
+    ResultWithValue(T value) : value_(value), error_(Result::OK) {}
+    T value() const { return value_; }
+    Result error() const { return error_; }
+    explicit operator bool() const { return error_ == Result::OK; }
+
+private:
+    T value_;
+    Result error_;
+};
+
+class AudioStream;
+
+class AudioStreamDataCallback {
+public:
+    virtual ~AudioStreamDataCallback() = default;
+    virtual DataCallbackResult onAudioReady(AudioStream* stream, void* audioData, int32_t numFrames) = 0;
+};
+
+class AudioStreamErrorCallback {
+public:
+    virtual ~AudioStreamErrorCallback() = default;
+    virtual bool onError(AudioStream*, Result) { return false; }
+    virtual void onErrorBeforeClose(AudioStream*, Result) {}
+    virtual void onErrorAfterClose(AudioStream*, Result) {}
+};
+
+class AudioStreamCallback : public AudioStreamDataCallback, public AudioStreamErrorCallback {};
+
+struct StreamConfig {
+    Direction direction = Direction::Output;
+    AudioFormat format = AudioFormat::Float;
+    int32_t sampleRate = kUnspecified;
+    int32_t channelCount = 2;
+    AudioStreamDataCallback* dataCallback = nullptr;
+};
+
+class AudioStream {
+public:
+    static constexpr int32_t kBurstFrames = 192;
+
+    // 未指定采样率时模拟设备的原生采样率
+    static int32_t& deviceSampleRate() {
+        static int32_t rate = 48000;
+        return rate;
+    }
+
+    // 为true时requestStart()不启动设备线程
+    static bool& manualCallbacks() {
+        static bool manual = false;
+        return manual;
+    }
+
+    explicit AudioStream(const StreamConfig& config)
+        : config_(config)
+        , sampleRate_(config.sampleRate != kUnspecified ? config.sampleRate : deviceSampleRate()) {}
+
+    ~AudioStream() { stop(); }
+
+    Result requestStart() {
+        if (thread_.joinable()) return Result::ErrorInvalidState;
+        if (manualCallbacks()) return Result::OK;
+        running_ = true;
+        thread_ = std::thread(&AudioStream::deviceThread, this);
+        return Result::OK;
+    }
+
+    Result stop() {
+        running_ = false;
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+            thread_.join();
+        }
+        return Result::OK;
+    }
+
+    Result requestStop() { return stop(); }
+    Result close() { return stop(); }
+
+    int32_t getSampleRate() const { return sampleRate_; }
+    int32_t getChannelCount() const { return config_.channelCount; }
+    AudioFormat getFormat() const { return config_.format; }
+    int32_t getBufferSizeInFrames() const { return kBurstFrames * 2; }
+    int64_t getFramesProcessed() const { return framesProcessed_.load(); }
+
+    ResultWithValue<FrameTimestamp> getTimestamp(int32_t) {
+        const int64_t processed = framesProcessed_.load();
+        if (processed < getBufferSizeInFrames()) return Result::ErrorInvalidState;
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        return FrameTimestamp{processed - getBufferSizeInFrames(), now};
+    }
+
+private:
+    void deviceThread() {
+        const size_t sampleBytes = config_.format == AudioFormat::I16 ? sizeof(int16_t) : sizeof(float);
+        std::vector<uint8_t> buffer(static_cast<size_t>(kBurstFrames) * config_.channelCount * sampleBytes);
+        const auto period = std::chrono::nanoseconds(1000000000LL * kBurstFrames / sampleRate_);
+        auto next = std::chrono::steady_clock::now();
+        double phase = 0.0;
+        while (running_) {
+            if (config_.direction == Direction::Input) {
+                fillSine(buffer.data(), phase);
+            }
+            if (config_.dataCallback->onAudioReady(this, buffer.data(), kBurstFrames) == DataCallbackResult::Stop) {
+                break;
+            }
+            framesProcessed_ += kBurstFrames;
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+        running_ = false;
+    }
+
+    void fillSine(uint8_t* data, double& phase) {
+        const double step = 2.0 * M_PI * 440.0 / sampleRate_;
+        for (int32_t frame = 0; frame < kBurstFrames; ++frame, phase += step) {
+            const double value = 0.5 * std::sin(phase);
+            for (int32_t ch = 0; ch < config_.channelCount; ++ch) {
+                const size_t index = static_cast<size_t>(frame) * config_.channelCount + ch;
+                if (config_.format == AudioFormat::I16) {
+                    reinterpret_cast<int16_t*>(data)[index] = static_cast<int16_t>(value * 32767.0);
+                } else {
+                    reinterpret_cast<float*>(data)[index] = static_cast<float>(value);
+                }
+            }
+        }
+    }
+
+    const StreamConfig config_;
+    const int32_t sampleRate_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<int64_t> framesProcessed_{0};
+};
+
+class AudioStreamBuilder {
+public:
+    AudioStreamBuilder* setDirection(Direction direction) { config_.direction = direction; return this; }
+    AudioStreamBuilder* setFormat(AudioFormat format) { config_.format = format; return this; }
+    AudioStreamBuilder* setSampleRate(int32_t rate) { config_.sampleRate = rate; return this; }
+    AudioStreamBuilder* setChannelCount(int32_t count) { config_.channelCount = count; return this; }
+    AudioStreamBuilder* setDataCallback(AudioStreamDataCallback* callback) { config_.dataCallback = callback; return this; }
+    AudioStreamBuilder* setErrorCallback(AudioStreamErrorCallback*) { return this; }
+    AudioStreamBuilder* setCallback(AudioStreamCallback* callback) { config_.dataCallback = callback; return this; }
+    AudioStreamBuilder* setPerformanceMode(PerformanceMode) { return this; }
+    AudioStreamBuilder* setSharingMode(SharingMode) { return this; }
+    AudioStreamBuilder* setAudioApi(AudioApi) { return this; }
+    AudioStreamBuilder* setDeviceId(int32_t) { return this; }
+    AudioStreamBuilder* setInputPreset(InputPreset) { return this; }
+    AudioStreamBuilder* setSampleRateConversionQuality(SampleRateConversionQuality) { return this; }
+
+    Result openStream(std::shared_ptr<AudioStream>& stream) {
+        if (!config_.dataCallback) return Result::ErrorInvalidState;
+        stream = std::make_shared<AudioStream>(config_);
+        return Result::OK;
+    }
+
+private:
+    StreamConfig config_;
+};
+
+inline const char* convertToText(Result result) {
+    return result == Result::OK ? "OK" : "Error";
+}
+
+inline const char* convertToText(AudioStream*) {
+    return "host stream";
+}
+
+} // namespace oboe
+
+#endif // HOST_TESTS_OBOE_H
@@ -0,0 +1,40 @@
+#ifndef HOST_TEST_DELAY_SIGNAL_H
+#define HOST_TEST_DELAY_SIGNAL_H
+
+// 延迟检测测试用的合成信号：左声道为近似音乐的信号，右声道为它延迟、衰减后加独立噪声
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// 两级一阶低通的噪声，加上不成谐波关系的正弦；互相关主峰宽于时域粗搜索的步进
+inline std::vector<float> musicLike(size_t frames, int32_t sampleRate, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> signal(frames);
+    float stage1 = 0.0f;
+    float stage2 = 0.0f;
+    for (size_t i = 0; i < signal.size(); ++i) {
+        stage1 += 0.02f * (noise(rng) - stage1);
+        stage2 += 0.02f * (stage1 - stage2);
+        const double t = static_cast<double>(i) / sampleRate;
+        signal[i] = 2.0f * stage2 + static_cast<float>(0.05 * std::sin(2 * M_PI * 173.0 * t) +
+                                                       0.03 * std::sin(2 * M_PI * 311.0 * t));
+    }
+    return signal;
+}
+
+// right[i] = gain * left[i - delay] + 噪声
+inline std::vector<float> delayed(const std::vector<float>& left, size_t delay, float gain, float noiseLevel,
+                                  uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, noiseLevel);
+    std::vector<float> right(left.size());
+    for (size_t i = 0; i < right.size(); ++i) {
+        right[i] = (i >= delay ? gain * left[i - delay] : 0.0f) + noise(rng);
+    }
+    return right;
+}
+
+#endif // HOST_TEST_DELAY_SIGNAL_H
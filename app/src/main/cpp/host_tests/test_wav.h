@@ -0,0 +1,49 @@
+#ifndef HOST_TEST_WAV_H
+#define HOST_TEST_WAV_H
+
+// 生成测试用的WAV文件：正弦波，格式与录音文件相同（写入器和文件头由被测代码提供）
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "wav_data_writer.h"
+
+inline std::string tempPath(const char* suffix) {
+    std::string path = std::string("/tmp/host_test_XXXXXX") + suffix;
+    std::vector<char> buffer(path.begin(), path.end());
+    buffer.push_back('\0');
+    const int fd = mkstemps(buffer.data(), static_cast<int>(std::string(suffix).size()));
+    if (fd >= 0) close(fd);
+    return buffer.data();
+}
+
+inline std::string writeTestWav(int32_t sampleRate, int32_t channels, bool isFloat, double seconds,
+                                double frequency = 440.0) {
+    const std::string path = tempPath(".wav");
+    WavFormat format;
+    format.sampleRate = sampleRate;
+    format.channelCount = channels;
+    format.isFloat = isFloat;
+    WavDataWriter writer(path.c_str(), format);
+
+    const auto frames = static_cast<size_t>(sampleRate * seconds);
+    std::vector<uint8_t> data(frames * format.bytesPerFrame());
+    for (size_t frame = 0; frame < frames; ++frame) {
+        const double value = 0.5 * std::sin(2.0 * M_PI * frequency * frame / sampleRate);
+        for (int32_t ch = 0; ch < channels; ++ch) {
+            const size_t index = frame * channels + ch;
+            if (isFloat) {
+                reinterpret_cast<float*>(data.data())[index] = static_cast<float>(value);
+            } else {
+                reinterpret_cast<int16_t*>(data.data())[index] = static_cast<int16_t>(value * 32767.0);
+            }
+        }
+    }
+    writer.write(data.data(), data.size());
+    writer.updateHeader();
+    return path;
+}
+
+#endif // HOST_TEST_WAV_H
@@ -0,0 +1,136 @@
+// WsolaTimeStretcher基准：按回调大小（192帧）驱动render()，统计每秒输出音频的CPU耗时，
+// 以及单次回调的最大耗时占回调周期的比例。覆盖单/双声道、s16/f32和[0.5, 3.0]内的各档速度。
+// 同时检查：速度为1时输出与输入逐样本相同；其它速度下消耗的输入与输出之比接近设定速度。
+// 相似度搜索的点积由 time_stretcher.cpp 自己的dotAndEnergy计算：主机上为SSE，设备上的NEON需在ARM上运行本程序。
+
+#include "host_test.h"
+#include "time_stretcher.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr size_t kCallbackFrames = 192;
+constexpr double kOutputSeconds = 20.0;
+
+// 输入信号：几个不成谐波关系的正弦加噪声，接近音乐，互相关的峰不会太尖锐。
+// 预先生成几秒循环读取，计时中只有拷贝
+class SignalSource {
+public:
+    SignalSource(int32_t channels, bool isFloat)
+        : frameBytes_(channels * (isFloat ? 4 : 2)), data_(kLoopFrames * frameBytes_) {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+        for (size_t frame = 0; frame < kLoopFrames; ++frame) {
+            const double t = static_cast<double>(frame) / kSampleRate;
+            for (int32_t ch = 0; ch < channels; ++ch) {
+                const float value = static_cast<float>(0.3 * std::sin(2 * M_PI * 220.0 * t + ch) +
+                                                       0.2 * std::sin(2 * M_PI * 331.0 * t) +
+                                                       0.1 * std::sin(2 * M_PI * 1187.0 * t)) + noise(rng);
+                const size_t index = frame * channels + ch;
+                if (isFloat) {
+                    reinterpret_cast<float*>(data_.data())[index] = value;
+                } else {
+                    reinterpret_cast<int16_t*>(data_.data())[index] = static_cast<int16_t>(std::lrint(value * 32767.0f));
+                }
+            }
+        }
+    }
+
+    size_t read(void* dst, size_t maxFrames) {
+        auto* out = static_cast<uint8_t*>(dst);
+        for (size_t done = 0; done < maxFrames;) {
+            const size_t offset = static_cast<size_t>(position_ % kLoopFrames);
+            const size_t count = std::min(maxFrames - done, kLoopFrames - offset);
+            memcpy(out + done * frameBytes_, data_.data() + offset * frameBytes_, count * frameBytes_);
+            done += count;
+            position_ += static_cast<int64_t>(count);
+        }
+        return maxFrames;
+    }
+
+    int64_t position() const { return position_; }
+
+private:
+    static constexpr size_t kLoopFrames = kSampleRate * 4;
+    const size_t frameBytes_;
+    std::vector<uint8_t> data_;
+    int64_t position_ = 0;
+};
+
+// 速度为1时WSOLA直接取自然延续的位置，输出应与输入逐字节相同
+void checkUnitSpeedIsIdentity(int32_t channels, bool isFloat) {
+    const size_t frameBytes = channels * (isFloat ? 4 : 2);
+    WsolaTimeStretcher stretcher(kSampleRate, channels, isFloat);
+    stretcher.setSpeed(1.0f);
+    SignalSource source(channels, isFloat);
+    SignalSource reference(channels, isFloat);
+    std::vector<uint8_t> out(kCallbackFrames * frameBytes);
+    std::vector<uint8_t> expected(kCallbackFrames * frameBytes);
+    size_t mismatches = 0;
+    for (int call = 0; call < 500; ++call) {
+        const size_t frames = stretcher.render(out.data(), kCallbackFrames,
+                [&](void* dst, size_t maxFrames, bool&) { return source.read(dst, maxFrames); });
+        reference.read(expected.data(), frames);
+        if (memcmp(out.data(), expected.data(), frames * frameBytes) != 0) {
+            ++mismatches;
+        }
+    }
+    HOST_CHECK(mismatches == 0, "speed 1.0 is not an identity (%d ch, %s): %zu mismatched callbacks",
+               channels, isFloat ? "f32" : "s16", mismatches);
+}
+
+void benchmark(int32_t channels, bool isFloat, float speed) {
+    const size_t frameBytes = channels * (isFloat ? 4 : 2);
+    WsolaTimeStretcher stretcher(kSampleRate, channels, isFloat);
+    stretcher.setSpeed(speed);
+    SignalSource source(channels, isFloat);
+    std::vector<uint8_t> out(kCallbackFrames * frameBytes);
+
+    const size_t callbacks = static_cast<size_t>(kOutputSeconds * kSampleRate / kCallbackFrames);
+    LatencyStats stats;
+    int64_t totalNanos = 0;
+    size_t produced = 0;
+    for (size_t call = 0; call < callbacks; ++call) {
+        const int64_t begin = nowNanos();
+        produced += stretcher.render(out.data(), kCallbackFrames,
+                [&](void* dst, size_t maxFrames, bool&) { return source.read(dst, maxFrames); });
+        const int64_t elapsed = nowNanos() - begin;
+        totalNanos += elapsed;
+        stats.add(elapsed);
+    }
+    HOST_CHECK(produced == callbacks * kCallbackFrames, "stretcher underran with an endless source");
+
+    // 输入由render按需读取，读取的总量与速度成正比；缓冲中未输出的部分不计
+    const double consumed = static_cast<double>(source.position() - stretcher.pendingInputFrames());
+    const double ratio = consumed / produced;
+    HOST_CHECK(std::fabs(ratio - speed) < 0.02 * speed, "input/output ratio %.3f at speed %.2f", ratio, speed);
+
+    // 单次最大耗时受主机调度影响较大，以平均耗时和p99为准
+    const double audioSeconds = static_cast<double>(produced) / kSampleRate;
+    const double callbackPeriodNanos = 1e9 * kCallbackFrames / kSampleRate;
+    std::printf("  %d ch %s  speed %.2f: %6.2f ms/s  (%.2f%% CPU)  p99 %5.1f us  max %6.1f us (%5.1f%% of callback)\n",
+                channels, isFloat ? "f32" : "s16", speed, totalNanos / 1e6 / audioSeconds,
+                totalNanos / 1e7 / audioSeconds, stats.percentile(0.99) / 1e3, stats.max() / 1e3,
+                100.0 * stats.max() / callbackPeriodNanos);
+}
+
+} // namespace
+
+int main() {
+    std::printf("time stretcher, %d Hz, %zu-frame callbacks, %.0f s of output per case\n",
+                kSampleRate, kCallbackFrames, kOutputSeconds);
+    const float speeds[] = {0.5f, 0.75f, 1.0f, 1.25f, 1.5f, 2.0f, 2.5f, 3.0f};
+    for (const int32_t channels : {1, 2}) {
+        for (const bool isFloat : {false, true}) {
+            checkUnitSpeedIsIdentity(channels, isFloat);
+            for (const float speed : speeds) {
+                benchmark(channels, isFloat, speed);
+            }
+        }
+    }
+    return testResult("time_stretcher_bench");
+}
@@ -0,0 +1,102 @@
+// 单窗口延迟检测基准：700ms窗口、0~500ms延迟范围（与LatencyTester相同），
+// 每个窗口分别计时FFT NCC（detectWindowDelayNcc）、时域NCC搜索（detectWindowDelayNccDirect）和GCC-PHAT，
+// 报告平均和最大耗时以及FFT相对时域搜索的加速比，同时检查两种NCC给出相同的延迟。
+// 找到主机的libavutil时链接它，否则FFT由 stubs/av_tx_reference.cpp 的基2参考实现提供，
+// 后者比FFmpeg的av_tx慢得多；时域搜索在主机上走AVX2内核。因此主机上的加速比明显小于设备，
+// 设备上的数字需在ARM上以FFmpeg构建本程序。
+
+#include "host_test.h"
+#include "test_delay_signal.h"
+
+#include "config.h"
+#include "ncc_kernels.h"
+#include "window_delay_detector.h"
+
+#include <cmath>
+
+namespace {
+
+constexpr size_t kWindowSize = static_cast<size_t>(kSampleRate * 0.7);
+constexpr size_t kMaxDelay = static_cast<size_t>(kSampleRate * 0.5);
+constexpr size_t kWindowStart = 1000;
+constexpr size_t kTotalFrames = kWindowStart + kWindowSize + kMaxDelay + 1000;
+constexpr int kWindows = 8;
+
+#if defined(HOST_AV_TX_REFERENCE)
+constexpr const char* kFftName = "reference radix-2 (stub)";
+#else
+constexpr const char* kFftName = "libavutil av_tx";
+#endif
+
+double millis(int64_t nanos) {
+    return nanos / 1e6;
+}
+
+} // namespace
+
+int main() {
+    std::printf("window delay detector, window %zu samples, lags 0..%zu, fft: %s, ncc kernel: %s\n", kWindowSize,
+                kMaxDelay, kFftName, nccKernelName());
+
+    // 与LatencyTester的每线程暂存区相同，FFT计划在窗口之间复用；第一个窗口之前先建好计划
+    WindowDelayScratch scratch;
+    LatencyStats fftStats;
+    LatencyStats directStats;
+    LatencyStats gccStats;
+    int64_t fftTotal = 0;
+    int64_t directTotal = 0;
+    int64_t gccTotal = 0;
+    for (int window = -1; window < kWindows; ++window) {
+        const uint32_t seed = 100 + static_cast<uint32_t>(window + 1);
+        const size_t delay = 500 + static_cast<size_t>(window + 1) * 2345;
+        const std::vector<float> left = musicLike(kTotalFrames, kSampleRate, seed);
+        const std::vector<float> right = delayed(left, delay, 0.5f, 0.02f, seed + 1000);
+
+        double fftDelay = 0.0;
+        double fftCorr = 0.0;
+        int64_t begin = nowNanos();
+        const bool fftOk = detectWindowDelayNcc(left, right, kWindowStart, kWindowSize, kTotalFrames, scratch,
+                                                fftDelay, fftCorr);
+        const int64_t fftNanos = nowNanos() - begin;
+
+        size_t directDelay = 0;
+        double directCorr = 0.0;
+        begin = nowNanos();
+        const bool directOk = detectWindowDelayNccDirect(left, right, kWindowStart, kWindowSize, kTotalFrames,
+                                                         directDelay, directCorr);
+        const int64_t directNanos = nowNanos() - begin;
+
+        double gccDelay = 0.0;
+        double gccConfidence = 0.0;
+        begin = nowNanos();
+        const bool gccOk = detectWindowDelayGccPhat(left, right, kWindowStart, kWindowSize, kTotalFrames, scratch,
+                                                    gccDelay, gccConfidence);
+        const int64_t gccNanos = nowNanos() - begin;
+
+        HOST_CHECK(fftOk && directOk && gccOk, "window %d: fft %d direct %d gcc %d", window, fftOk, directOk, gccOk);
+        HOST_CHECK(fftDelay == static_cast<double>(directDelay) && directDelay == delay,
+                   "window %d: delay %zu, fft %.1f, direct %zu", window, delay, fftDelay, directDelay);
+        if (window < 0) {
+            continue;  // 预热：建立FFT计划和缓冲区
+        }
+        fftStats.add(fftNanos);
+        directStats.add(directNanos);
+        gccStats.add(gccNanos);
+        fftTotal += fftNanos;
+        directTotal += directNanos;
+        gccTotal += gccNanos;
+        std::printf("  window %d delay %5zu: fft ncc %7.2f ms  direct ncc %8.2f ms  gcc-phat %7.2f ms\n", window,
+                    delay, millis(fftNanos), millis(directNanos), millis(gccNanos));
+    }
+
+    const double fftAvg = millis(fftTotal) / kWindows;
+    const double directAvg = millis(directTotal) / kWindows;
+    const double gccAvg = millis(gccTotal) / kWindows;
+    std::printf("per window: fft ncc avg %.2f ms (max %.2f)  direct ncc avg %.2f ms (max %.2f)  "
+                "gcc-phat avg %.2f ms (max %.2f)  speed-up %.1fx\n",
+                fftAvg, millis(fftStats.max()), directAvg, millis(directStats.max()), gccAvg,
+                millis(gccStats.max()), directAvg / fftAvg);
+    HOST_CHECK(fftAvg < directAvg, "fft ncc (%.2f ms) is not faster than the direct search (%.2f ms)", fftAvg,
+               directAvg);
+    return testResult("window_delay_detector_bench");
+}
@@ -0,0 +1,206 @@
+// 单窗口NCC延迟检测：FFT实现（detectWindowDelayNcc）与原来的时域搜索（detectWindowDelayNccDirect）
+// 在同一组合成窗口上应给出相同的延迟和相关度。
+// 信号为低通噪声加几个正弦，互相关主峰宽于粗搜索步进，时域搜索能找到全局最大值；
+// 右声道为延迟、衰减后的左声道加独立噪声。
+// 另外检查两者都拒绝全部延迟上都负相关的窗口和静音窗口。
+// GCC-PHAT（detectWindowDelayGccPhat）：宽带信号的分数延迟，亚样本估计误差不超过0.17样本；
+// 加入反射后延迟仍取直达声，置信度随反射增强而下降。
+// FFT由 stubs/av_tx_reference.cpp 的参考实现提供，设备上使用FFmpeg的av_tx。
+
+#include "host_test.h"
+#include "test_delay_signal.h"
+
+#include "config.h"
+#include "window_delay_detector.h"
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+constexpr size_t kWindowSize = static_cast<size_t>(kSampleRate * 0.7);
+constexpr size_t kMaxDelay = static_cast<size_t>(kSampleRate * 0.5);
+constexpr size_t kWindowStart = 1000;
+constexpr size_t kTotalFrames = kWindowStart + kWindowSize + kMaxDelay + 1000;
+
+std::vector<float> musicLike(uint32_t seed) {
+    return ::musicLike(kTotalFrames, kSampleRate, seed);
+}
+
+void checkSameEstimate(size_t delay, float gain, float noiseLevel, uint32_t seed) {
+    const std::vector<float> left = musicLike(seed);
+    const std::vector<float> right = delayed(left, delay, gain, noiseLevel, seed + 1);
+
+    WindowDelayScratch scratch;
+    double fftDelay = -1.0;
+    double fftCorr = 0.0;
+    const bool fftOk = detectWindowDelayNcc(left, right, kWindowStart, kWindowSize, kTotalFrames, scratch,
+                                            fftDelay, fftCorr);
+    size_t directDelay = 0;
+    double directCorr = 0.0;
+    const bool directOk = detectWindowDelayNccDirect(left, right, kWindowStart, kWindowSize, kTotalFrames,
+                                                     directDelay, directCorr);
+
+    std::printf("  delay %5zu gain %.2f noise %.2f: fft %s %7.1f (%.5f)  direct %s %5zu (%.5f)\n", delay, gain,
+                noiseLevel, fftOk ? "ok" : "--", fftDelay, fftCorr, directOk ? "ok" : "--", directDelay,
+                directCorr);
+    HOST_CHECK(fftOk && directOk, "delay %zu: fft %d direct %d", delay, fftOk, directOk);
+    HOST_CHECK(fftDelay == static_cast<double>(directDelay), "delay %zu: fft %.1f direct %zu", delay, fftDelay,
+               directDelay);
+    HOST_CHECK(directDelay == delay, "delay %zu detected as %zu", delay, directDelay);
+    HOST_CHECK(std::fabs(fftCorr - directCorr) < 1e-4, "delay %zu: fft corr %.6f direct corr %.6f", delay,
+               fftCorr, directCorr);
+}
+
+// 两个声道都检测失败
+void checkRejected(const char* name, const std::vector<float>& left, const std::vector<float>& right) {
+    WindowDelayScratch scratch;
+    double fftDelay = 0.0;
+    double fftCorr = 0.0;
+    size_t directDelay = 0;
+    double directCorr = 0.0;
+    const bool fftOk = detectWindowDelayNcc(left, right, kWindowStart, kWindowSize, kTotalFrames, scratch,
+                                            fftDelay, fftCorr);
+    const bool directOk = detectWindowDelayNccDirect(left, right, kWindowStart, kWindowSize, kTotalFrames,
+                                                     directDelay, directCorr);
+    HOST_CHECK(!fftOk, "%s: fft accepted delay %.1f (corr %.4f)", name, fftDelay, fftCorr);
+    HOST_CHECK(!directOk, "%s: direct accepted delay %zu (corr %.4f)", name, directDelay, directCorr);
+}
+
+// 宽带信号的分数延迟：白噪声经Kaiser窗sinc滤波（截止0.8倍奈奎斯特频率），
+// 左声道用整数对齐的滤波器，右声道用平移frac样本的同一滤波器，两者只差一个分数延迟。
+// 反射为 gain·reflection[k] 延迟 reflectionDelays[k] 的直达声副本
+constexpr int kSincHalf = 64;
+
+double kaiserSinc(double x) {
+    constexpr double kCutoff = 0.8;
+    constexpr double kBeta = 8.0;
+    auto besselI0 = [](double v) {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 40; ++k) {
+            term *= v * v / (4.0 * k * k);
+            sum += term;
+        }
+        return sum;
+    };
+    const double r = x / (kSincHalf + 1);
+    if (r * r >= 1.0) return 0.0;
+    const double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * kCutoff * x) / (M_PI * kCutoff * x);
+    return kCutoff * sinc * besselI0(kBeta * std::sqrt(1.0 - r * r)) / besselI0(kBeta);
+}
+
+// 把白噪声按 delay（可为分数）延迟、滤波后加到 out 上
+void addFilteredNoise(const std::vector<float>& noise, double delay, float gain, std::vector<float>& out) {
+    const int whole = static_cast<int>(std::floor(delay));
+    const double frac = delay - whole;
+    double taps[2 * kSincHalf + 1];
+    for (int k = -kSincHalf; k <= kSincHalf; ++k) {
+        taps[k + kSincHalf] = kaiserSinc(k - frac);
+    }
+    for (size_t i = 0; i < out.size(); ++i) {
+        double sum = 0.0;
+        for (int k = -kSincHalf; k <= kSincHalf; ++k) {
+            const int64_t index = static_cast<int64_t>(i) - whole - k;
+            if (index >= 0 && index < static_cast<int64_t>(noise.size())) {
+                sum += taps[k + kSincHalf] * noise[index];
+            }
+        }
+        out[i] += static_cast<float>(gain * sum);
+    }
+}
+
+struct GccResult {
+    bool ok = false;
+    double lag = 0.0;
+    double confidence = 0.0;
+};
+
+GccResult gccPhat(double delay, float reflectionGain, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, 0.3f);
+    std::vector<float> noise(kTotalFrames);
+    for (float& sample : noise) sample = dist(rng);
+
+    std::vector<float> left(kTotalFrames, 0.0f);
+    std::vector<float> right(kTotalFrames, 0.0f);
+    addFilteredNoise(noise, 0.0, 1.0f, left);
+    addFilteredNoise(noise, delay, 0.5f, right);
+    // 房间反射：几条逐渐减弱的延迟副本，都在峰值的1ms排除区之外
+    const double reflectionDelays[] = {240.0, 517.0, 911.0};
+    const float reflectionGains[] = {1.0f, 0.7f, 0.5f};
+    for (int k = 0; k < 3 && reflectionGain > 0.0f; ++k) {
+        addFilteredNoise(noise, delay + reflectionDelays[k], 0.5f * reflectionGain * reflectionGains[k], right);
+    }
+    std::normal_distribution<float> floorNoise(0.0f, 0.005f);
+    for (float& sample : right) sample += floorNoise(rng);
+
+    WindowDelayScratch scratch;
+    GccResult result;
+    result.ok = detectWindowDelayGccPhat(left, right, kWindowStart, kWindowSize, kTotalFrames, scratch, result.lag,
+                                         result.confidence);
+    return result;
+}
+
+// 无反射时各种分数延迟的估计误差
+void checkGccPhatFractional() {
+    const double delays[] = {100.0, 100.25, 480.5, 1234.75, 7000.1, 20000.6};
+    double worst = 0.0;
+    uint32_t seed = 31;
+    for (const double delay : delays) {
+        const GccResult r = gccPhat(delay, 0.0f, seed++);
+        const double error = std::fabs(r.lag - delay);
+        worst = std::max(worst, error);
+        std::printf("  gcc-phat delay %9.2f: lag %9.3f (error %.3f) confidence %.3f\n", delay, r.lag, error,
+                    r.confidence);
+        HOST_CHECK(r.ok, "gcc-phat rejected delay %.2f", delay);
+        HOST_CHECK(error <= 0.17, "gcc-phat delay %.2f estimated as %.3f", delay, r.lag);
+        HOST_CHECK(r.confidence > 0.8, "gcc-phat delay %.2f confidence %.3f without reflections", delay,
+                   r.confidence);
+    }
+    std::printf("  gcc-phat worst sub-sample error %.3f samples\n", worst);
+}
+
+// 反射逐渐增强：延迟仍为直达声，置信度单调下降
+void checkGccPhatReverb() {
+    const double delay = 960.4;
+    const float gains[] = {0.0f, 0.2f, 0.4f, 0.6f, 0.8f};
+    double previous = 2.0;
+    for (const float gain : gains) {
+        const GccResult r = gccPhat(delay, gain, 41);
+        std::printf("  gcc-phat reflections x%.1f: lag %9.3f confidence %.3f\n", gain, r.lag, r.confidence);
+        HOST_CHECK(r.ok, "gcc-phat rejected reflections x%.1f", gain);
+        HOST_CHECK(std::fabs(r.lag - delay) <= 0.17, "reflections x%.1f: lag %.3f, direct path at %.1f", gain, r.lag,
+                   delay);
+        HOST_CHECK(r.confidence < previous, "reflections x%.1f: confidence %.3f did not fall below %.3f", gain,
+                   r.confidence, previous);
+        previous = r.confidence;
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("ncc window %zu samples, lags 0..%zu\n", kWindowSize, kMaxDelay);
+    checkSameEstimate(0, 1.0f, 0.0f, 11);
+    checkSameEstimate(37, 0.8f, 0.01f, 12);
+    checkSameEstimate(480, 0.5f, 0.02f, 13);
+    checkSameEstimate(1234, 0.3f, 0.02f, 14);
+    checkSameEstimate(9601, 0.5f, 0.05f, 15);
+    checkSameEstimate(20000, 0.2f, 0.02f, 16);
+
+    // 直流偏置的信号与其反相：所有延迟上相关度都接近-1
+    std::vector<float> offset = musicLike(21);
+    for (float& sample : offset) sample = 0.5f + 0.1f * sample;
+    std::vector<float> inverted = delayed(offset, 300, -1.0f, 0.01f, 22);
+    checkRejected("inverted", offset, inverted);
+
+    const std::vector<float> silence(kTotalFrames, 0.0f);
+    checkRejected("silence", silence, delayed(musicLike(23), 300, 1.0f, 0.0f, 24));
+    checkRejected("silent right", musicLike(25), silence);
+
+    checkGccPhatFractional();
+    checkGccPhatReverb();
+
+    return testResult("window_delay_detector_test");
+}
@@ -0,0 +1,163 @@
+// WindowWorkerPool的取消约定：按LatencyTester::detectWindowsParallel的方式运行多轮随机窗口，
+// 任务里统计相关度>阈值的窗口，达到早期停止数量后取消尚未开始的窗口。每轮检查：
+//   - 已执行的窗口是从0开始的连续前缀，取消不会在中间留下空洞；
+//   - 按detectDelay的方式顺序汇总已执行的窗口，得到的窗口序列和是否早期停止与逐个检测完全相同；
+//   - 单线程时恰好执行到顺序检测停止的那个窗口为止。
+// 每个窗口的耗时随机，并不时让出CPU，使各线程完成的顺序与分发顺序不同。
+
+#include "host_test.h"
+#include "window_worker_pool.h"
+
+#include <random>
+#include <thread>
+
+namespace {
+
+constexpr double kEarlyStopThreshold = 0.5;
+constexpr size_t kEarlyStopCount = 3;
+constexpr int kRounds = 500;
+
+struct Window {
+    bool valid = false;
+    double correlation = 0.0;
+    uint32_t work = 0;  // 模拟检测耗时的自旋次数
+};
+
+// 与LatencyTester::WindowSlot相同
+struct WindowSlot {
+    bool evaluated = false;
+    bool valid = false;
+    double correlation = 0.0;
+};
+
+struct Summary {
+    std::vector<size_t> used;  // 参与汇总的有效窗口
+    size_t consumed = 0;       // 顺序汇总读到的窗口数
+    bool earlyStopped = false;
+};
+
+// detectDelay的汇总循环：按顺序读取窗口，第earlyStopCount个高相关窗口之后停止
+template <typename Available, typename Get>
+Summary summarize(size_t count, size_t earlyStopCount, Available available, Get get) {
+    Summary summary;
+    size_t highCorrelationCount = 0;
+    for (size_t index = 0; index < count && available(index); ++index) {
+        summary.consumed++;
+        bool valid;
+        double correlation;
+        get(index, valid, correlation);
+        if (!valid) continue;
+        summary.used.push_back(index);
+        if (correlation > kEarlyStopThreshold && earlyStopCount > 0 &&
+            ++highCorrelationCount >= earlyStopCount) {
+            summary.earlyStopped = true;
+            break;
+        }
+    }
+    return summary;
+}
+
+volatile uint32_t gSink = 0;
+
+void simulateWork(uint32_t iterations) {
+    uint32_t x = iterations;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        x = x * 1664525u + 1013904223u;
+    }
+    gSink = x;
+    if (iterations % 3 == 0) {
+        std::this_thread::yield();
+    }
+}
+
+struct PoolStats {
+    size_t windows = 0;
+    size_t evaluated = 0;
+    size_t earlyStops = 0;
+};
+
+void runRound(WindowWorkerPool& pool, std::mt19937& rng, int round, PoolStats& stats) {
+    const size_t count = 1 + rng() % 40;
+    const size_t earlyStopCount = rng() % 4 == 0 ? 0 : kEarlyStopCount;
+    std::uniform_real_distribution<double> corr(0.0, 1.0);
+    std::vector<Window> windows(count);
+    for (Window& window : windows) {
+        window.valid = rng() % 5 != 0;
+        window.correlation = corr(rng);
+        window.work = rng() % 20000;
+    }
+
+    // detectWindowsParallel的任务
+    std::vector<WindowSlot> slots(count);
+    std::atomic<bool> cancel{false};
+    std::atomic<size_t> highCorrelationCount{0};
+    // 工作线程里不调用HOST_CHECK（失败计数不是原子的），异常情况计数后在这里检查
+    std::atomic<size_t> badWorkers{0};
+    std::atomic<size_t> repeated{0};
+    pool.run(count, [&](size_t index, size_t worker) {
+        if (worker >= pool.threadCount()) badWorkers.fetch_add(1, std::memory_order_relaxed);
+        WindowSlot& slot = slots[index];
+        if (slot.evaluated) repeated.fetch_add(1, std::memory_order_relaxed);
+        slot.evaluated = true;
+        simulateWork(windows[index].work);
+        slot.valid = windows[index].valid;
+        slot.correlation = windows[index].correlation;
+        if (earlyStopCount > 0 && slot.valid && slot.correlation > kEarlyStopThreshold &&
+            highCorrelationCount.fetch_add(1, std::memory_order_relaxed) + 1 >= earlyStopCount) {
+            cancel.store(true, std::memory_order_release);
+        }
+    }, &cancel);
+    HOST_CHECK(badWorkers == 0 && repeated == 0, "round %d: %zu tasks with a bad worker index, %zu repeated windows",
+               round, badWorkers.load(), repeated.load());
+
+    size_t prefix = 0;
+    while (prefix < count && slots[prefix].evaluated) ++prefix;
+    for (size_t index = prefix; index < count; ++index) {
+        HOST_CHECK(!slots[index].evaluated, "round %d (%zu threads): window %zu evaluated after skipped window %zu",
+                   round, pool.threadCount(), index, prefix);
+    }
+
+    const Summary sequential = summarize(
+            count, earlyStopCount, [](size_t) { return true; },
+            [&](size_t index, bool& valid, double& correlation) {
+                valid = windows[index].valid;
+                correlation = windows[index].correlation;
+            });
+    const Summary parallel = summarize(
+            count, earlyStopCount, [&](size_t index) { return slots[index].evaluated; },
+            [&](size_t index, bool& valid, double& correlation) {
+                valid = slots[index].valid;
+                correlation = slots[index].correlation;
+            });
+    HOST_CHECK(parallel.used == sequential.used && parallel.earlyStopped == sequential.earlyStopped,
+               "round %d (%zu threads): parallel used %zu windows (early stop %d), sequential %zu (early stop %d)",
+               round, pool.threadCount(), parallel.used.size(), parallel.earlyStopped, sequential.used.size(),
+               sequential.earlyStopped);
+    HOST_CHECK(prefix >= sequential.consumed, "round %d (%zu threads): %zu windows evaluated, sequential needs %zu",
+               round, pool.threadCount(), prefix, sequential.consumed);
+    if (pool.threadCount() == 1) {
+        HOST_CHECK(prefix == sequential.consumed, "round %d: single thread evaluated %zu windows, sequential %zu",
+                   round, prefix, sequential.consumed);
+    }
+
+    stats.windows += count;
+    stats.evaluated += prefix;
+    stats.earlyStops += sequential.earlyStopped ? 1 : 0;
+}
+
+} // namespace
+
+int main() {
+    for (const size_t threads : {1, 2, 4, 8}) {
+        // 同一个线程池连续运行多轮，与LatencyTester复用线程池相同
+        WindowWorkerPool pool(threads);
+        std::mt19937 rng(static_cast<uint32_t>(1000 + threads));
+        PoolStats stats;
+        for (int round = 0; round < kRounds; ++round) {
+            runRound(pool, rng, round, stats);
+        }
+        std::printf("  %zu threads: %d rounds, %zu early stops, evaluated %zu of %zu windows\n", threads, kRounds,
+                    stats.earlyStops, stats.evaluated, stats.windows);
+    }
+    return testResult("window_worker_pool_test");
+}
@@ -98,22 +98,37 @@ public:
         const size_t inBytesPerFrame = inBytesPerSample * inCh;
         const size_t needInBytes = needInFrames * inBytesPerFrame;
 
-        // 仅在当前缓冲区大小不足时扩容，避免每次都触发resize
-        if (tmpIn_.size() < needInBytes) {
-            tmpIn_.resize(needInBytes);
-        }
-        size_t gotBytes = rb_.read(tmpIn_.data(), needInBytes);
-        if (gotBytes == 0) return 0;
-        size_t gotInFrames = gotBytes / inBytesPerFrame;
-
         // 要求在 init 中已初始化 SwrContext
         if (!swr_) return 0;
 
+        // 优先把环形缓冲区内存直接交给 swr_convert（镜像存储下可读区域总是连续的）
+        size_t contiguousBytes = 0;
+        const uint8_t* src = rb_.peekRead(contiguousBytes);
+        size_t directBytes = std::min(contiguousBytes, needInBytes) / inBytesPerFrame * inBytesPerFrame;
+        size_t gotInFrames = 0;
+        if (directBytes > 0) {
+            gotInFrames = directBytes / inBytesPerFrame;
+        } else {
+            // 非镜像存储且环绕点落在帧中间时，退回到拷贝到临时缓冲区的方式
+            // 仅在当前缓冲区大小不足时扩容，避免每次都触发resize
+            if (tmpIn_.size() < needInBytes) {
+                tmpIn_.resize(needInBytes);
+            }
+            size_t gotBytes = rb_.read(tmpIn_.data(), needInBytes);
+            if (gotBytes == 0) return 0;
+            gotInFrames = gotBytes / inBytesPerFrame;
+            src = tmpIn_.data();
+        }
+
         // 执行重采样与格式/通道转换（交错）
-        const uint8_t* inData[1] = { reinterpret_cast<const uint8_t*>(tmpIn_.data()) };
+        const uint8_t* inData[1] = { src };
         uint8_t* outData[1] = { reinterpret_cast<uint8_t*>(out) };
         int conv = swr_convert(swr_, outData, static_cast<int>(outFrames), inData, static_cast<int>(gotInFrames));
-        return static_cast<size_t>(conv);
+        if (directBytes > 0) {
+            // swr_convert 会缓存未能输出的输入，因此整块输入都视为已消费
+            rb_.commitRead(directBytes);
+        }
+        return conv > 0 ? static_cast<size_t>(conv) : 0;
     }
 
 private:
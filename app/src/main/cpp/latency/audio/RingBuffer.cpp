@@ -1,7 +1,7 @@
 #include "RingBuffer.h"
 
 RingBuffer::RingBuffer(size_t capacityBytes)
-    : buffer_(capacityBytes), capacity_(capacityBytes) {}
+    : storage_(capacityBytes), buffer_(storage_.data()), capacity_(storage_.capacity()) {}
 
 size_t RingBuffer::write(const uint8_t* data, size_t bytes) {
     if (bytes <= 0 || data == nullptr) return 0;
@@ -10,9 +10,9 @@ size_t RingBuffer::write(const uint8_t* data, size_t bytes) {
     if (space == 0) space = capacity_;
     size_t can = bytes < (space - 1) ? bytes : (space - 1);
     size_t wi = writeIndex_.load();
-    size_t first = std::min(can, capacity_ - wi);
-    std::memcpy(buffer_.data() + wi, data, first);
-    if (can > first) std::memcpy(buffer_.data(), data + first, can - first);
+    size_t first = storage_.contiguous(wi, can);
+    std::memcpy(buffer_ + wi, data, first);
+    if (can > first) std::memcpy(buffer_, data + first, can - first);
     writeIndex_.store((wi + can) % capacity_);
     return can;
 }
@@ -23,13 +23,26 @@ size_t RingBuffer::read(uint8_t* out, size_t bytes) {
     size_t avail = (capacity_ + writeIndex_.load() - readIndex_.load()) % capacity_;
     size_t can = bytes < avail ? bytes : avail;
     size_t ri = readIndex_.load();
-    size_t first = std::min(can, capacity_ - ri);
-    std::memcpy(out, buffer_.data() + ri, first);
-    if (can > first) std::memcpy(out + first, buffer_.data(), can - first);
+    size_t first = storage_.contiguous(ri, can);
+    std::memcpy(out, buffer_ + ri, first);
+    if (can > first) std::memcpy(out + first, buffer_, can - first);
     readIndex_.store((ri + can) % capacity_);
     return can;
 }
 
+const uint8_t* RingBuffer::peekRead(size_t& bytes) const {
+    // 写入端只会在写完数据后更新 writeIndex_，且不会覆盖未读数据，因此无需加锁
+    size_t ri = readIndex_.load();
+    size_t avail = (capacity_ + writeIndex_.load() - ri) % capacity_;
+    bytes = storage_.contiguous(ri, avail);
+    return buffer_ + ri;
+}
+
+void RingBuffer::commitRead(size_t bytes) {
+    std::lock_guard<std::mutex> _l(mutex_);
+    readIndex_.store((readIndex_.load() + bytes) % capacity_);
+}
+
 void RingBuffer::clear() {
     std::lock_guard<std::mutex> _l(mutex_);
     readIndex_.store(0);
@@ -6,16 +6,21 @@
 #include <mutex>
 #include <algorithm>
 #include <cstring>
+#include "mirrored_buffer.h"
 
 class RingBuffer {
 public:
     explicit RingBuffer(size_t capacityBytes);
     size_t write(const uint8_t* data, size_t bytes);
     size_t read(uint8_t* out, size_t bytes);
+    // 零拷贝读取（仅消费者调用）：返回可连续访问的可读区域，镜像存储下即全部可读数据
+    const uint8_t* peekRead(size_t& bytes) const;
+    void commitRead(size_t bytes);
     void clear();
 
 private:
-    std::vector<uint8_t> buffer_;
+    MirroredBuffer storage_;
+    uint8_t* buffer_;
     std::atomic<size_t> readIndex_{0};
     std::atomic<size_t> writeIndex_{0};
     size_t capacity_;
@@ -4,6 +4,7 @@
 #include <vector>
 #include "../logging.h"
 #include "../config.h"
+#include "../../peak_pyramid.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -265,4 +266,87 @@ int encode_pcm_to_m4a(const char* pcmPath,
     return 0;
 }
 
+// Decode to interleaved float at the source rate and feed the peak pyramid builder,
+// nothing is written besides the .peaks file.
+bool build_peak_pyramid_from_media(const char* inputPath, const char* peaksPath) {
+    LOGI("build_peak_pyramid_from_media in=%s out=%s",
+         inputPath ? inputPath : "(null)", peaksPath ? peaksPath : "(null)");
+    AVFormatContext* fmt = nullptr;
+    if (avformat_open_input(&fmt, inputPath, nullptr, nullptr) < 0) { LOGE("avformat_open_input failed"); return false; }
+    if (avformat_find_stream_info(fmt, nullptr) < 0) { avformat_close_input(&fmt); return false; }
+
+    int audioStreamIndex = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (audioStreamIndex < 0) { avformat_close_input(&fmt); return false; }
+
+    AVStream* st = fmt->streams[audioStreamIndex];
+    const AVCodec* codec = avcodec_find_decoder(st->codecpar->codec_id);
+    if (!codec) { LOGE("decoder not found"); avformat_close_input(&fmt); return false; }
+    AVCodecContext* ctx = avcodec_alloc_context3(codec);
+    if (!ctx) { LOGE("alloc codec ctx failed"); avformat_close_input(&fmt); return false; }
+    if (avcodec_parameters_to_context(ctx, st->codecpar) < 0) { avcodec_free_context(&ctx); avformat_close_input(&fmt); return false; }
+    if (avcodec_open2(ctx, codec, nullptr) < 0) { LOGE("avcodec_open2 failed"); avcodec_free_context(&ctx); avformat_close_input(&fmt); return false; }
 
+    AVChannelLayout in_ch_layout{};
+    AVChannelLayout out_ch_layout{};
+    if (ctx->ch_layout.nb_channels > 0) {
+        av_channel_layout_copy(&in_ch_layout, &ctx->ch_layout);
+    } else {
+        av_channel_layout_default(&in_ch_layout, 2);
+    }
+    const int out_channels = in_ch_layout.nb_channels >= 2 ? 2 : 1;
+    av_channel_layout_default(&out_ch_layout, out_channels);
+    const int sample_rate = ctx->sample_rate > 0 ? ctx->sample_rate : kSampleRate;
+
+    SwrContext* swr = nullptr;
+    if (swr_alloc_set_opts2(&swr,
+                            &out_ch_layout, AV_SAMPLE_FMT_FLT, sample_rate,
+                            &in_ch_layout,  ctx->sample_fmt, sample_rate,
+                            0, nullptr) < 0 || !swr || swr_init(swr) < 0) {
+        LOGE("swr init failed");
+        if (swr) swr_free(&swr);
+        av_channel_layout_uninit(&in_ch_layout);
+        av_channel_layout_uninit(&out_ch_layout);
+        avcodec_free_context(&ctx);
+        avformat_close_input(&fmt);
+        return false;
+    }
+
+    AVPacket* pkt = av_packet_alloc();
+    AVFrame* frame = av_frame_alloc();
+    PeakPyramidBuilder builder(sample_rate, out_channels, true);
+    std::vector<float> out_buf;
+
+    auto drain_frames = [&]() {
+        while (avcodec_receive_frame(ctx, frame) == 0) {
+            const int out_nb_samples = swr_get_out_samples(swr, frame->nb_samples);
+            if (out_nb_samples <= 0) continue;
+            out_buf.resize(static_cast<size_t>(out_nb_samples) * out_channels);
+            uint8_t* out_ptr = reinterpret_cast<uint8_t*>(out_buf.data());
+            const int conv = swr_convert(swr, &out_ptr, out_nb_samples,
+                                         (const uint8_t**)frame->extended_data, frame->nb_samples);
+            if (conv > 0) builder.appendPcm(out_buf.data(), conv);
+        }
+    };
+
+    bool ok = pkt && frame;
+    while (ok && av_read_frame(fmt, pkt) >= 0) {
+        if (pkt->stream_index == audioStreamIndex && avcodec_send_packet(ctx, pkt) == 0) {
+            drain_frames();
+        }
+        av_packet_unref(pkt);
+    }
+    if (ok) {
+        avcodec_send_packet(ctx, nullptr);
+        drain_frames();
+        ok = builder.finish(peaksPath);
+    }
+
+    if (pkt) av_packet_free(&pkt);
+    if (frame) av_frame_free(&frame);
+    swr_free(&swr);
+    av_channel_layout_uninit(&in_ch_layout);
+    av_channel_layout_uninit(&out_ch_layout);
+    avcodec_free_context(&ctx);
+    avformat_close_input(&fmt);
+    return ok;
+}
@@ -17,5 +17,6 @@ int encode_pcm_to_m4a(const char* pcmPath,
                       int inSampleRate,
                       int inChannels,
                       bool inputIsFloat);
-
-
+// Decode any FFmpeg-readable audio file and write its .peaks waveform pyramid.
+// Keeps the source sample rate; downmixes to at most two channels.
+bool build_peak_pyramid_from_media(const char* inputPath, const char* peaksPath);
@@ -0,0 +1,408 @@
+#include "DecoderSource.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <strings.h>
+#include "../logging.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libswresample/swresample.h>
+#include <libavutil/channel_layout.h>
+}
+
+#define LOG_TAG "DecoderSource"
+
+// About half a second of decoded audio is kept ahead of playback.
+static constexpr int kRingMillis = 500;
+// The decode thread waits for space until the ring has drained below this fraction.
+static constexpr size_t kRefillDivisor = 2;
+
+DecoderSource::DecoderSource() {
+    sem_init(&wake_, 0, 0);
+}
+
+DecoderSource::~DecoderSource() {
+    close();
+    sem_destroy(&wake_);
+}
+
+bool DecoderSource::isCompressedFile(const char* path) {
+    static const char* const kExtensions[] = {".m4a", ".mp4", ".aac", ".flac", ".opus", ".ogg", ".mp3"};
+    const size_t length = strlen(path);
+    for (const char* ext : kExtensions) {
+        const size_t extLength = strlen(ext);
+        if (length >= extLength && strcasecmp(path + length - extLength, ext) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecoderSource::open(const char* path) {
+    close();
+    LOGI("open %s", path ? path : "(null)");
+    if (avformat_open_input(&fmt_, path, nullptr, nullptr) < 0) { LOGE("avformat_open_input failed"); return false; }
+
+    // mp4/flac/ogg headers already describe the audio stream; probing reads packets
+    // and would delay the first sound, so only do it when the header is incomplete.
+    int index = av_find_best_stream(fmt_, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (index < 0 || fmt_->streams[index]->codecpar->sample_rate <= 0 ||
+        fmt_->streams[index]->codecpar->ch_layout.nb_channels <= 0) {
+        if (avformat_find_stream_info(fmt_, nullptr) < 0) { LOGE("avformat_find_stream_info failed"); close(); return false; }
+        index = av_find_best_stream(fmt_, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    }
+    if (index < 0) { LOGE("no audio stream"); close(); return false; }
+    streamIndex_ = index;
+
+    AVStream* st = fmt_->streams[streamIndex_];
+    const AVCodec* codec = avcodec_find_decoder(st->codecpar->codec_id);
+    if (!codec) { LOGE("decoder not found"); close(); return false; }
+    codec_ = avcodec_alloc_context3(codec);
+    if (!codec_) { LOGE("alloc codec ctx failed"); close(); return false; }
+    if (avcodec_parameters_to_context(codec_, st->codecpar) < 0) { close(); return false; }
+    if (avcodec_open2(codec_, codec, nullptr) < 0) { LOGE("avcodec_open2 failed"); close(); return false; }
+
+    sampleRate_ = codec_->sample_rate > 0 ? codec_->sample_rate : st->codecpar->sample_rate;
+    const int inChannels = codec_->ch_layout.nb_channels > 0 ? codec_->ch_layout.nb_channels : 2;
+    channelCount_ = inChannels >= 2 ? 2 : 1;
+    if (sampleRate_ <= 0) { LOGE("unknown sample rate"); close(); return false; }
+
+    startPts_ = st->start_time != AV_NOPTS_VALUE ? st->start_time : 0;
+    if (st->duration != AV_NOPTS_VALUE && st->duration > 0) {
+        totalFrames_ = av_rescale_q(st->duration, st->time_base, AVRational{1, sampleRate_});
+    } else if (fmt_->duration != AV_NOPTS_VALUE && fmt_->duration > 0) {
+        totalFrames_ = av_rescale(fmt_->duration, sampleRate_, AV_TIME_BASE);
+    } else {
+        totalFrames_ = 0;
+    }
+
+    packet_ = av_packet_alloc();
+    frame_ = av_frame_alloc();
+    if (!packet_ || !frame_) { LOGE("alloc pkt/frame failed"); close(); return false; }
+
+    const size_t ringBytes = static_cast<size_t>(sampleRate_) * kRingMillis / 1000 * bytesPerFrame();
+    ring_ = std::make_unique<SpscRingBuffer>(std::max<size_t>(ringBytes, 64 * 1024));
+    LOGI("stream #%d codec=%s rate=%d channels=%d->%d frames=%lld", streamIndex_, codec->name, sampleRate_,
+         inChannels, channelCount_, static_cast<long long>(totalFrames_));
+    return true;
+}
+
+bool DecoderSource::start() {
+    if (!codec_ || thread_) return false;
+    // A previous run left the demuxer, decoder and ring where it stopped.
+    const bool rewind = bytesWritten_ > 0 || endOfStream_.load();
+    decodedFrame_ = 0;
+    skipUntil_ = 0;
+    bytesWritten_ = 0;
+    bytesConsumed_ = 0;
+    flushPending_ = false;
+    flushSeen_ = 0;
+    loopStart_ = 0;
+    loopEnd_ = 0;
+    position_.store(0);
+    flushUntil_.store(0);
+    flushFrame_.store(0);
+    flushSeq_.store(0);
+    endOfStream_.store(false);
+    requestedSeek_.store(-1);
+    waitingForSpace_.store(false);
+    if (rewind) {
+        seekInternal(0, false);
+        // No thread reads or writes the ring while stopped, so it can be drained from here.
+        ring_->commitRead(ring_->size());
+    }
+    closing_ = false;
+    thread_ = std::make_unique<std::thread>(&DecoderSource::decodeThreadFunc, this);
+    return true;
+}
+
+void DecoderSource::stop() {
+    if (!thread_) return;
+    closing_ = true;
+    sem_post(&wake_);
+    if (thread_->joinable()) thread_->join();
+    thread_.reset();
+}
+
+void DecoderSource::close() {
+    stop();
+    if (swr_) swr_free(&swr_);
+    if (packet_) av_packet_free(&packet_);
+    if (frame_) av_frame_free(&frame_);
+    if (codec_) avcodec_free_context(&codec_);
+    if (fmt_) avformat_close_input(&fmt_);
+    swrInFormat_ = -1;
+    streamIndex_ = -1;
+    ring_.reset();
+}
+
+size_t DecoderSource::read(void* dst, size_t size, bool* seeked) {
+    if (seeked) *seeked = false;
+    if (!ring_) return 0;
+
+    const size_t frameBytes = bytesPerFrame();
+
+    // A seek is published once its first frames are queued: drop everything before them.
+    // The previous read may already have run on into the new data, then only the position moves.
+    const uint32_t flushSeq = flushSeq_.load(std::memory_order_acquire);
+    if (flushSeq != flushSeen_) {
+        flushSeen_ = flushSeq;
+        const uint64_t flushUntil = flushUntil_.load(std::memory_order_relaxed);
+        const int64_t flushFrame = flushFrame_.load(std::memory_order_relaxed);
+        if (flushUntil > bytesConsumed_) {
+            ring_->commitRead(static_cast<size_t>(flushUntil - bytesConsumed_));
+            bytesConsumed_ = flushUntil;
+            position_.store(flushFrame, std::memory_order_release);
+        } else {
+            position_.store(flushFrame + static_cast<int64_t>((bytesConsumed_ - flushUntil) / frameBytes),
+                            std::memory_order_release);
+        }
+        if (seeked) *seeked = true;
+    }
+
+    const size_t bytes = std::min(size, ring_->size()) / frameBytes * frameBytes;
+    const size_t copied = bytes > 0 ? ring_->read(dst, bytes) : 0;
+    bytesConsumed_ += copied;
+
+    // Looping wraps inside the decoded data; fold the position back into the loop.
+    int64_t position = position_.load(std::memory_order_relaxed) + static_cast<int64_t>(copied / frameBytes);
+    const int64_t loopStart = loopStartRequest_.load(std::memory_order_relaxed);
+    const int64_t loopEnd = loopEndRequest_.load(std::memory_order_relaxed);
+    if (loopEnd > loopStart && position >= loopEnd) {
+        position = loopStart + (position - loopEnd) % (loopEnd - loopStart);
+    }
+    position_.store(position, std::memory_order_release);
+
+    if (waitingForSpace_.load(std::memory_order_acquire) && ring_->size() <= ring_->capacity() / kRefillDivisor &&
+        waitingForSpace_.exchange(false, std::memory_order_acq_rel)) {
+        sem_post(&wake_);
+    }
+    return copied;
+}
+
+bool DecoderSource::finished() const {
+    return endOfStream_.load(std::memory_order_acquire) && ring_ && ring_->size() == 0 &&
+           flushSeq_.load(std::memory_order_acquire) == flushSeen_;
+}
+
+void DecoderSource::seek(int64_t frame) {
+    requestedSeek_.store(std::max<int64_t>(frame, 0), std::memory_order_release);
+    sem_post(&wake_);
+}
+
+void DecoderSource::setLoop(int64_t startFrame, int64_t endFrame) {
+    if (endFrame <= startFrame) {
+        startFrame = 0;
+        endFrame = 0;
+    }
+    loopStartRequest_.store(startFrame, std::memory_order_relaxed);
+    loopEndRequest_.store(endFrame, std::memory_order_relaxed);
+    loopChanged_.store(true, std::memory_order_release);
+    sem_post(&wake_);
+}
+
+void DecoderSource::decodeThreadFunc() {
+    while (!closing_) {
+        if (loopChanged_.exchange(false, std::memory_order_acq_rel)) {
+            loopStart_ = loopStartRequest_.load(std::memory_order_relaxed);
+            loopEnd_ = loopEndRequest_.load(std::memory_order_relaxed);
+            // Data past the new end may already be queued; restart from the playback position.
+            int64_t noSeek = -1;
+            if (loopEnd_ > 0 && decodedFrame_ > loopEnd_) {
+                requestedSeek_.compare_exchange_strong(noSeek, position());
+            }
+        }
+
+        const int64_t target = requestedSeek_.exchange(-1, std::memory_order_acq_rel);
+        if (target >= 0) {
+            seekInternal(loopEnd_ > 0 && target >= loopEnd_ ? loopStart_ : target, true);
+        }
+
+        if (endOfStream_.load(std::memory_order_relaxed)) {
+            // Wait for a seek, a loop change or shutdown.
+            if (sem_wait(&wake_) != 0 && errno == EINTR) continue;
+            continue;
+        }
+        if (!decodeNextPacket()) {
+            drainDecoder();
+            if (loopEnd_ > 0 && !closing_) {
+                // Loop end lies beyond the real end of the stream: wrap here.
+                seekInternal(loopStart_, false);
+                continue;
+            }
+            LOGI("decode finished at frame %lld", static_cast<long long>(decodedFrame_));
+            // A seek to (or past) the end decodes nothing; publish it so the stale data goes.
+            publishFlush();
+            endOfStream_.store(true, std::memory_order_release);
+        }
+    }
+}
+
+bool DecoderSource::decodeNextPacket() {
+    while (!closing_) {
+        const int ret = av_read_frame(fmt_, packet_);
+        if (ret < 0) {
+            return false;
+        }
+        if (packet_->stream_index != streamIndex_) {
+            av_packet_unref(packet_);
+            continue;
+        }
+        const int sent = avcodec_send_packet(codec_, packet_);
+        av_packet_unref(packet_);
+        if (sent < 0 && sent != AVERROR(EAGAIN)) {
+            LOGW("send_packet failed: %d", sent);
+            return true;  // skip the corrupt packet
+        }
+        // Receive everything even when a seek interrupts, so the decoder accepts the next packet.
+        bool keep = true;
+        while (avcodec_receive_frame(codec_, frame_) == 0) {
+            if (keep) keep = emitFrame(frame_);
+            av_frame_unref(frame_);
+        }
+        return true;
+    }
+    return false;
+}
+
+void DecoderSource::drainDecoder() {
+    if (avcodec_send_packet(codec_, nullptr) < 0) return;
+    bool keep = true;
+    while (avcodec_receive_frame(codec_, frame_) == 0) {
+        if (keep) keep = emitFrame(frame_);
+        av_frame_unref(frame_);
+    }
+}
+
+bool DecoderSource::ensureResampler(const AVFrame* frame) {
+    if (swr_ && frame->format == swrInFormat_ && frame->sample_rate == swrInRate_ &&
+        frame->ch_layout.nb_channels == swrInChannels_) {
+        return true;
+    }
+    if (swr_) swr_free(&swr_);
+    AVChannelLayout inLayout{};
+    AVChannelLayout outLayout{};
+    if (frame->ch_layout.order != AV_CHANNEL_ORDER_UNSPEC) {
+        av_channel_layout_copy(&inLayout, &frame->ch_layout);
+    } else {
+        av_channel_layout_default(&inLayout, frame->ch_layout.nb_channels);
+    }
+    av_channel_layout_default(&outLayout, channelCount_);
+    // Output stays at the stream rate the player opened; only a mid-stream rate change resamples.
+    const int ret = swr_alloc_set_opts2(&swr_, &outLayout, AV_SAMPLE_FMT_FLT, sampleRate_,
+                                        &inLayout, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+                                        0, nullptr);
+    av_channel_layout_uninit(&inLayout);
+    av_channel_layout_uninit(&outLayout);
+    if (ret < 0 || !swr_ || swr_init(swr_) < 0) {
+        LOGE("swr init failed");
+        if (swr_) swr_free(&swr_);
+        return false;
+    }
+    swrInFormat_ = frame->format;
+    swrInRate_ = frame->sample_rate;
+    swrInChannels_ = frame->ch_layout.nb_channels;
+    return true;
+}
+
+bool DecoderSource::emitFrame(AVFrame* frame) {
+    if (closing_ || !ensureResampler(frame)) return false;
+
+    // After a seek the position is only known from the first decoded frame.
+    const int64_t pts = frame->best_effort_timestamp;
+    if (decodedFrame_ < 0) {
+        decodedFrame_ = pts != AV_NOPTS_VALUE
+                ? av_rescale_q(pts - startPts_, fmt_->streams[streamIndex_]->time_base, AVRational{1, sampleRate_})
+                : skipUntil_;
+    }
+
+    const int maxOut = swr_get_out_samples(swr_, frame->nb_samples);
+    if (maxOut <= 0) return true;
+    convertBuffer_.resize(static_cast<size_t>(maxOut) * channelCount_);
+    uint8_t* out = reinterpret_cast<uint8_t*>(convertBuffer_.data());
+    const int converted = swr_convert(swr_, &out, maxOut, const_cast<const uint8_t**>(frame->extended_data),
+                                      frame->nb_samples);
+    if (converted <= 0) return true;
+
+    int64_t begin = 0;
+    int64_t end = converted;
+    // Sample-accurate seek: drop what precedes the target.
+    if (decodedFrame_ < skipUntil_) {
+        begin = std::min<int64_t>(skipUntil_ - decodedFrame_, end);
+    }
+    // Loop end: keep the samples up to it and continue from the loop start.
+    bool wrap = false;
+    if (loopEnd_ > 0 && decodedFrame_ + end >= loopEnd_) {
+        end = std::max<int64_t>(begin, loopEnd_ - decodedFrame_);
+        wrap = true;
+    }
+    decodedFrame_ += converted;
+    if (end > begin && !writeFrames(convertBuffer_.data() + begin * channelCount_, end - begin)) {
+        return false;
+    }
+    if (wrap) {
+        seekInternal(loopStart_, false);
+        return false;
+    }
+    // A seek request arriving mid-packet is handled before decoding the next one.
+    return requestedSeek_.load(std::memory_order_relaxed) < 0;
+}
+
+bool DecoderSource::writeFrames(const float* data, int64_t frames) {
+    const size_t frameBytes = bytesPerFrame();
+    auto* src = reinterpret_cast<const uint8_t*>(data);
+    size_t remaining = static_cast<size_t>(frames) * frameBytes;
+    while (remaining > 0) {
+        if (closing_ || requestedSeek_.load(std::memory_order_relaxed) >= 0) {
+            // The rest would be flushed by the seek anyway.
+            return false;
+        }
+        const size_t bytes = std::min(remaining, ring_->available()) / frameBytes * frameBytes;
+        if (bytes == 0) {
+            // Announce the wait, then re-check so a read in between cannot be missed.
+            waitingForSpace_.store(true, std::memory_order_release);
+            if (ring_->size() > ring_->capacity() / kRefillDivisor) {
+                if (sem_wait(&wake_) != 0 && errno == EINTR) continue;
+            }
+            waitingForSpace_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        ring_->write(src, bytes);
+        src += bytes;
+        remaining -= bytes;
+        bytesWritten_ += bytes;
+        publishFlush();
+    }
+    return true;
+}
+
+void DecoderSource::publishFlush() {
+    if (!flushPending_) return;
+    flushPending_ = false;
+    flushFrame_.store(pendingFlushFrame_, std::memory_order_relaxed);
+    flushUntil_.store(pendingFlushStart_, std::memory_order_relaxed);
+    flushSeq_.fetch_add(1, std::memory_order_release);
+}
+
+void DecoderSource::seekInternal(int64_t frame, bool flush) {
+    if (totalFrames_ > 0) frame = std::min(frame, totalFrames_);
+    AVStream* st = fmt_->streams[streamIndex_];
+    const int64_t ts = startPts_ + av_rescale_q(frame, AVRational{1, sampleRate_}, st->time_base);
+    if (avformat_seek_file(fmt_, streamIndex_, INT64_MIN, ts, ts, 0) < 0) {
+        LOGW("seek to frame %lld failed", static_cast<long long>(frame));
+    }
+    avcodec_flush_buffers(codec_);
+    if (swr_) swr_free(&swr_);  // drop samples buffered inside swresample
+    decodedFrame_ = -1;
+    skipUntil_ = frame;
+    endOfStream_.store(false, std::memory_order_relaxed);
+    if (flush) {
+        // Everything written so far is stale. The callback keeps playing it until the first
+        // frames of the new position are queued, then discards it (see publishFlush()).
+        flushPending_ = true;
+        pendingFlushFrame_ = frame;
+        pendingFlushStart_ = bytesWritten_;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <semaphore.h>
+#include "../../spsc_ring_buffer.h"
+
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+struct SwrContext;
+
+// Streaming playback source for compressed files (m4a/flac/opus/...).
+// A background thread demuxes, decodes and converts to interleaved float at the
+// source rate (downmixed to at most two channels) straight into a lock-free ring;
+// playback can start as soon as the first packet is decoded and nothing touches disk.
+// Seeks are sample-accurate: the decoder seeks to the preceding key frame and drops
+// samples up to the target; once the first frames at the target are queued the callback
+// discards everything queued before them, so it never runs dry waiting for the decoder.
+class DecoderSource {
+public:
+    DecoderSource();
+    ~DecoderSource();
+
+    DecoderSource(const DecoderSource&) = delete;
+    DecoderSource& operator=(const DecoderSource&) = delete;
+
+    // Whether a file should be played through the decoder, judged by extension.
+    static bool isCompressedFile(const char* path);
+
+    // Opens the container and decoder. Stream info is only probed when the
+    // container header does not already carry rate and channel count.
+    bool open(const char* path);
+    // Starts / stops the decode thread; stop() must not race with read().
+    // Starting again after stop() rewinds to the first frame.
+    bool start();
+    void stop();
+    void close();
+
+    int sampleRate() const { return sampleRate_; }
+    int channelCount() const { return channelCount_; }
+    size_t bytesPerFrame() const { return static_cast<size_t>(channelCount_) * sizeof(float); }
+    // Estimated from the container duration, 0 when unknown.
+    int64_t totalFrames() const { return totalFrames_; }
+
+    // Audio callback only, real-time safe. Copies whole frames; *seeked is set
+    // when the returned data starts at a new position.
+    size_t read(void* dst, size_t size, bool* seeked = nullptr);
+    // Audio callback only. True once the decoder reached the end and everything it produced was read.
+    bool finished() const;
+    // Frame index of the next frame read() returns.
+    int64_t position() const { return position_.load(std::memory_order_acquire); }
+
+    // Any thread. The callback keeps playing queued data until the new position is decoded.
+    void seek(int64_t frame);
+    // Any thread. Loops [startFrame, endFrame) seamlessly; endFrame <= startFrame clears it.
+    void setLoop(int64_t startFrame, int64_t endFrame);
+
+private:
+    void decodeThreadFunc();
+    bool decodeNextPacket();
+    void drainDecoder();
+    bool emitFrame(AVFrame* frame);
+    bool writeFrames(const float* data, int64_t frames);
+    void seekInternal(int64_t frame, bool flush);
+    void publishFlush();
+    bool ensureResampler(const AVFrame* frame);
+
+    AVFormatContext* fmt_ = nullptr;
+    AVCodecContext* codec_ = nullptr;
+    SwrContext* swr_ = nullptr;
+    AVPacket* packet_ = nullptr;
+    AVFrame* frame_ = nullptr;
+    int streamIndex_ = -1;
+    int sampleRate_ = 0;
+    int channelCount_ = 0;
+    int64_t totalFrames_ = 0;
+    int64_t startPts_ = 0;
+
+    // swresample input configuration, rebuilt if the decoder output changes
+    int swrInFormat_ = -1;
+    int swrInRate_ = 0;
+    int swrInChannels_ = 0;
+    std::vector<float> convertBuffer_;
+
+    std::unique_ptr<SpscRingBuffer> ring_;
+
+    // decode thread private
+    int64_t decodedFrame_ = 0;   // output frame index of the next decoded sample, -1 until known
+    int64_t skipUntil_ = 0;      // drop decoded samples before this frame (sample-accurate seek)
+    uint64_t bytesWritten_ = 0;
+    int64_t loopStart_ = 0;
+    int64_t loopEnd_ = 0;
+    bool flushPending_ = false;       // a seek waits for its first frames before it is published
+    int64_t pendingFlushFrame_ = 0;
+    uint64_t pendingFlushStart_ = 0;  // bytesWritten_ when the seek was taken
+
+    // requests from control threads
+    std::atomic<int64_t> requestedSeek_{-1};
+    std::atomic<int64_t> loopStartRequest_{0};
+    std::atomic<int64_t> loopEndRequest_{0};
+    std::atomic<bool> loopChanged_{false};
+
+    // decode thread -> callback: data queued before flushUntil_ is stale after a seek.
+    // Published with flushSeq_ after the first post-seek frames are in the ring; a sequence
+    // rather than a byte count because the callback may already have read past flushUntil_.
+    std::atomic<uint64_t> flushUntil_{0};
+    std::atomic<int64_t> flushFrame_{0};
+    std::atomic<uint32_t> flushSeq_{0};
+    std::atomic<bool> endOfStream_{false};
+    std::atomic<bool> waitingForSpace_{false};
+
+    // callback private, position_ is also read by control threads
+    uint64_t bytesConsumed_ = 0;
+    uint32_t flushSeen_ = 0;
+    std::atomic<int64_t> position_{0};
+
+    sem_t wake_;
+    std::unique_ptr<std::thread> thread_;
+    std::atomic<bool> closing_{false};
+};
@@ -0,0 +1,213 @@
+#include "FftCorrelator.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/tx.h>
+}
+
+#include "../logging.h"
+
+#define LOG_TAG "FftCorrelator"
+
+namespace {
+
+size_t nextPowerOfTwo(size_t n) {
+    size_t size = 1;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+// Below this fraction of the search signal's energy a sliding window is treated as
+// digital silence: its prefix-sum norm is dominated by rounding, not by signal.
+constexpr double kSilenceRatio = 1e-12;
+
+// Cross-spectrum bins weaker than this fraction of the strongest bin are left out of GCC-PHAT.
+constexpr double kPhatFloor = 1e-9;
+
+} // namespace
+
+FftCorrelator::~FftCorrelator() {
+    releasePlan();
+}
+
+void FftCorrelator::releasePlan() {
+    av_tx_uninit(&forward_);
+    av_tx_uninit(&inverse_);
+    av_freep(&timeA_);
+    av_freep(&timeB_);
+    av_freep(&specA_);
+    av_freep(&specB_);
+    forwardFn_ = nullptr;
+    inverseFn_ = nullptr;
+    fftSize_ = 0;
+}
+
+bool FftCorrelator::ensurePlan(size_t fftSize) {
+    if (fftSize == fftSize_) return true;
+    releasePlan();
+
+    const double scale = 1.0 / static_cast<double>(fftSize);
+    const int len = static_cast<int>(fftSize);
+    int ret = av_tx_init(&forward_, &forwardFn_, AV_TX_DOUBLE_RDFT, 0, len, nullptr, 0);
+    if (ret >= 0) {
+        // The inverse is normalised here so the output is the correlation itself.
+        ret = av_tx_init(&inverse_, &inverseFn_, AV_TX_DOUBLE_RDFT, 1, len, &scale, 0);
+    }
+    if (ret < 0) {
+        LOGE("av_tx_init failed for size %zu: %d", fftSize, ret);
+        releasePlan();
+        return false;
+    }
+
+    const size_t bins = fftSize / 2 + 1;
+    timeA_ = static_cast<double*>(av_malloc_array(fftSize, sizeof(double)));
+    timeB_ = static_cast<double*>(av_malloc_array(fftSize, sizeof(double)));
+    specA_ = static_cast<AVComplexDouble*>(av_malloc_array(bins, sizeof(AVComplexDouble)));
+    specB_ = static_cast<AVComplexDouble*>(av_malloc_array(bins, sizeof(AVComplexDouble)));
+    if (!timeA_ || !timeB_ || !specA_ || !specB_) {
+        LOGE("Failed to allocate FFT buffers for size %zu", fftSize);
+        releasePlan();
+        return false;
+    }
+    fftSize_ = fftSize;
+    return true;
+}
+
+bool FftCorrelator::crossSpectrum(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                                  double& leftNorm) {
+    const size_t searchLength = windowSize + maxLag;
+    // Circular correlation only wraps for lags past searchLength - windowSize, so padding
+    // to the search length keeps every lag in [0, maxLag] linear.
+    if (windowSize == 0 || !ensurePlan(nextPowerOfTwo(searchLength))) {
+        return false;
+    }
+
+    leftNorm = 0.0;
+    for (size_t i = 0; i < windowSize; ++i) {
+        const double v = a[i];
+        timeA_[i] = v;
+        leftNorm += v * v;
+    }
+    std::fill(timeA_ + windowSize, timeA_ + fftSize_, 0.0);
+
+    prefixSq_.resize(searchLength + 1);
+    prefixSq_[0] = 0.0;
+    for (size_t i = 0; i < searchLength; ++i) {
+        const double v = b[i];
+        timeB_[i] = v;
+        prefixSq_[i + 1] = prefixSq_[i] + v * v;
+    }
+    std::fill(timeB_ + searchLength, timeB_ + fftSize_, 0.0);
+
+    forwardFn_(forward_, specA_, timeA_, sizeof(double));
+    forwardFn_(forward_, specB_, timeB_, sizeof(double));
+
+    // corr(d) = IFFT(conj(A) * B)(d)
+    const size_t bins = fftSize_ / 2 + 1;
+    for (size_t k = 0; k < bins; ++k) {
+        const double ar = specA_[k].re, ai = specA_[k].im;
+        const double br = specB_[k].re, bi = specB_[k].im;
+        specB_[k].re = ar * br + ai * bi;
+        specB_[k].im = ar * bi - ai * br;
+    }
+    return true;
+}
+
+bool FftCorrelator::computeNcc(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                               std::vector<double>& ncc) {
+    double leftNorm = 0.0;
+    if (!crossSpectrum(a, b, windowSize, maxLag, leftNorm)) {
+        return false;
+    }
+    inverseFn_(inverse_, timeA_, specB_, sizeof(AVComplexDouble));
+
+    const size_t searchLength = windowSize + maxLag;
+    ncc.resize(maxLag + 1);
+    const double silenceFloor = prefixSq_[searchLength] * kSilenceRatio;
+    for (size_t d = 0; d <= maxLag; ++d) {
+        const double rightNorm = prefixSq_[d + windowSize] - prefixSq_[d];
+        if (leftNorm > 0 && rightNorm > silenceFloor) {
+            // Rounding can push a perfect match a hair past +-1.
+            ncc[d] = std::clamp(timeA_[d] / std::sqrt(leftNorm * rightNorm), -1.0, 1.0);
+        } else {
+            ncc[d] = kInvalid;
+        }
+    }
+    return true;
+}
+
+bool FftCorrelator::computeGccPhat(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                                   std::vector<double>& gcc) {
+    double leftNorm = 0.0;
+    if (!crossSpectrum(a, b, windowSize, maxLag, leftNorm)) {
+        return false;
+    }
+    if (leftNorm <= 0 || prefixSq_[windowSize + maxLag] <= 0) {
+        gcc.assign(maxLag + 1, kInvalid);
+        return true;
+    }
+
+    // Bins far below the strongest one carry only rounding noise; whitening them to unit
+    // magnitude would flood the result, so they are dropped instead.
+    const size_t bins = fftSize_ / 2 + 1;
+    double maxMagnitude = 0.0;
+    for (size_t k = 0; k < bins; ++k) {
+        maxMagnitude = std::max(maxMagnitude, std::hypot(specB_[k].re, specB_[k].im));
+    }
+    const double floor = maxMagnitude * kPhatFloor;
+    for (size_t k = 0; k < bins; ++k) {
+        const double magnitude = std::hypot(specB_[k].re, specB_[k].im);
+        if (magnitude > floor) {
+            specB_[k].re /= magnitude;
+            specB_[k].im /= magnitude;
+        } else {
+            specB_[k].re = 0.0;
+            specB_[k].im = 0.0;
+        }
+    }
+    inverseFn_(inverse_, timeA_, specB_, sizeof(AVComplexDouble));
+    gcc.assign(timeA_, timeA_ + maxLag + 1);
+    return true;
+}
+
+bool FftCorrelator::findPeak(const std::vector<double>& values, size_t exclusion, Peak& peak) {
+    size_t best = 0;
+    double bestValue = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] > bestValue) {
+            bestValue = values[i];
+            best = i;
+        }
+    }
+    if (bestValue <= 0.0) {
+        return false;
+    }
+
+    double sidelobe = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        const size_t distance = i > best ? i - best : best - i;
+        if (distance > exclusion) {
+            sidelobe = std::max(sidelobe, values[i]);
+        }
+    }
+
+    // Parabola through the peak and its neighbours; an edge peak stays on the integer lag.
+    double offset = 0.0;
+    if (best > 0 && best + 1 < values.size() &&
+        values[best - 1] != kInvalid && values[best + 1] != kInvalid) {
+        const double left = values[best - 1];
+        const double right = values[best + 1];
+        const double curvature = left - 2.0 * bestValue + right;
+        if (curvature < 0.0) {
+            offset = std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5);
+        }
+    }
+
+    peak.lag = static_cast<double>(best) + offset;
+    peak.value = bestValue;
+    peak.confidence = std::clamp(1.0 - sidelobe / bestValue, 0.0, 1.0);
+    return true;
+}
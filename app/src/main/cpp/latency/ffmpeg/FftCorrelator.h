@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct AVTXContext;
+struct AVComplexDouble;
+
+// Cross-correlation of two mono float signals at every lag, in O(N log N).
+//
+// For a reference window a[0, W) and a search signal b[0, W + maxLag) it computes
+//     ncc(d) = sum_i a[i] * b[i + d] / sqrt(sum_i a[i]^2 * sum_i b[i + d]^2),  d in [0, maxLag]
+// exactly as the time-domain loop does, but the numerator comes from one zero-padded
+// real FFT per input (libavutil av_tx, double precision) and the sliding norm of b from
+// a prefix sum of squares. computeGccPhat() runs the same transforms but whitens the
+// cross spectrum (phase transform), which keeps the direct-path peak narrow under
+// reverberation and speaker/mic coloration.
+// Plans and buffers are cached and only rebuilt when the transform size changes, so one
+// instance should be reused across windows and estimators.
+// Not thread-safe; use one instance per thread.
+class FftCorrelator {
+public:
+    FftCorrelator() = default;
+    ~FftCorrelator();
+
+    FftCorrelator(const FftCorrelator&) = delete;
+    FftCorrelator& operator=(const FftCorrelator&) = delete;
+
+    // Fills ncc[0..maxLag] (resized to maxLag + 1). Lags where either norm is zero
+    // are set to kInvalid. Returns false if the transform could not be set up.
+    bool computeNcc(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                    std::vector<double>& ncc);
+
+    // GCC-PHAT over the same lag range: IFFT(conj(A)B / |conj(A)B|) at lags [0, maxLag].
+    // A perfectly matched, noise-free delay peaks at 1.
+    bool computeGccPhat(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                        std::vector<double>& gcc);
+
+    struct Peak {
+        double lag = 0.0;         // sub-sample lag from parabolic interpolation
+        double value = 0.0;       // value at the integer peak
+        double confidence = 0.0;  // 1 - (highest sidelobe / peak), 0..1
+    };
+
+    // Finds the maximum of a correlation curve. Sidelobes within exclusion samples of
+    // the peak are treated as its main lobe. Returns false when there is no positive peak.
+    static bool findPeak(const std::vector<double>& values, size_t exclusion, Peak& peak);
+
+    // FFT length used for the last call, 0 before the first one.
+    size_t fftSize() const { return fftSize_; }
+
+    static constexpr double kInvalid = -2.0;
+
+private:
+    bool ensurePlan(size_t fftSize);
+    // Loads both inputs, transforms them and leaves conj(A) * B in specB_.
+    bool crossSpectrum(const float* a, const float* b, size_t windowSize, size_t maxLag,
+                       double& leftNorm);
+    void releasePlan();
+
+    size_t fftSize_ = 0;
+    AVTXContext* forward_ = nullptr;
+    AVTXContext* inverse_ = nullptr;
+    void (*forwardFn_)(AVTXContext*, void*, void*, ptrdiff_t) = nullptr;
+    void (*inverseFn_)(AVTXContext*, void*, void*, ptrdiff_t) = nullptr;
+
+    // av_malloc'ed so the transforms may assume SIMD alignment.
+    double* timeA_ = nullptr;            // fftSize_ reals, later reused for the inverse output
+    double* timeB_ = nullptr;            // fftSize_ reals
+    AVComplexDouble* specA_ = nullptr;   // fftSize_ / 2 + 1 bins
+    AVComplexDouble* specB_ = nullptr;
+    std::vector<double> prefixSq_;       // prefixSq_[k] = sum of b[0, k)^2
+};
@@ -12,12 +12,18 @@
 #include <oboe/Oboe.h>
 #include <thread>
 #include <vector>
+#include <deque>
 #include <mutex>
+#include <condition_variable>
 
 #include "audio/AudioRingBuffer.h"
 #include "ffmpeg/AudioTranscode.h"
+#include "window_delay_detector.h"
+#include "window_worker_pool.h"
+#include "ncc_kernels.h"
 #include "logging.h"
 #include "config.h"
+#include "rt_sanitizer.h"
 
 #define LOG_TAG "RecordLatency"
 
@@ -40,6 +46,12 @@ public:
         cleanup();
     }
     
+    // 延迟检测方法，取值与Java层一致
+    enum class DetectMode : int {
+        Ncc = 0,      // 归一化互相关，整样本延迟，结果为相关度
+        GccPhat = 1,  // 相位变换加权的广义互相关，亚样本延迟，结果为峰值尖锐度（置信度）
+    };
+
     // 禁止拷贝和移动
     LatencyTester(const LatencyTester&) = delete;
     LatencyTester& operator=(const LatencyTester&) = delete;
@@ -52,6 +64,7 @@ public:
         explicit PlayCallback(LatencyTester* tester) : tester_(tester) {}
         
         oboe::DataCallbackResult onAudioReady(oboe::AudioStream* audioStream, void* audioData, int32_t numFrames) override {
+            RT_CALLBACK_SCOPE("LatencyTester::PlayCallback");
             if (!tester_ || !tester_->running_.load()) {
                 LOGI("PlayCallback: not running, stop");
                 return oboe::DataCallbackResult::Stop;
@@ -152,6 +165,7 @@ public:
         explicit RecCallback(LatencyTester* tester) : tester_(tester) {}
         
         oboe::DataCallbackResult onAudioReady(oboe::AudioStream* audioStream, void* audioData, int32_t numFrames) override {
+            RT_CALLBACK_SCOPE("LatencyTester::RecCallback");
             if (!tester_ || !tester_->running_.load()) return oboe::DataCallbackResult::Stop;
             const int ch = tester_->inChannelCount_;
             // 严格按录音流参数写入原始数据到环形缓冲（不做格式转换）
@@ -418,6 +432,7 @@ public:
                 outputStream_.reset();
             }
         }
+        RT_SANITIZER_REPORT();
     }
     
     bool isRunning() const {
@@ -435,16 +450,66 @@ public:
     void setInExclusive(bool v) { inExclusive_ = v; }
     void setInLowLatency(bool v) { inLowLatency_ = v; }
     void setInFormatFloat(bool v) { inFormatFloat_ = v; }
+    void setDetectMode(int mode) {
+        detectMode_ = mode == static_cast<int>(DetectMode::GccPhat) ? DetectMode::GccPhat : DetectMode::Ncc;
+    }
+    // 在线检测提前结束：windows 个高置信度窗口的延迟相差不超过 toleranceMs 时停止测试，windows 为0时不提前结束
+    void setEarlyStop(int windows, double toleranceMs) {
+        earlyStopWindows_ = std::max(0, windows);
+        earlyStopToleranceMs_ = std::max(0.0, toleranceMs);
+    }
 
 private:
     // 允许回调类访问私有成员
     friend class PlayCallback;
     friend class RecCallback;
+    // 延迟检测工作线程的暂存区：FFT计划和缓冲区在该线程处理的各窗口间复用
+    using DetectScratch = WindowDelayScratch;
+
+    // 单个窗口的并行检测结果
+    struct WindowSlot {
+        bool evaluated = false;  // 因早期停止被取消的窗口为false
+        bool valid = false;
+        double delaySamples = 0.0;
+        double correlation = 0.0;
+    };
+
+    // 在线检测：合成线程边写文件边把数据交给在线检测线程，滚动缓冲只保留尚未检测的数据
+    struct OnlineWindow {
+        double delaySamples;
+        double correlation;
+    };
+    struct OnlineDetectState {
+        std::vector<float> left;           // 滚动缓冲，left[0] 对应第 base 帧
+        std::vector<float> right;
+        size_t base = 0;                   // 缓冲区起点的绝对帧号
+        size_t scanPos = 0;                // 下一次能量扫描的绝对帧号
+        std::deque<size_t> candidates;     // 待检测的窗口起点（绝对帧号）
+        std::vector<OnlineWindow> results;
+    };
+
+    // 合成线程交给在线检测线程的数据：合成线程只追加交错立体声帧，检测在另一线程进行，
+    // 读取两路 ring 不会因单个窗口的检测（FFT和Java通知）而停顿
+    struct OnlineFeed {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<float> pending;  // 尚未交给 onlineDetect 的交错立体声数据
+        bool finished = false;       // 合成结束，检测线程不再处理剩余数据
+    };
+
+    // 在线检测中相关度/置信度高于此值的窗口参与一致性判断，与离线检测的早期停止阈值相同
+    static constexpr double kOnlineConfidence = 0.5;
+
     static std::string joinPath(const std::string& a, const std::string& b) {
         if (a.empty()) return b;
         if (a.back() == '/') return a + b;
         return a + "/" + b;
     }
+
+    // 短时窗的均方能量，离线和在线的能量扫描共用，由 computeEnergy 的SIMD内核计算
+    static double meanSquare(const float* p, size_t n) {
+        return static_cast<double>(computeEnergy(p, n)) / static_cast<double>(n);
+    }
     
     bool loadPcmFile() {
         const size_t kMaxPcmSize = 50 * 1024 * 1024; // 50MB
@@ -564,6 +629,11 @@ private:
         
         bool started = false;
         
+        // 在线检测状态，起点与离线检测相同（跳过前0.1秒）
+        ensureDetectPool();
+        OnlineFeed feed;
+        std::thread onlineThread([this, &feed]() { onlineDetectThreadProc(feed); });
+        
         while (running_.load()) {
             // 预热门控：等待预热期结束
             if (!started) {
@@ -612,6 +682,14 @@ private:
             // 直接写入 float 数据到文件
             fwrite(interleavedFloat.data(), sizeof(float), frames * 2, fp);
 
+            // 交给在线检测线程
+            {
+                std::lock_guard<std::mutex> lock(feed.mutex);
+                feed.pending.insert(feed.pending.end(), interleavedFloat.data(),
+                                    interleavedFloat.data() + frames * 2);
+            }
+            feed.cv.notify_one();
+
             // 处理剩余数据：将未使用的数据移到缓冲区头部
             leftRemainingFrames = lFrames - frames;
             rightRemainingFrames = rFrames - frames;
@@ -624,6 +702,14 @@ private:
         }
         
         fclose(fp);
+
+        // 停止在线检测：正在检测的窗口完成后退出，未处理的数据由离线检测覆盖
+        {
+            std::lock_guard<std::mutex> lock(feed.mutex);
+            feed.finished = true;
+        }
+        feed.cv.notify_one();
+        onlineThread.join();
         
         // 如果发生错误，不进行后续处理（包括录音检测和编码等操作）
         if (errorOccurred_.load()) {
@@ -662,106 +748,184 @@ private:
         }
     }
     
-    // 单窗口延迟检测辅助函数：检测指定窗口内的延迟
-    // 使用归一化互相关(NCC)方法，在浮点数据上计算左右声道的延迟
-    // 返回是否成功检测，通过输出参数返回延迟值（样本）和相关度
+    // 单窗口延迟检测辅助函数：按当前检测方法检测指定窗口内的延迟，见 window_delay_detector.h
+    // 可在多个工作线程上同时调用，每个线程使用自己的 scratch
+    // 返回是否成功检测，通过输出参数返回延迟值（样本）和相关度/置信度
     bool detectDelayInWindow(
         const std::vector<float>& left,
         const std::vector<float>& right,
         size_t windowStart,
         size_t windowSize,
         size_t totalFrames,
-        size_t& outDelaySamples,
+        DetectScratch& scratch,
+        double& outDelaySamples,
         double& outCorrelation) {
-        
-        // 搜索范围：0到500ms（约24000样本@48kHz）
-        const size_t maxDelaySamples = static_cast<size_t>(kSampleRate * 0.5);  // 500ms
-        const size_t searchEnd = std::min(maxDelaySamples, totalFrames - windowStart - windowSize);
-        
-        if (searchEnd < 100 || windowSize < 1000) {
-            return false;
+        if (detectMode_ == DetectMode::GccPhat) {
+            return detectWindowDelayGccPhat(left, right, windowStart, windowSize, totalFrames, scratch,
+                                            outDelaySamples, outCorrelation);
         }
-        
-        // 归一化互相关：搜索最佳延迟
-        double bestCorr = -1.0;
-        size_t bestDelaySamples = 0;
-        
-        // 为了提高精度，先进行粗搜索（步进10样本），然后对最佳位置附近进行精细搜索
-        const size_t coarseStep = 10;  // 约0.2ms @48kHz
-        
-        // 粗搜索
-        for (size_t delay = 0; delay <= searchEnd && (windowStart + windowSize + delay) < totalFrames; delay += coarseStep) {
-            double corr = 0.0;
-            double leftNorm = 0.0;
-            double rightNorm = 0.0;
-            size_t validSamples = 0;
-            
-            for (size_t i = 0; i < windowSize; ++i) {
-                size_t leftIdx = windowStart + i;
-                size_t rightIdx = windowStart + i + delay;
-                
-                if (leftIdx < totalFrames && rightIdx < totalFrames) {
-                    double lVal = static_cast<double>(left[leftIdx]);
-                    double rVal = static_cast<double>(right[rightIdx]);
-                    corr += lVal * rVal;
-                    leftNorm += lVal * lVal;
-                    rightNorm += rVal * rVal;
-                    validSamples++;
-                }
+        return detectWindowDelayNcc(left, right, windowStart, windowSize, totalFrames, scratch,
+                                    outDelaySamples, outCorrelation);
+    }
+
+    // 在工作线程池上并行检测一组窗口，结果按窗口顺序写入 slots
+    // earlyStopCount > 0 时，已完成的窗口中相关度 > earlyStopThreshold 的达到该数量后取消尚未开始的窗口；
+    // 窗口按顺序分发，所以顺序检测会用到的窗口在返回时都已完成
+    void detectWindowsParallel(
+        const std::vector<float>& left,
+        const std::vector<float>& right,
+        const std::vector<size_t>& windowStarts,
+        size_t windowSize,
+        size_t totalFrames,
+        double earlyStopThreshold,
+        size_t earlyStopCount,
+        std::vector<WindowSlot>& slots) {
+        
+        ensureDetectPool();
+        slots.assign(windowStarts.size(), WindowSlot{});
+        std::atomic<bool> cancel{false};
+        std::atomic<size_t> highCorrelationCount{0};
+        detectPool_->run(windowStarts.size(), [&](size_t index, size_t worker) {
+            WindowSlot& slot = slots[index];
+            slot.evaluated = true;
+            slot.valid = detectDelayInWindow(left, right, windowStarts[index], windowSize, totalFrames,
+                                             *detectScratch_[worker], slot.delaySamples, slot.correlation);
+            if (earlyStopCount > 0 && slot.valid && slot.correlation > earlyStopThreshold &&
+                highCorrelationCount.fetch_add(1, std::memory_order_relaxed) + 1 >= earlyStopCount) {
+                cancel.store(true, std::memory_order_release);
             }
-            
-            // 归一化互相关（NCC）
-            if (validSamples > 0 && leftNorm > 0 && rightNorm > 0) {
-                double normalizedCorr = corr / std::sqrt(leftNorm * rightNorm);
-                if (normalizedCorr > bestCorr) {
-                    bestCorr = normalizedCorr;
-                    bestDelaySamples = delay;
-                }
+        }, &cancel);
+    }
+
+    // 首次检测时创建线程池和每线程暂存区，之后的测试复用
+    void ensureDetectPool() {
+        if (detectPool_) return;
+        const size_t threadCount = WindowWorkerPool::defaultThreadCount();
+        detectScratch_.clear();
+        for (size_t i = 0; i < threadCount; ++i) {
+            detectScratch_.push_back(std::make_unique<DetectScratch>());
+        }
+        detectPool_ = std::make_unique<WindowWorkerPool>(threadCount);
+        LOGI("detectDelay: worker pool with %zu threads, ncc kernel %s", threadCount, nccKernelName());
+    }
+
+    // 在线检测线程：取出合成线程交来的数据逐批检测，起点与离线检测相同（跳过前0.1秒）
+    // 结果一致时提前结束：停止播放/录音，后续流程与播放完毕相同
+    void onlineDetectThreadProc(OnlineFeed& feed) {
+        OnlineDetectState online;
+        online.scanPos = static_cast<size_t>(kSampleRate * 0.1);
+        std::vector<float> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(feed.mutex);
+                feed.cv.wait(lock, [&feed]() { return feed.finished || !feed.pending.empty(); });
+                if (feed.finished) return;
+                batch.swap(feed.pending);
+            }
+            if (onlineDetect(online, batch.data(), batch.size() / 2)) {
+                running_.store(false);
+                return;
             }
+            batch.clear();
         }
-        
-        if (bestCorr < 0) {
-            return false;
+    }
+
+    // 追加合成后的交错立体声数据，并检测已经凑齐搜索范围的候选窗口
+    // 参数与 findHighEnergyWindowStarts / detectDelay 相同；返回是否满足提前结束条件
+    bool onlineDetect(OnlineDetectState& state, const float* interleaved, size_t frames) {
+        const size_t windowSize = static_cast<size_t>(kSampleRate * 0.7);
+        const size_t maxDelaySamples = static_cast<size_t>(kSampleRate * 0.5);
+        const size_t energyWindow = static_cast<size_t>(kSampleRate * 0.03);
+        const size_t energyStep   = static_cast<size_t>(kSampleRate * 0.01);
+        const size_t skipGap      = static_cast<size_t>(kSampleRate * 0.70);
+        const double thresholdMeanSq = 0.001;  // -30 dBFS
+
+        for (size_t i = 0; i < frames; ++i) {
+            state.left.push_back(interleaved[2 * i]);
+            state.right.push_back(interleaved[2 * i + 1]);
         }
-        
-        // 精细搜索：在最佳位置附近进行样本级精确搜索
-        size_t fineSearchStart = (bestDelaySamples > coarseStep) ? (bestDelaySamples - coarseStep) : 0;
-        size_t fineSearchEnd = std::min(bestDelaySamples + coarseStep, searchEnd);
-        size_t refinedBestDelay = bestDelaySamples;
-        double refinedBestCorr = bestCorr;
-        
-        for (size_t delay = fineSearchStart; delay <= fineSearchEnd && (windowStart + windowSize + delay) < totalFrames; ++delay) {
-            double corr = 0.0;
-            double leftNorm = 0.0;
-            double rightNorm = 0.0;
-            size_t validSamples = 0;
-            
-            for (size_t i = 0; i < windowSize; ++i) {
-                size_t leftIdx = windowStart + i;
-                size_t rightIdx = windowStart + i + delay;
-                
-                if (leftIdx < totalFrames && rightIdx < totalFrames) {
-                    double lVal = static_cast<double>(left[leftIdx]);
-                    double rVal = static_cast<double>(right[rightIdx]);
-                    corr += lVal * rVal;
-                    leftNorm += lVal * lVal;
-                    rightNorm += rVal * rVal;
-                    validSamples++;
-                }
+        const size_t end = state.base + state.left.size();
+
+        // 能量扫描：与离线版本相同的步进和跳过规则
+        while (state.scanPos + energyWindow <= end) {
+            if (meanSquare(state.left.data() + (state.scanPos - state.base), energyWindow) >= thresholdMeanSq) {
+                state.candidates.push_back(state.scanPos);
+                state.scanPos += skipGap;
+            } else {
+                state.scanPos += energyStep;
             }
-            
-            if (validSamples > 0 && leftNorm > 0 && rightNorm > 0) {
-                double normalizedCorr = corr / std::sqrt(leftNorm * rightNorm);
-                if (normalizedCorr > refinedBestCorr) {
-                    refinedBestCorr = normalizedCorr;
-                    refinedBestDelay = delay;
-                }
+        }
+
+        // 右声道覆盖完整搜索范围后才检测，结果与离线检测同一窗口一致
+        bool updated = false;
+        while (!state.candidates.empty() &&
+               state.candidates.front() + windowSize + maxDelaySamples < end) {
+            const size_t start = state.candidates.front();
+            state.candidates.pop_front();
+            double delaySamples = 0.0;
+            double correlation = 0.0;
+            if (detectDelayInWindow(state.left, state.right, start - state.base, windowSize, state.left.size(),
+                                    *detectScratch_[0], delaySamples, correlation)) {
+                state.results.push_back({delaySamples, correlation});
+                updated = true;
+                LOGI("onlineDetect: window at %.2fs: delay=%.2f ms, correlation=%.4f",
+                     start * 1.0 / kSampleRate, delaySamples * 1000.0 / kSampleRate, correlation);
             }
         }
-        
-        outDelaySamples = refinedBestDelay;
-        outCorrelation = refinedBestCorr;
-        return true;
+
+        // 丢弃不再需要的数据：最早的待检测窗口或扫描位置之前的部分
+        const size_t keepFrom = std::min(state.scanPos,
+                                         state.candidates.empty() ? state.scanPos : state.candidates.front());
+        if (keepFrom > state.base + static_cast<size_t>(kSampleRate)) {
+            const size_t drop = std::min(keepFrom - state.base, state.left.size());
+            state.left.erase(state.left.begin(), state.left.begin() + drop);
+            state.right.erase(state.right.begin(), state.right.begin() + drop);
+            state.base += drop;
+        }
+
+        if (!updated) return false;
+        publishProvisional(state);
+        return earlyStopWindows_ > 0 && onlineConverged(state);
+    }
+
+    // 临时结果：与最终结果相同，取相关度最高的3个窗口按相关度平方加权
+    void publishProvisional(const OnlineDetectState& state) {
+        std::vector<OnlineWindow> top(state.results);
+        std::sort(top.begin(), top.end(), [](const OnlineWindow& a, const OnlineWindow& b) {
+            return a.correlation > b.correlation;
+        });
+        top.resize(std::min<size_t>(3, top.size()));
+        double weightSum = 0.0;
+        double delaySum = 0.0;
+        for (const OnlineWindow& w : top) {
+            const double weight = w.correlation * w.correlation;
+            delaySum += w.delaySamples * weight;
+            weightSum += weight;
+        }
+        if (weightSum <= 0.0) return;
+        notifyJavaProvisional(delaySum / weightSum * 1000.0 / kSampleRate, top.front().correlation,
+                              static_cast<int>(state.results.size()));
+    }
+
+    // 是否已有 earlyStopWindows_ 个高置信度窗口的延迟落在 earlyStopToleranceMs_ 之内
+    bool onlineConverged(const OnlineDetectState& state) const {
+        std::vector<double> delays;
+        for (const OnlineWindow& w : state.results) {
+            if (w.correlation > kOnlineConfidence) delays.push_back(w.delaySamples);
+        }
+        const size_t need = static_cast<size_t>(earlyStopWindows_);
+        if (delays.size() < need) return false;
+        std::sort(delays.begin(), delays.end());
+        const double toleranceSamples = earlyStopToleranceMs_ * kSampleRate / 1000.0;
+        for (size_t i = 0; i + need <= delays.size(); ++i) {
+            if (delays[i + need - 1] - delays[i] <= toleranceSamples) {
+                LOGI("onlineDetect: %zu windows agree within %.2f ms (%.2f - %.2f ms), finishing early",
+                     need, earlyStopToleranceMs_, delays[i] * 1000.0 / kSampleRate,
+                     delays[i + need - 1] * 1000.0 / kSampleRate);
+                return true;
+            }
+        }
+        return false;
     }
 
     // float 版本的 findHighEnergyWindowStarts 函数
@@ -787,13 +951,7 @@ private:
 
         size_t s = startOffset;
         while (s + energyWindow <= totalFrames) {
-            double sumSq = 0.0;
-            const size_t end = s + energyWindow;
-            for (size_t i = s; i < end; ++i) {
-                const double v = static_cast<double>(left[i]);
-                sumSq += v * v;
-            }
-            const double meanSq = sumSq / static_cast<double>(energyWindow);
+            const double meanSq = meanSquare(left.data() + s, energyWindow);
 
             if (meanSq >= thresholdMeanSq) {
                 // 命中一个高能量起点
@@ -832,7 +990,7 @@ private:
         
         // 存储每个窗口的检测结果：延迟值（样本）和相关度
         struct WindowResult {
-            size_t delaySamples;
+            double delaySamples;
             double correlation;
             
             // 用于排序：按相关度降序
@@ -845,19 +1003,25 @@ private:
         const size_t earlyStopCount = 3;        // 早期停止所需的高质量窗口数
         
         // 基于能量的候选窗口起点（针对"数字+停顿"的语音结构）
-        const std::vector<size_t> windowStarts = findHighEnergyWindowStarts(left, totalFrames, windowSize, startOffset);
+        std::vector<size_t> windowStarts = findHighEnergyWindowStarts(left, totalFrames, windowSize, startOffset);
+        windowStarts.erase(std::remove_if(windowStarts.begin(), windowStarts.end(),
+                                          [&](size_t start) { return start + windowSize > totalFrames; }),
+                           windowStarts.end());
 
-        // 遍历候选窗口进行检测
+        // 并行检测候选窗口，再按窗口顺序汇总，早期停止的结果与逐个检测一致
+        std::vector<WindowSlot> slots;
+        detectWindowsParallel(left, right, windowStarts, windowSize, totalFrames,
+                              earlyStopThreshold, earlyStopCount, slots);
         size_t windowCount = 0;
         size_t highCorrelationCount = 0;  // 相关度>0.5的窗口数
-        for (size_t windowStart : windowStarts) {
-            if (windowStart + windowSize > totalFrames) continue;
+        for (size_t index = 0; index < windowStarts.size() && slots[index].evaluated; ++index) {
+            const size_t windowStart = windowStarts[index];
             windowCount++;
-            size_t delaySamples = 0;
-            double correlation = 0.0;
-            if (detectDelayInWindow(left, right, windowStart, windowSize, totalFrames, delaySamples, correlation)) {
+            const double delaySamples = slots[index].delaySamples;
+            const double correlation = slots[index].correlation;
+            if (slots[index].valid) {
                 allResults.push_back({delaySamples, correlation});
-                LOGI("detectDelay: Candidate %zu (start=%.2fs): delay=%zu samples (%.2f ms), correlation=%.4f",
+                LOGI("detectDelay: Candidate %zu (start=%.2fs): delay=%.2f samples (%.2f ms), correlation=%.4f",
                      windowCount, windowStart * 1000.0 / kSampleRate,
                      delaySamples, delaySamples * 1000.0 / kSampleRate, correlation);
                 if (correlation > earlyStopThreshold) {
@@ -875,10 +1039,14 @@ private:
         if (allResults.size() < 3) {
             LOGW("detectDelay: Not enough results, using uniform sliding window strategy");
             const size_t windowStep = static_cast<size_t>(kSampleRate * 0.5);   // 50%重叠，0.5秒步进
+            std::vector<size_t> uniformStarts;
             for (size_t windowStart = startOffset; windowStart + windowSize <= totalFrames; windowStart += windowStep) {
-                size_t delaySamples = 0; double correlation = 0.0;
-                if (detectDelayInWindow(left, right, windowStart, windowSize, totalFrames, delaySamples, correlation)) {
-                    allResults.push_back({delaySamples, correlation});
+                uniformStarts.push_back(windowStart);
+            }
+            detectWindowsParallel(left, right, uniformStarts, windowSize, totalFrames, 0.0, 0, slots);
+            for (const WindowSlot& slot : slots) {
+                if (slot.valid) {
+                    allResults.push_back({slot.delaySamples, slot.correlation});
                 }
             }
         }
@@ -915,7 +1083,7 @@ private:
         for (const auto& result : selectedResults) {
             // 权重：相关度的平方，使高相关度窗口影响更大
             double weight = result.correlation * result.correlation;
-            weightedDelaySum += static_cast<double>(result.delaySamples) * weight;
+            weightedDelaySum += result.delaySamples * weight;
             totalWeight += weight;
         }
         
@@ -924,14 +1092,18 @@ private:
             return -1.0;
         }
         
-        size_t averageDelaySamples = static_cast<size_t>(weightedDelaySum / totalWeight + 0.5);
+        // NCC只有整样本精度，平均后仍取整；GCC-PHAT保留亚样本结果
+        double averageDelaySamples = weightedDelaySum / totalWeight;
+        if (detectMode_ == DetectMode::Ncc) {
+            averageDelaySamples = std::floor(averageDelaySamples + 0.5);
+        }
         double delayMs = averageDelaySamples * 1000.0 / kSampleRate;
         
         // 计算标准差，验证一致性
         double variance = 0.0;
         for (const auto& result : selectedResults) {
             double weight = result.correlation * result.correlation;
-            double diff = static_cast<double>(result.delaySamples) - static_cast<double>(averageDelaySamples);
+            double diff = result.delaySamples - averageDelaySamples;
             variance += weight * diff * diff;
         }
         double stdDevSamples = std::sqrt(variance / totalWeight);
@@ -963,7 +1135,15 @@ private:
             leftChannel[i] = interleaved[i * 2];
             rightChannel[i] = interleaved[i * 2 + 1];
         }
-        return detectDelay(leftChannel, rightChannel, totalFrames);
+        const auto detectStart = std::chrono::steady_clock::now();
+        const double delayMs = detectDelay(leftChannel, rightChannel, totalFrames);
+        const auto detectMs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - detectStart).count() / 1000.0;
+        LOGI("detectDelay: %s took %.1f ms (%zu threads, fft size %zu)",
+             detectMode_ == DetectMode::GccPhat ? "GCC-PHAT" : "NCC", detectMs,
+             detectPool_ ? detectPool_->threadCount() : 0,
+             detectScratch_.empty() ? 0 : detectScratch_[0]->correlator.fftSize());
+        return delayMs;
     }
 
     
@@ -1123,6 +1303,31 @@ private:
         if (needDetach) vm_->DetachCurrentThread();
     }
     
+    void notifyJavaProvisional(double delayMs, double correlation, int windowCount) {
+        if (!vm_) return;
+        JNIEnv* envCb = nullptr;
+        bool needDetach = false;
+        if (vm_->GetEnv(reinterpret_cast<void**>(&envCb), JNI_VERSION_1_6) != JNI_OK) {
+            if (vm_->AttachCurrentThread(&envCb, nullptr) == JNI_OK) needDetach = true;
+        }
+        if (envCb) {
+            jclass cls = latencyEventsClass_ ? latencyEventsClass_ : envCb->FindClass(LATENCY_EVENTS_CLASS);
+            if (cls) {
+                // 方法签名: notifyProvisional(double delayMs, double correlation, int windowCount)
+                jmethodID mid = envCb->GetStaticMethodID(cls, "notifyProvisional", "(DDI)V");
+                if (mid) {
+                    envCb->CallStaticVoidMethod(cls, mid, (jdouble)delayMs, (jdouble)correlation, (jint)windowCount);
+                } else {
+                    LOGE("notifyProvisional not found");
+                }
+                if (!latencyEventsClass_) envCb->DeleteLocalRef(cls);
+            } else {
+                LOGE("LatencyEvents class not found");
+            }
+        }
+        if (needDetach) vm_->DetachCurrentThread();
+    }
+    
     void notifyJavaCompleted(int rc) {
         if (!vm_) return;
         JNIEnv* envCb = nullptr;
@@ -1284,6 +1489,12 @@ private:
     double detectedDelayMs_{-1.0};  // 检测到的延迟值（毫秒），-1表示未检测或检测失败
     double top3Delays_[3];          // 前3个最高相关度窗口的延迟值（毫秒）
     double top3Correlations_[3];    // 前3个最高相关度窗口的相关度
+    DetectMode detectMode_{DetectMode::Ncc};  // 延迟检测方法
+    int earlyStopWindows_{0};                 // 在线检测提前结束所需的一致窗口数，0为不提前结束
+    double earlyStopToleranceMs_{1.0};        // 一致窗口的最大延迟差（毫秒）
+    // 延迟检测线程池及每线程暂存区（两种检测方法共用）；线程池先于暂存区析构
+    std::vector<std::unique_ptr<DetectScratch>> detectScratch_;
+    std::unique_ptr<WindowWorkerPool> detectPool_;
     std::unique_ptr<oboe::AudioStream> inputStream_;
     std::unique_ptr<oboe::AudioStream> outputStream_;
     std::chrono::steady_clock::time_point startTime_;
@@ -1363,7 +1574,10 @@ Java_me_rjy_oboe_record_demo_LatencyTesterActivity_startLatencyTest(
         jboolean inLowLatency,
         jint inSampleRate,
         jint inChannels,
-        jboolean inFormatFloat) {
+        jboolean inFormatFloat,
+        jint detectMode,
+        jint earlyStopWindows,
+        jdouble earlyStopToleranceMs) {
     LatencyTester* tester = reinterpret_cast<LatencyTester*>(nativeHandle);
     if (tester == nullptr) {
         LOGE("LatencyTester instance is null");
@@ -1393,6 +1607,10 @@ Java_me_rjy_oboe_record_demo_LatencyTesterActivity_startLatencyTest(
     tester->setInExclusive(inExclusive == JNI_TRUE);
     tester->setInLowLatency(inLowLatency == JNI_TRUE);
     tester->setInFormatFloat(inFormatFloat == JNI_TRUE);
+
+    // 延迟检测方法
+    tester->setDetectMode(static_cast<int>(detectMode));
+    tester->setEarlyStop(static_cast<int>(earlyStopWindows), static_cast<double>(earlyStopToleranceMs));
     
     int result = tester->start(env, std::string(inPath), std::string(cacheDir), std::string(outPath));
     
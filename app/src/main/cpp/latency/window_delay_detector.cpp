@@ -0,0 +1,143 @@
+#include "window_delay_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "config.h"
+#include "ncc_kernels.h"
+
+namespace {
+
+// 搜索范围：0到500ms（约24000样本@48kHz）
+constexpr size_t kMaxDelaySamples = static_cast<size_t>(kSampleRate * 0.5);
+
+// GCC-PHAT峰值两侧1ms内视为主瓣，其外的最高值作为旁瓣计算置信度
+constexpr size_t kPeakExclusionSamples = kSampleRate / 1000;
+
+// 窗口和搜索范围是否足够，足够时给出右声道可用的最大延迟
+// 右声道需要覆盖 windowStart + windowSize + delay < totalFrames
+bool searchRange(size_t windowStart, size_t windowSize, size_t totalFrames, size_t& maxLag) {
+    const size_t searchEnd = std::min(kMaxDelaySamples, totalFrames - windowStart - windowSize);
+    if (searchEnd < 100 || windowSize < 1000) {
+        return false;
+    }
+    maxLag = std::min(searchEnd, totalFrames - windowStart - windowSize - 1);
+    return true;
+}
+
+} // namespace
+
+bool detectWindowDelayNcc(const std::vector<float>& left, const std::vector<float>& right,
+                          size_t windowStart, size_t windowSize, size_t totalFrames,
+                          WindowDelayScratch& scratch, double& outDelaySamples, double& outCorrelation) {
+    size_t maxLag = 0;
+    if (!searchRange(windowStart, windowSize, totalFrames, maxLag)) {
+        return false;
+    }
+    if (!scratch.correlator.computeNcc(left.data() + windowStart, right.data() + windowStart,
+                                       windowSize, maxLag, scratch.values)) {
+        size_t directDelay = 0;
+        if (!detectWindowDelayNccDirect(left, right, windowStart, windowSize, totalFrames,
+                                        directDelay, outCorrelation)) {
+            return false;
+        }
+        outDelaySamples = static_cast<double>(directDelay);
+        return true;
+    }
+
+    // 相同相关度取较小的延迟，与时域搜索一致
+    double bestCorr = FftCorrelator::kInvalid;
+    size_t bestDelaySamples = 0;
+    for (size_t delay = 0; delay <= maxLag; ++delay) {
+        if (scratch.values[delay] > bestCorr) {
+            bestCorr = scratch.values[delay];
+            bestDelaySamples = delay;
+        }
+    }
+    // 与时域搜索相同：没有有效延迟（kInvalid）或最大相关度为负时视为没有检测到
+    if (bestCorr < 0) {
+        return false;
+    }
+
+    outDelaySamples = static_cast<double>(bestDelaySamples);
+    outCorrelation = bestCorr;
+    return true;
+}
+
+bool detectWindowDelayNccDirect(const std::vector<float>& left, const std::vector<float>& right,
+                                size_t windowStart, size_t windowSize, size_t totalFrames,
+                                size_t& outDelaySamples, double& outCorrelation) {
+    const size_t searchEnd = std::min(kMaxDelaySamples, totalFrames - windowStart - windowSize);
+
+    // 归一化互相关：搜索最佳延迟
+    double bestCorr = -1.0;
+    size_t bestDelaySamples = 0;
+
+    // 为了提高精度，先进行粗搜索（步进10样本），然后对最佳位置附近进行精细搜索
+    const size_t coarseStep = 10;  // 约0.2ms @48kHz
+
+    // 粗搜索；循环条件保证右声道 windowStart + delay 起的整个窗口都在范围内
+    for (size_t delay = 0; delay <= searchEnd && (windowStart + windowSize + delay) < totalFrames; delay += coarseStep) {
+        // 点积和两路能量由 computeNccSums 的SIMD内核一次遍历得到
+        const NccSums sums = computeNccSums(left.data() + windowStart, right.data() + windowStart + delay, windowSize);
+        const double corr = sums.dot;
+        const double leftNorm = sums.energyA;
+        const double rightNorm = sums.energyB;
+
+        // 归一化互相关（NCC）
+        if (leftNorm > 0 && rightNorm > 0) {
+            double normalizedCorr = corr / std::sqrt(leftNorm * rightNorm);
+            if (normalizedCorr > bestCorr) {
+                bestCorr = normalizedCorr;
+                bestDelaySamples = delay;
+            }
+        }
+    }
+
+    if (bestCorr < 0) {
+        return false;
+    }
+
+    // 精细搜索：在最佳位置附近进行样本级精确搜索
+    size_t fineSearchStart = (bestDelaySamples > coarseStep) ? (bestDelaySamples - coarseStep) : 0;
+    size_t fineSearchEnd = std::min(bestDelaySamples + coarseStep, searchEnd);
+    size_t refinedBestDelay = bestDelaySamples;
+    double refinedBestCorr = bestCorr;
+
+    for (size_t delay = fineSearchStart; delay <= fineSearchEnd && (windowStart + windowSize + delay) < totalFrames; ++delay) {
+        const NccSums sums = computeNccSums(left.data() + windowStart, right.data() + windowStart + delay, windowSize);
+        const double corr = sums.dot;
+        const double leftNorm = sums.energyA;
+        const double rightNorm = sums.energyB;
+
+        if (leftNorm > 0 && rightNorm > 0) {
+            double normalizedCorr = corr / std::sqrt(leftNorm * rightNorm);
+            if (normalizedCorr > refinedBestCorr) {
+                refinedBestCorr = normalizedCorr;
+                refinedBestDelay = delay;
+            }
+        }
+    }
+
+    outDelaySamples = refinedBestDelay;
+    outCorrelation = refinedBestCorr;
+    return true;
+}
+
+bool detectWindowDelayGccPhat(const std::vector<float>& left, const std::vector<float>& right,
+                              size_t windowStart, size_t windowSize, size_t totalFrames,
+                              WindowDelayScratch& scratch, double& outDelaySamples, double& outCorrelation) {
+    size_t maxLag = 0;
+    if (!searchRange(windowStart, windowSize, totalFrames, maxLag)) {
+        return false;
+    }
+    FftCorrelator::Peak peak;
+    if (!scratch.correlator.computeGccPhat(left.data() + windowStart, right.data() + windowStart,
+                                           windowSize, maxLag, scratch.values) ||
+        !FftCorrelator::findPeak(scratch.values, kPeakExclusionSamples, peak)) {
+        return false;
+    }
+    outDelaySamples = peak.lag;
+    outCorrelation = peak.confidence;
+    return true;
+}
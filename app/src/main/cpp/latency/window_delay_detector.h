@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ffmpeg/FftCorrelator.h"
+
+// 单窗口延迟检测：以左声道 [windowStart, windowStart + windowSize) 为参考，
+// 在右声道中搜索 0 到 500ms 的延迟。left/right 长度至少为 totalFrames。
+// 可在多个工作线程上同时调用，每个线程使用自己的 WindowDelayScratch。
+// 成功时通过输出参数返回延迟（样本）和相关度/置信度。
+
+// 每线程暂存区：FFT计划和缓冲区在该线程处理的各窗口间复用
+struct WindowDelayScratch {
+    FftCorrelator correlator;
+    std::vector<double> values;  // 单窗口各延迟的NCC或GCC-PHAT值
+};
+
+// NCC：通过FFT一次得到所有延迟上的精确归一化互相关并取最大值，整样本延迟；
+// FFT不可用时回退到时域搜索。最大相关度为负时视为没有检测到
+bool detectWindowDelayNcc(const std::vector<float>& left, const std::vector<float>& right,
+                          size_t windowStart, size_t windowSize, size_t totalFrames,
+                          WindowDelayScratch& scratch, double& outDelaySamples, double& outCorrelation);
+
+// 时域NCC搜索：先按10样本步进粗搜索，再在最佳位置附近逐样本精细搜索
+// 每个延迟都重新计算范数，O(窗口长度 × 搜索范围)，仅在FFT不可用时使用
+bool detectWindowDelayNccDirect(const std::vector<float>& left, const std::vector<float>& right,
+                                size_t windowStart, size_t windowSize, size_t totalFrames,
+                                size_t& outDelaySamples, double& outCorrelation);
+
+// GCC-PHAT：白化互功率谱后取峰值，抛物线插值得到亚样本延迟，相关度输出为峰值尖锐度
+bool detectWindowDelayGccPhat(const std::vector<float>& left, const std::vector<float>& right,
+                              size_t windowStart, size_t windowSize, size_t totalFrames,
+                              WindowDelayScratch& scratch, double& outDelaySamples, double& outCorrelation);
@@ -0,0 +1,75 @@
+#include "window_worker_pool.h"
+
+#include <algorithm>
+
+WindowWorkerPool::WindowWorkerPool(size_t threadCount) {
+    threadCount = std::max<size_t>(1, threadCount);
+    threads_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&WindowWorkerPool::workerLoop, this, i);
+    }
+}
+
+WindowWorkerPool::~WindowWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    workCv_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+size_t WindowWorkerPool::defaultThreadCount() {
+    const unsigned cores = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(cores, 1, kMaxThreads);
+}
+
+void WindowWorkerPool::run(size_t count, const Task& task, const std::atomic<bool>* cancel) {
+    if (count == 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    cancel_ = cancel;
+    nextIndex_.store(0, std::memory_order_relaxed);
+    finishedWorkers_ = 0;
+    ++generation_;
+    workCv_.notify_all();
+
+    // 每个线程处理完本轮都会计数，全部到齐才返回，保证下一轮开始时没有线程还在用旧任务
+    doneCv_.wait(lock, [this] { return finishedWorkers_ == threads_.size(); });
+    task_ = nullptr;
+    cancel_ = nullptr;
+}
+
+void WindowWorkerPool::workerLoop(size_t worker) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        const Task* task;
+        size_t count;
+        const std::atomic<bool>* cancel;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            workCv_.wait(lock, [&] { return quit_ || generation_ != seenGeneration; });
+            if (quit_) return;
+            seenGeneration = generation_;
+            task = task_;
+            count = count_;
+            cancel = cancel_;
+        }
+
+        while (!(cancel && cancel->load(std::memory_order_acquire))) {
+            const size_t index = nextIndex_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count) break;
+            (*task)(index, worker);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++finishedWorkers_;
+        }
+        doneCv_.notify_one();
+    }
+}
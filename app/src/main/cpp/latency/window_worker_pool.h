@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池：用于延迟检测时并行计算多个窗口
+// 线程在构造时创建并一直保留，run() 之间空闲等待，不会反复创建线程。
+// 任务按索引从小到大分发；取消后尚未开始的索引被跳过，已开始的会执行完，
+// 因此取消时刻之前分发出去的所有索引在 run() 返回时都已完成。
+class WindowWorkerPool {
+public:
+    // task(index, worker)：worker 为 [0, threadCount()) 内的线程编号，可用于索引每线程的暂存区
+    using Task = std::function<void(size_t index, size_t worker)>;
+
+    explicit WindowWorkerPool(size_t threadCount);
+    ~WindowWorkerPool();
+
+    WindowWorkerPool(const WindowWorkerPool&) = delete;
+    WindowWorkerPool& operator=(const WindowWorkerPool&) = delete;
+
+    size_t threadCount() const { return threads_.size(); }
+
+    // 对 [0, count) 并行执行 task，阻塞直到全部完成或被取消；不可重入
+    // cancel 为 nullptr 时不支持取消
+    void run(size_t count, const Task& task, const std::atomic<bool>* cancel);
+
+    // 默认线程数：CPU 核心数，最多 kMaxThreads
+    static size_t defaultThreadCount();
+
+    static constexpr size_t kMaxThreads = 8;
+
+private:
+    void workerLoop(size_t worker);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable workCv_;
+    std::condition_variable doneCv_;
+    uint64_t generation_ = 0;   // 每次 run() 加一，唤醒所有线程
+    size_t finishedWorkers_ = 0;
+    bool quit_ = false;
+
+    // 当前任务（run() 期间有效）
+    const Task* task_ = nullptr;
+    size_t count_ = 0;
+    const std::atomic<bool>* cancel_ = nullptr;
+    std::atomic<size_t> nextIndex_{0};
+};
@@ -0,0 +1,303 @@
+#include "mapped_pcm_source.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "logging.h"
+
+#define LOG_TAG "MappedPcmSource"
+
+// 预取线程保持读位置前方已在内存中的数据量
+static constexpr uint64_t kPrefetchAheadBytes = 2 * 1024 * 1024;
+// 读位置每前进这么多字节唤醒一次预取线程，也是打开和跳转时同步准备的数据量
+static constexpr uint64_t kPrefetchStepBytes = 256 * 1024;
+// 读位置之后保留的页面，超出部分释放
+static constexpr uint64_t kKeepBehindBytes = 256 * 1024;
+
+constexpr int64_t MappedPcmSource::kNoSeek;
+
+MappedPcmSource::MappedPcmSource()
+    : pageSize_(static_cast<size_t>(std::max(sysconf(_SC_PAGESIZE), 4096L)))
+    , mapBase_(nullptr)
+    , mapLength_(0)
+    , data_(nullptr)
+    , dataDelta_(0)
+    , size_(0)
+    , bytesPerFrame_(1)
+    , cursor_(0)
+    , requestedSeek_(kNoSeek)
+    , readySeek_(kNoSeek)
+    , loopSerial_(0)
+    , loopStartRequest_(0)
+    , loopEndRequest_(0)
+    , loopSerialSeen_(0)
+    , loopStart_(0)
+    , loopEnd_(0)
+    , prefetchedEnd_(0)
+    , releasedEnd_(0)
+    , closing_(false) {
+    sem_init(&wake_, 0, 0);
+}
+
+MappedPcmSource::~MappedPcmSource() {
+    close();
+    sem_destroy(&wake_);
+}
+
+bool MappedPcmSource::open(int fd, int64_t dataOffset, uint64_t dataSize, size_t bytesPerFrame) {
+    close();
+    if (fd < 0 || dataOffset < 0 || dataSize == 0 || bytesPerFrame == 0) {
+        return false;
+    }
+
+    // mmap的文件偏移必须页对齐，数据区起点落在第一页中间
+    const uint64_t mapOffset = alignDown(static_cast<uint64_t>(dataOffset));
+    const uint64_t delta = static_cast<uint64_t>(dataOffset) - mapOffset;
+    if (dataSize > SIZE_MAX - delta) {
+        LOGW("data too large to map: %llu bytes", static_cast<unsigned long long>(dataSize));
+        return false;
+    }
+    const size_t length = static_cast<size_t>(delta + dataSize);
+    void* base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(mapOffset));
+    if (base == MAP_FAILED) {
+        LOGW("mmap failed: %s", strerror(errno));
+        return false;
+    }
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    mapBase_ = base;
+    mapLength_ = length;
+    dataDelta_ = static_cast<size_t>(delta);
+    data_ = static_cast<const uint8_t*>(base) + delta;
+    size_ = dataSize;
+    bytesPerFrame_ = bytesPerFrame;
+    cursor_.store(0);
+    requestedSeek_.store(kNoSeek);
+    readySeek_.store(kNoSeek);
+    loopStartRequest_.store(0);
+    loopEndRequest_.store(0);
+    loopSerialSeen_ = loopSerial_.load();
+    loopStart_ = 0;
+    loopEnd_ = 0;
+
+    // 同步准备开头的数据，保证第一次回调不会缺页
+    prefetchedEnd_ = std::min(kPrefetchStepBytes, size_);
+    prefetch(0, prefetchedEnd_);
+    releasedEnd_ = 0;
+
+    startPrefetchThread();
+    LOGI("mapped %llu bytes at offset %lld", static_cast<unsigned long long>(size_),
+         static_cast<long long>(dataOffset));
+    return true;
+}
+
+void MappedPcmSource::close() {
+    stopPrefetchThread();
+    if (mapBase_) {
+        munmap(mapBase_, mapLength_);
+        mapBase_ = nullptr;
+        mapLength_ = 0;
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void MappedPcmSource::rewind() {
+    if (!data_) {
+        return;
+    }
+    // 先停下预取线程，它的私有状态才可以在这里重置
+    stopPrefetchThread();
+    cursor_.store(0);
+    requestedSeek_.store(kNoSeek);
+    readySeek_.store(kNoSeek);
+    prefetchedEnd_ = std::min(kPrefetchStepBytes, size_);
+    prefetch(0, prefetchedEnd_);
+    releasedEnd_ = 0;
+    startPrefetchThread();
+}
+
+void MappedPcmSource::startPrefetchThread() {
+    closing_ = false;
+    prefetchThread_ = std::make_unique<std::thread>(&MappedPcmSource::prefetchThreadFunc, this);
+    sem_post(&wake_);
+}
+
+void MappedPcmSource::stopPrefetchThread() {
+    if (!prefetchThread_) {
+        return;
+    }
+    closing_ = true;
+    sem_post(&wake_);
+    if (prefetchThread_->joinable()) {
+        prefetchThread_->join();
+    }
+    prefetchThread_.reset();
+}
+
+size_t MappedPcmSource::read(void* dst, size_t size, bool* seeked) {
+    if (!data_) {
+        return 0;
+    }
+    if (loopSerial_.load(std::memory_order_acquire) != loopSerialSeen_) {
+        applyLoopRequest();
+    }
+
+    uint64_t position = cursor_.load(std::memory_order_relaxed);
+    bool jumped = false;
+    if (readySeek_.load(std::memory_order_relaxed) != kNoSeek) {
+        const int64_t target = readySeek_.exchange(kNoSeek, std::memory_order_acquire);
+        if (target != kNoSeek) {
+            position = static_cast<uint64_t>(target);
+            jumped = true;
+        }
+    }
+    if (seeked) {
+        *seeked = jumped;
+    }
+
+    const uint64_t start = position;
+    auto* out = static_cast<uint8_t*>(dst);
+    size_t copied = 0;
+    while (copied < size) {
+        const bool looping = loopEnd_ > loopStart_;
+        const uint64_t limit = looping ? loopEnd_ : size_;
+        if (position >= limit) {
+            if (!looping) {
+                break;
+            }
+            position = loopStart_;
+            jumped = true;
+            continue;
+        }
+        const size_t bytes = static_cast<size_t>(std::min<uint64_t>(size - copied, limit - position));
+        memcpy(out + copied, data_ + position, bytes);
+        position += bytes;
+        copied += bytes;
+    }
+    cursor_.store(position, std::memory_order_release);
+
+    if (jumped || position / kPrefetchStepBytes != start / kPrefetchStepBytes) {
+        sem_post(&wake_);
+    }
+    return copied;
+}
+
+void MappedPcmSource::applyLoopRequest() {
+    // 写入端正在更新时序号为奇数，或读取期间序号变化，下次回调再取
+    const uint32_t serial = loopSerial_.load(std::memory_order_acquire);
+    if (serial & 1u) {
+        return;
+    }
+    const uint64_t start = loopStartRequest_.load(std::memory_order_relaxed);
+    const uint64_t end = loopEndRequest_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (loopSerial_.load(std::memory_order_relaxed) != serial) {
+        return;
+    }
+    loopSerialSeen_ = serial;
+    loopStart_ = start;
+    loopEnd_ = end;
+}
+
+void MappedPcmSource::seek(uint64_t position) {
+    if (!data_) {
+        return;
+    }
+    position = std::min(position, size_);
+    position -= position % bytesPerFrame_;
+    requestedSeek_.store(static_cast<int64_t>(position), std::memory_order_release);
+    sem_post(&wake_);
+}
+
+void MappedPcmSource::setLoop(uint64_t start, uint64_t end) {
+    if (!data_) {
+        return;
+    }
+    start = std::min(start, size_);
+    start -= start % bytesPerFrame_;
+    end = std::min(end, size_);
+    end -= end % bytesPerFrame_;
+    if (end <= start) {
+        start = 0;
+        end = 0;
+    }
+    // 序号为奇数期间读取端不会采用起止位置
+    const uint32_t serial = loopSerial_.load(std::memory_order_relaxed);
+    loopSerial_.store(serial + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    loopStartRequest_.store(start, std::memory_order_relaxed);
+    loopEndRequest_.store(end, std::memory_order_relaxed);
+    loopSerial_.store(serial + 2, std::memory_order_release);
+    sem_post(&wake_);
+}
+
+void MappedPcmSource::prefetchThreadFunc() {
+    while (true) {
+        if (sem_wait(&wake_) != 0 && errno == EINTR) {
+            continue;
+        }
+        if (closing_) {
+            break;
+        }
+
+        uint64_t base = cursor_.load(std::memory_order_acquire);
+        const int64_t target = requestedSeek_.exchange(kNoSeek, std::memory_order_acq_rel);
+        if (target != kNoSeek) {
+            // 先准备目标位置的一小段再交给回调，跳转后的第一次读取不会缺页
+            base = static_cast<uint64_t>(target);
+            prefetchedEnd_ = std::min(base + kPrefetchStepBytes, size_);
+            prefetch(base, prefetchedEnd_);
+            readySeek_.store(target, std::memory_order_release);
+        }
+
+        // 读位置跳出了已预取的范围（跳转或预取落后），从读位置重新开始
+        if (prefetchedEnd_ < base || prefetchedEnd_ > base + kPrefetchAheadBytes + kPrefetchStepBytes) {
+            prefetchedEnd_ = base;
+        }
+        const uint64_t loopStart = loopStartRequest_.load(std::memory_order_relaxed);
+        const uint64_t loopEnd = loopEndRequest_.load(std::memory_order_relaxed);
+        const bool looping = loopEnd > loopStart && base < loopEnd;
+        const uint64_t limit = looping ? loopEnd : size_;
+        const uint64_t ahead = std::min(base + kPrefetchAheadBytes, limit);
+        if (prefetchedEnd_ < ahead) {
+            prefetch(prefetchedEnd_, ahead);
+            prefetchedEnd_ = ahead;
+        }
+        // 接近循环终点时提前准备起点，回到起点时不会缺页
+        if (looping && base + kPrefetchAheadBytes > loopEnd) {
+            prefetch(loopStart, std::min(loopStart + (base + kPrefetchAheadBytes - loopEnd), loopEnd));
+        }
+
+        // 释放已经播放过的页面；向后跳转时从新位置重新计算，循环时保留整个循环区间
+        uint64_t releaseEnd = base > kKeepBehindBytes ? alignDown(dataDelta_ + base - kKeepBehindBytes) : 0;
+        if (loopEnd > loopStart) {
+            releaseEnd = std::min(releaseEnd, alignDown(dataDelta_ + loopStart));
+        }
+        if (releaseEnd < releasedEnd_) {
+            releasedEnd_ = releaseEnd;
+        } else if (releaseEnd > releasedEnd_) {
+            madvise(static_cast<uint8_t*>(mapBase_) + releasedEnd_, releaseEnd - releasedEnd_, MADV_DONTNEED);
+            releasedEnd_ = releaseEnd;
+        }
+    }
+}
+
+void MappedPcmSource::prefetch(uint64_t from, uint64_t to) {
+    if (from >= to) {
+        return;
+    }
+    // 映射内的页对齐范围
+    const size_t start = static_cast<size_t>(alignDown(dataDelta_ + from));
+    const size_t end = static_cast<size_t>(dataDelta_ + to);
+    auto* base = static_cast<uint8_t*>(mapBase_);
+    madvise(base + start, end - start, MADV_WILLNEED);
+
+    // WILLNEED只是异步预读，逐页读取一次确保页面已经映射，回调中不会再阻塞在缺页上
+    volatile uint8_t sink = 0;
+    for (size_t offset = start; offset < end; offset += pageSize_) {
+        sink = sink + base[offset];
+    }
+    (void)sink;
+}
@@ -0,0 +1,118 @@
+#ifndef MAPPED_PCM_SOURCE_H
+#define MAPPED_PCM_SOURCE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <semaphore.h>
+
+/**
+ * @brief 内存映射的PCM数据源
+ * 把文件中的音频数据区整体mmap，音频回调直接从映射中拷贝，没有生产者线程和中间缓冲区。
+ * 预取线程在读位置前方madvise(WILLNEED)并逐页触碰，保证回调访问的页面已经在内存中；
+ * 读位置之后的页面随播放释放，长文件不会持续占用内存。
+ * 读位置是映射内的字节偏移，进度和跳转只需读写这个位置。
+ * 设置循环区间后读到区间终点时在同一次读取内回到起点，循环是采样级无缝的。
+ */
+class MappedPcmSource {
+public:
+    MappedPcmSource();
+    ~MappedPcmSource();
+
+    MappedPcmSource(const MappedPcmSource&) = delete;
+    MappedPcmSource& operator=(const MappedPcmSource&) = delete;
+
+    /**
+     * @brief 映射文件的数据区并启动预取线程
+     * @param fd 文件描述符，映射建立后不再使用，调用方可以关闭
+     * @param dataOffset 数据区在文件中的偏移
+     * @param dataSize 数据区长度（字节）
+     * @param bytesPerFrame 每帧字节数，跳转位置按帧对齐
+     * @return 是否成功，32位进程映射超大文件等情况会失败
+     */
+    bool open(int fd, int64_t dataOffset, uint64_t dataSize, size_t bytesPerFrame);
+
+    /**
+     * @brief 停止预取线程并解除映射，调用前必须确保回调不再读取
+     */
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+
+    /**
+     * @brief 从读位置拷贝数据并前移（仅音频回调线程调用，实时安全）
+     * 有已就绪的跳转请求时先跳转再读
+     * @param seeked 输出参数，本次读取是否应用了跳转
+     * @return 实际拷贝的字节数，到达末尾时小于size
+     */
+    size_t read(void* dst, size_t size, bool* seeked = nullptr);
+
+    /**
+     * @brief 请求跳转到指定字节位置（任意线程调用）
+     * 预取线程把目标位置附近的页面读入内存后才交给回调，回调在此之前继续播放原位置
+     */
+    void seek(uint64_t position);
+
+    /**
+     * @brief 立即回到开头并同步准备开头的数据，丢弃未生效的跳转（仅在回调不读取时调用，如流停止后重新开始）
+     * 与seek不同，返回后第一次读取就从开头开始
+     */
+    void rewind();
+
+    /**
+     * @brief 设置循环区间[start, end)（任意线程调用），end <= start时取消循环
+     * 读位置已在终点之后时，下一次读取回到起点
+     */
+    void setLoop(uint64_t start, uint64_t end);
+
+    /**
+     * @brief 当前读位置（字节）
+     */
+    uint64_t position() const { return cursor_.load(std::memory_order_acquire); }
+
+    uint64_t size() const { return size_; }
+
+private:
+    static constexpr int64_t kNoSeek = -1;
+
+    void applyLoopRequest();
+    void startPrefetchThread();
+    void stopPrefetchThread();
+    void prefetchThreadFunc();
+    void prefetch(uint64_t from, uint64_t to);
+    uint64_t alignDown(uint64_t value) const { return value / pageSize_ * pageSize_; }
+
+    size_t pageSize_;
+    void* mapBase_;
+    size_t mapLength_;
+    const uint8_t* data_;   // 数据区起点，位于mapBase_之后
+    size_t dataDelta_;      // 数据区起点相对映射起点的偏移（映射必须页对齐）
+    uint64_t size_;
+    size_t bytesPerFrame_;
+
+    std::atomic<uint64_t> cursor_;
+    std::atomic<int64_t> requestedSeek_;   // 等待预取的跳转位置
+    std::atomic<int64_t> readySeek_;       // 已预取、等待回调应用的跳转位置
+
+    // 循环区间：写入端更新起止位置后递增序号，读取端用序号检查读到的起止位置是否一致
+    std::atomic<uint32_t> loopSerial_;
+    std::atomic<uint64_t> loopStartRequest_;
+    std::atomic<uint64_t> loopEndRequest_;
+
+    // 回调线程私有的循环区间，loopEnd_为0表示不循环
+    uint32_t loopSerialSeen_;
+    uint64_t loopStart_;
+    uint64_t loopEnd_;
+
+    // 预取线程私有状态：已触碰到的位置、已释放到的位置
+    uint64_t prefetchedEnd_;
+    uint64_t releasedEnd_;
+
+    sem_t wake_;
+    std::unique_ptr<std::thread> prefetchThread_;
+    std::atomic<bool> closing_;
+};
+
+#endif // MAPPED_PCM_SOURCE_H
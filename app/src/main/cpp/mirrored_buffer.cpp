@@ -0,0 +1,90 @@
+#include "mirrored_buffer.h"
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "logging.h"
+
+#define LOG_TAG "MirroredBuffer"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+// 旧版本bionic没有memfd_create的封装，直接走系统调用
+static int createMemFd(const char* name) {
+#ifdef __NR_memfd_create
+    return static_cast<int>(syscall(__NR_memfd_create, name, MFD_CLOEXEC));
+#else
+    (void)name;
+    return -1;
+#endif
+}
+
+MirroredBuffer::MirroredBuffer(size_t capacity, bool allowMirror)
+    : data_(nullptr)
+    , capacity_(0)
+    , mirrored_(false) {
+    if (allowMirror && mapMirrored(capacity)) {
+        mirrored_ = true;
+    } else {
+        capacity_ = capacity;
+        data_ = new uint8_t[capacity_];
+    }
+    // 预先触碰所有页，避免在音频回调中首次访问时产生缺页
+    memset(data_, 0, capacity_);
+}
+
+MirroredBuffer::~MirroredBuffer() {
+    if (mirrored_) {
+        munmap(data_, capacity_ * 2);
+    } else {
+        delete[] data_;
+    }
+}
+
+bool MirroredBuffer::mapMirrored(size_t capacity) {
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0 || capacity == 0) {
+        return false;
+    }
+    const size_t size = (capacity + pageSize - 1) / pageSize * pageSize;
+
+    int fd = createMemFd("mirrored_ring");
+    if (fd < 0) {
+        LOGW("memfd_create unavailable, fallback to linear buffer");
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // 先保留2倍大小的地址空间，再把同一个memfd固定映射到前后两半
+    void* reserved = mmap(nullptr, size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    auto* base = static_cast<uint8_t*>(reserved);
+    void* first = mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void* second = first == MAP_FAILED ? MAP_FAILED
+            : mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+    if (first == MAP_FAILED || second == MAP_FAILED) {
+        munmap(reserved, size * 2);
+        LOGW("double mapping failed, fallback to linear buffer");
+        return false;
+    }
+
+    // 校验两段映射确实指向同一物理页
+    base[0] = 0x5a;
+    if (base[size] != 0x5a) {
+        munmap(reserved, size * 2);
+        return false;
+    }
+
+    data_ = base;
+    capacity_ = size;
+    return true;
+}
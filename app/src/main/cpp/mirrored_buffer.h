@@ -0,0 +1,65 @@
+#ifndef MIRRORED_BUFFER_H
+#define MIRRORED_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 环形缓冲区的底层存储
+ * 优先将同一块memfd内存连续映射两次（[0, capacity)与[capacity, 2*capacity)指向相同物理页），
+ * 这样从任意位置开始、长度不超过capacity的区域在虚拟地址上都是连续的，读写无需拆分成两次memcpy，
+ * 也可以把缓冲区内存直接交给swr_convert、fwrite等接口。
+ * 不支持双重映射时（无memfd、mmap失败等）退化为普通的连续内存，调用方需自行处理环绕。
+ */
+class MirroredBuffer {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 期望容量（字节）。镜像模式下向上取整为页大小的整数倍
+     * @param allowMirror 是否尝试使用双重映射
+     */
+    explicit MirroredBuffer(size_t capacity, bool allowMirror = true);
+
+    /**
+     * @brief 析构函数
+     */
+    ~MirroredBuffer();
+
+    MirroredBuffer(const MirroredBuffer&) = delete;
+    MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+    /**
+     * @brief 缓冲区起始地址。镜像模式下[data(), data() + 2 * capacity())均可访问
+     */
+    uint8_t* data() const { return data_; }
+
+    /**
+     * @brief 实际容量（字节）
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief 是否为双重映射布局
+     */
+    bool isMirrored() const { return mirrored_; }
+
+    /**
+     * @brief 计算从offset开始、长度为size的区域中，可连续访问的字节数
+     * 镜像模式下总是等于size，普通模式下截断到缓冲区末尾
+     */
+    size_t contiguous(size_t offset, size_t size) const {
+        if (mirrored_ || offset + size <= capacity_) {
+            return size;
+        }
+        return capacity_ - offset;
+    }
+
+private:
+    bool mapMirrored(size_t capacity);
+
+    uint8_t* data_;
+    size_t capacity_;
+    bool mirrored_;
+};
+
+#endif // MIRRORED_BUFFER_H
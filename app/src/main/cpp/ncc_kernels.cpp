@@ -0,0 +1,260 @@
+#include "ncc_kernels.h"
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NCC_KERNELS_NEON 1
+#elif defined(__SSE__)
+#include <immintrin.h>
+#define NCC_KERNELS_SSE 1
+#if defined(__GNUC__) || defined(__clang__)
+#define NCC_KERNELS_AVX2 1
+#endif
+#endif
+
+namespace {
+
+using BlockKernel = NccSums (*)(const float* a, const float* b, size_t n);
+using EnergyKernel = float (*)(const float* a, size_t n);
+
+NccSums blockScalar(const float* a, const float* b, size_t n) {
+    NccSums sums;
+    for (size_t i = 0; i < n; ++i) {
+        sums.dot += a[i] * b[i];
+        sums.energyA += a[i] * a[i];
+        sums.energyB += b[i] * b[i];
+    }
+    return sums;
+}
+
+float energyScalar(const float* a, size_t n) {
+    float energy = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        energy += a[i] * a[i];
+    }
+    return energy;
+}
+
+// 以下内核处理一个块（不超过kNccBlock个样本），每个累加量两组寄存器、每次8个样本，尾部标量处理
+
+#if defined(NCC_KERNELS_NEON)
+NccSums blockNeon(const float* a, const float* b, size_t n) {
+    float32x4_t d0 = vdupq_n_f32(0.0f), d1 = vdupq_n_f32(0.0f);
+    float32x4_t ea0 = vdupq_n_f32(0.0f), ea1 = vdupq_n_f32(0.0f);
+    float32x4_t eb0 = vdupq_n_f32(0.0f), eb1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t a0 = vld1q_f32(a + i), a1 = vld1q_f32(a + i + 4);
+        const float32x4_t b0 = vld1q_f32(b + i), b1 = vld1q_f32(b + i + 4);
+        d0 = vmlaq_f32(d0, a0, b0);
+        d1 = vmlaq_f32(d1, a1, b1);
+        ea0 = vmlaq_f32(ea0, a0, a0);
+        ea1 = vmlaq_f32(ea1, a1, a1);
+        eb0 = vmlaq_f32(eb0, b0, b0);
+        eb1 = vmlaq_f32(eb1, b1, b1);
+    }
+    float lanes[4];
+    NccSums sums;
+    vst1q_f32(lanes, vaddq_f32(d0, d1));
+    sums.dot = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    vst1q_f32(lanes, vaddq_f32(ea0, ea1));
+    sums.energyA = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    vst1q_f32(lanes, vaddq_f32(eb0, eb1));
+    sums.energyB = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    const NccSums tail = blockScalar(a + i, b + i, n - i);
+    sums.dot += tail.dot;
+    sums.energyA += tail.energyA;
+    sums.energyB += tail.energyB;
+    return sums;
+}
+
+float energyNeon(const float* a, size_t n) {
+    float32x4_t e0 = vdupq_n_f32(0.0f), e1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t a0 = vld1q_f32(a + i), a1 = vld1q_f32(a + i + 4);
+        e0 = vmlaq_f32(e0, a0, a0);
+        e1 = vmlaq_f32(e1, a1, a1);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(e0, e1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + energyScalar(a + i, n - i);
+}
+#endif
+
+#if defined(NCC_KERNELS_SSE)
+float horizontalSum(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+NccSums blockSse(const float* a, const float* b, size_t n) {
+    __m128 d0 = _mm_setzero_ps(), d1 = _mm_setzero_ps();
+    __m128 ea0 = _mm_setzero_ps(), ea1 = _mm_setzero_ps();
+    __m128 eb0 = _mm_setzero_ps(), eb1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a0 = _mm_loadu_ps(a + i), a1 = _mm_loadu_ps(a + i + 4);
+        const __m128 b0 = _mm_loadu_ps(b + i), b1 = _mm_loadu_ps(b + i + 4);
+        d0 = _mm_add_ps(d0, _mm_mul_ps(a0, b0));
+        d1 = _mm_add_ps(d1, _mm_mul_ps(a1, b1));
+        ea0 = _mm_add_ps(ea0, _mm_mul_ps(a0, a0));
+        ea1 = _mm_add_ps(ea1, _mm_mul_ps(a1, a1));
+        eb0 = _mm_add_ps(eb0, _mm_mul_ps(b0, b0));
+        eb1 = _mm_add_ps(eb1, _mm_mul_ps(b1, b1));
+    }
+    NccSums sums;
+    sums.dot = horizontalSum(_mm_add_ps(d0, d1));
+    sums.energyA = horizontalSum(_mm_add_ps(ea0, ea1));
+    sums.energyB = horizontalSum(_mm_add_ps(eb0, eb1));
+    const NccSums tail = blockScalar(a + i, b + i, n - i);
+    sums.dot += tail.dot;
+    sums.energyA += tail.energyA;
+    sums.energyB += tail.energyB;
+    return sums;
+}
+
+float energySse(const float* a, size_t n) {
+    __m128 e0 = _mm_setzero_ps(), e1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a0 = _mm_loadu_ps(a + i), a1 = _mm_loadu_ps(a + i + 4);
+        e0 = _mm_add_ps(e0, _mm_mul_ps(a0, a0));
+        e1 = _mm_add_ps(e1, _mm_mul_ps(a1, a1));
+    }
+    return horizontalSum(_mm_add_ps(e0, e1)) + energyScalar(a + i, n - i);
+}
+#endif
+
+#if defined(NCC_KERNELS_AVX2)
+// 只给这个函数开启AVX2/FMA，其余代码仍按基线指令集编译，运行时确认CPU支持后才会调用
+__attribute__((target("avx2,fma")))
+NccSums blockAvx2(const float* a, const float* b, size_t n) {
+    __m256 d0 = _mm256_setzero_ps(), d1 = _mm256_setzero_ps();
+    __m256 ea0 = _mm256_setzero_ps(), ea1 = _mm256_setzero_ps();
+    __m256 eb0 = _mm256_setzero_ps(), eb1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 a0 = _mm256_loadu_ps(a + i), a1 = _mm256_loadu_ps(a + i + 8);
+        const __m256 b0 = _mm256_loadu_ps(b + i), b1 = _mm256_loadu_ps(b + i + 8);
+        d0 = _mm256_fmadd_ps(a0, b0, d0);
+        d1 = _mm256_fmadd_ps(a1, b1, d1);
+        ea0 = _mm256_fmadd_ps(a0, a0, ea0);
+        ea1 = _mm256_fmadd_ps(a1, a1, ea1);
+        eb0 = _mm256_fmadd_ps(b0, b0, eb0);
+        eb1 = _mm256_fmadd_ps(b1, b1, eb1);
+    }
+    alignas(32) float lanes[8];
+    NccSums sums;
+    _mm256_store_ps(lanes, _mm256_add_ps(d0, d1));
+    sums.dot = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    _mm256_store_ps(lanes, _mm256_add_ps(ea0, ea1));
+    sums.energyA = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    _mm256_store_ps(lanes, _mm256_add_ps(eb0, eb1));
+    sums.energyB = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    const NccSums tail = blockScalar(a + i, b + i, n - i);
+    sums.dot += tail.dot;
+    sums.energyA += tail.energyA;
+    sums.energyB += tail.energyB;
+    return sums;
+}
+
+__attribute__((target("avx2,fma")))
+float energyAvx2(const float* a, size_t n) {
+    __m256 e0 = _mm256_setzero_ps(), e1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 a0 = _mm256_loadu_ps(a + i), a1 = _mm256_loadu_ps(a + i + 8);
+        e0 = _mm256_fmadd_ps(a0, a0, e0);
+        e1 = _mm256_fmadd_ps(a1, a1, e1);
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(e0, e1));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])) +
+           energyScalar(a + i, n - i);
+}
+#endif
+
+struct KernelChoice {
+    BlockKernel kernel;
+    EnergyKernel energy;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#if defined(NCC_KERNELS_NEON)
+    // arm64-v8a和NDK默认的armeabi-v7a都保证有NEON，编译期即可确定
+    return {blockNeon, energyNeon, "neon"};
+#elif defined(NCC_KERNELS_SSE)
+#if defined(NCC_KERNELS_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {blockAvx2, energyAvx2, "avx2"};
+    }
+#endif
+    return {blockSse, energySse, "sse"};
+#else
+    return {blockScalar, energyScalar, "scalar"};
+#endif
+}
+
+const KernelChoice& kernelChoice() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+void addSums(NccSums& to, const NccSums& from) {
+    to.dot += from.dot;
+    to.energyA += from.energyA;
+    to.energyB += from.energyB;
+}
+
+void addSums(float& to, float from) {
+    to += from;
+}
+
+// 成对求和：栈中第k层保存2^k个块之和，新块入栈后与同层的结果逐层合并（与二进制计数进位相同）
+// block(offset, count) 计算一个块的累加量
+template <typename Sums, typename Block>
+Sums pairwiseSum(size_t n, Block block) {
+    Sums levels[64];
+    uint64_t occupied = 0;
+    for (size_t offset = 0; offset < n; offset += kNccBlock) {
+        const size_t count = n - offset < kNccBlock ? n - offset : kNccBlock;
+        Sums carry = block(offset, count);
+        int level = 0;
+        while (occupied & (uint64_t{1} << level)) {
+            addSums(carry, levels[level]);
+            occupied &= ~(uint64_t{1} << level);
+            ++level;
+        }
+        levels[level] = carry;
+        occupied |= uint64_t{1} << level;
+    }
+
+    // 剩余各层从小到大合并
+    Sums total{};
+    for (int level = 0; level < 64; ++level) {
+        if (occupied & (uint64_t{1} << level)) {
+            addSums(total, levels[level]);
+        }
+    }
+    return total;
+}
+
+} // namespace
+
+NccSums computeNccSums(const float* a, const float* b, size_t n) {
+    const BlockKernel kernel = kernelChoice().kernel;
+    return pairwiseSum<NccSums>(n, [&](size_t offset, size_t count) { return kernel(a + offset, b + offset, count); });
+}
+
+float computeEnergy(const float* a, size_t n) {
+    const EnergyKernel kernel = kernelChoice().energy;
+    return pairwiseSum<float>(n, [&](size_t offset, size_t count) { return kernel(a + offset, count); });
+}
+
+const char* nccKernelName() {
+    return kernelChoice().name;
+}
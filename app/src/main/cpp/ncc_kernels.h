@@ -0,0 +1,38 @@
+#ifndef NCC_KERNELS_H
+#define NCC_KERNELS_H
+
+#include <cstddef>
+
+// 单个块的样本数：块内float累加，块间成对求和
+constexpr size_t kNccBlock = 256;
+
+/**
+ * @brief 互相关的三个累加量
+ */
+struct NccSums {
+    float dot = 0.0f;      // sum(a[i] * b[i])
+    float energyA = 0.0f;  // sum(a[i]^2)
+    float energyB = 0.0f;  // sum(b[i]^2)
+};
+
+/**
+ * @brief 一次遍历float数据，同时计算点积和两路能量
+ * 每kNccBlock个样本在SIMD寄存器里用float累加，块结果再按二叉树两两相加（分块成对求和），
+ * 误差随长度对数增长，几万样本的窗口不需要double也能保持精度。
+ * 内核在首次调用时按CPU特性选择：x86上有AVX2+FMA时用AVX2，否则SSE；ARM上用NEON；其它平台为标量。
+ * 线程安全，可供任意互相关代码使用。
+ */
+NccSums computeNccSums(const float* a, const float* b, size_t n);
+
+/**
+ * @brief 只计算一路能量 sum(a[i]^2)，内核选择和分块成对求和与 computeNccSums 相同，
+ * 只读一路数据、只有一组累加，供能量扫描等不需要互相关的地方使用
+ */
+float computeEnergy(const float* a, size_t n);
+
+/**
+ * @brief 当前使用的内核名称（"avx2"、"sse"、"neon"或"scalar"），用于日志
+ */
+const char* nccKernelName();
+
+#endif // NCC_KERNELS_H
@@ -0,0 +1,603 @@
+#include "oboe_mixer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <android/log.h>
+#include "DecoderSource.h"
+#include "logging.h"
+#include "mapped_pcm_source.h"
+#include "polyphase_resampler.h"
+#include "rt_sanitizer.h"
+#include "wav_format.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OBOE_MIXER_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define OBOE_MIXER_SSE 1
+#endif
+
+#define LOG_TAG "OboeMixer"
+
+constexpr int32_t OboeMixer::kMaxTracks;
+constexpr size_t OboeMixer::kChunkFrames;
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void updatePeak(std::atomic<float>& target, float value) {
+    float current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// 以下内核把音轨累加到交错立体声输出上，返回累加量的峰值
+
+float mixStereo(float* out, const float* in, size_t frames, float left, float right) {
+    const size_t samples = frames * 2;
+    size_t i = 0;
+    float peak = 0.0f;
+#if defined(OBOE_MIXER_NEON)
+    const float gains[4] = {left, right, left, right};
+    const float32x4_t g = vld1q_f32(gains);
+    float32x4_t p0 = vdupq_n_f32(0.0f), p1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= samples; i += 8) {
+        const float32x4_t y0 = vmulq_f32(vld1q_f32(in + i), g);
+        const float32x4_t y1 = vmulq_f32(vld1q_f32(in + i + 4), g);
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i), y0));
+        vst1q_f32(out + i + 4, vaddq_f32(vld1q_f32(out + i + 4), y1));
+        p0 = vmaxq_f32(p0, vabsq_f32(y0));
+        p1 = vmaxq_f32(p1, vabsq_f32(y1));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vmaxq_f32(p0, p1));
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(OBOE_MIXER_SSE)
+    const __m128 g = _mm_setr_ps(left, right, left, right);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 p0 = _mm_setzero_ps(), p1 = _mm_setzero_ps();
+    for (; i + 8 <= samples; i += 8) {
+        const __m128 y0 = _mm_mul_ps(_mm_loadu_ps(in + i), g);
+        const __m128 y1 = _mm_mul_ps(_mm_loadu_ps(in + i + 4), g);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), y0));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(out + i + 4), y1));
+        p0 = _mm_max_ps(p0, _mm_andnot_ps(sign, y0));
+        p1 = _mm_max_ps(p1, _mm_andnot_ps(sign, y1));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_max_ps(p0, p1));
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < samples; i += 2) {
+        const float l = in[i] * left;
+        const float r = in[i + 1] * right;
+        out[i] += l;
+        out[i + 1] += r;
+        peak = std::max(peak, std::max(std::fabs(l), std::fabs(r)));
+    }
+    return peak;
+}
+
+float mixMono(float* out, const float* in, size_t frames, float left, float right) {
+    size_t i = 0;
+    float peak = 0.0f;
+#if defined(OBOE_MIXER_NEON)
+    const float gains[4] = {left, right, left, right};
+    const float32x4_t g = vld1q_f32(gains);
+    float32x4_t p0 = vdupq_n_f32(0.0f), p1 = vdupq_n_f32(0.0f);
+    for (; i + 4 <= frames; i += 4) {
+        // 每个单声道样本复制到左右两个位置
+        const float32x4x2_t x = vzipq_f32(vld1q_f32(in + i), vld1q_f32(in + i));
+        const float32x4_t y0 = vmulq_f32(x.val[0], g);
+        const float32x4_t y1 = vmulq_f32(x.val[1], g);
+        float* o = out + 2 * i;
+        vst1q_f32(o, vaddq_f32(vld1q_f32(o), y0));
+        vst1q_f32(o + 4, vaddq_f32(vld1q_f32(o + 4), y1));
+        p0 = vmaxq_f32(p0, vabsq_f32(y0));
+        p1 = vmaxq_f32(p1, vabsq_f32(y1));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vmaxq_f32(p0, p1));
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(OBOE_MIXER_SSE)
+    const __m128 g = _mm_setr_ps(left, right, left, right);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 p0 = _mm_setzero_ps(), p1 = _mm_setzero_ps();
+    for (; i + 4 <= frames; i += 4) {
+        const __m128 x = _mm_loadu_ps(in + i);
+        const __m128 y0 = _mm_mul_ps(_mm_unpacklo_ps(x, x), g);
+        const __m128 y1 = _mm_mul_ps(_mm_unpackhi_ps(x, x), g);
+        float* o = out + 2 * i;
+        _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), y0));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), y1));
+        p0 = _mm_max_ps(p0, _mm_andnot_ps(sign, y0));
+        p1 = _mm_max_ps(p1, _mm_andnot_ps(sign, y1));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_max_ps(p0, p1));
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < frames; ++i) {
+        const float l = in[i] * left;
+        const float r = in[i] * right;
+        out[2 * i] += l;
+        out[2 * i + 1] += r;
+        peak = std::max(peak, std::max(std::fabs(l), std::fabs(r)));
+    }
+    return peak;
+}
+
+// 参数改变的那一块：增益从from线性过渡到to
+float mixRamp(float* out, const float* in, size_t frames, int32_t channels,
+              float fromLeft, float fromRight, float toLeft, float toRight) {
+    float peak = 0.0f;
+    const float step = 1.0f / static_cast<float>(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        const float t = (i + 1) * step;
+        const float left = fromLeft + (toLeft - fromLeft) * t;
+        const float right = fromRight + (toRight - fromRight) * t;
+        const float inLeft = in[i * channels];
+        const float inRight = in[i * channels + channels - 1];
+        const float l = inLeft * left;
+        const float r = inRight * right;
+        out[2 * i] += l;
+        out[2 * i + 1] += r;
+        peak = std::max(peak, std::max(std::fabs(l), std::fabs(r)));
+    }
+    return peak;
+}
+
+// 总增益，原地缩放并返回峰值
+float applyMasterGain(float* data, size_t frames, float from, float to) {
+    const size_t samples = frames * 2;
+    float peak = 0.0f;
+    if (from != to) {
+        const float step = 1.0f / static_cast<float>(frames);
+        for (size_t i = 0; i < samples; ++i) {
+            data[i] *= from + (to - from) * ((i / 2 + 1) * step);
+            peak = std::max(peak, std::fabs(data[i]));
+        }
+        return peak;
+    }
+    size_t i = 0;
+#if defined(OBOE_MIXER_NEON)
+    const float32x4_t g = vdupq_n_f32(to);
+    float32x4_t p = vdupq_n_f32(0.0f);
+    for (; i + 4 <= samples; i += 4) {
+        const float32x4_t y = vmulq_f32(vld1q_f32(data + i), g);
+        vst1q_f32(data + i, y);
+        p = vmaxq_f32(p, vabsq_f32(y));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, p);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(OBOE_MIXER_SSE)
+    const __m128 g = _mm_set1_ps(to);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 p = _mm_setzero_ps();
+    for (; i + 4 <= samples; i += 4) {
+        const __m128 y = _mm_mul_ps(_mm_loadu_ps(data + i), g);
+        _mm_storeu_ps(data + i, y);
+        p = _mm_max_ps(p, _mm_andnot_ps(sign, y));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, p);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < samples; ++i) {
+        data[i] *= to;
+        peak = std::max(peak, std::fabs(data[i]));
+    }
+    return peak;
+}
+
+oboe::AudioApi toAudioApi(int32_t api) {
+    switch (api) {
+        case 1: return oboe::AudioApi::AAudio;
+        case 2: return oboe::AudioApi::OpenSLES;
+        default: return oboe::AudioApi::Unspecified;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief 一条音轨：数据源、可选的重采样器和回调暂存区
+ */
+struct OboeMixer::Track {
+    MappedPcmSource mapped;
+    std::unique_ptr<DecoderSource> decoder;
+    int32_t sampleRate = 0;
+    int32_t channelCount = 1;
+    bool isFloat = false;
+    size_t bytesPerFrame = 0;
+    std::unique_ptr<PolyphaseResampler> resampler;
+    std::vector<uint8_t> raw;      // 16位数据转换前的暂存
+    std::vector<float> samples;    // 本块的浮点数据，声道数同数据源
+
+    std::atomic<float> gain{1.0f};
+    std::atomic<float> pan{0.0f};
+    std::atomic<bool> muted{false};
+    std::atomic<float> peak{0.0f};
+
+    // 回调私有
+    float appliedLeft = 0.0f;
+    float appliedRight = 0.0f;
+    bool drained = false;
+    bool finished = false;
+
+    // 当前参数对应的左右增益：单声道按等功率声像，立体声按平衡
+    void targetGains(float& left, float& right) const {
+        if (muted.load(std::memory_order_relaxed)) {
+            left = right = 0.0f;
+            return;
+        }
+        const float g = gain.load(std::memory_order_relaxed);
+        const float p = pan.load(std::memory_order_relaxed);
+        if (channelCount == 1) {
+            const float angle = (p + 1.0f) * static_cast<float>(M_PI) / 4.0f;
+            left = g * std::cos(angle);
+            right = g * std::sin(angle);
+        } else {
+            left = g * std::min(1.0f, 1.0f - p);
+            right = g * std::min(1.0f, 1.0f + p);
+        }
+    }
+
+    // 从数据源读取并转换为浮点，frames不超过kChunkFrames
+    size_t readFloat(float* dst, size_t frames) {
+        void* target = isFloat ? static_cast<void*>(dst) : static_cast<void*>(raw.data());
+        size_t bytes;
+        if (decoder) {
+            bytes = decoder->read(target, frames * bytesPerFrame);
+            drained = bytes == 0 && decoder->finished();
+        } else {
+            bytes = mapped.read(target, frames * bytesPerFrame);
+            drained = bytes == 0;
+        }
+        const size_t count = bytes / bytesPerFrame;
+        if (!isFloat) {
+            const auto* pcm = reinterpret_cast<const int16_t*>(raw.data());
+            for (size_t i = 0; i < count * channelCount; ++i) {
+                dst[i] = pcm[i] * (1.0f / 32768.0f);
+            }
+        }
+        return count;
+    }
+
+    // 生成本块的数据到samples，返回帧数；数据源读完且没有剩余时标记结束
+    size_t render(size_t frames) {
+        size_t produced;
+        if (resampler) {
+            produced = resampler->render(samples.data(), frames, [this](void* dst, size_t maxFrames) {
+                return readFloat(static_cast<float*>(dst), maxFrames);
+            });
+        } else {
+            produced = 0;
+            while (produced < frames) {
+                const size_t count = readFloat(samples.data() + produced * channelCount, frames - produced);
+                if (count == 0) {
+                    break;
+                }
+                produced += count;
+            }
+        }
+        finished = drained && produced < frames;
+        return produced;
+    }
+};
+
+OboeMixer::OboeMixer(int32_t audioApi, int32_t deviceId)
+    : audioApi_(audioApi)
+    , deviceId_(deviceId > 0 ? deviceId : oboe::kUnspecified)
+    , masterGain_(1.0f)
+    , appliedMasterGain_(1.0f)
+    , masterPeak_(0.0f)
+    , finished_(false)
+    , callCount_(0)
+    , totalNanos_(0)
+    , maxNanos_(0)
+    , maxLoadPermille_(0)
+    , activeTrackCalls_(0)
+    , outputNanos_(0) {
+}
+
+OboeMixer::~OboeMixer() {
+    stop();
+    for (auto& track : tracks_) {
+        track->mapped.close();
+    }
+}
+
+int32_t OboeMixer::addTrack(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat) {
+    if (stream_) {
+        LOGW("tracks can only be added while stopped");
+        return -1;
+    }
+    if (static_cast<int32_t>(tracks_.size()) >= kMaxTracks) {
+        LOGW("too many tracks, max %d", kMaxTracks);
+        return -1;
+    }
+
+    auto track = std::make_unique<Track>();
+    track->sampleRate = sampleRate;
+    track->channelCount = isStereo ? 2 : 1;
+    track->isFloat = isFloat;
+    if (DecoderSource::isCompressedFile(filePath)) {
+        track->decoder = std::make_unique<DecoderSource>();
+        if (!track->decoder->open(filePath)) {
+            LOGE("Failed to open decoder: %s", filePath);
+            return -1;
+        }
+        // 解码输出为浮点交错数据，采样率与文件一致
+        track->sampleRate = track->decoder->sampleRate();
+        track->channelCount = track->decoder->channelCount();
+        track->isFloat = true;
+    } else {
+        std::unique_ptr<FILE, decltype(&fclose)> file(fopen(filePath, "rb"), fclose);
+        if (!file) {
+            LOGE("Failed to open file: %s", filePath);
+            return -1;
+        }
+        int64_t dataOffset = 0;
+        int64_t headerDataSize = -1;
+        WavInfo wavInfo;
+        if (parseWavHeader(file.get(), wavInfo)) {
+            // WAV文件以文件头中的格式为准
+            track->sampleRate = wavInfo.format.sampleRate;
+            track->channelCount = wavInfo.format.channelCount;
+            track->isFloat = wavInfo.format.isFloat;
+            dataOffset = wavInfo.dataOffset;
+            headerDataSize = wavInfo.dataSize;
+        }
+        if (track->channelCount > 2) {
+            LOGE("unsupported channel count %d: %s", track->channelCount, filePath);
+            return -1;
+        }
+        const size_t frameBytes = static_cast<size_t>(track->channelCount) * (track->isFloat ? 4 : 2);
+        const uint64_t dataSize = audioDataSize(file.get(), dataOffset, headerDataSize);
+        if (!track->mapped.open(fileno(file.get()), dataOffset, dataSize, frameBytes)) {
+            LOGE("Failed to map file: %s", filePath);
+            return -1;
+        }
+    }
+    track->bytesPerFrame = static_cast<size_t>(track->channelCount) * (track->isFloat ? 4 : 2);
+    track->raw.resize(kChunkFrames * track->bytesPerFrame);
+    track->samples.resize(kChunkFrames * track->channelCount);
+
+    LOGI("track #%zu: rate=%d channels=%d float=%d %s", tracks_.size(), track->sampleRate, track->channelCount,
+         track->isFloat, filePath);
+    tracks_.push_back(std::move(track));
+    return static_cast<int32_t>(tracks_.size()) - 1;
+}
+
+bool OboeMixer::start() {
+    if (stream_ && finished_.load(std::memory_order_acquire)) {
+        // 上次播放完后回调已停止，先关闭旧流再从头开始
+        stop();
+    }
+    if (stream_ || tracks_.empty()) {
+        return false;
+    }
+
+    // 按设备原生采样率打开，各音轨自行重采样
+    oboe::AudioStreamBuilder builder;
+    builder.setDirection(oboe::Direction::Output)
+            ->setDeviceId(deviceId_)
+            ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
+            ->setSharingMode(oboe::SharingMode::Exclusive)
+            ->setFormat(oboe::AudioFormat::Float)
+            ->setSampleRateConversionQuality(oboe::SampleRateConversionQuality::None)
+            ->setChannelCount(2)
+            ->setCallback(this)
+            ->setAudioApi(toAudioApi(audioApi_));
+    oboe::Result result = builder.openStream(stream_);
+    if (result != oboe::Result::OK) {
+        LOGE("Failed to open stream. Error: %s", oboe::convertToText(result));
+        stream_.reset();
+        return false;
+    }
+
+    // 每次启动都从头播放：数据源回到开头，重采样器和回调私有状态清零，统计只覆盖本次播放
+    const int32_t deviceRate = stream_->getSampleRate();
+    for (auto& track : tracks_) {
+        if (track->sampleRate == deviceRate) {
+            track->resampler.reset();
+        } else if (track->resampler && track->resampler->outputRate() == deviceRate) {
+            track->resampler->reset();
+        } else {
+            track->resampler = std::make_unique<PolyphaseResampler>(track->sampleRate, deviceRate,
+                                                                     track->channelCount, true);
+        }
+        track->targetGains(track->appliedLeft, track->appliedRight);
+        track->drained = false;
+        track->finished = false;
+        track->peak.store(0.0f);
+        if (track->decoder) {
+            track->decoder->start();
+        } else {
+            track->mapped.rewind();
+        }
+    }
+    appliedMasterGain_ = masterGain_.load();
+    masterPeak_.store(0.0f);
+    finished_ = false;
+    callCount_.store(0);
+    totalNanos_.store(0);
+    maxNanos_.store(0);
+    maxLoadPermille_.store(0);
+    activeTrackCalls_.store(0);
+    outputNanos_.store(0);
+    LOGI("mixing %zu tracks at %d Hz", tracks_.size(), deviceRate);
+
+    result = stream_->requestStart();
+    if (result != oboe::Result::OK) {
+        LOGE("Failed to start stream. Error: %s", oboe::convertToText(result));
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void OboeMixer::stop() {
+    if (!stream_) {
+        return;
+    }
+    // 先关闭流，确保回调不再访问音轨
+    stream_->stop();
+    stream_->close();
+    stream_.reset();
+    for (auto& track : tracks_) {
+        if (track->decoder) {
+            track->decoder->stop();
+        }
+    }
+
+    const MixerStats stats = getStats();
+    LOGI("mixer %d tracks: calls=%lld avg=%.1fus max=%.1fus maxLoad=%.1f%% perTrack=%.2fus (%.2f%%)",
+         stats.trackCount, static_cast<long long>(stats.callCount), stats.avgMicros, stats.maxMicros,
+         stats.maxLoadPercent, stats.avgMicrosPerTrack, stats.loadPercentPerTrack);
+    RT_SANITIZER_REPORT();
+}
+
+void OboeMixer::setTrackGain(int32_t track, float gain) {
+    if (track >= 0 && track < trackCount()) {
+        tracks_[track]->gain.store(std::max(0.0f, gain), std::memory_order_relaxed);
+    }
+}
+
+void OboeMixer::setTrackPan(int32_t track, float pan) {
+    if (track >= 0 && track < trackCount()) {
+        tracks_[track]->pan.store(std::max(-1.0f, std::min(pan, 1.0f)), std::memory_order_relaxed);
+    }
+}
+
+void OboeMixer::setTrackMute(int32_t track, bool muted) {
+    if (track >= 0 && track < trackCount()) {
+        tracks_[track]->muted.store(muted, std::memory_order_relaxed);
+    }
+}
+
+void OboeMixer::setMasterGain(float gain) {
+    masterGain_.store(std::max(0.0f, gain), std::memory_order_relaxed);
+}
+
+float OboeMixer::readPeaks(float* trackPeaks) {
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        trackPeaks[i] = tracks_[i]->peak.exchange(0.0f, std::memory_order_relaxed);
+    }
+    return masterPeak_.exchange(0.0f, std::memory_order_relaxed);
+}
+
+oboe::DataCallbackResult OboeMixer::onAudioReady(
+        oboe::AudioStream* audioStream,
+        void* audioData,
+        int32_t numFrames) {
+    RT_CALLBACK_SCOPE("OboeMixer::onAudioReady");
+    const int64_t begin = nowNanos();
+
+    int32_t activeTracks = 0;
+    for (const auto& track : tracks_) {
+        activeTracks += track->finished ? 0 : 1;
+    }
+
+    auto* out = static_cast<float*>(audioData);
+    for (size_t offset = 0; offset < static_cast<size_t>(numFrames); offset += kChunkFrames) {
+        const size_t frames = std::min(kChunkFrames, static_cast<size_t>(numFrames) - offset);
+        float* dst = out + offset * 2;
+        memset(dst, 0, frames * 2 * sizeof(float));
+
+        for (auto& track : tracks_) {
+            if (track->finished) {
+                continue;
+            }
+            // 静音的音轨照常读取，保持与其它音轨同步
+            const size_t produced = track->render(frames);
+            float left, right;
+            track->targetGains(left, right);
+            if (produced == 0 || (left == 0.0f && right == 0.0f && track->appliedLeft == 0.0f &&
+                                  track->appliedRight == 0.0f)) {
+                track->appliedLeft = left;
+                track->appliedRight = right;
+                continue;
+            }
+            float peak;
+            if (left != track->appliedLeft || right != track->appliedRight) {
+                peak = mixRamp(dst, track->samples.data(), produced, track->channelCount,
+                               track->appliedLeft, track->appliedRight, left, right);
+                track->appliedLeft = left;
+                track->appliedRight = right;
+            } else if (track->channelCount == 2) {
+                peak = mixStereo(dst, track->samples.data(), produced, left, right);
+            } else {
+                peak = mixMono(dst, track->samples.data(), produced, left, right);
+            }
+            updatePeak(track->peak, peak);
+        }
+
+        const float masterGain = masterGain_.load(std::memory_order_relaxed);
+        updatePeak(masterPeak_, applyMasterGain(dst, frames, appliedMasterGain_, masterGain));
+        appliedMasterGain_ = masterGain;
+    }
+
+    recordCost(nowNanos() - begin, numFrames, audioStream->getSampleRate(), activeTracks);
+
+    const bool allFinished = std::all_of(tracks_.begin(), tracks_.end(),
+            [](const std::unique_ptr<Track>& track) { return track->finished; });
+    if (allFinished) {
+        finished_.store(true, std::memory_order_release);
+        return oboe::DataCallbackResult::Stop;
+    }
+    return oboe::DataCallbackResult::Continue;
+}
+
+void OboeMixer::onErrorAfterClose(oboe::AudioStream*, oboe::Result result) {
+    LOGE("onErrorAfterClose %s", oboe::convertToText(result));
+}
+
+void OboeMixer::recordCost(int64_t nanos, int32_t numFrames, int32_t sampleRate, int32_t activeTracks) {
+    callCount_.fetch_add(1, std::memory_order_relaxed);
+    totalNanos_.fetch_add(nanos, std::memory_order_relaxed);
+    activeTrackCalls_.fetch_add(activeTracks, std::memory_order_relaxed);
+    int64_t maxNanos = maxNanos_.load(std::memory_order_relaxed);
+    while (nanos > maxNanos && !maxNanos_.compare_exchange_weak(maxNanos, nanos, std::memory_order_relaxed)) {
+    }
+    if (sampleRate > 0 && numFrames > 0) {
+        const int64_t budgetNanos = static_cast<int64_t>(numFrames) * 1000000000LL / sampleRate;
+        outputNanos_.fetch_add(budgetNanos, std::memory_order_relaxed);
+        const auto permille = static_cast<int32_t>(nanos * 1000 / std::max<int64_t>(1, budgetNanos));
+        int32_t current = maxLoadPermille_.load(std::memory_order_relaxed);
+        while (permille > current &&
+               !maxLoadPermille_.compare_exchange_weak(current, permille, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+MixerStats OboeMixer::getStats() const {
+    MixerStats stats;
+    stats.trackCount = trackCount();
+    stats.callCount = callCount_.load(std::memory_order_relaxed);
+    const int64_t totalNanos = totalNanos_.load(std::memory_order_relaxed);
+    const int64_t trackCalls = activeTrackCalls_.load(std::memory_order_relaxed);
+    const int64_t outputNanos = outputNanos_.load(std::memory_order_relaxed);
+    if (stats.callCount > 0) {
+        stats.avgMicros = totalNanos / 1000.0 / stats.callCount;
+    }
+    stats.maxMicros = maxNanos_.load(std::memory_order_relaxed) / 1000.0;
+    stats.maxLoadPercent = maxLoadPermille_.load(std::memory_order_relaxed) / 10.0;
+    if (trackCalls > 0) {
+        stats.avgMicrosPerTrack = totalNanos / 1000.0 / trackCalls;
+        if (outputNanos > 0) {
+            // 总占用按平均参与音轨数摊开
+            const double avgTracks = static_cast<double>(trackCalls) / stats.callCount;
+            stats.loadPercentPerTrack = 100.0 * totalNanos / outputNanos / avgTracks;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,112 @@
+#ifndef OBOE_MIXER_H
+#define OBOE_MIXER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <oboe/Oboe.h>
+
+/**
+ * @brief 混音耗时统计
+ */
+struct MixerStats {
+    int32_t trackCount = 0;
+    int64_t callCount = 0;           // 回调次数
+    double avgMicros = 0;            // 每次回调的平均耗时（读取、重采样和混音）
+    double maxMicros = 0;
+    double maxLoadPercent = 0;       // 回调耗时占本次输出时长的最大比例
+    double avgMicrosPerTrack = 0;    // 按参与混音的音轨数平均
+    double loadPercentPerTrack = 0;  // 每条音轨平均占用的回调预算
+};
+
+/**
+ * @brief 多音轨混音播放器
+ * 在一个Oboe输出流上同时播放最多kMaxTracks条音轨，用于一起试听多个录音（如近场和远场麦克风）。
+ * PCM/WAV音轨通过内存映射读取，压缩格式由FFmpeg在后台线程解码；采样率与设备不同的音轨各自重采样。
+ * 每条音轨有增益、声像和静音，参数改变时在一次回调内线性过渡，没有拉链噪声；
+ * 参数不变时按立体声/单声道分别用NEON/SSE内核累加，同时得到音轨峰值，最后乘总增益得到总峰值。
+ * 流以浮点立体声、设备原生采样率打开，所有缓冲区在启动前分配，回调中不分配内存、不加锁。
+ */
+class OboeMixer : public oboe::AudioStreamCallback {
+public:
+    static constexpr int32_t kMaxTracks = 32;
+
+    /**
+     * @param audioApi 音频API类型
+     * @param deviceId 输出设备，oboe::kUnspecified为默认设备
+     */
+    OboeMixer(int32_t audioApi, int32_t deviceId);
+
+    ~OboeMixer() override;
+
+    /**
+     * @brief 添加音轨（仅停止时调用）
+     * WAV和压缩格式以文件本身的格式为准，裸PCM按参数解释
+     * @return 音轨序号，失败返回-1
+     */
+    int32_t addTrack(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat);
+
+    /**
+     * @brief 打开流并开始播放，所有音轨从头开始
+     * 播放完或stop()之后可以再次调用，重新从头播放
+     */
+    bool start();
+
+    void stop();
+
+    // 音轨参数（任意线程调用），下一次回调生效
+    void setTrackGain(int32_t track, float gain);
+    void setTrackPan(int32_t track, float pan);  // -1为最左，1为最右
+    void setTrackMute(int32_t track, bool muted);
+    void setMasterGain(float gain);
+
+    int32_t trackCount() const { return static_cast<int32_t>(tracks_.size()); }
+
+    /**
+     * @brief 读取并清零上次读取以来的峰值（任意线程调用）
+     * @param trackPeaks 输出每条音轨的峰值（增益和声像之后），至少trackCount()个
+     * @return 总输出的峰值，超过1表示削波
+     */
+    float readPeaks(float* trackPeaks);
+
+    /**
+     * @brief 所有音轨都已播放完
+     */
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+
+    MixerStats getStats() const;
+
+    oboe::DataCallbackResult onAudioReady(
+            oboe::AudioStream* audioStream,
+            void* audioData,
+            int32_t numFrames) override;
+
+    void onErrorAfterClose(oboe::AudioStream*, oboe::Result) override;
+
+private:
+    struct Track;
+
+    // 回调中按块处理，每条音轨的暂存区按块长分配
+    static constexpr size_t kChunkFrames = 512;
+
+    void recordCost(int64_t nanos, int32_t numFrames, int32_t sampleRate, int32_t activeTracks);
+
+    const int32_t audioApi_;
+    const int32_t deviceId_;
+    std::shared_ptr<oboe::AudioStream> stream_;
+    std::vector<std::unique_ptr<Track>> tracks_;
+    std::atomic<float> masterGain_;
+    float appliedMasterGain_;  // 回调私有
+    std::atomic<float> masterPeak_;
+    std::atomic<bool> finished_;
+
+    // 耗时统计（回调写，其它线程读）
+    std::atomic<int64_t> callCount_;
+    std::atomic<int64_t> totalNanos_;
+    std::atomic<int64_t> maxNanos_;
+    std::atomic<int32_t> maxLoadPermille_;
+    std::atomic<int64_t> activeTrackCalls_;  // 每次回调参与混音的音轨数之和
+    std::atomic<int64_t> outputNanos_;       // 输出的总时长
+};
+
+#endif // OBOE_MIXER_H
@@ -0,0 +1,134 @@
+#include <jni.h>
+#include "oboe_mixer.h"
+#include "logging.h"
+
+#define LOG_TAG "OboeMixerJNI"
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeCreate(
+        JNIEnv* env, jobject thiz, jint audioApi, jint deviceId) {
+    return reinterpret_cast<jlong>(new OboeMixer(audioApi, deviceId));
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeRelease(
+        JNIEnv* env, jobject thiz, jlong nativeMixer) {
+    delete reinterpret_cast<OboeMixer*>(nativeMixer);
+}
+
+// 添加音轨，返回序号，失败返回-1
+JNIEXPORT jint JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeAddTrack(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jstring filePath, jint sampleRate,
+        jboolean isStereo, jboolean isFloat) {
+
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (!mixer) {
+        return -1;
+    }
+    const char* path = env->GetStringUTFChars(filePath, nullptr);
+    if (!path) {
+        LOGE("Failed to get file path");
+        return -1;
+    }
+    const int32_t track = mixer->addTrack(path, sampleRate, isStereo, isFloat);
+    env->ReleaseStringUTFChars(filePath, path);
+    return track;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeStart(
+        JNIEnv* env, jobject thiz, jlong nativeMixer) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    return mixer && mixer->start() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeStop(
+        JNIEnv* env, jobject thiz, jlong nativeMixer) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (mixer) {
+        mixer->stop();
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeSetTrackGain(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jint track, jfloat gain) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (mixer) {
+        mixer->setTrackGain(track, gain);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeSetTrackPan(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jint track, jfloat pan) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (mixer) {
+        mixer->setTrackPan(track, pan);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeSetTrackMute(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jint track, jboolean muted) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (mixer) {
+        mixer->setTrackMute(track, muted);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeSetMasterGain(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jfloat gain) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (mixer) {
+        mixer->setMasterGain(gain);
+    }
+}
+
+// 读取并清零峰值：out[0]为总输出，out[1 + i]为第i条音轨
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeReadPeaks(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jfloatArray out) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (!mixer || !out || env->GetArrayLength(out) < mixer->trackCount() + 1) {
+        return;
+    }
+    jfloat values[OboeMixer::kMaxTracks + 1];
+    values[0] = mixer->readPeaks(values + 1);
+    env->SetFloatArrayRegion(out, 0, mixer->trackCount() + 1, values);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeIsFinished(
+        JNIEnv* env, jobject thiz, jlong nativeMixer) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    return mixer && mixer->isFinished() ? JNI_TRUE : JNI_FALSE;
+}
+
+// 获取耗时统计：{音轨数, 回调次数, 平均耗时, 最大耗时, 最大占用, 每音轨平均耗时, 每音轨占用}，耗时单位为微秒，占用为百分比
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboeMixer_nativeGetStats(
+        JNIEnv* env, jobject thiz, jlong nativeMixer, jdoubleArray out) {
+    auto* mixer = reinterpret_cast<OboeMixer*>(nativeMixer);
+    if (!mixer || !out || env->GetArrayLength(out) < 7) {
+        return;
+    }
+    const MixerStats stats = mixer->getStats();
+    const jdouble values[7] = {
+            static_cast<jdouble>(stats.trackCount),
+            static_cast<jdouble>(stats.callCount),
+            stats.avgMicros,
+            stats.maxMicros,
+            stats.maxLoadPercent,
+            stats.avgMicrosPerTrack,
+            stats.loadPercentPerTrack
+    };
+    env->SetDoubleArrayRegion(out, 0, 7, values);
+}
+
+} // extern "C"
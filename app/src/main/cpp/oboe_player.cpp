@@ -1,8 +1,13 @@
 #include "oboe_player.h"
-#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <android/log.h>
 #include <jni.h>
 #include "logging.h"
+#include "rt_sanitizer.h"
+#include "wav_format.h"
 
 #define LOG_TAG "OboePlayerNative"
 
@@ -14,6 +19,17 @@ extern jobject recorderViewModel;
 
 // 定义静态成员变量
 constexpr size_t OboePlayer::BUFFER_CAPACITY;
+constexpr size_t OboePlayer::MIN_PREFETCH_BLOCK;
+constexpr size_t OboePlayer::MAX_PREFETCH_BLOCK;
+
+// 播放列表的关闭标记：回调读完最后一项时写入next，此后加入的项不会被播放。
+// 只用于比较、从不解引用，取一个不可能是有效对象地址的值，不必构造一个真正的PlaylistItem
+static PlaylistItem* const playlistClosed = reinterpret_cast<PlaylistItem*>(uintptr_t{1});
+
+static int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 // 通用的JNI线程安全执行方法
 template<typename F>
@@ -51,27 +67,99 @@ static void executeInJniThread(F&& callback) {
     }
 }
 
-OboePlayer::OboePlayer(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat, int32_t audioApi, int32_t deviceId)
+OboePlayer::OboePlayer(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat, int32_t audioApi, int32_t deviceId,
+                       bool useMmap, size_t bufferCapacity)
     : file_(fopen(filePath, "rb"), fclose)
     , isFloat(isFloat)
     , sampleRate(sampleRate)
     , isStereo(isStereo)
     , samplesPerFrame(isStereo ? 2 : 1)
     , audioApi(audioApi)
-    , ringBuffer_(std::make_unique<ThreadSafeRingBuffer>(BUFFER_CAPACITY))
-    , isRunning_(false)
-    , onPlaybackCompleteMethodId_(nullptr)
-    , callbackObject_(nullptr)
     , totalBytes_(0)
+    , dataOffset_(0)
+    , headerDataSize_(-1)
     , playbackProgress_(0.0f)
     , framesPlayed_(0)
-    , totalFrames_(0) {
-    
+    , totalFrames_(0)
+    , useMmap_(useMmap)
+    , currentItem_(nullptr)
+    , currentIndex_(0)
+    , ringBuffer_(std::make_unique<ThreadSafeRingBuffer>(
+            std::max(bufferCapacity > 0 ? bufferCapacity : BUFFER_CAPACITY, 2 * MAX_PREFETCH_BLOCK)))
+    // 高水位留出一个最小读取块的空间；低水位为一半，两者之间生产者不被唤醒
+    , lowWatermark_(ringBuffer_->capacity() / 2)
+    , highWatermark_(ringBuffer_->capacity() - MIN_PREFETCH_BLOCK)
+    , isRunning_(false)
+    , endOfData_(false)
+    , producerSleeping_(false)
+    , producerWritten_(0)
+    , consumerRead_(0)
+    , flushUntil_(0)
+    , flushFrame_(0)
+    , flushSeq_(0)
+    , flushSeen_(0)
+    , flushApplied_(false)
+    , pendingSeekFrame_(-1)
+    , loopStartFrame_(0)
+    , loopEndFrame_(0)
+    , loopChanged_(false)
+    , seekRequestNanos_(0)
+    , seekCount_(0)
+    , seekLatencySumNanos_(0)
+    , lastSeekLatencyNanos_(0)
+    , maxSeekLatencyNanos_(0)
+    , minFillBytes_(SIZE_MAX)
+    , fillSumBytes_(0)
+    , fillSamples_(0)
+    , underrunCount_(0)
+    , producerWakeCount_(0)
+    , prefetchReads_(0)
+    , prefetchBytes_(0)
+    , prefetchNanos_(0)
+    , playbackSpeed_(1.0f)
+    , sourceDrained_(false)
+    , streamFramesWritten_(0)
+    , completedItems_(0)
+    , playbackEnded_(false)
+    , endReported_(false)
+    , eventClosing_(false)
+    , onPlaybackCompleteMethodId_(nullptr)
+    , callbackObject_(nullptr) {
+    sem_init(&producerWake_, 0, 0);
+    sem_init(&eventWake_, 0, 0);
+
     if (!file_) {
         LOGD("Failed to open file: %s", filePath);
         return;
     }
 
+    WavInfo wavInfo;
+    if (parseWavHeader(file_.get(), wavInfo)) {
+        // WAV文件以文件头中的格式为准
+        this->sampleRate = wavInfo.format.sampleRate;
+        this->isFloat = wavInfo.format.isFloat;
+        this->isStereo = wavInfo.format.channelCount == 2;
+        samplesPerFrame = wavInfo.format.channelCount;
+        dataOffset_ = wavInfo.dataOffset;
+        headerDataSize_ = wavInfo.dataSize;
+        LOGI("wav file: rate=%d channels=%d float=%d dataOffset=%lld dataSize=%lld%s",
+             this->sampleRate, samplesPerFrame, this->isFloat, static_cast<long long>(dataOffset_),
+             static_cast<long long>(headerDataSize_), wavInfo.isRf64 ? " (RF64)" : "");
+    } else if (DecoderSource::isCompressedFile(filePath)) {
+        decoderSource_ = std::make_unique<DecoderSource>();
+        if (decoderSource_->open(filePath)) {
+            // 解码输出为浮点交错数据，采样率与文件一致
+            this->sampleRate = decoderSource_->sampleRate();
+            this->isFloat = true;
+            this->isStereo = decoderSource_->channelCount() == 2;
+            samplesPerFrame = decoderSource_->channelCount();
+        } else {
+            LOGE("Failed to open decoder: %s", filePath);
+            decoderSource_.reset();
+            file_.reset();
+        }
+    }
+
     bytesRead_ = 0;
     if (deviceId > 0) {
         this->deviceId = deviceId;
@@ -87,26 +175,117 @@ OboePlayer::~OboePlayer() {
             env->DeleteGlobalRef(callbackObject_);
         });
     }
+    sem_destroy(&producerWake_);
+    sem_destroy(&eventWake_);
 }
 
 void OboePlayer::producerThreadFunc() {
-    const size_t bytesPerSample = isFloat ? 4 : 2;
-    const size_t bytesPerFrame = bytesPerSample * samplesPerFrame * 8;
-    std::vector<uint8_t> buffer(bytesPerFrame);
+    const size_t frameBytes = bytesPerFrame();
+    // 循环区间（字节），loopEnd为0表示不循环
+    size_t loopStart = 0;
+    size_t loopEnd = 0;
+    // 跳转后新位置的第一块数据写入缓冲区后才通知回调丢弃旧数据，在此之前回调继续播放已缓冲的数据
+    bool flushPending = false;
+    int64_t flushFrame = 0;
+    uint64_t flushStart = 0;  // 新位置数据在缓冲区中的起点（累计写入字节数）
+    auto publishFlush = [&]() {
+        flushFrame_.store(flushFrame, std::memory_order_relaxed);
+        flushUntil_.store(flushStart, std::memory_order_relaxed);
+        flushSeq_.fetch_add(1, std::memory_order_release);
+        flushPending = false;
+    };
 
     while (isRunning_) {
-        size_t bytesRead = fread(buffer.data(), 1, buffer.size(), file_.get());
+        if (loopChanged_.exchange(false, std::memory_order_acq_rel)) {
+            const int64_t startFrame = loopStartFrame_.load(std::memory_order_relaxed);
+            const int64_t endFrame = std::min(loopEndFrame_.load(std::memory_order_relaxed), totalFrames_);
+            loopStart = endFrame > startFrame ? static_cast<size_t>(startFrame) * frameBytes : 0;
+            loopEnd = endFrame > startFrame ? static_cast<size_t>(endFrame) * frameBytes : 0;
+            // 已经缓冲了终点之后的数据，从当前播放位置重新读取
+            int64_t noSeek = -1;
+            if (loopEnd > 0 && bytesRead_ > loopEnd) {
+                pendingSeekFrame_.compare_exchange_strong(noSeek, framesPlayed_.load());
+            }
+        }
+
+        const int64_t seekFrame = pendingSeekFrame_.exchange(-1, std::memory_order_acq_rel);
+        if (seekFrame >= 0) {
+            size_t target = std::min(static_cast<size_t>(seekFrame) * frameBytes, totalBytes_ - totalBytes_ % frameBytes);
+            if (loopEnd > 0 && target >= loopEnd) {
+                target = loopStart;
+            }
+            fseeko(file_.get(), static_cast<off_t>(dataOffset_ + target), SEEK_SET);
+            bytesRead_ = target;
+            endOfData_ = false;
+            // 此前写入的数据全部作废，读入新位置的第一块后由回调丢弃
+            flushPending = true;
+            flushFrame = static_cast<int64_t>(target / frameBytes);
+            flushStart = producerWritten_;
+        }
+
+        if (loopEnd > 0 && bytesRead_ >= loopEnd) {
+            // 循环：回到起点继续读，数据在缓冲区中首尾相接
+            fseeko(file_.get(), static_cast<off_t>(dataOffset_ + loopStart), SEEK_SET);
+            bytesRead_ = loopStart;
+        }
+        // 不读入数据块之后的内容（WAV文件尾部可能还有其它块）
+        const size_t limit = loopEnd > 0 ? loopEnd : totalBytes_;
+        if (bytesRead_ >= limit) {
+            // 跳转到末尾时没有新数据可读，直接丢弃旧数据
+            if (flushPending) {
+                publishFlush();
+            }
+            // 读到末尾后等待跳转、设置循环或停止
+            if (!endOfData_) {
+                LOGI("file read finished");
+                endOfData_ = true;
+            }
+            if (sem_wait(&producerWake_) != 0 && errno == EINTR) {
+                continue;
+            }
+            continue;
+        }
+
+        // 等待跳转的数据时不受高水位限制：高水位之上总留有一个最小读取块的空间
+        const size_t fill = ringBuffer_->size();
+        if (fill >= highWatermark_ && !flushPending) {
+            // 达到高水位后休眠，先标记再复查，回调在此之间取走数据时不会漏掉唤醒
+            producerSleeping_.store(true);
+            if (ringBuffer_->size() >= lowWatermark_ && pendingSeekFrame_.load() < 0 && !loopChanged_.load()) {
+                sem_wait(&producerWake_);
+            }
+            producerSleeping_.store(false);
+            continue;
+        }
+
+        // 按缺口大小读取大块：缺得越多一次读得越多，按帧对齐
+        // 跳转后先读一个最小块，尽快让回调切换到新位置
+        const size_t deficit = highWatermark_ - std::min(fill, highWatermark_);
+        const size_t block = (flushPending ? MIN_PREFETCH_BLOCK
+                                           : std::min(std::max(deficit, MIN_PREFETCH_BLOCK), MAX_PREFETCH_BLOCK))
+                             / frameBytes * frameBytes;
+
+        // 直接读入环形缓冲区的空闲区域，省去中间缓冲区
+        RingBufferSpans spans = ringBuffer_->peekWritable();
+        const size_t toRead = std::min({block, spans.firstSize, limit - bytesRead_});
+        const auto readBegin = std::chrono::steady_clock::now();
+        size_t bytesRead = fread(spans.first, 1, toRead, file_.get());
+        prefetchNanos_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - readBegin).count(), std::memory_order_relaxed);
         if (bytesRead > 0) {
             bytesRead_ += bytesRead;
-            if (!ringBuffer_->write(buffer.data(), bytesRead)) {
-                // 写入失败，可能是被release了
-                isRunning_ = false;
-                break;
+            ringBuffer_->commitWrite(bytesRead);
+            producerWritten_ += bytesRead;
+            prefetchReads_.fetch_add(1, std::memory_order_relaxed);
+            prefetchBytes_.fetch_add(bytesRead, std::memory_order_relaxed);
+            if (flushPending) {
+                publishFlush();
             }
         } else {
-            LOGI("file read finished");
-            isRunning_ = false;
-            break;
+            // 读取失败，按数据末尾处理
+            LOGW("file read failed at %zu", bytesRead_);
+            totalBytes_ = bytesRead_;
+            loopEnd = 0;
         }
     }
 }
@@ -120,6 +299,35 @@ void OboePlayer::notifyPlaybackComplete() {
     }
 }
 
+void OboePlayer::notifyItemComplete(int32_t index) {
+    if (onItemCompleteMethodId_ && callbackObject_) {
+        executeInJniThread([this, index](JNIEnv* env) {
+            LOGI("notifyItemComplete %d", index);
+            env->CallVoidMethod(callbackObject_, onItemCompleteMethodId_, static_cast<jint>(index));
+        });
+    }
+}
+
+void OboePlayer::eventThreadFunc() {
+    int32_t notified = 0;
+    while (true) {
+        if (sem_wait(&eventWake_) != 0 && errno == EINTR) {
+            continue;
+        }
+        if (eventClosing_) {
+            break;
+        }
+        // 每一项读完时依次通知，最后一项之后通知播放完成
+        const int32_t completed = completedItems_.load(std::memory_order_acquire);
+        for (; notified < completed; ++notified) {
+            notifyItemComplete(notified);
+        }
+        if (playbackEnded_.exchange(false)) {
+            notifyPlaybackComplete();
+        }
+    }
+}
+
 float OboePlayer::getPlaybackProgress() const {
     return playbackProgress_.load();
 }
@@ -128,40 +336,387 @@ oboe::DataCallbackResult OboePlayer::onAudioReady(
         oboe::AudioStream *audioStream,
         void *audioData,
         int32_t numFrames) {
+    RT_CALLBACK_SCOPE("OboePlayer::onAudioReady");
+
+    // 数据源经变速器输出，速度为1时变速器原样拷贝
+    stretcher_->setSpeed(playbackSpeed_.load(std::memory_order_relaxed));
+    sourceDrained_ = false;
+    auto stretched = [this, audioStream](void* dst, size_t maxFrames) {
+        return stretcher_->render(dst, maxFrames,
+                [this, audioStream](void* src, size_t sourceFrames, bool& discontinuity) {
+                    return readSource(audioStream, src, sourceFrames, discontinuity);
+                });
+    };
+    // 流按设备原生采样率打开，文件采样率不同时在变速之后重采样
+    const size_t frames = resampler_
+            ? resampler_->render(audioData, static_cast<size_t>(numFrames), stretched)
+            : stretched(audioData, static_cast<size_t>(numFrames));
+
+    if (frames == 0 && sourceDrained_) {
+        // 数据源已读完，变速器中也没有剩余数据，播放完成，由事件线程通知Java层。
+        // 流不停止而是继续输出静音，之后的跳转或循环设置仍能让数据源重新产出数据
+        if (!endReported_) {
+            endReported_ = true;
+            playbackProgress_.store(1.0f);
+            // 跳转回来再次播完时当前项已计过数
+            if (completedItems_.load(std::memory_order_relaxed) <= currentIndex_.load(std::memory_order_relaxed)) {
+                completedItems_.fetch_add(1, std::memory_order_release);
+            }
+            playbackEnded_ = true;
+            sem_post(&eventWake_);
+        }
+    } else if (frames > 0) {
+        endReported_ = false;
+    }
+    if (frames < static_cast<size_t>(numFrames)) {
+        // 数据暂时不足或到达文件末尾，补静音
+        const size_t frameBytes = bytesPerFrame();
+        memset(static_cast<uint8_t*>(audioData) + frames * frameBytes, 0, (numFrames - frames) * frameBytes);
+    }
+    publishPresentation(audioStream, numFrames);
+    return oboe::DataCallbackResult::Continue;
+}
 
-    const size_t bytesPerSample = isFloat ? 4 : 2;
-    const size_t bytesPerFrame = bytesPerSample * samplesPerFrame;
-    const size_t bytesToRead = numFrames * bytesPerFrame;
+void OboePlayer::publishPresentation(oboe::AudioStream* audioStream, int32_t numFrames) {
+    streamFramesWritten_ += numFrames;
 
-    std::vector<uint8_t> buffer(bytesToRead);
-    if (!ringBuffer_->read(buffer.data(), bytesToRead)) {
-        // 没有数据可读，且生产者线程已经结束，说明播放完成
-        if (!isRunning_) {
-            playbackProgress_.store(1.0f);  // 播放完成时设置进度为1.0
-            notifyPlaybackComplete();
-            return oboe::DataCallbackResult::Stop;
+    PresentationClock::Update update{};
+    int64_t readPosition;
+    if (currentItem_) {
+        readPosition = static_cast<int64_t>(currentItem_->source.position() / bytesPerFrame());
+        update.itemIndex = currentItem_->index;
+        update.totalFrames = currentItem_->totalFrames;
+    } else {
+        readPosition = decoderSource_ ? decoderSource_->position() : framesPlayed_.load(std::memory_order_relaxed);
+        update.itemIndex = 0;
+        update.totalFrames = totalFrames_;
+    }
+    // 数据源的读取位置减去变速器和重采样器中还没有输出的数据，就是下一个写入流的帧对应的位置
+    const double speed = stretcher_->speed();
+    double pending = static_cast<double>(stretcher_->pendingInputFrames());
+    update.sourcePerStream = speed;
+    update.sampleRate = audioStream->getSampleRate();
+    if (resampler_) {
+        pending += resampler_->pendingInputFrames() * speed;
+        update.sourcePerStream = speed * sampleRate / update.sampleRate;
+    }
+    update.streamFrame = streamFramesWritten_;
+    update.sourceFrame = readPosition - static_cast<int64_t>(pending);
+
+    update.callbackNanos = nowNanos();
+    const oboe::ResultWithValue<oboe::FrameTimestamp> timestamp = audioStream->getTimestamp(CLOCK_MONOTONIC);
+    update.timestampValid = static_cast<bool>(timestamp);
+    if (update.timestampValid) {
+        update.anchorFrame = timestamp.value().position;
+        update.anchorNanos = timestamp.value().timestamp;
+    } else {
+        // 流刚启动或API不支持时间戳：假定缓冲区中的数据都排在播出位置之前
+        update.anchorFrame = streamFramesWritten_ - audioStream->getBufferSizeInFrames();
+        update.anchorNanos = update.callbackNanos;
+    }
+    presentationClock_.publish(update);
+}
+
+PresentationPosition OboePlayer::getPresentationPosition() const {
+    return presentationClock_.read(nowNanos());
+}
+
+size_t OboePlayer::readSource(oboe::AudioStream* audioStream, void* dst, size_t maxFrames, bool& discontinuity) {
+    const size_t frameBytes = bytesPerFrame();
+
+    if (currentItem_) {
+        // 直接从映射中拷贝，页面已由预取线程准备好
+        const size_t bytesWanted = maxFrames * frameBytes;
+        auto* out = static_cast<uint8_t*>(dst);
+        bool seeked = false;
+        size_t bytesCopied = currentItem_->source.read(out, bytesWanted, &seeked);
+        // 当前项读完，在同一次读取内接上下一项，两项之间采样连续
+        while (bytesCopied < bytesWanted && advancePlaylist()) {
+            bool nextSeeked = false;
+            bytesCopied += currentItem_->source.read(out + bytesCopied, bytesWanted - bytesCopied, &nextSeeked);
+            seeked = seeked || nextSeeked;
         }
-        return oboe::DataCallbackResult::Continue;
+        if (seeked) {
+            discontinuity = true;
+            recordSeekLatency(audioStream);
+        }
+        sourceDrained_ = bytesCopied == 0;
+        playbackProgress_.store(static_cast<float>(currentItem_->source.position()) / currentItem_->source.size());
+        return bytesCopied / frameBytes;
+    }
+
+    if (decoderSource_) {
+        bool seeked = false;
+        const size_t bytesCopied = decoderSource_->read(dst, maxFrames * frameBytes, &seeked);
+        if (seeked) {
+            discontinuity = true;
+            recordSeekLatency(audioStream);
+        }
+        sourceDrained_ = bytesCopied == 0 && decoderSource_->finished();
+        if (totalFrames_ > 0) {
+            playbackProgress_.store(std::min(1.0f, static_cast<float>(decoderSource_->position()) / totalFrames_));
+        }
+        return bytesCopied / frameBytes;
+    }
+
+    // 跳转：丢弃生产者在跳转前写入的旧数据，新位置的第一块数据此时已在缓冲区中。
+    // 生产者先提交数据再发布序号，上一次回调可能已经接着旧数据取走了部分新数据，此时只校正进度
+    const uint32_t flushSeq = flushSeq_.load(std::memory_order_acquire);
+    if (flushSeq != flushSeen_) {
+        flushSeen_ = flushSeq;
+        const uint64_t flushUntil = flushUntil_.load(std::memory_order_relaxed);
+        const int64_t flushFrame = flushFrame_.load(std::memory_order_relaxed);
+        if (flushUntil > consumerRead_) {
+            ringBuffer_->commitRead(static_cast<size_t>(flushUntil - consumerRead_));
+            consumerRead_ = flushUntil;
+            framesPlayed_.store(flushFrame);
+        } else {
+            framesPlayed_.store(flushFrame + static_cast<int64_t>((consumerRead_ - flushUntil) / frameBytes));
+        }
+        flushApplied_ = true;
+        discontinuity = true;
+    }
+
+    // 先读取生产者状态再查看可读数据：若生产者已读完，此时缓冲区中即为全部剩余数据
+    const bool dataEnded = endOfData_;
+    RingBufferSpans spans = ringBuffer_->peekReadable();
+    const size_t readable = spans.total();
+    const size_t bytesWanted = maxFrames * frameBytes;
+
+    // 填充率和欠载统计，只有回调写入
+    if (readable < minFillBytes_.load(std::memory_order_relaxed)) {
+        minFillBytes_.store(readable, std::memory_order_relaxed);
+    }
+    fillSumBytes_.fetch_add(readable, std::memory_order_relaxed);
+    fillSamples_.fetch_add(1, std::memory_order_relaxed);
+    // 刚跳转时新位置的数据可能还不满一次回调，不计为欠载
+    if (readable < bytesWanted && !dataEnded && !flushApplied_) {
+        underrunCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 本次取走后低于低水位时唤醒休眠的生产者，每次休眠只唤醒一次；跳转丢弃旧数据后也在这里唤醒
+    if (readable - std::min(readable, bytesWanted) < lowWatermark_ && producerSleeping_.exchange(false)) {
+        producerWakeCount_.fetch_add(1, std::memory_order_relaxed);
+        sem_post(&producerWake_);
+    }
+
+    if (readable == 0) {
+        sourceDrained_ = dataEnded;
+        return 0;
     }
 
-    // 更新播放进度
+    // 直接从环形缓冲区拷贝，只取整帧
+    const size_t bytesToCopy = std::min(readable, bytesWanted) / frameBytes * frameBytes;
+    auto* out = static_cast<uint8_t*>(dst);
+    const size_t firstPart = std::min(bytesToCopy, spans.firstSize);
+    memcpy(out, spans.first, firstPart);
+    if (bytesToCopy > firstPart) {
+        memcpy(out + firstPart, spans.second, bytesToCopy - firstPart);
+    }
+    ringBuffer_->commitRead(bytesToCopy);
+    consumerRead_ += bytesToCopy;
+    if (flushApplied_ && bytesToCopy > 0) {
+        flushApplied_ = false;
+        recordSeekLatency(audioStream);
+    }
+
+    // 更新播放进度，循环时折回循环区间内
+    const size_t framesCopied = bytesToCopy / frameBytes;
     if (totalFrames_ > 0) {
-        framesPlayed_ += numFrames;
-        float progress = static_cast<float>(framesPlayed_.load()) / totalFrames_;
+        int64_t played = framesPlayed_.load() + static_cast<int64_t>(framesCopied);
+        const int64_t loopStart = loopStartFrame_.load(std::memory_order_relaxed);
+        const int64_t loopEnd = loopEndFrame_.load(std::memory_order_relaxed);
+        if (loopEnd > loopStart && played >= loopEnd) {
+            played = loopStart + (played - loopEnd) % (loopEnd - loopStart);
+        }
+        framesPlayed_.store(played);
+        float progress = static_cast<float>(played) / totalFrames_;
         playbackProgress_.store(progress);
     }
+    return framesCopied;
+}
+
+bool OboePlayer::advancePlaylist() {
+    PlaylistItem* next = currentItem_->next.load(std::memory_order_acquire);
+    if (!next && currentItem_->next.compare_exchange_strong(next, playlistClosed, std::memory_order_acq_rel)) {
+        // 没有下一项，关闭播放列表；与控制线程的链接竞争时以CAS的结果为准
+        return false;
+    }
+    if (next == playlistClosed) {
+        return false;
+    }
+    currentItem_ = next;
+    currentIndex_.store(next->index, std::memory_order_release);
+    completedItems_.fetch_add(1, std::memory_order_release);
+    sem_post(&eventWake_);
+    return true;
+}
+
+PlaylistItem* OboePlayer::activeItem() {
+    // 调用方持有playlistMutex_，回调已经离开的项只会在此锁下释放
+    const int32_t index = currentIndex_.load(std::memory_order_acquire);
+    for (auto& item : playlist_) {
+        if (item->index == index) {
+            return item.get();
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<PlaylistItem> OboePlayer::openItem(FILE* file, int64_t dataOffset, uint64_t dataSize, int32_t index) {
+    auto item = std::make_unique<PlaylistItem>();
+    if (!item->source.open(fileno(file), dataOffset, dataSize, bytesPerFrame())) {
+        return nullptr;
+    }
+    item->index = index;
+    item->totalFrames = static_cast<int64_t>(dataSize / bytesPerFrame());
+    return item;
+}
+
+bool OboePlayer::enqueue(const char* filePath) {
+    std::lock_guard<std::mutex> lock(playlistMutex_);
+    if (playlist_.empty()) {
+        LOGW("enqueue requires memory-mapped playback");
+        return false;
+    }
+
+    std::unique_ptr<FILE, decltype(&fclose)> file(fopen(filePath, "rb"), fclose);
+    if (!file) {
+        LOGW("Failed to open file: %s", filePath);
+        return false;
+    }
+    // 接续播放不重新打开流，格式必须与流一致；裸PCM按当前格式播放
+    int64_t dataOffset = 0;
+    int64_t headerDataSize = -1;
+    WavInfo wavInfo;
+    if (parseWavHeader(file.get(), wavInfo)) {
+        if (wavInfo.format.sampleRate != sampleRate || wavInfo.format.channelCount != samplesPerFrame ||
+            wavInfo.format.isFloat != isFloat) {
+            LOGW("enqueue format mismatch: rate=%d channels=%d float=%d", wavInfo.format.sampleRate,
+                 wavInfo.format.channelCount, wavInfo.format.isFloat);
+            return false;
+        }
+        dataOffset = wavInfo.dataOffset;
+        headerDataSize = wavInfo.dataSize;
+    } else if (DecoderSource::isCompressedFile(filePath)) {
+        LOGW("enqueue supports PCM/WAV only: %s", filePath);
+        return false;
+    }
+    const uint64_t dataSize = audioDataSize(file.get(), dataOffset, headerDataSize);
+    auto item = openItem(file.get(), dataOffset, dataSize, playlist_.back()->index + 1);
+    if (!item) {
+        LOGW("Failed to map file: %s", filePath);
+        return false;
+    }
+
+    PlaylistItem* expected = nullptr;
+    if (!playlist_.back()->next.compare_exchange_strong(expected, item.get(), std::memory_order_acq_rel)) {
+        LOGI("playback already finished, enqueue rejected");
+        return false;
+    }
+    LOGI("enqueued #%d: %s", item->index, filePath);
+    playlist_.push_back(std::move(item));
+
+    // 释放已经播放完的项
+    const int32_t current = currentIndex_.load(std::memory_order_acquire);
+    while (playlist_.front()->index < current) {
+        playlist_.pop_front();
+    }
+    return true;
+}
+
+void OboePlayer::recordSeekLatency(oboe::AudioStream* audioStream) {
+    const int64_t requested = seekRequestNanos_.exchange(0, std::memory_order_relaxed);
+    if (requested == 0) {
+        return;
+    }
+    // 本次写入的数据排在流缓冲区中已有数据之后
+    const int64_t outputNanos = static_cast<int64_t>(audioStream->getBufferSizeInFrames()) * 1000000000LL /
+            audioStream->getSampleRate();
+    const int64_t latency = nowNanos() - requested + outputNanos;
+    lastSeekLatencyNanos_.store(latency, std::memory_order_relaxed);
+    seekLatencySumNanos_.fetch_add(latency, std::memory_order_relaxed);
+    seekCount_.fetch_add(1, std::memory_order_relaxed);
+    int64_t maxLatency = maxSeekLatencyNanos_.load(std::memory_order_relaxed);
+    while (latency > maxLatency && !maxSeekLatencyNanos_.compare_exchange_weak(maxLatency, latency)) {
+    }
+}
+
+void OboePlayer::seekToFrame(int64_t frame) {
+    std::lock_guard<std::mutex> lock(playlistMutex_);
+    PlaylistItem* item = activeItem();
+    frame = std::max<int64_t>(0, std::min(frame, item ? item->totalFrames : totalFrames_));
+    seekRequestNanos_.store(nowNanos(), std::memory_order_relaxed);
+    if (item) {
+        item->source.seek(static_cast<uint64_t>(frame) * bytesPerFrame());
+    } else if (decoderSource_) {
+        decoderSource_->seek(frame);
+    } else if (producerThread_) {
+        pendingSeekFrame_.store(frame, std::memory_order_release);
+        sem_post(&producerWake_);
+    }
+}
 
-    if (isFloat) {
-        auto* floatData = static_cast<float*>(audioData);
-        const auto* floatBuffer = reinterpret_cast<const float*>(buffer.data());
-        std::copy(floatBuffer, floatBuffer + numFrames * samplesPerFrame, floatData);
+void OboePlayer::setLoop(int64_t startFrame, int64_t endFrame) {
+    if (endFrame <= startFrame) {
+        startFrame = 0;
+        endFrame = 0;
+    }
+    loopStartFrame_.store(startFrame, std::memory_order_relaxed);
+    loopEndFrame_.store(endFrame, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(playlistMutex_);
+    if (PlaylistItem* item = activeItem()) {
+        item->source.setLoop(static_cast<uint64_t>(startFrame) * bytesPerFrame(),
+                             static_cast<uint64_t>(endFrame) * bytesPerFrame());
+    } else if (decoderSource_) {
+        decoderSource_->setLoop(startFrame, endFrame);
     } else {
-        auto* shortData = static_cast<int16_t*>(audioData);
-        const auto* shortBuffer = reinterpret_cast<const int16_t*>(buffer.data());
-        std::copy(shortBuffer, shortBuffer + numFrames * samplesPerFrame, shortData);
+        loopChanged_.store(true, std::memory_order_release);
+        sem_post(&producerWake_);
     }
+}
 
-    return oboe::DataCallbackResult::Continue;
+void OboePlayer::setPlaybackSpeed(float speed) {
+    playbackSpeed_.store(std::max(WsolaTimeStretcher::kMinSpeed, std::min(speed, WsolaTimeStretcher::kMaxSpeed)),
+                         std::memory_order_relaxed);
+}
+
+int64_t OboePlayer::getTotalFrames() {
+    std::lock_guard<std::mutex> lock(playlistMutex_);
+    PlaylistItem* item = activeItem();
+    return item ? item->totalFrames : totalFrames_;
+}
+
+SeekStats OboePlayer::getSeekStats() const {
+    SeekStats stats;
+    stats.seekCount = seekCount_.load(std::memory_order_relaxed);
+    stats.lastLatencyMs = lastSeekLatencyNanos_.load(std::memory_order_relaxed) / 1e6;
+    stats.maxLatencyMs = maxSeekLatencyNanos_.load(std::memory_order_relaxed) / 1e6;
+    if (stats.seekCount > 0) {
+        stats.avgLatencyMs = seekLatencySumNanos_.load(std::memory_order_relaxed) / 1e6 / stats.seekCount;
+    }
+    return stats;
+}
+
+PrefetchStats OboePlayer::getPrefetchStats() const {
+    PrefetchStats stats;
+    stats.capacityBytes = ringBuffer_->capacity();
+    const int64_t samples = fillSamples_.load(std::memory_order_relaxed);
+    if (samples > 0) {
+        stats.minFillPercent = 100.0 * minFillBytes_.load(std::memory_order_relaxed) / stats.capacityBytes;
+        stats.avgFillPercent = 100.0 * fillSumBytes_.load(std::memory_order_relaxed) / samples / stats.capacityBytes;
+    }
+    stats.underrunCount = underrunCount_.load(std::memory_order_relaxed);
+    stats.wakeCount = producerWakeCount_.load(std::memory_order_relaxed);
+    stats.readCount = prefetchReads_.load(std::memory_order_relaxed);
+    const uint64_t bytes = prefetchBytes_.load(std::memory_order_relaxed);
+    const int64_t nanos = prefetchNanos_.load(std::memory_order_relaxed);
+    if (stats.readCount > 0) {
+        stats.avgReadKB = bytes / 1024.0 / stats.readCount;
+    }
+    if (nanos > 0) {
+        stats.throughputMBps = bytes / (1024.0 * 1024.0) / (nanos / 1e9);
+    }
+    return stats;
 }
 
 bool OboePlayer::start() {
@@ -170,21 +725,75 @@ bool OboePlayer::start() {
         return false;
     }
 
-    // 获取文件总大小和总帧数
-    fseek(file_.get(), 0, SEEK_END);
-    totalBytes_ = ftell(file_.get());
-    fseek(file_.get(), 0, SEEK_SET);
     bytesRead_ = 0;
     framesPlayed_.store(0);
+    streamFramesWritten_ = 0;
+    presentationClock_.reset();
+    minFillBytes_.store(SIZE_MAX);
+    fillSumBytes_.store(0);
+    fillSamples_.store(0);
+    underrunCount_.store(0);
+    producerWakeCount_.store(0);
+    prefetchReads_.store(0);
+    prefetchBytes_.store(0);
+    prefetchNanos_.store(0);
     playbackProgress_.store(0.0f);
 
-    // 计算总帧数
+    // 计算总帧数；压缩格式按容器记录的时长估计
     const size_t bytesPerSample = isFloat ? 4 : 2;
     const size_t bytesPerFrame = bytesPerSample * samplesPerFrame;
-    totalFrames_ = totalBytes_ / bytesPerFrame;
+    if (decoderSource_) {
+        totalBytes_ = 0;
+        totalFrames_ = decoderSource_->totalFrames();
+    } else {
+        totalBytes_ = static_cast<size_t>(audioDataSize(file_.get(), dataOffset_, headerDataSize_));
+        totalFrames_ = totalBytes_ / bytesPerFrame;
+    }
 
-    isRunning_ = true;
-    producerThread_ = std::make_unique<std::thread>(&OboePlayer::producerThreadFunc, this);
+    // 缓冲区按采样率和声道数预先分配，回调中改变速度不分配内存
+    if (!stretcher_) {
+        stretcher_ = std::make_unique<WsolaTimeStretcher>(sampleRate, samplesPerFrame, isFloat);
+    }
+    stretcher_->reset();
+
+    currentIndex_.store(0);
+    completedItems_.store(0);
+    playbackEnded_ = false;
+    endReported_ = false;
+    std::unique_ptr<PlaylistItem> firstItem =
+            useMmap_ && !decoderSource_ ? openItem(file_.get(), dataOffset_, totalBytes_, 0) : nullptr;
+    if (decoderSource_) {
+        LOGI("streaming through decoder");
+        // 启动前设置的循环区间
+        decoderSource_->setLoop(loopStartFrame_.load(), loopEndFrame_.load());
+        decoderSource_->start();
+    } else if (firstItem) {
+        LOGI("playing from memory mapping");
+        // 启动前设置的循环区间
+        firstItem->source.setLoop(static_cast<uint64_t>(loopStartFrame_.load()) * bytesPerFrame,
+                                  static_cast<uint64_t>(loopEndFrame_.load()) * bytesPerFrame);
+        currentItem_ = firstItem.get();
+        std::lock_guard<std::mutex> lock(playlistMutex_);
+        playlist_.push_back(std::move(firstItem));
+    } else {
+        if (useMmap_) {
+            LOGW("mmap unavailable, fallback to buffered playback");
+        }
+        endOfData_ = false;
+        producerSleeping_.store(false);
+        producerWritten_ = 0;
+        consumerRead_ = 0;
+        flushUntil_.store(0);
+        flushSeq_.store(0);
+        flushSeen_ = 0;
+        flushApplied_ = false;
+        pendingSeekFrame_.store(-1);
+        loopChanged_.store(true);
+        isRunning_ = true;
+        producerThread_ = std::make_unique<std::thread>(&OboePlayer::producerThreadFunc, this);
+    }
+    eventClosing_ = false;
+    eventThread_ = std::make_unique<std::thread>(&OboePlayer::eventThreadFunc, this);
 
     return startOboeStream();
 }
@@ -197,7 +806,7 @@ bool OboePlayer::startOboeStream() {
             ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
             ->setSharingMode(oboe::SharingMode::Exclusive)
             ->setFormat(isFloat ? oboe::AudioFormat::Float : oboe::AudioFormat::I16)
-            ->setSampleRate(sampleRate)
+            ->setSampleRateConversionQuality(oboe::SampleRateConversionQuality::None)
             ->setChannelCount(isStereo ? 2 : 1)
             ->setCallback(this)
             ->setAudioApi(getAudioApi(audioApi));
@@ -208,6 +817,18 @@ bool OboePlayer::startOboeStream() {
         return false;
     }
 
+    // 不指定采样率，流按设备原生采样率打开，避免系统重采样和非快速路径；与文件不一致时自行转换
+    const int32_t deviceRate = stream_->getSampleRate();
+    if (deviceRate != sampleRate) {
+        if (!resampler_ || resampler_->outputRate() != deviceRate) {
+            resampler_ = std::make_unique<PolyphaseResampler>(sampleRate, deviceRate, samplesPerFrame, isFloat);
+        }
+        resampler_->reset();
+        LOGI("resampling %d -> %d", sampleRate, deviceRate);
+    } else {
+        resampler_.reset();
+    }
+
     result = stream_->requestStart();
     if (result != oboe::Result::OK) {
         LOGE("Failed to start stream. Error: %s", oboe::convertToText(result));
@@ -217,18 +838,44 @@ bool OboePlayer::startOboeStream() {
 }
 
 void OboePlayer::stop() {
+    // 先关闭流，确保回调不再访问映射和缓冲区
+    if (stream_) {
+        stream_->stop();
+        stream_->close();
+        stream_.reset();
+    }
+
     if (producerThread_ && producerThread_->joinable()) {
         isRunning_ = false;
-        ringBuffer_->release();  // 通知阻塞的写入操作退出
+        sem_post(&producerWake_);  // 唤醒读到末尾后等待的生产者
         producerThread_->join();
         producerThread_.reset();
     }
 
-    if (stream_) {
-        stream_->stop();
-        stream_->close();
-        stream_.reset();
+    if (decoderSource_) {
+        decoderSource_->stop();
+    }
+
+    if (resampler_) {
+        const ResamplerStats stats = resampler_->getStats();
+        LOGI("resampler %d -> %d: calls=%lld avg=%.1fus max=%.1fus maxLoad=%.1f%%", resampler_->inputRate(),
+             resampler_->outputRate(), static_cast<long long>(stats.callCount), stats.avgMicros, stats.maxMicros,
+             stats.maxLoadPercent);
+    }
+
+    if (eventThread_ && eventThread_->joinable()) {
+        eventClosing_ = true;
+        sem_post(&eventWake_);
+        eventThread_->join();
+        eventThread_.reset();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(playlistMutex_);
+        playlist_.clear();
+        currentItem_ = nullptr;
     }
+    RT_SANITIZER_REPORT();
 }
 
 oboe::AudioApi OboePlayer::getAudioApi(int32_t api) {
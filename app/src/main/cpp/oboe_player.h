@@ -1,30 +1,80 @@
 #ifndef OBOE_PLAYER_H
 #define OBOE_PLAYER_H
 
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
 #include <jni.h>
+#include <semaphore.h>
 #include <oboe/Oboe.h>
+#include "DecoderSource.h"
+#include "mapped_pcm_source.h"
+#include "polyphase_resampler.h"
+#include "presentation_clock.h"
 #include "thread_safe_ring_buffer.h"
+#include "time_stretcher.h"
+
+/**
+ * @brief 跳转统计
+ */
+struct SeekStats {
+    int32_t seekCount = 0;       // 已生效的跳转次数
+    double lastLatencyMs = 0;    // 最近一次从请求跳转到新位置的声音被听到的估计时间
+    double avgLatencyMs = 0;
+    double maxLatencyMs = 0;
+};
+
+/**
+ * @brief 缓冲模式的预读统计，用于按设备数据确定缓冲区大小
+ */
+struct PrefetchStats {
+    size_t capacityBytes = 0;     // 缓冲区容量
+    double minFillPercent = 0;    // 回调取数据前缓冲区的最低填充率
+    double avgFillPercent = 0;    // 回调取数据前缓冲区的平均填充率
+    int32_t underrunCount = 0;    // 回调需要的数据未能全部给出的次数（不含文件末尾和跳转后的第一次回调）
+    int32_t wakeCount = 0;        // 低于低水位唤醒生产者的次数
+    int64_t readCount = 0;        // 生产者的读取次数
+    double avgReadKB = 0;         // 平均每次读取的大小
+    double throughputMBps = 0;    // 读取吞吐：读取字节数 / 读取耗时
+};
+
+/**
+ * @brief 播放列表中的一项，数据通过内存映射读取
+ */
+struct PlaylistItem {
+    MappedPcmSource source;
+    int32_t index = 0;
+    int64_t totalFrames = 0;
+    // 下一项，由控制线程链接、回调读完本项后取走；回调结束播放时置为关闭标记，之后不再接受新项
+    std::atomic<PlaylistItem*> next{nullptr};
+};
 
 /**
  * @brief Oboe音频播放器类
  * 负责PCM文件的播放
+ * 默认把文件映射到内存，回调直接从映射中拷贝；映射失败时退回生产者线程读文件的缓冲模式
+ * 数据经WSOLA变速器输出，播放中可以改变速度而不改变音调
+ * 压缩格式（m4a/flac/opus等）由FFmpeg边解码边播放，不生成临时文件，以浮点格式输出
+ * 流总是按设备原生采样率打开，文件采样率不同时由多相重采样器在变速之后转换
+ * 内存映射模式下支持播放列表：后续文件在当前文件播放时映射并预读，读完当前文件后在同一个流上无缝接续
  */
 class OboePlayer : public oboe::AudioStreamCallback {
 public:
     /**
      * @brief 构造函数
-     * @param filePath PCM文件路径
+     * @param filePath PCM、WAV或压缩格式文件路径，WAV和压缩格式以文件本身的格式为准
      * @param sampleRate 采样率
      * @param isStereo 是否为立体声
      * @param isFloat 是否使用浮点数格式
      * @param audioApi 音频API类型
+     * @param useMmap 是否使用内存映射播放
+     * @param bufferCapacity 缓冲模式的缓冲区容量（字节），0为默认的BUFFER_CAPACITY
      */
-    OboePlayer(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat, int32_t audioApi, int32_t deviceId);
+    OboePlayer(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat, int32_t audioApi, int32_t deviceId,
+               bool useMmap = true, size_t bufferCapacity = 0);
     
     /**
      * @brief 析构函数
@@ -57,13 +107,62 @@ public:
     void stop();
 
     // 设置回调对象
-    void setCallbackObject(jobject obj, jmethodID methodId) {
+    void setCallbackObject(jobject obj, jmethodID methodId, jmethodID itemCompleteMethodId) {
         callbackObject_ = obj;
         onPlaybackCompleteMethodId_ = methodId;
+        onItemCompleteMethodId_ = itemCompleteMethodId;
     }
 
+    /**
+     * @brief 把文件加入播放列表末尾（控制线程调用）
+     * 文件立即映射并预读开头的数据，当前文件读完后采样连续地接续播放，每一项读完时回调onItemComplete
+     * @return 是否加入成功；缓冲模式、格式与当前流不一致或播放已经结束时失败
+     */
+    bool enqueue(const char* filePath);
+
     float getPlaybackProgress() const;  // 获取播放进度的方法
 
+    /**
+     * @brief 正在从扬声器播出的位置（任意线程调用，无锁）
+     * getPlaybackProgress按回调取走的数据计算，超前于实际听到的声音一个缓冲区加设备延迟；
+     * 这里用流时间戳校正并在两次回调之间按时间插值，适合驱动波形光标
+     */
+    PresentationPosition getPresentationPosition() const;
+
+    /**
+     * @brief 跳转到指定帧（任意线程调用）
+     * 新位置的数据准备好之前回调继续播放已缓冲的数据，不会输出静音。
+     * 播完后流保持运行并输出静音直到stop()，此时跳转会从新位置继续播放
+     */
+    void seekToFrame(int64_t frame);
+
+    /**
+     * @brief 设置A/B循环区间[startFrame, endFrame)，endFrame <= startFrame时取消循环
+     * 播放到终点时采样级无缝地回到起点；当前位置已在终点之后时回到起点
+     */
+    void setLoop(int64_t startFrame, int64_t endFrame);
+
+    /**
+     * @brief 获取跳转统计（任意线程调用）
+     * 跳转延迟 = 请求到回调输出新位置数据的时间 + 流缓冲区时长
+     */
+    SeekStats getSeekStats() const;
+
+    /**
+     * @brief 获取缓冲模式的预读统计（任意线程调用），内存映射和解码模式下各项为0
+     */
+    PrefetchStats getPrefetchStats() const;
+
+    /**
+     * @brief 当前播放项的总帧数
+     */
+    int64_t getTotalFrames();
+
+    /**
+     * @brief 设置播放速度（任意线程调用），范围0.5~3.0，下一次回调生效
+     */
+    void setPlaybackSpeed(float speed);
+
 private:
     std::shared_ptr<oboe::AudioStream> stream_;
     std::unique_ptr<FILE, decltype(&fclose)> file_;
@@ -73,26 +172,108 @@ private:
     int32_t samplesPerFrame;
     int32_t audioApi;
     size_t bytesRead_;
-    size_t totalBytes_;  // 文件总字节数
+    size_t totalBytes_;  // 音频数据总字节数
+    int64_t dataOffset_;  // 音频数据在文件中的偏移，裸PCM为0
+    int64_t headerDataSize_;  // WAV文件头记录的数据长度，裸PCM为-1
     std::atomic<float> playbackProgress_;  // 播放进度
     std::atomic<int64_t> framesPlayed_;  // 已播放的帧数
     int64_t totalFrames_;  // 总帧数
     int32_t deviceId = oboe::kUnspecified;
+    bool useMmap_;
+
+    // 内存映射模式：播放列表，playlist_由控制线程在playlistMutex_下维护，回调只沿next前进
+    std::mutex playlistMutex_;
+    std::deque<std::unique_ptr<PlaylistItem>> playlist_;
+    PlaylistItem* currentItem_;  // 回调正在读取的项（回调私有）
+    std::atomic<int32_t> currentIndex_;
 
-    // 缓冲区相关
-    static constexpr size_t BUFFER_CAPACITY = 1024 * 1024; // 1MB 缓冲区
+    // 压缩格式：解码线程直接写入环形缓冲区
+    std::unique_ptr<DecoderSource> decoderSource_;
+
+    // 缓冲模式：生产者按水位预读，低于低水位时被回调唤醒，按缺口大小一次读入64~256KB，达到高水位后休眠
+    static constexpr size_t BUFFER_CAPACITY = 1024 * 1024; // 默认1MB 缓冲区
+    static constexpr size_t MIN_PREFETCH_BLOCK = 64 * 1024;
+    static constexpr size_t MAX_PREFETCH_BLOCK = 256 * 1024;
     std::unique_ptr<ThreadSafeRingBuffer> ringBuffer_;
+    size_t lowWatermark_;
+    size_t highWatermark_;
     std::unique_ptr<std::thread> producerThread_;
     std::atomic<bool> isRunning_;
+    std::atomic<bool> endOfData_;  // 生产者已读到数据末尾，等待跳转或停止
+    std::atomic<bool> producerSleeping_;  // 生产者达到高水位后休眠，回调在低于低水位时唤醒
+    sem_t producerWake_;
+    uint64_t producerWritten_;  // 生产者累计写入缓冲区的字节数（生产者私有）
+    uint64_t consumerRead_;     // 回调累计取走的字节数（回调私有）
+    // 跳转后生产者把新位置的第一块数据写入缓冲区，再发布此前写入的字节数，
+    // 回调丢弃到这个位置为止的旧数据；发布之前回调继续播放旧数据。
+    // 旧数据可能已被回调全部取走，因此用序号而不是字节数判断是否有新的跳转
+    std::atomic<uint64_t> flushUntil_;
+    std::atomic<int64_t> flushFrame_;
+    std::atomic<uint32_t> flushSeq_;
+    uint32_t flushSeen_;  // 回调已处理的跳转序号（回调私有）
+    bool flushApplied_;  // 回调已丢弃旧数据，等待输出新位置的数据（回调私有）
+
+    // 跳转和循环请求
+    std::atomic<int64_t> pendingSeekFrame_;
+    std::atomic<int64_t> loopStartFrame_;
+    std::atomic<int64_t> loopEndFrame_;
+    std::atomic<bool> loopChanged_;
+
+    // 跳转统计
+    std::atomic<int64_t> seekRequestNanos_;
+    std::atomic<int32_t> seekCount_;
+    std::atomic<int64_t> seekLatencySumNanos_;
+    std::atomic<int64_t> lastSeekLatencyNanos_;
+    std::atomic<int64_t> maxSeekLatencyNanos_;
+
+    // 预读统计：填充率和欠载由回调记录，读取次数和耗时由生产者记录
+    std::atomic<size_t> minFillBytes_;
+    std::atomic<uint64_t> fillSumBytes_;
+    std::atomic<int64_t> fillSamples_;
+    std::atomic<int32_t> underrunCount_;
+    std::atomic<int32_t> producerWakeCount_;
+    std::atomic<int64_t> prefetchReads_;
+    std::atomic<uint64_t> prefetchBytes_;
+    std::atomic<int64_t> prefetchNanos_;
+
+    // 变速
+    std::unique_ptr<WsolaTimeStretcher> stretcher_;
+    std::atomic<float> playbackSpeed_;
+    bool sourceDrained_;  // 本次回调中数据源已读完（回调私有）
+
+    // 文件与设备采样率不同时的重采样，打开流后创建、启动前分配好
+    std::unique_ptr<PolyphaseResampler> resampler_;
+
+    // 播出位置：回调发布，任意线程读取
+    PresentationClock presentationClock_;
+    int64_t streamFramesWritten_;  // 写入流的累计帧数（回调私有）
+
+    // 播放事件：回调只计数并唤醒事件线程，由事件线程调用Java层
+    std::atomic<int32_t> completedItems_;  // 已读完的项数
+    std::atomic<bool> playbackEnded_;
+    bool endReported_;  // 已报告播放完成，流继续输出静音，跳转后有了新数据再复位（回调私有）
+    sem_t eventWake_;
+    std::unique_ptr<std::thread> eventThread_;
+    std::atomic<bool> eventClosing_;
 
     // 播放完成的回调
     void notifyPlaybackComplete();
+    void notifyItemComplete(int32_t index);
+    void eventThreadFunc();
 
     // 回调相关的成员变量
     jmethodID onPlaybackCompleteMethodId_ = nullptr;
+    jmethodID onItemCompleteMethodId_ = nullptr;
     jobject callbackObject_ = nullptr;
 
     void producerThreadFunc();
+    size_t readSource(oboe::AudioStream* audioStream, void* dst, size_t maxFrames, bool& discontinuity);
+    bool advancePlaylist();
+    PlaylistItem* activeItem();
+    std::unique_ptr<PlaylistItem> openItem(FILE* file, int64_t dataOffset, uint64_t dataSize, int32_t index);
+    void recordSeekLatency(oboe::AudioStream* audioStream);
+    void publishPresentation(oboe::AudioStream* audioStream, int32_t numFrames);
+    size_t bytesPerFrame() const { return (isFloat ? 4 : 2) * samplesPerFrame; }
     bool startOboeStream();
     static oboe::AudioApi getAudioApi(int32_t api);
 };
@@ -1,4 +1,5 @@
 #include <jni.h>
+#include <algorithm>
 #include <string>
 #include "oboe_player.h"
 #include "logging.h"
@@ -16,7 +17,7 @@ extern "C" {
 JNIEXPORT jlong JNICALL
 Java_me_rjy_oboe_record_demo_OboePlayer_createNativePlayer(
         JNIEnv* env, jobject thiz, jstring filePath, jint sampleRate,
-        jboolean isStereo, jboolean isFloat, jint audioApi, jint deviceId) {
+        jboolean isStereo, jboolean isFloat, jint audioApi, jint deviceId, jboolean useMmap, jint bufferCapacity) {
     
     const char* path = env->GetStringUTFChars(filePath, nullptr);
     if (!path) {
@@ -24,7 +25,8 @@ Java_me_rjy_oboe_record_demo_OboePlayer_createNativePlayer(
         return 0;
     }
 
-    auto* player = new OboePlayer(path, sampleRate, isStereo, isFloat, audioApi, deviceId);
+    auto* player = new OboePlayer(path, sampleRate, isStereo, isFloat, audioApi, deviceId, useMmap,
+                                  static_cast<size_t>(std::max(0, bufferCapacity)));
     env->ReleaseStringUTFChars(filePath, path);
 
     if (!player) {
@@ -84,12 +86,13 @@ Java_me_rjy_oboe_record_demo_OboePlayer_setCallbackObject(
         // 获取回调方法ID
         jclass clazz = env->GetObjectClass(callbackObject);
         onPlaybackCompleteMethodId = env->GetMethodID(clazz, "onPlaybackComplete", "()V");
+        jmethodID onItemCompleteMethodId = env->GetMethodID(clazz, "onItemComplete", "(I)V");
         
         // 创建全局引用
         jobject globalRef = env->NewGlobalRef(callbackObject);
         
         // 设置到C++对象
-        player->setCallbackObject(globalRef, onPlaybackCompleteMethodId);
+        player->setCallbackObject(globalRef, onPlaybackCompleteMethodId, onItemCompleteMethodId);
     }
 }
 
@@ -107,4 +110,127 @@ Java_me_rjy_oboe_record_demo_OboePlayer_nativeGetPlaybackProgress(
     return player->getPlaybackProgress();
 }
 
+// 跳转到指定帧
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeSeekToFrame(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jlong frame) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (player) {
+        player->seekToFrame(frame);
+    }
+}
+
+// 设置A/B循环区间
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeSetLoop(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jlong startFrame, jlong endFrame) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (player) {
+        player->setLoop(startFrame, endFrame);
+    }
+}
+
+// 加入播放列表
+JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeEnqueue(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jstring filePath) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (!player) {
+        return JNI_FALSE;
+    }
+    const char* path = env->GetStringUTFChars(filePath, nullptr);
+    if (!path) {
+        LOGE("Failed to get file path");
+        return JNI_FALSE;
+    }
+    const bool enqueued = player->enqueue(path);
+    env->ReleaseStringUTFChars(filePath, path);
+    return enqueued ? JNI_TRUE : JNI_FALSE;
+}
+
+// 设置播放速度
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeSetPlaybackSpeed(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jfloat speed) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (player) {
+        player->setPlaybackSpeed(speed);
+    }
+}
+
+// 获取总帧数
+JNIEXPORT jlong JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeGetTotalFrames(
+        JNIEnv* env, jobject thiz, jlong nativePlayer) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    return player ? player->getTotalFrames() : 0;
+}
+
+// 获取预读统计：{容量(字节), 最低填充率, 平均填充率, 欠载次数, 唤醒次数, 读取次数, 平均读取KB, 吞吐MB/s}
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeGetPrefetchStats(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jdoubleArray out) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (!player || !out || env->GetArrayLength(out) < 8) {
+        return;
+    }
+    const PrefetchStats stats = player->getPrefetchStats();
+    const jdouble values[8] = {
+            static_cast<jdouble>(stats.capacityBytes),
+            stats.minFillPercent,
+            stats.avgFillPercent,
+            static_cast<jdouble>(stats.underrunCount),
+            static_cast<jdouble>(stats.wakeCount),
+            static_cast<jdouble>(stats.readCount),
+            stats.avgReadKB,
+            stats.throughputMBps
+    };
+    env->SetDoubleArrayRegion(out, 0, 8, values);
+}
+
+// 获取播出位置：{帧位置, 播放列表项, 进度, 输出延迟(毫秒), 是否基于流时间戳}
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeGetPresentationPosition(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jdoubleArray out) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (!player || !out || env->GetArrayLength(out) < 5) {
+        return;
+    }
+    const PresentationPosition position = player->getPresentationPosition();
+    const jdouble values[5] = {
+            static_cast<jdouble>(position.frame),
+            static_cast<jdouble>(position.itemIndex),
+            position.progress,
+            position.latencyMs,
+            position.timestampValid ? 1.0 : 0.0
+    };
+    env->SetDoubleArrayRegion(out, 0, 5, values);
+}
+
+// 获取跳转统计：{次数, 最近一次延迟, 平均延迟, 最大延迟}，延迟单位为毫秒
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_OboePlayer_nativeGetSeekStats(
+        JNIEnv* env, jobject thiz, jlong nativePlayer, jdoubleArray out) {
+
+    auto* player = reinterpret_cast<OboePlayer*>(nativePlayer);
+    if (!player || !out || env->GetArrayLength(out) < 4) {
+        return;
+    }
+    const SeekStats stats = player->getSeekStats();
+    const jdouble values[4] = {
+            static_cast<jdouble>(stats.seekCount),
+            stats.lastLatencyMs,
+            stats.avgLatencyMs,
+            stats.maxLatencyMs
+    };
+    env->SetDoubleArrayRegion(out, 0, 4, values);
+}
+
 } // extern "C" 
\ No newline at end of file
@@ -1,23 +1,82 @@
 #include "oboe_recorder.h"
-#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <string>
 #include <android/log.h>
 #include <jni.h>
 #include "logging.h"
+#include "async_block_writer.h"
+#include "flac_encoder_sink.h"
+#include "peak_pyramid_sink.h"
+#include "preroll_sink.h"
+#include "rt_sanitizer.h"
+#include "wav_data_writer.h"
 
 #define LOG_TAG "OboeRecorder"
 
 // 声明外部变量
 extern JavaVM* javaVm;
-extern jmethodID onAudioDataMethodId;
 extern jmethodID onErrorMethodId;
 extern jobject recorderViewModel;
 
 // 定义静态成员变量
 constexpr size_t OboeRecorder::BUFFER_CAPACITY;
+constexpr int32_t OboeRecorder::kMaxFramesPerPass;
+
+static bool hasSuffix(const std::string& path, const char* suffix) {
+    const size_t length = strlen(suffix);
+    return path.size() >= length && path.compare(path.size() - length, length, suffix) == 0;
+}
+
+// 按扩展名选择文件格式：.flac实时压缩，.wav写入带文件头的WAV，其它保持裸PCM
+// burstMs为需要额外吸收的突发数据时长，预录事件开始时会一次性写入整段历史
+static std::unique_ptr<AudioSink> createSink(const char* filePath, int32_t sampleRate,
+                                             bool isStereo, bool isFloat, int32_t burstMs = 0) {
+    const std::string path(filePath);
+    const int32_t channelCount = isStereo ? 2 : 1;
+    if (hasSuffix(path, ".flac")) {
+        return std::make_unique<FlacEncoderSink>(filePath, sampleRate, channelCount, isFloat, 2000 + burstMs);
+    }
+    std::unique_ptr<DataWriter> dataWriter;
+    if (hasSuffix(path, ".wav")) {
+        WavFormat format;
+        format.sampleRate = sampleRate;
+        format.channelCount = channelCount;
+        format.isFloat = isFloat;
+        dataWriter = std::make_unique<WavDataWriter>(filePath, format);
+    } else {
+        dataWriter = std::make_unique<DataWriter>(filePath);
+    }
+    AsyncWriterOptions options;
+    const size_t bytesPerFrame = channelCount * (isFloat ? sizeof(float) : sizeof(int16_t));
+    options.blockCount += static_cast<size_t>(sampleRate) * burstMs / 1000 * bytesPerFrame / options.blockSize;
+    return std::make_unique<AsyncBlockWriter>(std::move(dataWriter), options);
+}
+
+// 预录模式下录音文件只在事件发生时创建，每个事件一个文件
+static std::unique_ptr<AudioSink> createPrerollSink(const char* filePath, int32_t sampleRate,
+                                                    bool isStereo, bool isFloat, int32_t prerollMs,
+                                                    float triggerLevel) {
+    PrerollOptions options;
+    options.prerollMs = prerollMs;
+    options.triggerLevel = triggerLevel;
+    return std::make_unique<PrerollSink>(
+            filePath, sampleRate, isStereo ? 2 : 1, isFloat, options,
+            [sampleRate, isStereo, isFloat, prerollMs](const std::string& path) {
+                return createSink(path.c_str(), sampleRate, isStereo, isFloat, prerollMs);
+            });
+}
 
 OboeRecorder::OboeRecorder(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat,
-                         int32_t deviceId, int32_t audioSource, int32_t audioApi)
-    : writer(std::make_unique<DataWriter>(filePath))
+                         int32_t deviceId, int32_t audioSource, int32_t audioApi, int32_t framesPerPoint,
+                         int32_t prerollMs, float triggerLevel)
+    : writer(prerollMs > 0
+             ? createPrerollSink(filePath, sampleRate, isStereo, isFloat, prerollMs, triggerLevel)
+             : createSink(filePath, sampleRate, isStereo, isFloat))
+    , peaks_(prerollMs > 0 ? nullptr
+             : std::make_unique<PeakPyramidSink>(std::string(filePath) + ".peaks", sampleRate,
+                                                 isStereo ? 2 : 1, isFloat))
+    , preroll_(prerollMs > 0 ? static_cast<PrerollSink*>(writer.get()) : nullptr)
     , isFloat(isFloat)
     , sampleRate(sampleRate)
     , isStereo(isStereo)
@@ -25,85 +84,16 @@ OboeRecorder::OboeRecorder(const char* filePath, int32_t sampleRate, bool isSter
     , deviceId(deviceId)
     , audioSource(audioSource)
     , audioApi(audioApi)
-    , ringBuffer_(std::make_unique<SimpleRingBuffer>(BUFFER_CAPACITY))
-    , isRunning_(false)
-    , cachedEnv_(nullptr)
-    , audioDataArray_(nullptr)
-    , audioDataArraySize_(0) {
+    , audioChannel_(std::make_shared<SharedAudioChannel>(
+            BUFFER_CAPACITY, PeakDecimator::kMaxChannels * sizeof(float)))
+    , decimator_(samplesPerFrame, isFloat, framesPerPoint)
+    , points_(new float[decimator_.maxPointsFor(kMaxFramesPerPass) * PeakDecimator::kMaxChannels]) {
 }
 
 OboeRecorder::~OboeRecorder() {
     stop();
 }
 
-void OboeRecorder::initJniEnv() {
-    if (javaVm->AttachCurrentThread(&cachedEnv_, nullptr) != JNI_OK) {
-        LOGE("Failed to attach thread to JVM");
-        return;
-    }
-    consumerThreadId_ = std::this_thread::get_id();
-}
-
-void OboeRecorder::cleanupJniEnv() {
-    if (std::this_thread::get_id() == consumerThreadId_) {
-        cleanupAudioDataArray();
-        javaVm->DetachCurrentThread();
-        cachedEnv_ = nullptr;
-    }
-}
-
-void OboeRecorder::initAudioDataArray(size_t initialSize) {
-
-    audioDataArraySize_ = initialSize;
-    jbyteArray localArray = cachedEnv_->NewByteArray(initialSize);
-    if (localArray) {
-        audioDataArray_ = cachedEnv_->NewGlobalRef(localArray);
-        cachedEnv_->DeleteLocalRef(localArray);
-    }
-}
-
-void OboeRecorder::cleanupAudioDataArray() {
-    if (cachedEnv_ && audioDataArray_) {
-        cachedEnv_->DeleteGlobalRef(audioDataArray_);
-        audioDataArray_ = nullptr;
-        audioDataArraySize_ = 0;
-    }
-}
-
-void OboeRecorder::ensureAudioDataArrayCapacity(size_t requiredSize) {
-    if (audioDataArraySize_ < requiredSize) {
-        // 如果需要更大的缓冲区，创建新的数组
-        cleanupAudioDataArray();
-        initAudioDataArray(requiredSize);
-    }
-}
-
-void OboeRecorder::sendAudioDataToJava(const void* audioData, int32_t numFrames) {
-    size_t bytesPerSample = isFloat ? sizeof(float) : sizeof(int16_t);
-    size_t channelCount = isStereo ? 2 : 1;
-    size_t totalBytes = numFrames * channelCount * bytesPerSample;
-
-    // 确保数组大小足够
-    ensureAudioDataArrayCapacity(totalBytes);
-    if (!audioDataArray_) return;
-
-    // 获取全局引用对应的局部引用
-    auto localArray = static_cast<jbyteArray>(
-        cachedEnv_->NewLocalRef(audioDataArray_));
-    if (!localArray) return;
-
-    // 复制数据
-    cachedEnv_->SetByteArrayRegion(localArray, 0, totalBytes, 
-                                  static_cast<const jbyte*>(audioData));
-
-    // 回调Java方法
-    cachedEnv_->CallVoidMethod(recorderViewModel, onAudioDataMethodId, 
-                              localArray, static_cast<jint>(totalBytes));
-
-    // 删除局部引用
-    cachedEnv_->DeleteLocalRef(localArray);
-}
-
 void OboeRecorder::sendErrorToJava(const char* errorMessage) {
     if (!onErrorMethodId || !recorderViewModel || !javaVm) {
         LOGE("Cannot send error to Java: missing JNI references");
@@ -114,7 +104,7 @@ void OboeRecorder::sendErrorToJava(const char* errorMessage) {
     bool attached = false;
     
     // 尝试获取当前线程的JNI环境
-    // 注意：错误回调在Oboe的音频流线程中调用，不能使用cachedEnv_
+    // 注意：错误回调在Oboe的音频流线程中调用，该线程可能尚未附加到JVM
     jint result = javaVm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
     
     if (result == JNI_EDETACHED) {
@@ -163,10 +153,6 @@ void OboeRecorder::onErrorBeforeClose(oboe::AudioStream *audioStream, oboe::Resu
     const char* errorText = oboe::convertToText(error);
     LOGE("Oboe error before close: %s", errorText);
     
-    // 停止录音
-    isRunning_ = false;
-    dataReady_.notify_one();
-
     // 发送错误到Java层
 //    sendErrorToJava(errorText);
 }
@@ -179,60 +165,31 @@ void OboeRecorder::onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Resul
     const char* errorText = oboe::convertToText(error);
     LOGE("Oboe error after close: %s", errorText);
     
-    // 确保停止录音
-    isRunning_ = false;
-    dataReady_.notify_one();
-
     // 发送错误到Java层
     sendErrorToJava(errorText);
 }
 
-void OboeRecorder::consumerThreadFunc() {
-    // 初始化JNI环境
-    initJniEnv();
-    if (!cachedEnv_) return;
-
-    // 初始化一个合理大小的音频数据数组
-    initAudioDataArray(16 * 1024);  // 16KB初始大小
-
-    std::vector<uint8_t> tempBuffer(16 * 1024);
-
-    while (isRunning_) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        
-        dataReady_.wait(lock, [this] {
-            return ringBuffer_->size() > 0 || !isRunning_;
-        });
-
-        if (!isRunning_) break;
-
-        size_t dataSize = std::min(ringBuffer_->size(), tempBuffer.size());
-        
-        if (dataSize > 0) {
-            if (ringBuffer_->read(tempBuffer.data(), dataSize)) {
-                lock.unlock();
-                sendAudioDataToJava(tempBuffer.data(), 
-                                  dataSize / (samplesPerFrame * (isFloat ? sizeof(float) : sizeof(int16_t))));
-            }
-        }
-    }
-
-    // 清理JNI环境
-    cleanupJniEnv();
-}
-
 oboe::DataCallbackResult OboeRecorder::onAudioReady(
         oboe::AudioStream *audioStream,
         void *audioData,
         int32_t numFrames) {
+    RT_CALLBACK_SCOPE("OboeRecorder::onAudioReady");
     size_t bytesPerSample = isFloat ? sizeof(float) : sizeof(int16_t);
     size_t totalBytes = numFrames * samplesPerFrame * bytesPerSample;
     writer->write(audioData, totalBytes);
+    if (peaks_) {
+        peaks_->write(audioData, totalBytes);
+    }
 
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (ringBuffer_->write(audioData, totalBytes)) {
-            dataReady_.notify_one();
+    // 抽取波形包络点写入共享通道，由Kotlin按刷新频率拉取；读端跟不上时丢弃并计数
+    const size_t maxPoints = decimator_.maxPointsFor(kMaxFramesPerPass);
+    const auto* pcm = static_cast<const uint8_t*>(audioData);
+    const size_t bytesPerFrame = samplesPerFrame * bytesPerSample;
+    for (int32_t frame = 0; frame < numFrames; frame += kMaxFramesPerPass) {
+        const int32_t frames = std::min(numFrames - frame, kMaxFramesPerPass);
+        const size_t count = decimator_.process(pcm + frame * bytesPerFrame, frames, points_.get(), maxPoints);
+        if (count > 0) {
+            audioChannel_->write(points_.get(), static_cast<int32_t>(count));
         }
     }
 
@@ -240,8 +197,13 @@ oboe::DataCallbackResult OboeRecorder::onAudioReady(
 }
 
 bool OboeRecorder::start() {
-    isRunning_ = true;
-    consumerThread_ = std::make_unique<std::thread>(&OboeRecorder::consumerThreadFunc, this);
+    if (!writer->start()) {
+        LOGE("Failed to start writer");
+        return false;
+    }
+    if (peaks_) {
+        peaks_->start();
+    }
 
     oboe::AudioStreamBuilder builder;
     builder.setDirection(oboe::Direction::Input)
@@ -277,18 +239,31 @@ bool OboeRecorder::start() {
 }
 
 void OboeRecorder::stop() {
-    if (consumerThread_ && consumerThread_->joinable()) {
-        isRunning_ = false;
-        dataReady_.notify_one();
-        consumerThread_->join();
-        consumerThread_.reset();
-    }
-
     if (stream_) {
         stream_->stop();
         stream_->close();
         stream_.reset();
     }
+
+    // 流停止后回调不再写入，此时写完剩余数据并关闭文件
+    writer->close();
+    if (peaks_) {
+        peaks_->close();
+    }
+
+    if (audioChannel_->lostPoints() > 0) {
+        LOGW("audio channel overflow, %lld waveform points not delivered to Java",
+             static_cast<long long>(audioChannel_->lostPoints()));
+    }
+    RT_SANITIZER_REPORT();
+}
+
+bool OboeRecorder::triggerCapture() {
+    if (!preroll_) {
+        return false;
+    }
+    preroll_->trigger();
+    return true;
 }
 
 oboe::InputPreset OboeRecorder::getInputPreset(int32_t audioSource) {
@@ -2,18 +2,16 @@
 #define OBOE_RECORDER_H
 
 #include <memory>
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <atomic>
 #include <jni.h>
 #include <oboe/Oboe.h>
-#include "simple_ring_buffer.h"
-#include "data_writer.h"
+#include "audio_sink.h"
+#include "peak_decimator.h"
+#include "preroll_sink.h"
+#include "shared_audio_channel.h"
 
 /**
  * @brief Oboe音频录制器类
- * 负责音频数据的采集、缓存和回调
+ * 负责音频数据的采集与保存，并在回调中抽取波形包络点放入共享通道供界面拉取
  */
 class OboeRecorder : public oboe::AudioStreamDataCallback, public oboe::AudioStreamErrorCallback {
 public:
@@ -26,9 +24,13 @@ public:
      * @param deviceId 音频设备ID
      * @param audioSource 音频源类型
      * @param audioApi 音频API类型
+     * @param framesPerPoint 界面波形每个包络点对应的帧数
+     * @param prerollMs 预录时长，大于0时进入预录模式：只在触发后保存事件前后的录音
+     * @param triggerLevel 预录模式下自动触发的峰值电平（线性），0表示只能手动触发
      */
     OboeRecorder(const char* filePath, int32_t sampleRate, bool isStereo, bool isFloat,
-                int32_t deviceId, int32_t audioSource, int32_t audioApi);
+                int32_t deviceId, int32_t audioSource, int32_t audioApi, int32_t framesPerPoint,
+                int32_t prerollMs = 0, float triggerLevel = 0.0f);
     
     /**
      * @brief 析构函数
@@ -64,9 +66,23 @@ public:
      */
     void stop();
 
+    /**
+     * @brief 获取供Kotlin拉取波形包络点的共享通道，每个点为（左、右）两个float，单声道时右声道为NaN
+     * 通道由JNI层额外持有，录音器销毁后DirectByteBuffer指向的内存依然有效
+     */
+    std::shared_ptr<SharedAudioChannel> getAudioChannel() const { return audioChannel_; }
+
+    /**
+     * @brief 预录模式下手动触发一次事件
+     * @return 是否处于预录模式
+     */
+    bool triggerCapture();
+
 private:
     std::shared_ptr<oboe::AudioStream> stream_;
-    std::unique_ptr<DataWriter> writer;
+    std::unique_ptr<AudioSink> writer;  // 回调只做内存拷贝，编码与文件I/O在各自的后台线程完成
+    std::unique_ptr<AudioSink> peaks_;  // 同时构建.peaks波形金字塔，失败不影响录音；预录模式下不构建
+    PrerollSink* preroll_;              // 预录模式下指向writer，否则为空
     bool isFloat;
     int32_t sampleRate;
     bool isStereo;
@@ -75,62 +91,18 @@ private:
     int32_t audioSource;
     int32_t audioApi;
 
-    // 缓冲区相关
-    static constexpr size_t BUFFER_CAPACITY = 1024 * 1024; // 1MB 缓冲区
-    std::unique_ptr<SimpleRingBuffer> ringBuffer_;
-    std::unique_ptr<std::thread> consumerThread_;
-    std::mutex mutex_;
-    std::condition_variable dataReady_;
-    std::atomic<bool> isRunning_;
-
-    // JNI相关优化
-    JNIEnv* cachedEnv_;                  // 缓存的JNI环境
-    std::thread::id consumerThreadId_;    // 消费者线程ID
-    jweak audioDataArray_;               // 复用的音频数据数组
-    size_t audioDataArraySize_;          // 当前数组大小
-
-    /**
-     * @brief 初始化JNI环境
-     */
-    void initJniEnv();
-
-    /**
-     * @brief 清理JNI环境
-     */
-    void cleanupJniEnv();
-
-    /**
-     * @brief 初始化音频数据数组
-     * @param initialSize 初始大小
-     */
-    void initAudioDataArray(size_t initialSize);
-
-    /**
-     * @brief 清理音频数据数组
-     */
-    void cleanupAudioDataArray();
-
-    /**
-     * @brief 确保音频数据数组足够大
-     * @param requiredSize 需要的大小
-     */
-    void ensureAudioDataArrayCapacity(size_t requiredSize);
-
-    /**
-     * @brief 发送音频数据到Java层
-     */
-    void sendAudioDataToJava(const void* audioData, int32_t numFrames);
+    // 共享通道相关
+    static constexpr size_t BUFFER_CAPACITY = 64 * 1024;  // 可容纳8192个包络点
+    static constexpr int32_t kMaxFramesPerPass = 4096;    // 单次抽取的最大帧数，决定暂存区大小
+    std::shared_ptr<SharedAudioChannel> audioChannel_;
+    PeakDecimator decimator_;
+    std::unique_ptr<float[]> points_;  // 预分配的包络点暂存区，回调中不分配内存
 
     /**
      * @brief 发送错误信息到Java层
      */
     void sendErrorToJava(const char* errorMessage);
 
-    /**
-     * @brief 消费者线程函数
-     */
-    void consumerThreadFunc();
-
     /**
      * @brief 获取输入预设
      */
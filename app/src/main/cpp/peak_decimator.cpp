@@ -0,0 +1,164 @@
+#include "peak_decimator.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PEAK_DECIMATOR_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PEAK_DECIMATOR_SSE2 1
+#endif
+
+namespace {
+
+// 交错数据按向量处理时，向量宽度为偶数且起点对齐到帧，因此第i个通道恰好落在i % channels号lane上
+
+void minMaxS16Scalar(const int16_t* data, size_t samples, int32_t channels, int16_t* mn, int16_t* mx) {
+    for (size_t i = 0; i < samples; ++i) {
+        const int32_t ch = channels == 1 ? 0 : static_cast<int32_t>(i & 1u);
+        mn[ch] = std::min(mn[ch], data[i]);
+        mx[ch] = std::max(mx[ch], data[i]);
+    }
+}
+
+void minMaxF32Scalar(const float* data, size_t samples, int32_t channels, float* mn, float* mx) {
+    for (size_t i = 0; i < samples; ++i) {
+        const int32_t ch = channels == 1 ? 0 : static_cast<int32_t>(i & 1u);
+        mn[ch] = std::min(mn[ch], data[i]);
+        mx[ch] = std::max(mx[ch], data[i]);
+    }
+}
+
+template <typename T>
+void reduceLanes(const T* laneMin, const T* laneMax, int32_t lanes, int32_t channels, T* mn, T* mx) {
+    for (int32_t i = 0; i < lanes; ++i) {
+        const int32_t ch = channels == 1 ? 0 : (i & 1);
+        mn[ch] = std::min(mn[ch], laneMin[i]);
+        mx[ch] = std::max(mx[ch], laneMax[i]);
+    }
+}
+
+void minMaxS16(const int16_t* data, size_t samples, int32_t channels, int16_t* mn, int16_t* mx) {
+    size_t i = 0;
+#if defined(PEAK_DECIMATOR_NEON)
+    if (samples >= 8) {
+        int16x8_t vmin = vld1q_s16(data);
+        int16x8_t vmax = vmin;
+        for (i = 8; i + 8 <= samples; i += 8) {
+            const int16x8_t v = vld1q_s16(data + i);
+            vmin = vminq_s16(vmin, v);
+            vmax = vmaxq_s16(vmax, v);
+        }
+        int16_t laneMin[8], laneMax[8];
+        vst1q_s16(laneMin, vmin);
+        vst1q_s16(laneMax, vmax);
+        reduceLanes(laneMin, laneMax, 8, channels, mn, mx);
+    }
+#elif defined(PEAK_DECIMATOR_SSE2)
+    if (samples >= 8) {
+        __m128i vmin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i vmax = vmin;
+        for (i = 8; i + 8 <= samples; i += 8) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            vmin = _mm_min_epi16(vmin, v);
+            vmax = _mm_max_epi16(vmax, v);
+        }
+        alignas(16) int16_t laneMin[8], laneMax[8];
+        _mm_store_si128(reinterpret_cast<__m128i*>(laneMin), vmin);
+        _mm_store_si128(reinterpret_cast<__m128i*>(laneMax), vmax);
+        reduceLanes(laneMin, laneMax, 8, channels, mn, mx);
+    }
+#endif
+    minMaxS16Scalar(data + i, samples - i, channels, mn, mx);
+}
+
+void minMaxF32(const float* data, size_t samples, int32_t channels, float* mn, float* mx) {
+    size_t i = 0;
+#if defined(PEAK_DECIMATOR_NEON)
+    if (samples >= 4) {
+        float32x4_t vmin = vld1q_f32(data);
+        float32x4_t vmax = vmin;
+        for (i = 4; i + 4 <= samples; i += 4) {
+            const float32x4_t v = vld1q_f32(data + i);
+            vmin = vminq_f32(vmin, v);
+            vmax = vmaxq_f32(vmax, v);
+        }
+        float laneMin[4], laneMax[4];
+        vst1q_f32(laneMin, vmin);
+        vst1q_f32(laneMax, vmax);
+        reduceLanes(laneMin, laneMax, 4, channels, mn, mx);
+    }
+#elif defined(PEAK_DECIMATOR_SSE2)
+    if (samples >= 4) {
+        __m128 vmin = _mm_loadu_ps(data);
+        __m128 vmax = vmin;
+        for (i = 4; i + 4 <= samples; i += 4) {
+            const __m128 v = _mm_loadu_ps(data + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+        }
+        alignas(16) float laneMin[4], laneMax[4];
+        _mm_store_ps(laneMin, vmin);
+        _mm_store_ps(laneMax, vmax);
+        reduceLanes(laneMin, laneMax, 4, channels, mn, mx);
+    }
+#endif
+    minMaxF32Scalar(data + i, samples - i, channels, mn, mx);
+}
+
+} // namespace
+
+PeakDecimator::PeakDecimator(int32_t channelCount, bool isFloat, int32_t framesPerPoint)
+    : channelCount_(std::min(std::max(channelCount, 1), kMaxChannels))
+    , isFloat_(isFloat)
+    , framesPerPoint_(std::max(framesPerPoint, 1)) {
+    reset();
+}
+
+void PeakDecimator::reset() {
+    accumulatedFrames_ = 0;
+    positivePhase_ = true;
+    std::fill(min_, min_ + kMaxChannels, 0.0f);
+    std::fill(max_, max_ + kMaxChannels, 0.0f);
+}
+
+size_t PeakDecimator::process(const void* data, int32_t numFrames, float* points, size_t maxPoints) {
+    size_t pointCount = 0;
+    int32_t frame = 0;
+    while (frame < numFrames) {
+        const int32_t frames = std::min(numFrames - frame, framesPerPoint_ - accumulatedFrames_);
+        const size_t offset = static_cast<size_t>(frame) * channelCount_;
+        const size_t samples = static_cast<size_t>(frames) * channelCount_;
+
+        // 段内最值从0开始累积，结果自然满足max >= 0、min <= 0
+        if (isFloat_) {
+            minMaxF32(static_cast<const float*>(data) + offset, samples, channelCount_, min_, max_);
+        } else {
+            int16_t mn[kMaxChannels] = {0, 0};
+            int16_t mx[kMaxChannels] = {0, 0};
+            minMaxS16(static_cast<const int16_t*>(data) + offset, samples, channelCount_, mn, mx);
+            for (int32_t ch = 0; ch < channelCount_; ++ch) {
+                min_[ch] = std::min(min_[ch], mn[ch] / 32768.0f);
+                max_[ch] = std::max(max_[ch], mx[ch] / 32768.0f);
+            }
+        }
+        accumulatedFrames_ += frames;
+        frame += frames;
+
+        if (accumulatedFrames_ == framesPerPoint_) {
+            if (pointCount < maxPoints) {
+                const float* peak = positivePhase_ ? max_ : min_;
+                float* out = points + pointCount * kMaxChannels;
+                out[0] = std::min(std::max(peak[0], -1.0f), 1.0f);
+                out[1] = channelCount_ == 2 ? std::min(std::max(peak[1], -1.0f), 1.0f) : NAN;
+                ++pointCount;
+            }
+            accumulatedFrames_ = 0;
+            positivePhase_ = !positivePhase_;
+            std::fill(min_, min_ + kMaxChannels, 0.0f);
+            std::fill(max_, max_ + kMaxChannels, 0.0f);
+        }
+    }
+    return pointCount;
+}
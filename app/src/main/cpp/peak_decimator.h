@@ -0,0 +1,64 @@
+#ifndef PEAK_DECIMATOR_H
+#define PEAK_DECIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 波形包络抽取器
+ * 把交错排列的PCM按固定帧数分段，每段输出一个包络点，正负交替：
+ * 偶数个点取max(0, 段内最大值)，奇数个点取min(0, 段内最小值)，与原Kotlin层的振幅计算策略一致，
+ * 在波形控件上画出上下交替的包络。
+ * 段内最值由NEON/SSE2向量化的min/max内核计算，不支持的平台使用标量实现。
+ * 分段状态跨调用保留，数据可以任意切分后分批送入。
+ */
+class PeakDecimator {
+public:
+    static constexpr int32_t kMaxChannels = 2;
+
+    /**
+     * @brief 构造函数
+     * @param channelCount 声道数（1或2）
+     * @param isFloat 输入是否为32位浮点，否则为16位整数
+     * @param framesPerPoint 每个包络点对应的帧数
+     */
+    PeakDecimator(int32_t channelCount, bool isFloat, int32_t framesPerPoint);
+
+    /**
+     * @brief 处理一批PCM数据（实时安全，不分配内存）
+     * @param data PCM数据
+     * @param numFrames 帧数
+     * @param points 输出包络点，每个点占2个float（左、右），单声道时右声道为NaN，取值范围[-1, 1]
+     * @param maxPoints points最多能容纳的点数，超出的点被丢弃
+     * @return 输出的点数
+     */
+    size_t process(const void* data, int32_t numFrames, float* points, size_t maxPoints);
+
+    /**
+     * @brief 清空分段状态
+     */
+    void reset();
+
+    /**
+     * @brief 处理numFrames帧最多会输出的点数
+     */
+    size_t maxPointsFor(int32_t numFrames) const {
+        return static_cast<size_t>(numFrames) / framesPerPoint_ + 1;
+    }
+
+    int32_t channelCount() const { return channelCount_; }
+    bool isFloat() const { return isFloat_; }
+    int32_t framesPerPoint() const { return framesPerPoint_; }
+
+private:
+    const int32_t channelCount_;
+    const bool isFloat_;
+    const int32_t framesPerPoint_;
+
+    int32_t accumulatedFrames_;
+    bool positivePhase_;
+    float min_[kMaxChannels];
+    float max_[kMaxChannels];
+};
+
+#endif // PEAK_DECIMATOR_H
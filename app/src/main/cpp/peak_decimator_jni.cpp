@@ -0,0 +1,63 @@
+#include <jni.h>
+#include <algorithm>
+#include <vector>
+#include "peak_decimator.h"
+#include "logging.h"
+
+#define LOG_TAG "PeakDecimatorJNI"
+
+namespace {
+
+// Kotlin侧持有的抽取器及其输出暂存区
+struct NativeDecimator {
+    NativeDecimator(int32_t channelCount, bool isFloat, int32_t framesPerPoint)
+        : decimator(channelCount, isFloat, framesPerPoint) {}
+
+    PeakDecimator decimator;
+    std::vector<float> points;
+};
+
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_me_rjy_oboe_record_demo_NativeAmplitudeCalculator_nativeCreate(
+        JNIEnv* env, jobject thiz, jint channelCount, jboolean isFloat, jint framesPerPoint) {
+    auto* decimator = new NativeDecimator(channelCount, isFloat, framesPerPoint);
+    return reinterpret_cast<jlong>(decimator);
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_NativeAmplitudeCalculator_nativeRelease(
+        JNIEnv* env, jobject thiz, jlong handle) {
+    delete reinterpret_cast<NativeDecimator*>(handle);
+}
+
+// 处理DirectByteBuffer中的PCM，返回包络点数，点按（左、右）依次写入out
+JNIEXPORT jint JNICALL
+Java_me_rjy_oboe_record_demo_NativeAmplitudeCalculator_nativeProcess(
+        JNIEnv* env, jobject thiz, jlong handle, jobject buffer, jint size, jfloatArray out) {
+    auto* decimator = reinterpret_cast<NativeDecimator*>(handle);
+    auto* data = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    if (!decimator || !data || size <= 0) {
+        if (!data) {
+            LOGE("buffer is not a direct ByteBuffer");
+        }
+        return 0;
+    }
+
+    const PeakDecimator& d = decimator->decimator;
+    const size_t bytesPerFrame = d.channelCount() * (d.isFloat() ? sizeof(float) : sizeof(int16_t));
+    const auto frames = static_cast<int32_t>(static_cast<size_t>(size) / bytesPerFrame);
+    const size_t maxPoints = std::min(d.maxPointsFor(frames),
+                                      static_cast<size_t>(env->GetArrayLength(out)) / PeakDecimator::kMaxChannels);
+    decimator->points.resize(d.maxPointsFor(frames) * PeakDecimator::kMaxChannels);
+
+    const size_t count = decimator->decimator.process(data, frames, decimator->points.data(), maxPoints);
+    env->SetFloatArrayRegion(out, 0, static_cast<jsize>(count * PeakDecimator::kMaxChannels),
+                             decimator->points.data());
+    return static_cast<jint>(count);
+}
+
+}
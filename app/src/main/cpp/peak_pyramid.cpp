@@ -0,0 +1,383 @@
+#include "peak_pyramid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "logging.h"
+
+#define LOG_TAG "PeakPyramid"
+
+static constexpr float kPeakScale = 32767.0f;
+
+static int16_t quantizeSigned(float value) {
+    return static_cast<int16_t>(std::lrintf(std::min(std::max(value, -1.0f), 1.0f) * kPeakScale));
+}
+
+static uint16_t quantizeRms(double value) {
+    return static_cast<uint16_t>(std::lrint(std::min(std::max(value, 0.0), 1.0) * kPeakScale));
+}
+
+static void mergeStats(PeakBinStats& target, const PeakBinStats& source, int32_t channelCount) {
+    target.frames += source.frames;
+    for (int32_t ch = 0; ch < channelCount; ++ch) {
+        target.min[ch] = std::min(target.min[ch], source.min[ch]);
+        target.max[ch] = std::max(target.max[ch], source.max[ch]);
+        target.sumSquares[ch] += source.sumSquares[ch];
+    }
+}
+
+// 整数向下取整除法，区间起点可能为负
+static int64_t floorDiv(int64_t value, int64_t divisor) {
+    const int64_t q = value / divisor;
+    return (value % divisor != 0 && value < 0) ? q - 1 : q;
+}
+
+PeakBinAccumulator::PeakBinAccumulator(int32_t channelCount, bool isFloat, int32_t framesPerBin)
+    : channelCount_(std::min(std::max(channelCount, 1), kPeakMaxChannels))
+    , isFloat_(isFloat)
+    , framesPerBin_(std::max(framesPerBin, 1)) {
+    resetCurrent();
+}
+
+void PeakBinAccumulator::resetCurrent() {
+    current_.frames = 0;
+    for (int32_t ch = 0; ch < kPeakMaxChannels; ++ch) {
+        current_.min[ch] = 0.0f;
+        current_.max[ch] = 0.0f;
+        current_.sumSquares[ch] = 0.0;
+    }
+}
+
+size_t PeakBinAccumulator::process(const void* data, int32_t numFrames, PeakBinStats* bins, size_t maxBins) {
+    size_t binCount = 0;
+    int32_t frame = 0;
+    while (frame < numFrames) {
+        const int32_t frames = std::min(numFrames - frame, framesPerBin_ - current_.frames);
+        const size_t offset = static_cast<size_t>(frame) * channelCount_;
+        for (int32_t ch = 0; ch < channelCount_; ++ch) {
+            // 最值从0开始累积，与界面包络的约定一致：max >= 0、min <= 0
+            float mn = current_.min[ch];
+            float mx = current_.max[ch];
+            float sum = 0.0f;
+            if (isFloat_) {
+                const float* samples = static_cast<const float*>(data) + offset + ch;
+                for (int32_t i = 0; i < frames; ++i) {
+                    const float v = samples[static_cast<size_t>(i) * channelCount_];
+                    mn = std::min(mn, v);
+                    mx = std::max(mx, v);
+                    sum += v * v;
+                }
+            } else {
+                const int16_t* samples = static_cast<const int16_t*>(data) + offset + ch;
+                for (int32_t i = 0; i < frames; ++i) {
+                    const float v = samples[static_cast<size_t>(i) * channelCount_] / 32768.0f;
+                    mn = std::min(mn, v);
+                    mx = std::max(mx, v);
+                    sum += v * v;
+                }
+            }
+            current_.min[ch] = mn;
+            current_.max[ch] = mx;
+            current_.sumSquares[ch] += sum;
+        }
+        current_.frames += frames;
+        frame += frames;
+
+        if (current_.frames == framesPerBin_) {
+            if (binCount < maxBins) {
+                bins[binCount++] = current_;
+            }
+            resetCurrent();
+        }
+    }
+    return binCount;
+}
+
+bool PeakBinAccumulator::flush(PeakBinStats& bin) {
+    if (current_.frames == 0) {
+        return false;
+    }
+    bin = current_;
+    resetCurrent();
+    return true;
+}
+
+PeakPyramidBuilder::PeakPyramidBuilder(int32_t sampleRate, int32_t channelCount, bool isFloat,
+                                       int32_t baseFramesPerBin)
+    : sampleRate_(sampleRate)
+    , channelCount_(std::min(std::max(channelCount, 1), kPeakMaxChannels))
+    , accumulator_(channelCount, isFloat, baseFramesPerBin)
+    , pending_(kMaxPeakLevels)
+    , pendingChildren_(kMaxPeakLevels, 0)
+    , totalFrames_(0) {
+}
+
+void PeakPyramidBuilder::appendPcm(const void* data, int32_t numFrames) {
+    if (numFrames <= 0) {
+        return;
+    }
+    scratch_.resize(accumulator_.maxBinsFor(numFrames));
+    const size_t count = accumulator_.process(data, numFrames, scratch_.data(), scratch_.size());
+    for (size_t i = 0; i < count; ++i) {
+        addBin(scratch_[i]);
+    }
+}
+
+void PeakPyramidBuilder::addBin(const PeakBinStats& bin) {
+    totalFrames_ += bin.frames;
+    addBinAt(bin, 0);
+}
+
+void PeakPyramidBuilder::addBinAt(const PeakBinStats& bin, size_t level) {
+    if (level >= static_cast<size_t>(kMaxPeakLevels)) {
+        return;
+    }
+    if (levels_.size() <= level) {
+        levels_.resize(level + 1);
+    }
+
+    std::vector<PeakBin>& bins = levels_[level];
+    for (int32_t ch = 0; ch < channelCount_; ++ch) {
+        PeakBin peak{};
+        peak.min = quantizeSigned(bin.min[ch]);
+        peak.max = quantizeSigned(bin.max[ch]);
+        peak.rms = quantizeRms(bin.frames > 0 ? std::sqrt(bin.sumSquares[ch] / bin.frames) : 0.0);
+        bins.push_back(peak);
+    }
+
+    // 每两个子bin合并成上一层的一个bin
+    const size_t parent = level + 1;
+    if (parent >= static_cast<size_t>(kMaxPeakLevels)) {
+        return;
+    }
+    if (pendingChildren_[parent] == 0) {
+        pending_[parent] = bin;
+    } else {
+        mergeStats(pending_[parent], bin, channelCount_);
+    }
+    if (++pendingChildren_[parent] == 2) {
+        pendingChildren_[parent] = 0;
+        const PeakBinStats merged = pending_[parent];
+        addBinAt(merged, parent);
+    }
+}
+
+bool PeakPyramidBuilder::finish(const std::string& path) {
+    PeakBinStats tail{};
+    if (accumulator_.flush(tail)) {
+        addBin(tail);
+    }
+    if (levels_.empty()) {
+        LOGW("no audio, skip writing %s", path.c_str());
+        return false;
+    }
+
+    // 把各层未凑满的bin向上合并，直到某一层只剩一个bin
+    for (size_t level = 1; level < static_cast<size_t>(kMaxPeakLevels); ++level) {
+        if (levels_[level - 1].size() <= static_cast<size_t>(channelCount_)) {
+            break;
+        }
+        if (pendingChildren_[level] > 0) {
+            pendingChildren_[level] = 0;
+            const PeakBinStats merged = pending_[level];
+            addBinAt(merged, level);
+        }
+    }
+
+    size_t levelCount = 0;
+    while (levelCount < levels_.size()) {
+        ++levelCount;
+        if (levels_[levelCount - 1].size() <= static_cast<size_t>(channelCount_)) {
+            break;
+        }
+    }
+
+    PeaksFileHeader header{};
+    memcpy(header.magic, "PEAK", 4);
+    header.version = kPeaksVersion;
+    header.sampleRate = static_cast<uint32_t>(sampleRate_);
+    header.channelCount = static_cast<uint16_t>(channelCount_);
+    header.levelCount = static_cast<uint16_t>(levelCount);
+    header.baseFramesPerBin = static_cast<uint32_t>(accumulator_.framesPerBin());
+    header.totalFrames = totalFrames_;
+
+    std::vector<PeaksLevelEntry> entries(levelCount);
+    int64_t offset = static_cast<int64_t>(sizeof(PeaksFileHeader) + levelCount * sizeof(PeaksLevelEntry));
+    for (size_t level = 0; level < levelCount; ++level) {
+        entries[level].offset = offset;
+        entries[level].binCount = static_cast<int64_t>(levels_[level].size() / channelCount_);
+        offset += static_cast<int64_t>(levels_[level].size() * sizeof(PeakBin));
+    }
+
+    const std::string tmpPath = path + ".tmp";
+    FILE* file = fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        LOGE("Failed to open %s", tmpPath.c_str());
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+              && fwrite(entries.data(), sizeof(PeaksLevelEntry), levelCount, file) == levelCount;
+    for (size_t level = 0; ok && level < levelCount; ++level) {
+        ok = fwrite(levels_[level].data(), sizeof(PeakBin), levels_[level].size(), file) == levels_[level].size();
+    }
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOGE("Failed to write %s", path.c_str());
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    LOGI("peaks written: %s frames=%lld levels=%zu bytes=%lld", path.c_str(),
+         static_cast<long long>(totalFrames_), levelCount, static_cast<long long>(offset));
+    return true;
+}
+
+PeakPyramidReader::~PeakPyramidReader() {
+    close();
+}
+
+bool PeakPyramidReader::open(const char* path) {
+    close();
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PeaksFileHeader))) {
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        LOGE("mmap %s failed", path);
+        return false;
+    }
+    mapped_ = static_cast<const uint8_t*>(mapped);
+    mappedSize_ = size;
+
+    const auto* header = reinterpret_cast<const PeaksFileHeader*>(mapped_);
+    const size_t tableEnd = sizeof(PeaksFileHeader) + header->levelCount * sizeof(PeaksLevelEntry);
+    bool valid = memcmp(header->magic, "PEAK", 4) == 0
+                 && header->version == kPeaksVersion
+                 && header->channelCount >= 1 && header->channelCount <= kPeakMaxChannels
+                 && header->levelCount >= 1 && header->levelCount <= kMaxPeakLevels
+                 && header->baseFramesPerBin > 0
+                 && header->totalFrames >= 0
+                 && tableEnd <= size;
+    const auto* levels = reinterpret_cast<const PeaksLevelEntry*>(mapped_ + sizeof(PeaksFileHeader));
+    for (int32_t level = 0; valid && level < header->levelCount; ++level) {
+        const int64_t bytes = levels[level].binCount * header->channelCount * static_cast<int64_t>(sizeof(PeakBin));
+        valid = levels[level].offset >= static_cast<int64_t>(tableEnd)
+                && levels[level].binCount >= 0
+                && levels[level].offset % alignof(PeakBin) == 0
+                && levels[level].offset + bytes <= static_cast<int64_t>(size);
+    }
+    if (!valid) {
+        LOGE("invalid peaks file: %s", path);
+        close();
+        return false;
+    }
+
+    header_ = header;
+    levels_ = levels;
+    return true;
+}
+
+void PeakPyramidReader::close() {
+    if (mapped_) {
+        munmap(const_cast<uint8_t*>(mapped_), mappedSize_);
+    }
+    mapped_ = nullptr;
+    mappedSize_ = 0;
+    header_ = nullptr;
+    levels_ = nullptr;
+}
+
+size_t PeakPyramidReader::query(int64_t startFrame, int64_t endFrame, int32_t pointCount, float* out) const {
+    if (!header_ || pointCount <= 0 || endFrame <= startFrame) {
+        return 0;
+    }
+    const int32_t channels = header_->channelCount;
+    const int64_t base = header_->baseFramesPerBin;
+    const double framesPerPoint = static_cast<double>(endFrame - startFrame) / pointCount;
+
+    // 选每个bin不超过一段长度的最粗一层，每段最多合并两到三个bin
+    int32_t level = 0;
+    while (level + 1 < header_->levelCount && static_cast<double>(base << (level + 1)) <= framesPerPoint) {
+        ++level;
+    }
+    const int64_t framesPerBin = base << level;
+    const int64_t binCount = levels_[level].binCount;
+    const auto* bins = reinterpret_cast<const PeakBin*>(mapped_ + levels_[level].offset);
+
+    for (int32_t i = 0; i < pointCount; ++i) {
+        const int64_t s = startFrame + static_cast<int64_t>(i * framesPerPoint);
+        const int64_t e = startFrame + static_cast<int64_t>((i + 1) * framesPerPoint);
+        int64_t first = floorDiv(s, framesPerBin);
+        int64_t last = std::max(first + 1, floorDiv(e + framesPerBin - 1, framesPerBin));
+        first = std::max<int64_t>(first, 0);
+        last = std::min(last, binCount);
+
+        float* point = out + static_cast<size_t>(i) * channels * 3;
+        for (int32_t ch = 0; ch < channels; ++ch) {
+            int32_t mn = 0;
+            int32_t mx = 0;
+            double squares = 0.0;
+            for (int64_t b = first; b < last; ++b) {
+                const PeakBin& bin = bins[b * channels + ch];
+                mn = std::min<int32_t>(mn, bin.min);
+                mx = std::max<int32_t>(mx, bin.max);
+                squares += static_cast<double>(bin.rms) * bin.rms;
+            }
+            const int64_t count = last - first;
+            point[ch * 3] = mn / kPeakScale;
+            point[ch * 3 + 1] = mx / kPeakScale;
+            point[ch * 3 + 2] = count > 0 ? static_cast<float>(std::sqrt(squares / count) / kPeakScale) : 0.0f;
+        }
+    }
+    return static_cast<size_t>(pointCount);
+}
+
+bool buildPeakPyramidFromPcm(const char* pcmPath, int64_t dataOffset, int64_t dataSize,
+                             int32_t sampleRate, int32_t channelCount, bool isFloat,
+                             const char* peaksPath) {
+    FILE* file = fopen(pcmPath, "rb");
+    if (!file) {
+        LOGE("Failed to open %s", pcmPath);
+        return false;
+    }
+    if (fseeko(file, dataOffset, SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    const size_t bytesPerFrame = static_cast<size_t>(channelCount) * (isFloat ? sizeof(float) : sizeof(int16_t));
+    constexpr size_t kChunkFrames = 64 * 1024;
+    std::vector<uint8_t> buffer(kChunkFrames * bytesPerFrame);
+    PeakPyramidBuilder builder(sampleRate, channelCount, isFloat);
+
+    int64_t remaining = dataSize >= 0 ? dataSize : INT64_MAX;
+    while (remaining > 0) {
+        const size_t toRead = static_cast<size_t>(std::min<int64_t>(remaining, static_cast<int64_t>(buffer.size())));
+        const size_t bytesRead = fread(buffer.data(), 1, toRead, file);
+        const size_t frames = bytesRead / bytesPerFrame;
+        if (frames == 0) {
+            break;
+        }
+        builder.appendPcm(buffer.data(), static_cast<int32_t>(frames));
+        remaining -= static_cast<int64_t>(bytesRead);
+        if (bytesRead < toRead) {
+            break;
+        }
+    }
+    fclose(file);
+    return builder.finish(peaksPath);
+}
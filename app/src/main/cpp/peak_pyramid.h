@@ -0,0 +1,206 @@
+#ifndef PEAK_PYRAMID_H
+#define PEAK_PYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * .peaks波形金字塔文件（小端），与录音文件放在一起，文件名为录音文件名加上".peaks"：
+ *   PeaksFileHeader | PeaksLevelEntry × levelCount | 各层bin数组
+ * 第L层每个bin覆盖baseFramesPerBin << L帧，bin内依次存放各声道的PeakBin。
+ * 最高层只有一个bin，任意缩放级别都可以直接取到相近精度的层，不需要重新解码音频。
+ */
+
+static constexpr int32_t kPeakMaxChannels = 2;
+static constexpr uint32_t kPeaksVersion = 1;
+static constexpr int32_t kDefaultFramesPerPeakBin = 256;
+static constexpr int32_t kMaxPeakLevels = 32;
+
+struct PeaksFileHeader {
+    char magic[4];              // "PEAK"
+    uint32_t version;
+    uint32_t sampleRate;
+    uint16_t channelCount;
+    uint16_t levelCount;
+    uint32_t baseFramesPerBin;  // 第0层每个bin对应的帧数
+    uint32_t reserved;
+    int64_t totalFrames;
+};
+
+struct PeaksLevelEntry {
+    int64_t offset;             // 该层bin数组在文件中的偏移
+    int64_t binCount;
+};
+
+/**
+ * @brief 单个声道在一个bin内的统计，取值按32767量化到[-1, 1]
+ */
+struct PeakBin {
+    int16_t min;
+    int16_t max;
+    uint16_t rms;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(PeaksFileHeader) == 32, "unexpected PeaksFileHeader layout");
+static_assert(sizeof(PeaksLevelEntry) == 16, "unexpected PeaksLevelEntry layout");
+static_assert(sizeof(PeakBin) == 8, "unexpected PeakBin layout");
+
+/**
+ * @brief 构建过程中未量化的bin统计
+ */
+struct PeakBinStats {
+    int32_t frames;
+    float min[kPeakMaxChannels];
+    float max[kPeakMaxChannels];
+    double sumSquares[kPeakMaxChannels];
+};
+
+/**
+ * @brief 第0层bin累加器
+ * 按固定帧数把交错PCM归并为min/max/平方和，分段状态跨调用保留。
+ * 不分配内存，可以在音频回调中调用。
+ */
+class PeakBinAccumulator {
+public:
+    PeakBinAccumulator(int32_t channelCount, bool isFloat, int32_t framesPerBin);
+
+    /**
+     * @brief 处理一批PCM数据
+     * @param data PCM数据
+     * @param numFrames 帧数
+     * @param bins 输出已完成的bin
+     * @param maxBins bins最多能容纳的数量，超出的bin被丢弃
+     * @return 输出的bin数
+     */
+    size_t process(const void* data, int32_t numFrames, PeakBinStats* bins, size_t maxBins);
+
+    /**
+     * @brief 取出未满的最后一个bin
+     * @return 是否有剩余数据
+     */
+    bool flush(PeakBinStats& bin);
+
+    /**
+     * @brief 处理numFrames帧最多会输出的bin数
+     */
+    size_t maxBinsFor(int32_t numFrames) const {
+        return static_cast<size_t>(numFrames) / framesPerBin_ + 1;
+    }
+
+    int32_t channelCount() const { return channelCount_; }
+    bool isFloat() const { return isFloat_; }
+    int32_t framesPerBin() const { return framesPerBin_; }
+
+private:
+    void resetCurrent();
+
+    const int32_t channelCount_;
+    const bool isFloat_;
+    const int32_t framesPerBin_;
+    PeakBinStats current_;
+};
+
+/**
+ * @brief 波形金字塔构建器
+ * 逐个接收第0层bin，每凑齐两个子bin就向上合并一层，内存占用约为第0层的两倍。
+ * 录音结束或文件解码完成后调用finish写出.peaks文件。
+ */
+class PeakPyramidBuilder {
+public:
+    /**
+     * @brief 构造函数
+     * @param sampleRate 采样率
+     * @param channelCount 声道数（1或2）
+     * @param isFloat appendPcm的输入是否为32位浮点
+     * @param baseFramesPerBin 第0层每个bin对应的帧数
+     */
+    PeakPyramidBuilder(int32_t sampleRate, int32_t channelCount, bool isFloat,
+                       int32_t baseFramesPerBin = kDefaultFramesPerPeakBin);
+
+    /**
+     * @brief 追加交错PCM数据
+     */
+    void appendPcm(const void* data, int32_t numFrames);
+
+    /**
+     * @brief 追加一个已完成的第0层bin
+     */
+    void addBin(const PeakBinStats& bin);
+
+    /**
+     * @brief 合并剩余数据并写出.peaks文件，先写临时文件再重命名，读者不会看到写了一半的文件
+     * @return 是否成功
+     */
+    bool finish(const std::string& path);
+
+    int64_t totalFrames() const { return totalFrames_; }
+    int32_t baseFramesPerBin() const { return accumulator_.framesPerBin(); }
+
+private:
+    void addBinAt(const PeakBinStats& bin, size_t level);
+
+    const int32_t sampleRate_;
+    const int32_t channelCount_;
+    PeakBinAccumulator accumulator_;
+    std::vector<PeakBinStats> scratch_;
+    std::vector<std::vector<PeakBin>> levels_;
+    std::vector<PeakBinStats> pending_;      // 每层正在合并的bin，pending_[L]由第L-1层的子bin合并而来
+    std::vector<int32_t> pendingChildren_;
+    int64_t totalFrames_;
+};
+
+/**
+ * @brief .peaks文件读取器
+ * 通过mmap只读映射整个文件，打开耗时与音频长度无关
+ */
+class PeakPyramidReader {
+public:
+    PeakPyramidReader() = default;
+    ~PeakPyramidReader();
+
+    PeakPyramidReader(const PeakPyramidReader&) = delete;
+    PeakPyramidReader& operator=(const PeakPyramidReader&) = delete;
+
+    /**
+     * @brief 映射并校验文件
+     * @return 是否是有效的.peaks文件
+     */
+    bool open(const char* path);
+
+    void close();
+
+    /**
+     * @brief 查询[startFrame, endFrame)区间的波形
+     * 区间均分为pointCount段，自动选取每个bin不超过一段长度的最粗一层，每段只需合并少量bin。
+     * @param out 输出，布局为[点][声道]{min, max, rms}，共pointCount * channelCount * 3个float
+     * @return 输出的点数
+     */
+    size_t query(int64_t startFrame, int64_t endFrame, int32_t pointCount, float* out) const;
+
+    int32_t sampleRate() const { return header_ ? static_cast<int32_t>(header_->sampleRate) : 0; }
+    int32_t channelCount() const { return header_ ? header_->channelCount : 0; }
+    int32_t levelCount() const { return header_ ? header_->levelCount : 0; }
+    int32_t baseFramesPerBin() const { return header_ ? static_cast<int32_t>(header_->baseFramesPerBin) : 0; }
+    int64_t totalFrames() const { return header_ ? header_->totalFrames : 0; }
+
+private:
+    const uint8_t* mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+    const PeaksFileHeader* header_ = nullptr;
+    const PeaksLevelEntry* levels_ = nullptr;
+};
+
+/**
+ * @brief 从裸PCM或WAV文件的数据区构建.peaks文件
+ * @param dataOffset PCM数据起始偏移
+ * @param dataSize PCM数据长度，-1表示到文件末尾
+ * @return 是否成功
+ */
+bool buildPeakPyramidFromPcm(const char* pcmPath, int64_t dataOffset, int64_t dataSize,
+                             int32_t sampleRate, int32_t channelCount, bool isFloat,
+                             const char* peaksPath);
+
+#endif // PEAK_PYRAMID_H
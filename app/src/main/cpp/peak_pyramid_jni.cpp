@@ -0,0 +1,122 @@
+#include <jni.h>
+#include <algorithm>
+#include <vector>
+#include "peak_pyramid.h"
+#include "AudioTranscode.h"
+#include "logging.h"
+
+#define LOG_TAG "PeakPyramidJNI"
+
+namespace {
+
+// Kotlin侧持有的读取器及查询暂存区
+struct NativePeaks {
+    PeakPyramidReader reader;
+    std::vector<float> points;
+};
+
+class ScopedUtfChars {
+public:
+    ScopedUtfChars(JNIEnv* env, jstring string)
+        : env_(env), string_(string), chars_(string ? env->GetStringUTFChars(string, nullptr) : nullptr) {}
+    ~ScopedUtfChars() {
+        if (chars_) {
+            env_->ReleaseStringUTFChars(string_, chars_);
+        }
+    }
+    const char* c_str() const { return chars_; }
+
+private:
+    JNIEnv* env_;
+    jstring string_;
+    const char* chars_;
+};
+
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeOpen(JNIEnv* env, jclass clazz, jstring path) {
+    ScopedUtfChars peaksPath(env, path);
+    if (!peaksPath.c_str()) {
+        return 0;
+    }
+    auto* peaks = new NativePeaks();
+    if (!peaks->reader.open(peaksPath.c_str())) {
+        delete peaks;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(peaks);
+}
+
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeClose(JNIEnv* env, jclass clazz, jlong handle) {
+    delete reinterpret_cast<NativePeaks*>(handle);
+}
+
+// info依次为：采样率、声道数、总帧数、层数、第0层每个bin的帧数
+JNIEXPORT void JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeGetInfo(JNIEnv* env, jclass clazz, jlong handle, jlongArray info) {
+    auto* peaks = reinterpret_cast<NativePeaks*>(handle);
+    if (!peaks || env->GetArrayLength(info) < 5) {
+        return;
+    }
+    const PeakPyramidReader& reader = peaks->reader;
+    const jlong values[5] = {
+            reader.sampleRate(),
+            reader.channelCount(),
+            reader.totalFrames(),
+            reader.levelCount(),
+            reader.baseFramesPerBin(),
+    };
+    env->SetLongArrayRegion(info, 0, 5, values);
+}
+
+// 查询结果按[点][声道]{min, max, rms}写入out，返回点数
+JNIEXPORT jint JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeQuery(
+        JNIEnv* env, jclass clazz, jlong handle, jlong startFrame, jlong endFrame, jint pointCount, jfloatArray out) {
+    auto* peaks = reinterpret_cast<NativePeaks*>(handle);
+    if (!peaks || pointCount <= 0) {
+        return 0;
+    }
+    const size_t valuesPerPoint = static_cast<size_t>(peaks->reader.channelCount()) * 3;
+    const auto capacity = static_cast<jint>(static_cast<size_t>(env->GetArrayLength(out)) / valuesPerPoint);
+    const jint count = std::min(pointCount, capacity);
+    if (count <= 0) {
+        return 0;
+    }
+    peaks->points.resize(static_cast<size_t>(count) * valuesPerPoint);
+    // 点数由调用方按像素给出，区间按原点数均分，容量不足时只返回前面的点
+    const int64_t end = startFrame + (endFrame - startFrame) * count / pointCount;
+    const size_t written = peaks->reader.query(startFrame, end, count, peaks->points.data());
+    env->SetFloatArrayRegion(out, 0, static_cast<jsize>(written * valuesPerPoint), peaks->points.data());
+    return static_cast<jint>(written);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeBuildFromPcm(
+        JNIEnv* env, jclass clazz, jstring pcmPath, jstring peaksPath, jlong dataOffset, jlong dataSize,
+        jint sampleRate, jint channelCount, jboolean isFloat) {
+    ScopedUtfChars input(env, pcmPath);
+    ScopedUtfChars output(env, peaksPath);
+    if (!input.c_str() || !output.c_str()) {
+        return JNI_FALSE;
+    }
+    return buildPeakPyramidFromPcm(input.c_str(), dataOffset, dataSize, sampleRate, channelCount,
+                                   isFloat, output.c_str()) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL
+Java_me_rjy_oboe_record_demo_PeakPyramid_nativeBuildFromMedia(
+        JNIEnv* env, jclass clazz, jstring inputPath, jstring peaksPath) {
+    ScopedUtfChars input(env, inputPath);
+    ScopedUtfChars output(env, peaksPath);
+    if (!input.c_str() || !output.c_str()) {
+        return JNI_FALSE;
+    }
+    return build_peak_pyramid_from_media(input.c_str(), output.c_str()) ? JNI_TRUE : JNI_FALSE;
+}
+
+}
@@ -0,0 +1,103 @@
+#include "peak_pyramid_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include "logging.h"
+
+#define LOG_TAG "PeakPyramidSink"
+
+constexpr size_t PeakPyramidSink::kQueueBins;
+constexpr size_t PeakPyramidSink::kStagingBins;
+
+PeakPyramidSink::PeakPyramidSink(std::string peaksPath, int32_t sampleRate, int32_t channelCount, bool isFloat)
+    : peaksPath_(std::move(peaksPath))
+    , bytesPerFrame_(channelCount * (isFloat ? sizeof(float) : sizeof(int16_t)))
+    , accumulator_(channelCount, isFloat, kDefaultFramesPerPeakBin)
+    , staging_()
+    , queue_(kQueueBins * sizeof(PeakBinStats))
+    , builder_(sampleRate, channelCount, isFloat)
+    , closing_(false)
+    , droppedBins_(0) {
+    sem_init(&binsReady_, 0, 0);
+}
+
+PeakPyramidSink::~PeakPyramidSink() {
+    close();
+    sem_destroy(&binsReady_);
+}
+
+bool PeakPyramidSink::start() {
+    // 旧的.peaks与新录音不对应，先删掉，录音中途异常退出时播放端会重新构建
+    unlink(peaksPath_.c_str());
+    closing_ = false;
+    droppedBins_ = 0;
+    builderThread_ = std::make_unique<std::thread>(&PeakPyramidSink::builderThreadFunc, this);
+    return true;
+}
+
+void PeakPyramidSink::write(const void* data, size_t size) {
+    if (!builderThread_) {
+        return;
+    }
+    // 按暂存区大小分段，每段产生的bin不会超过kStagingBins
+    const auto* pcm = static_cast<const uint8_t*>(data);
+    const int32_t maxFrames = static_cast<int32_t>(kStagingBins - 1) * accumulator_.framesPerBin();
+    int32_t remaining = static_cast<int32_t>(size / bytesPerFrame_);
+    while (remaining > 0) {
+        const int32_t frames = std::min(remaining, maxFrames);
+        const size_t count = accumulator_.process(pcm, frames, staging_, kStagingBins);
+        if (count > 0) {
+            if (queue_.write(staging_, count * sizeof(PeakBinStats))) {
+                sem_post(&binsReady_);
+            } else {
+                droppedBins_.fetch_add(static_cast<int64_t>(count), std::memory_order_relaxed);
+            }
+        }
+        pcm += static_cast<size_t>(frames) * bytesPerFrame_;
+        remaining -= frames;
+    }
+}
+
+void PeakPyramidSink::close() {
+    if (!builderThread_) {
+        return;
+    }
+    // 生产者已停止，最后不足一个bin的数据也交给构建线程
+    PeakBinStats tail{};
+    if (accumulator_.flush(tail) && !queue_.write(&tail, sizeof(tail))) {
+        droppedBins_.fetch_add(1, std::memory_order_relaxed);
+    }
+    closing_ = true;
+    sem_post(&binsReady_);
+    if (builderThread_->joinable()) {
+        builderThread_->join();
+    }
+    builderThread_.reset();
+
+    if (droppedBins_.load() > 0) {
+        LOGW("peak queue overflow, %lld bins dropped, %s not written",
+             static_cast<long long>(droppedBins_.load()), peaksPath_.c_str());
+        return;
+    }
+    builder_.finish(peaksPath_);
+}
+
+void PeakPyramidSink::builderThreadFunc() {
+    while (true) {
+        if (sem_wait(&binsReady_) != 0 && errno == EINTR) {
+            continue;
+        }
+        const bool closing = closing_;
+        drainQueue();
+        if (closing) {
+            break;
+        }
+    }
+}
+
+void PeakPyramidSink::drainQueue() {
+    PeakBinStats bin{};
+    while (queue_.read(&bin, sizeof(bin)) == sizeof(bin)) {
+        builder_.addBin(bin);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef PEAK_PYRAMID_SINK_H
+#define PEAK_PYRAMID_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <semaphore.h>
+#include "audio_sink.h"
+#include "peak_pyramid.h"
+#include "spsc_ring_buffer.h"
+
+/**
+ * @brief 录音时增量构建.peaks波形金字塔
+ * 回调线程只把PCM归并成第0层bin（每256帧一个，几十字节），通过无锁队列交给构建线程；
+ * 构建线程逐层合并，录音结束时写出.peaks文件，打开录音时无需再解码整个文件。
+ * 队列溢出会导致bin缺失、时间轴错位，此时放弃写出，由播放端按需重新构建。
+ */
+class PeakPyramidSink : public AudioSink {
+public:
+    /**
+     * @brief 构造函数
+     * @param peaksPath .peaks文件路径
+     * @param sampleRate 采样率
+     * @param channelCount 声道数
+     * @param isFloat 输入是否为32位浮点
+     */
+    PeakPyramidSink(std::string peaksPath, int32_t sampleRate, int32_t channelCount, bool isFloat);
+
+    ~PeakPyramidSink() override;
+
+    PeakPyramidSink(const PeakPyramidSink&) = delete;
+    PeakPyramidSink& operator=(const PeakPyramidSink&) = delete;
+
+    bool start() override;
+
+    void write(const void* data, size_t size) override;
+
+    void close() override;
+
+private:
+    static constexpr size_t kQueueBins = 4096;   // 48kHz下约20秒
+    static constexpr size_t kStagingBins = 16;
+
+    void builderThreadFunc();
+    void drainQueue();
+
+    const std::string peaksPath_;
+    const size_t bytesPerFrame_;
+
+    PeakBinAccumulator accumulator_;     // 仅回调线程访问
+    PeakBinStats staging_[kStagingBins];
+    SpscRingBuffer queue_;
+    sem_t binsReady_;
+    PeakPyramidBuilder builder_;         // 仅构建线程访问
+
+    std::unique_ptr<std::thread> builderThread_;
+    std::atomic<bool> closing_;
+    std::atomic<int64_t> droppedBins_;
+};
+
+#endif // PEAK_PYRAMID_SINK_H
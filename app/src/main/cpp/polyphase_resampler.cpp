@@ -0,0 +1,221 @@
+#include "polyphase_resampler.h"
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define POLYPHASE_RESAMPLER_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define POLYPHASE_RESAMPLER_SSE 1
+#endif
+
+constexpr int32_t PolyphaseResampler::kTaps;
+constexpr int32_t PolyphaseResampler::kMaxPhases;
+constexpr size_t PolyphaseResampler::kBlockFrames;
+
+namespace {
+
+// Kaiser窗参数，约80dB阻带衰减
+constexpr double kKaiserBeta = 8.0;
+// 截止频率相对于较低一侧奈奎斯特频率的比例，留出过渡带
+constexpr double kCutoffScale = 0.95;
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double q = x * x / 4.0;
+    for (int k = 1; k < 50; ++k) {
+        term *= q / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// 定长点积：长度为8的倍数，SIMD循环没有尾部
+template <size_t N>
+float dot(const float* a, const float* b) {
+    static_assert(N % 8 == 0, "dot length must be a multiple of 8");
+#if defined(POLYPHASE_RESAMPLER_NEON)
+    float32x4_t v0 = vdupq_n_f32(0.0f), v1 = vdupq_n_f32(0.0f);
+    for (size_t i = 0; i < N; i += 8) {
+        v0 = vmlaq_f32(v0, vld1q_f32(a + i), vld1q_f32(b + i));
+        v1 = vmlaq_f32(v1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(v0, v1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(POLYPHASE_RESAMPLER_SSE)
+    __m128 v0 = _mm_setzero_ps(), v1 = _mm_setzero_ps();
+    for (size_t i = 0; i < N; i += 8) {
+        v0 = _mm_add_ps(v0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        v1 = _mm_add_ps(v1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(v0, v1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    float d = 0.0f;
+    for (size_t i = 0; i < N; ++i) {
+        d += a[i] * b[i];
+    }
+    return d;
+#endif
+}
+
+void updateMax(std::atomic<int64_t>& target, int64_t value) {
+    int64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(int32_t inputRate, int32_t outputRate, int32_t channelCount, bool isFloat)
+        : inputRate_(inputRate),
+          outputRate_(outputRate),
+          channelCount_(channelCount),
+          isFloat_(isFloat),
+          bytesPerFrame_(static_cast<size_t>(channelCount) * (isFloat ? sizeof(float) : sizeof(int16_t))),
+          windowCapacity_(kTaps + kBlockFrames),
+          windowFrames_(0),
+          inputIndex_(0),
+          phase_(0),
+          callCount_(0),
+          totalNanos_(0),
+          maxNanos_(0),
+          maxLoadPermille_(0) {
+    const int32_t g = std::gcd(inputRate, outputRate);
+    phases_ = outputRate / g;
+    step_ = inputRate / g;
+    if (phases_ > kMaxPhases) {
+        phases_ = kMaxPhases;
+        step_ = static_cast<int32_t>(std::lround(static_cast<double>(inputRate) * kMaxPhases / outputRate));
+    }
+    buildFilter();
+    window_.resize(windowCapacity_ * channelCount_);
+    readBuffer_.resize(kBlockFrames * bytesPerFrame_);
+    reset();
+}
+
+void PolyphaseResampler::buildFilter() {
+    // 降采样时截止频率随输出奈奎斯特频率降低，抑制混叠
+    const double cutoff = std::min(1.0, static_cast<double>(outputRate_) / inputRate_) * kCutoffScale;
+    const double half = kTaps / 2.0;
+    const double i0Beta = besselI0(kKaiserBeta);
+    coefficients_.assign(static_cast<size_t>(phases_) * kTaps, 0.0f);
+    std::vector<double> taps(kTaps);
+    for (int32_t p = 0; p < phases_; ++p) {
+        // 第p相对应的输出时刻位于窗口第(kTaps/2 - 1)帧之后p/L帧
+        double sum = 0.0;
+        for (int32_t k = 0; k < kTaps; ++k) {
+            const double d = k - (half - 1.0) - static_cast<double>(p) / phases_;
+            const double x = M_PI * cutoff * d;
+            const double sinc = d == 0.0 ? 1.0 : std::sin(x) / x;
+            const double r = d / half;
+            const double window = r * r < 1.0 ? besselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / i0Beta : 0.0;
+            taps[k] = cutoff * sinc * window;
+            sum += taps[k];
+        }
+        // 每相归一化为单位直流增益，避免相位之间的增益起伏
+        float* dst = coefficients_.data() + static_cast<size_t>(p) * kTaps;
+        for (int32_t k = 0; k < kTaps; ++k) {
+            dst[k] = static_cast<float>(taps[k] / sum);
+        }
+    }
+}
+
+void PolyphaseResampler::reset() {
+    std::fill(window_.begin(), window_.end(), 0.0f);
+    // 预置半个滤波器长度的静音，使第一个输出帧对准第一个输入帧
+    windowFrames_ = kTaps / 2 - 1;
+    inputIndex_ = 0;
+    phase_ = 0;
+}
+
+void PolyphaseResampler::compactWindow() {
+    if (inputIndex_ == 0) {
+        return;
+    }
+    const size_t remaining = windowFrames_ - inputIndex_;
+    for (int32_t ch = 0; ch < channelCount_; ++ch) {
+        float* plane = window_.data() + ch * windowCapacity_;
+        std::memmove(plane, plane + inputIndex_, remaining * sizeof(float));
+    }
+    windowFrames_ = remaining;
+    inputIndex_ = 0;
+}
+
+void PolyphaseResampler::appendInput(const uint8_t* data, size_t frames) {
+    // compactWindow之后剩余不足kTaps帧，容量足够放下一次读取的kBlockFrames帧
+    for (int32_t ch = 0; ch < channelCount_; ++ch) {
+        float* plane = window_.data() + ch * windowCapacity_ + windowFrames_;
+        if (isFloat_) {
+            const auto* src = reinterpret_cast<const float*>(data) + ch;
+            for (size_t i = 0; i < frames; ++i) {
+                plane[i] = src[i * channelCount_];
+            }
+        } else {
+            const auto* src = reinterpret_cast<const int16_t*>(data) + ch;
+            for (size_t i = 0; i < frames; ++i) {
+                plane[i] = src[i * channelCount_] * (1.0f / 32768.0f);
+            }
+        }
+    }
+    windowFrames_ += frames;
+}
+
+size_t PolyphaseResampler::filter(uint8_t* dst, size_t frames) {
+    size_t produced = 0;
+    while (produced < frames && inputIndex_ + kTaps <= windowFrames_) {
+        const float* coeff = coefficients_.data() + static_cast<size_t>(phase_) * kTaps;
+        for (int32_t ch = 0; ch < channelCount_; ++ch) {
+            const float* x = window_.data() + ch * windowCapacity_ + inputIndex_;
+            const float y = dot<kTaps>(x, coeff);
+            const size_t sample = produced * channelCount_ + ch;
+            if (isFloat_) {
+                reinterpret_cast<float*>(dst)[sample] = y;
+            } else {
+                const float scaled = std::min(32767.0f, std::max(-32768.0f, y * 32768.0f));
+                reinterpret_cast<int16_t*>(dst)[sample] = static_cast<int16_t>(std::lrint(scaled));
+            }
+        }
+        ++produced;
+        phase_ += step_;
+        inputIndex_ += phase_ / phases_;
+        phase_ %= phases_;
+    }
+    return produced;
+}
+
+void PolyphaseResampler::recordCost(std::chrono::steady_clock::duration cost, size_t frames) {
+    const int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(cost).count();
+    callCount_.fetch_add(1, std::memory_order_relaxed);
+    totalNanos_.fetch_add(nanos, std::memory_order_relaxed);
+    updateMax(maxNanos_, nanos);
+    if (frames > 0) {
+        // 本次输出对应的播放时长，滤波耗时占它的比例就是回调预算中重采样的占用
+        const double budgetNanos = static_cast<double>(frames) * 1e9 / outputRate_;
+        const auto permille = static_cast<int32_t>(nanos * 1000.0 / budgetNanos);
+        int32_t current = maxLoadPermille_.load(std::memory_order_relaxed);
+        while (permille > current &&
+               !maxLoadPermille_.compare_exchange_weak(current, permille, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+ResamplerStats PolyphaseResampler::getStats() const {
+    ResamplerStats stats;
+    stats.callCount = callCount_.load(std::memory_order_relaxed);
+    if (stats.callCount > 0) {
+        stats.avgMicros = totalNanos_.load(std::memory_order_relaxed) / 1000.0 / stats.callCount;
+    }
+    stats.maxMicros = maxNanos_.load(std::memory_order_relaxed) / 1000.0;
+    stats.maxLoadPercent = maxLoadPermille_.load(std::memory_order_relaxed) / 10.0;
+    return stats;
+}
@@ -0,0 +1,130 @@
+#ifndef POLYPHASE_RESAMPLER_H
+#define POLYPHASE_RESAMPLER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 重采样耗时统计
+ */
+struct ResamplerStats {
+    int64_t callCount = 0;     // render调用次数
+    double avgMicros = 0;      // 每次render中滤波本身的平均耗时（不含读取输入）
+    double maxMicros = 0;
+    double maxLoadPercent = 0; // 滤波耗时占本次输出时长的最大比例
+};
+
+/**
+ * @brief 多相FIR重采样器
+ * 输入输出采样率之比约分为L/M，原型滤波器为Kaiser窗sinc，分解成L个相位、每相kTaps个系数，构造时一次算好。
+ * 每个输出帧只做一次kTaps点的点积（NEON/SSE），计算量与输出帧数成正比，与比例无关，回调中的耗时有上界。
+ * 约分后相位数超过kMaxPhases时（少见的采样率组合）按kMaxPhases近似，速度误差在万分之一量级。
+ * 输入按声道拆成平面存放，点积访问连续内存；所有缓冲区在构造时分配。
+ */
+class PolyphaseResampler {
+public:
+    static constexpr int32_t kTaps = 32;
+    static constexpr int32_t kMaxPhases = 1024;
+
+    /**
+     * @brief 构造函数
+     * @param inputRate 输入采样率
+     * @param outputRate 输出采样率
+     * @param channelCount 声道数（1或2）
+     * @param isFloat 输入输出是否为32位浮点，否则为16位整数
+     */
+    PolyphaseResampler(int32_t inputRate, int32_t outputRate, int32_t channelCount, bool isFloat);
+
+    PolyphaseResampler(const PolyphaseResampler&) = delete;
+    PolyphaseResampler& operator=(const PolyphaseResampler&) = delete;
+
+    /**
+     * @brief 清空历史数据（从头播放前调用）
+     */
+    void reset();
+
+    /**
+     * @brief 生成输出（实时安全）
+     * @param out 输出缓冲区，格式与输入相同
+     * @param frames 需要的帧数
+     * @param reader 输入回调：size_t(void* dst, size_t maxFrames)，返回读到的帧数，0表示暂时没有数据
+     * @return 实际输出的帧数，输入不足时小于frames
+     */
+    template <typename Reader>
+    size_t render(void* out, size_t frames, Reader&& reader) {
+        const auto begin = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration readTime{0};
+        auto* dst = static_cast<uint8_t*>(out);
+        size_t produced = 0;
+        while (produced < frames) {
+            // 当前输出帧需要的输入窗口不完整时先补充输入
+            if (inputIndex_ + kTaps > windowFrames_) {
+                compactWindow();
+                const auto readBegin = std::chrono::steady_clock::now();
+                const size_t count = reader(readBuffer_.data(), kBlockFrames);
+                readTime += std::chrono::steady_clock::now() - readBegin;
+                if (count == 0) {
+                    break;
+                }
+                appendInput(readBuffer_.data(), count);
+                continue;
+            }
+            produced += filter(dst + produced * bytesPerFrame_, frames - produced);
+        }
+        recordCost(std::chrono::steady_clock::now() - begin - readTime, produced);
+        return produced;
+    }
+
+    /**
+     * @brief 已读入但还没有输出的输入帧数（回调线程调用）
+     */
+    double pendingInputFrames() const {
+        return static_cast<double>(windowFrames_) - static_cast<double>(inputIndex_) - (kTaps / 2 - 1) -
+               static_cast<double>(phase_) / phases_;
+    }
+
+    ResamplerStats getStats() const;
+
+    int32_t inputRate() const { return inputRate_; }
+    int32_t outputRate() const { return outputRate_; }
+
+private:
+    // 每次从上游读取的最大帧数
+    static constexpr size_t kBlockFrames = 256;
+
+    void buildFilter();
+    void compactWindow();
+    void appendInput(const uint8_t* data, size_t frames);
+    size_t filter(uint8_t* dst, size_t frames);
+    void recordCost(std::chrono::steady_clock::duration cost, size_t frames);
+
+    const int32_t inputRate_;
+    const int32_t outputRate_;
+    const int32_t channelCount_;
+    const bool isFloat_;
+    const size_t bytesPerFrame_;
+    int32_t phases_;   // L
+    int32_t step_;     // M：每个输出帧前进M/L个输入帧
+
+    std::vector<float> coefficients_;  // [phases_][kTaps]
+
+    // 平面输入窗口：每个声道一段，容量kTaps + kBlockFrames
+    std::vector<float> window_;
+    size_t windowCapacity_;
+    size_t windowFrames_;   // 窗口中的有效帧数
+    size_t inputIndex_;     // 当前输出帧对应窗口的起点
+    int32_t phase_;         // 当前输出帧的相位，[0, phases_)
+    std::vector<uint8_t> readBuffer_;
+
+    // 耗时统计（回调写，其它线程读）
+    std::atomic<int64_t> callCount_;
+    std::atomic<int64_t> totalNanos_;
+    std::atomic<int64_t> maxNanos_;
+    std::atomic<int32_t> maxLoadPermille_;
+};
+
+#endif // POLYPHASE_RESAMPLER_H
@@ -0,0 +1,248 @@
+#include "preroll_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include "logging.h"
+
+#define LOG_TAG "PrerollSink"
+
+// 历史缓冲区在预录时长之外的余量，吸收写线程把历史交给事件文件期间新到的数据
+static constexpr int32_t kHeadroomMs = 2000;
+
+constexpr int64_t PrerollSink::kNoEvent;
+constexpr int64_t PrerollSink::kEventOpen;
+constexpr size_t PrerollSink::kMaxWriteChunk;
+
+PrerollSink::PrerollSink(const char* filePath, int32_t sampleRate, int32_t channelCount, bool isFloat,
+                         const PrerollOptions& options, SinkFactory factory)
+    : filePath_(filePath)
+    , isFloat_(isFloat)
+    , bytesPerFrame_(channelCount * (isFloat ? sizeof(float) : sizeof(int16_t)))
+    , prerollBytes_(static_cast<uint64_t>(sampleRate) * std::max(options.prerollMs, 0) / 1000 * bytesPerFrame_)
+    , postRollFrames_(static_cast<int64_t>(sampleRate) * std::max(options.postRollMs, 0) / 1000)
+    , triggerLevel_(options.triggerLevel)
+    , factory_(std::move(factory))
+    , history_(prerollBytes_ + static_cast<size_t>(sampleRate) * kHeadroomMs / 1000 * bytesPerFrame_)
+    , capturing_(false)
+    , holdFrames_(0)
+    , retainFrom_(HistoryRingBuffer::kNoRetain)
+    , lastEventEnd_(0)
+    , eventStart_(0)
+    , eventEnd_(kNoEvent)
+    , readIndex_(0)
+    , triggerRequested_(false)
+    , eventActive_(false)
+    , nextEventIndex_(1)
+    , closing_(false)
+    , eventCount_(0)
+    , capturedBytes_(0)
+    , droppedBytes_(0) {
+    sem_init(&dataReady_, 0, 0);
+}
+
+PrerollSink::~PrerollSink() {
+    close();
+    sem_destroy(&dataReady_);
+}
+
+bool PrerollSink::start() {
+    closing_ = false;
+    writerThread_ = std::make_unique<std::thread>(&PrerollSink::writerThreadFunc, this);
+    LOGI("pre-roll armed: history=%zu bytes, preroll=%llu bytes, postroll=%lld frames, level=%.3f",
+         history_.capacity(), static_cast<unsigned long long>(prerollBytes_),
+         static_cast<long long>(postRollFrames_), triggerLevel_);
+    return true;
+}
+
+void PrerollSink::write(const void* data, size_t size) {
+    if (!writerThread_) {
+        return;
+    }
+    const size_t frames = size / bytesPerFrame_;
+
+    bool fire = triggerRequested_.load(std::memory_order_relaxed)
+                && triggerRequested_.exchange(false, std::memory_order_acq_rel);
+    if (!fire && triggerLevel_ > 0.0f) {
+        fire = peakLevel(data, frames) >= triggerLevel_;
+    }
+    if (fire) {
+        holdFrames_ = postRollFrames_;
+        if (!capturing_) {
+            openEvent();
+        }
+    }
+
+    // 写线程读完上一个事件后恢复覆盖模式，否则保护尚未读走的数据
+    if (retainFrom_ != HistoryRingBuffer::kNoRetain) {
+        if (!capturing_ && eventEnd_.load(std::memory_order_acquire) == kNoEvent) {
+            retainFrom_ = HistoryRingBuffer::kNoRetain;
+        } else {
+            retainFrom_ = std::max<uint64_t>(retainFrom_, readIndex_.load(std::memory_order_acquire));
+        }
+    }
+    if (!history_.write(data, size, retainFrom_)) {
+        droppedBytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+    }
+
+    if (capturing_) {
+        holdFrames_ -= static_cast<int64_t>(frames);
+        if (holdFrames_ <= 0) {
+            closeEvent();
+        } else {
+            sem_post(&dataReady_);
+        }
+    }
+}
+
+void PrerollSink::close() {
+    if (!writerThread_) {
+        return;
+    }
+    // 生产者已停止，进行中的事件在当前位置结束
+    if (capturing_) {
+        closeEvent();
+    }
+    closing_ = true;
+    sem_post(&dataReady_);
+    if (writerThread_->joinable()) {
+        writerThread_->join();
+    }
+    writerThread_.reset();
+
+    const PrerollStats stats = getStats();
+    LOGI("pre-roll closed: events=%d captured=%lld bytes dropped=%lld bytes",
+         stats.eventCount, static_cast<long long>(stats.capturedBytes),
+         static_cast<long long>(stats.droppedBytes));
+}
+
+PrerollStats PrerollSink::getStats() const {
+    PrerollStats stats;
+    stats.eventCount = eventCount_.load(std::memory_order_relaxed);
+    stats.capturedBytes = capturedBytes_.load(std::memory_order_relaxed);
+    stats.droppedBytes = droppedBytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+float PrerollSink::peakLevel(const void* data, size_t frames) const {
+    const size_t samples = frames * (bytesPerFrame_ / (isFloat_ ? sizeof(float) : sizeof(int16_t)));
+    float peak = 0.0f;
+    if (isFloat_) {
+        const auto* pcm = static_cast<const float*>(data);
+        for (size_t i = 0; i < samples; ++i) {
+            peak = std::max(peak, std::fabs(pcm[i]));
+        }
+    } else {
+        const auto* pcm = static_cast<const int16_t*>(data);
+        int32_t maxAbs = 0;
+        for (size_t i = 0; i < samples; ++i) {
+            maxAbs = std::max(maxAbs, std::abs(static_cast<int32_t>(pcm[i])));
+        }
+        peak = maxAbs / 32768.0f;
+    }
+    return peak;
+}
+
+void PrerollSink::openEvent() {
+    capturing_ = true;
+
+    int64_t end = eventEnd_.load(std::memory_order_acquire);
+    if (end != kNoEvent && eventEnd_.compare_exchange_strong(end, kEventOpen, std::memory_order_acq_rel)) {
+        // 上一个事件还没写完，直接延续，中间的数据一直受保护
+        return;
+    }
+
+    // 事件起点为当前位置往前预录时长，但不早于上一个事件的终点，避免重复写出
+    const uint64_t writeIndex = history_.writeIndex();
+    uint64_t start = writeIndex > prerollBytes_ ? writeIndex - prerollBytes_ : 0;
+    start = std::max(start, lastEventEnd_);
+    retainFrom_ = start;
+    eventStart_.store(static_cast<int64_t>(start), std::memory_order_relaxed);
+    eventEnd_.store(kEventOpen, std::memory_order_release);
+    eventCount_.fetch_add(1, std::memory_order_relaxed);
+    sem_post(&dataReady_);
+}
+
+void PrerollSink::closeEvent() {
+    capturing_ = false;
+    lastEventEnd_ = history_.writeIndex();
+    eventEnd_.store(static_cast<int64_t>(lastEventEnd_), std::memory_order_release);
+    sem_post(&dataReady_);
+}
+
+void PrerollSink::writerThreadFunc() {
+    while (true) {
+        if (sem_wait(&dataReady_) != 0 && errno == EINTR) {
+            continue;
+        }
+        const bool closing = closing_;
+        drain();
+        if (closing) {
+            break;
+        }
+    }
+    if (eventSink_) {
+        eventSink_->close();
+        eventSink_.reset();
+    }
+}
+
+void PrerollSink::drain() {
+    while (true) {
+        int64_t end = eventEnd_.load(std::memory_order_acquire);
+        if (end == kNoEvent) {
+            return;
+        }
+        if (!eventActive_) {
+            // 新事件：创建输出文件，从事件起点开始读
+            const std::string path = eventPath(nextEventIndex_++);
+            eventSink_ = factory_(path);
+            if (eventSink_ && !eventSink_->start()) {
+                LOGE("Failed to start event sink: %s", path.c_str());
+                eventSink_.reset();
+            }
+            readIndex_.store(static_cast<uint64_t>(eventStart_.load(std::memory_order_relaxed)),
+                             std::memory_order_release);
+            eventActive_ = true;
+            LOGI("event started: %s", path.c_str());
+        }
+
+        const uint64_t readIndex = readIndex_.load(std::memory_order_relaxed);
+        const uint64_t limit = end == kEventOpen ? history_.writeIndex() : static_cast<uint64_t>(end);
+        if (readIndex < limit) {
+            size_t size = 0;
+            const uint8_t* data = history_.peek(readIndex, size);
+            size = std::min<size_t>({size, static_cast<size_t>(limit - readIndex), kMaxWriteChunk});
+            if (eventSink_) {
+                eventSink_->write(data, size);
+            }
+            readIndex_.store(readIndex + size, std::memory_order_release);
+            capturedBytes_.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+            continue;
+        }
+        if (end == kEventOpen) {
+            return;
+        }
+
+        // 读到终点后结束事件；CAS失败说明回调在此期间再次触发，事件被延续，继续读
+        if (eventEnd_.compare_exchange_strong(end, kNoEvent, std::memory_order_acq_rel)) {
+            if (eventSink_) {
+                eventSink_->close();
+                eventSink_.reset();
+            }
+            eventActive_ = false;
+            LOGI("event finished");
+        }
+    }
+}
+
+std::string PrerollSink::eventPath(int32_t index) const {
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "_event%03d", index);
+    const size_t slash = filePath_.find_last_of('/');
+    const size_t dot = filePath_.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return filePath_ + suffix;
+    }
+    return filePath_.substr(0, dot) + suffix + filePath_.substr(dot);
+}
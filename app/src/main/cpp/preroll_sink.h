@@ -0,0 +1,136 @@
+#ifndef PREROLL_SINK_H
+#define PREROLL_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <semaphore.h>
+#include "audio_sink.h"
+#include "history_ring_buffer.h"
+
+/**
+ * @brief 预录配置
+ */
+struct PrerollOptions {
+    int32_t prerollMs = 10000;    // 触发前保留的历史时长
+    int32_t postRollMs = 3000;    // 最后一次触发后继续录制的时长
+    float triggerLevel = 0.0f;    // 自动触发的峰值电平（线性，0~1），0表示只能手动触发
+};
+
+/**
+ * @brief 预录统计信息
+ */
+struct PrerollStats {
+    int32_t eventCount = 0;       // 已开始的事件数
+    int64_t capturedBytes = 0;    // 已交给事件文件的字节数
+    int64_t droppedBytes = 0;     // 事件进行中写线程跟不上导致丢弃的字节数
+};
+
+/**
+ * @brief 预录（回溯录音）
+ * 平时回调只把PCM写入预分配的历史环形缓冲区，覆盖最旧的数据，不产生任何文件I/O。
+ * 手动触发或峰值超过阈值时，回调把"当前位置 - 预录时长"标记为事件起点并停止覆盖其后的数据；
+ * 写线程从起点开始把历史和后续的实时数据连续交给事件文件，历史与实时数据在同一个缓冲区中，天然无缝。
+ * 最后一次触发后postRollMs结束事件，写线程写完剩余数据后关闭文件。
+ * 每个事件单独保存为"<文件名>_eventNNN.<扩展名>"，事件结束前再次触发会延续当前事件。
+ */
+class PrerollSink : public AudioSink {
+public:
+    /**
+     * @brief 按事件文件路径创建实际的输出，在写线程中调用，需能接收预录时长的突发数据
+     */
+    using SinkFactory = std::function<std::unique_ptr<AudioSink>(const std::string& path)>;
+
+    /**
+     * @brief 构造函数
+     * @param filePath 录音文件路径，事件文件在此基础上加序号
+     * @param sampleRate 采样率
+     * @param channelCount 声道数
+     * @param isFloat 输入是否为32位浮点
+     * @param options 预录配置
+     * @param factory 事件输出的创建函数
+     */
+    PrerollSink(const char* filePath, int32_t sampleRate, int32_t channelCount, bool isFloat,
+                const PrerollOptions& options, SinkFactory factory);
+
+    ~PrerollSink() override;
+
+    PrerollSink(const PrerollSink&) = delete;
+    PrerollSink& operator=(const PrerollSink&) = delete;
+
+    bool start() override;
+
+    /**
+     * @brief 写入PCM（音频回调中调用），顺带检测电平触发
+     */
+    void write(const void* data, size_t size) override;
+
+    /**
+     * @brief 结束未完成的事件，写完剩余数据并停止写线程
+     */
+    void close() override;
+
+    /**
+     * @brief 手动触发（任意线程调用），在下一次回调中生效
+     */
+    void trigger() { triggerRequested_.store(true, std::memory_order_release); }
+
+    /**
+     * @brief 获取统计信息（任意线程调用）
+     */
+    PrerollStats getStats() const;
+
+private:
+    // eventEnd_的取值：没有事件、事件进行中，其它值为已结束事件的终点
+    static constexpr int64_t kNoEvent = -1;
+    static constexpr int64_t kEventOpen = INT64_MAX;
+    static constexpr size_t kMaxWriteChunk = 256 * 1024;
+
+    float peakLevel(const void* data, size_t frames) const;
+    void openEvent();
+    void closeEvent();
+    void writerThreadFunc();
+    void drain();
+    std::string eventPath(int32_t index) const;
+
+    const std::string filePath_;
+    const bool isFloat_;
+    const size_t bytesPerFrame_;
+    const uint64_t prerollBytes_;
+    const int64_t postRollFrames_;
+    const float triggerLevel_;
+    const SinkFactory factory_;
+
+    HistoryRingBuffer history_;
+
+    // 回调线程私有状态
+    bool capturing_;
+    int64_t holdFrames_;
+    uint64_t retainFrom_;
+    uint64_t lastEventEnd_;
+
+    // 回调线程与写线程之间的事件边界
+    std::atomic<int64_t> eventStart_;
+    std::atomic<int64_t> eventEnd_;
+    std::atomic<uint64_t> readIndex_;
+    std::atomic<bool> triggerRequested_;
+
+    // 写线程私有状态
+    std::unique_ptr<AudioSink> eventSink_;
+    bool eventActive_;
+    int32_t nextEventIndex_;
+
+    sem_t dataReady_;
+    std::unique_ptr<std::thread> writerThread_;
+    std::atomic<bool> closing_;
+
+    // 统计
+    std::atomic<int32_t> eventCount_;
+    std::atomic<int64_t> capturedBytes_;
+    std::atomic<int64_t> droppedBytes_;
+};
+
+#endif // PREROLL_SINK_H
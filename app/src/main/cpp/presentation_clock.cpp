@@ -0,0 +1,129 @@
+#include "presentation_clock.h"
+#include <algorithm>
+
+constexpr int32_t PresentationClock::kSegments;
+
+PresentationClock::PresentationClock()
+    : sequence_(0)
+    , published_(0)
+    , anchorFrame_(0)
+    , anchorNanos_(0)
+    , sampleRate_(0)
+    , timestampValid_(false)
+    , latencyNanos_(0) {
+}
+
+void PresentationClock::reset() {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published_.store(0, std::memory_order_relaxed);
+    anchorFrame_.store(0, std::memory_order_relaxed);
+    anchorNanos_.store(0, std::memory_order_relaxed);
+    sampleRate_.store(0, std::memory_order_relaxed);
+    timestampValid_.store(false, std::memory_order_relaxed);
+    latencyNanos_.store(0, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void PresentationClock::publish(const Update& update) {
+    // 单写者：先把序号置为奇数，读取方看到奇数或前后序号不同时重试
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const int64_t index = published_.load(std::memory_order_relaxed);
+    Segment& segment = segments_[index % kSegments];
+    segment.streamFrame.store(update.streamFrame, std::memory_order_relaxed);
+    segment.sourceFrame.store(update.sourceFrame, std::memory_order_relaxed);
+    segment.sourcePerStream.store(update.sourcePerStream, std::memory_order_relaxed);
+    segment.itemIndex.store(update.itemIndex, std::memory_order_relaxed);
+    segment.totalFrames.store(update.totalFrames, std::memory_order_relaxed);
+    published_.store(index + 1, std::memory_order_relaxed);
+
+    anchorFrame_.store(update.anchorFrame, std::memory_order_relaxed);
+    anchorNanos_.store(update.anchorNanos, std::memory_order_relaxed);
+    sampleRate_.store(update.sampleRate, std::memory_order_relaxed);
+    timestampValid_.store(update.timestampValid, std::memory_order_relaxed);
+    // 输出延迟 = 已写入但在发布时刻还没有播出的帧
+    if (update.sampleRate > 0) {
+        const double presented = update.anchorFrame +
+                static_cast<double>(update.callbackNanos - update.anchorNanos) * update.sampleRate / 1e9;
+        const double pending = std::max(0.0, static_cast<double>(update.streamFrame) - presented);
+        latencyNanos_.store(static_cast<int64_t>(pending * 1e9 / update.sampleRate), std::memory_order_relaxed);
+    }
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+PresentationPosition PresentationClock::read(int64_t nowNanos) const {
+    struct SegmentCopy {
+        int64_t streamFrame;
+        int64_t sourceFrame;
+        double sourcePerStream;
+        int32_t itemIndex;
+        int64_t totalFrames;
+    };
+    SegmentCopy copies[kSegments];
+    int64_t published, anchorFrame, anchorNanos, latencyNanos;
+    int32_t sampleRate;
+    bool timestampValid;
+
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = sequence_.load(std::memory_order_acquire);
+        if (before & 1u) {
+            after = before + 1;
+            continue;
+        }
+        published = published_.load(std::memory_order_relaxed);
+        const int64_t first = std::max<int64_t>(0, published - kSegments);
+        for (int64_t i = first; i < published; ++i) {
+            const Segment& segment = segments_[i % kSegments];
+            SegmentCopy& copy = copies[i - first];
+            copy.streamFrame = segment.streamFrame.load(std::memory_order_relaxed);
+            copy.sourceFrame = segment.sourceFrame.load(std::memory_order_relaxed);
+            copy.sourcePerStream = segment.sourcePerStream.load(std::memory_order_relaxed);
+            copy.itemIndex = segment.itemIndex.load(std::memory_order_relaxed);
+            copy.totalFrames = segment.totalFrames.load(std::memory_order_relaxed);
+        }
+        anchorFrame = anchorFrame_.load(std::memory_order_relaxed);
+        anchorNanos = anchorNanos_.load(std::memory_order_relaxed);
+        sampleRate = sampleRate_.load(std::memory_order_relaxed);
+        timestampValid = timestampValid_.load(std::memory_order_relaxed);
+        latencyNanos = latencyNanos_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence_.load(std::memory_order_relaxed);
+    } while (before != after);
+
+    PresentationPosition position;
+    const int32_t count = static_cast<int32_t>(std::min<int64_t>(published, kSegments));
+    if (count == 0 || sampleRate <= 0) {
+        return position;
+    }
+    position.timestampValid = timestampValid;
+    position.latencyMs = latencyNanos / 1e6;
+
+    // 按时间戳外推当前播出的流帧号，不超过已写入的数据（欠载或播放结束时停在最后一帧）
+    const SegmentCopy& newest = copies[count - 1];
+    const double elapsed = static_cast<double>(nowNanos - anchorNanos) * sampleRate / 1e9;
+    const double presented = std::max(0.0, std::min(anchorFrame + elapsed, static_cast<double>(newest.streamFrame)));
+
+    // 找到第一段写完后累计帧数不小于presented的记录，播出的帧就在这一段中
+    int32_t found = count - 1;
+    while (found > 0 && copies[found - 1].streamFrame >= presented) {
+        --found;
+    }
+    const SegmentCopy& segment = copies[found];
+    int64_t frame = segment.sourceFrame -
+            static_cast<int64_t>((segment.streamFrame - presented) * segment.sourcePerStream);
+    frame = std::max<int64_t>(0, frame);
+    if (segment.totalFrames > 0) {
+        frame = std::min(frame, segment.totalFrames);
+        position.progress = static_cast<float>(frame) / segment.totalFrames;
+    }
+    position.frame = frame;
+    position.itemIndex = segment.itemIndex;
+    return position;
+}
@@ -0,0 +1,81 @@
+#ifndef PRESENTATION_CLOCK_H
+#define PRESENTATION_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 正在从扬声器播出的位置
+ */
+struct PresentationPosition {
+    int64_t frame = 0;          // 当前播出的帧在所属文件中的位置
+    int32_t itemIndex = 0;      // 所属的播放列表项
+    float progress = 0;         // frame / 该项总帧数
+    double latencyMs = 0;       // 估计的输出延迟：回调写入到播出的时间
+    bool timestampValid = false; // 是否基于流时间戳，false时按缓冲区大小估计
+};
+
+/**
+ * @brief 播出位置时钟
+ * 回调每次写完数据后发布一段记录：写入流的累计帧数、对应的文件位置和两者的换算比例（速度×采样率之比），
+ * 连同流时间戳（某一时刻播出的流帧号）。读取时按时间戳外推当前播出的流帧号，
+ * 在最近kSegments次回调的记录中找到它所在的一段，换算回文件位置，跳转、循环和切换播放列表项都按段区分。
+ * 发布和读取用seqlock同步：回调只做原子存储不会阻塞，读取方在发布过程中重试，都不加锁。
+ */
+class PresentationClock {
+public:
+    static constexpr int32_t kSegments = 32;
+
+    /**
+     * @brief 一次回调发布的数据
+     */
+    struct Update {
+        int64_t streamFrame;     // 本次回调写完后流的累计写入帧数
+        int64_t sourceFrame;     // 下一个写入的帧对应的文件位置
+        double sourcePerStream;  // 每个流帧对应的文件帧数
+        int32_t itemIndex;
+        int64_t totalFrames;
+        int64_t anchorFrame;     // 时间戳：anchorNanos时刻播出的流帧号
+        int64_t anchorNanos;     // CLOCK_MONOTONIC
+        int32_t sampleRate;      // 流的采样率
+        bool timestampValid;
+        int64_t callbackNanos;   // 发布时刻，用于估计输出延迟
+    };
+
+    PresentationClock();
+
+    /**
+     * @brief 清空记录（启动流之前调用）
+     */
+    void reset();
+
+    /**
+     * @brief 发布一次回调的记录（仅回调线程调用，实时安全）
+     */
+    void publish(const Update& update);
+
+    /**
+     * @brief 读取nowNanos时刻播出的位置（任意线程调用，无锁）
+     */
+    PresentationPosition read(int64_t nowNanos) const;
+
+private:
+    struct Segment {
+        std::atomic<int64_t> streamFrame{0};
+        std::atomic<int64_t> sourceFrame{0};
+        std::atomic<double> sourcePerStream{0};
+        std::atomic<int32_t> itemIndex{0};
+        std::atomic<int64_t> totalFrames{0};
+    };
+
+    std::atomic<uint32_t> sequence_;   // 奇数表示正在发布
+    std::atomic<int64_t> published_;   // 已发布的段数
+    Segment segments_[kSegments];
+    std::atomic<int64_t> anchorFrame_;
+    std::atomic<int64_t> anchorNanos_;
+    std::atomic<int32_t> sampleRate_;
+    std::atomic<bool> timestampValid_;
+    std::atomic<int64_t> latencyNanos_;
+};
+
+#endif // PRESENTATION_CLOCK_H
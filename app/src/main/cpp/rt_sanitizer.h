@@ -0,0 +1,54 @@
+#ifndef RT_SANITIZER_H
+#define RT_SANITIZER_H
+
+/**
+ * 音频回调实时安全检查（调试构建选项）
+ *
+ * 以 -DOBOE_DEMO_RT_SANITIZER=ON 构建时（gradle传 -PrtSanitizer=ON），RT_CALLBACK_SCOPE 把当前线程
+ * 标记为处于音频回调中，另外构建的 librt_sanitizer.so 拦截内存分配、加锁和阻塞的系统调用，
+ * 在标记范围内调用时记录违规类型、次数和调用栈。拦截依赖符号插入，该库必须通过 LD_PRELOAD 加载：
+ * 主机上 LD_PRELOAD=librt_sanitizer.so 运行程序；设备上通过可调试应用的 wrap.sh 设置。
+ * 未预加载时标记函数为空，不影响运行。关闭该选项时所有宏为空操作。
+ */
+
+#ifdef OBOE_DEMO_RT_SANITIZER
+
+extern "C" {
+// 由 librt_sanitizer.so 提供，未加载时为空指针
+__attribute__((weak)) const char* rt_sanitizer_enter(const char* scope);
+__attribute__((weak)) void rt_sanitizer_exit(const char* previous);
+__attribute__((weak)) void rt_sanitizer_report();
+}
+
+/**
+ * @brief 回调范围标记，析构时恢复进入前的状态，可以嵌套
+ */
+class RtCallbackScope {
+public:
+    explicit RtCallbackScope(const char* scope)
+        : previous_(rt_sanitizer_enter ? rt_sanitizer_enter(scope) : nullptr) {}
+
+    ~RtCallbackScope() {
+        if (rt_sanitizer_exit) {
+            rt_sanitizer_exit(previous_);
+        }
+    }
+
+    RtCallbackScope(const RtCallbackScope&) = delete;
+    RtCallbackScope& operator=(const RtCallbackScope&) = delete;
+
+private:
+    const char* previous_;
+};
+
+#define RT_CALLBACK_SCOPE(scope) RtCallbackScope rtCallbackScope(scope)
+#define RT_SANITIZER_REPORT() do { if (rt_sanitizer_report) rt_sanitizer_report(); } while (0)
+
+#else
+
+#define RT_CALLBACK_SCOPE(scope) do {} while (0)
+#define RT_SANITIZER_REPORT() do {} while (0)
+
+#endif // OBOE_DEMO_RT_SANITIZER
+
+#endif // RT_SANITIZER_H
@@ -0,0 +1,556 @@
+/*
+ * 音频回调实时安全检查：LD_PRELOAD 加载的拦截库
+ *
+ * 拦截内存分配、加锁/等待、文件I/O和睡眠。调用线程处于 RT_CALLBACK_SCOPE 标记的范围内时，
+ * 按"类型 + 调用栈"去重记录违规次数，rt_sanitizer_report() 或进程退出时输出汇总。
+ * 用C实现，避免C++标准库头文件中的异常说明与libc声明冲突，也避免拦截函数自身产生分配。
+ * 线程状态用pthread key保存（emutls 的 thread_local 首次访问会调用 malloc）。
+ */
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <unwind.h>
+#include <sys/uio.h>
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+#define EXPORT __attribute__((visibility("default")))
+
+enum ViolationKind {
+    kAlloc,
+    kFree,
+    kLock,
+    kWait,
+    kFileIo,
+    kSleep,
+    kKindCount
+};
+
+static const char* const kKindNames[kKindCount] = {
+    "alloc", "free", "lock", "wait", "file-io", "sleep"
+};
+
+#define MAX_FRAMES 16
+#define MAX_SITES 256
+#define SKIP_FRAMES 2
+
+// 按调用栈去重的违规位置
+typedef struct {
+    _Atomic uint64_t hash;       // 0表示空槽
+    _Atomic uint32_t count;
+    _Atomic int ready;           // 调用栈已填写完整
+    int kind;
+    const char* function;
+    const char* scope;
+    int frameCount;
+    uintptr_t frames[MAX_FRAMES];
+} Site;
+
+static Site sites[MAX_SITES];
+static _Atomic uint64_t kindCounts[kKindCount];
+static _Atomic uint32_t lostSites;
+
+static pthread_key_t scopeKey;   // 当前回调范围的名称，为空表示不在回调中
+static pthread_key_t hookKey;    // 非空表示正在记录违规，期间的调用不再检查
+static _Atomic int keysReady;
+
+// ---- 原始函数 ----
+
+static void* (*real_malloc)(size_t);
+static void* (*real_calloc)(size_t, size_t);
+static void* (*real_realloc)(void*, size_t);
+static void (*real_free)(void*);
+static int (*real_posix_memalign)(void**, size_t, size_t);
+static void* (*real_memalign)(size_t, size_t);
+static void* (*real_aligned_alloc)(size_t, size_t);
+static int (*real_pthread_mutex_lock)(pthread_mutex_t*);
+static int (*real_pthread_rwlock_rdlock)(pthread_rwlock_t*);
+static int (*real_pthread_rwlock_wrlock)(pthread_rwlock_t*);
+static int (*real_pthread_cond_wait)(pthread_cond_t*, pthread_mutex_t*);
+static int (*real_pthread_cond_timedwait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+static int (*real_sem_wait)(sem_t*);
+static int (*real_sem_timedwait)(sem_t*, const struct timespec*);
+static int (*real_open)(const char*, int, ...);
+static int (*real_openat)(int, const char*, int, ...);
+static int (*real_close)(int);
+static ssize_t (*real_read)(int, void*, size_t);
+static ssize_t (*real_write)(int, const void*, size_t);
+static ssize_t (*real_pread)(int, void*, size_t, off_t);
+static ssize_t (*real_pwrite)(int, const void*, size_t, off_t);
+static ssize_t (*real_writev)(int, const struct iovec*, int);
+static int (*real_fsync)(int);
+static int (*real_fdatasync)(int);
+static FILE* (*real_fopen)(const char*, const char*);
+static size_t (*real_fread)(void*, size_t, size_t, FILE*);
+static size_t (*real_fwrite)(const void*, size_t, size_t, FILE*);
+static int (*real_fflush)(FILE*);
+static int (*real_fclose)(FILE*);
+static int (*real_usleep)(useconds_t);
+static int (*real_nanosleep)(const struct timespec*, struct timespec*);
+static unsigned int (*real_sleep)(unsigned int);
+
+// dlsym自身可能调用calloc，解析完成前的分配由静态区满足
+static char bootstrapHeap[16384] __attribute__((aligned(16)));
+static size_t bootstrapUsed;
+static int resolving;
+
+static void* bootstrapAlloc(size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    if (bootstrapUsed + size > sizeof(bootstrapHeap)) {
+        return NULL;
+    }
+    void* ptr = bootstrapHeap + bootstrapUsed;
+    bootstrapUsed += size;
+    return ptr;
+}
+
+static int isBootstrap(const void* ptr) {
+    return (const char*)ptr >= bootstrapHeap && (const char*)ptr < bootstrapHeap + sizeof(bootstrapHeap);
+}
+
+#define RESOLVE(name) real_##name = (__typeof__(real_##name))dlsym(RTLD_NEXT, #name)
+
+static void resolveAll(void) {
+    if (real_malloc || resolving) {
+        return;
+    }
+    resolving = 1;
+    RESOLVE(calloc);
+    RESOLVE(realloc);
+    RESOLVE(free);
+    RESOLVE(posix_memalign);
+    RESOLVE(memalign);
+    RESOLVE(aligned_alloc);
+    RESOLVE(pthread_mutex_lock);
+    RESOLVE(pthread_rwlock_rdlock);
+    RESOLVE(pthread_rwlock_wrlock);
+    RESOLVE(pthread_cond_wait);
+    RESOLVE(pthread_cond_timedwait);
+    RESOLVE(sem_wait);
+    RESOLVE(sem_timedwait);
+    RESOLVE(open);
+    RESOLVE(openat);
+    RESOLVE(close);
+    RESOLVE(read);
+    RESOLVE(write);
+    RESOLVE(pread);
+    RESOLVE(pwrite);
+    RESOLVE(writev);
+    RESOLVE(fsync);
+    RESOLVE(fdatasync);
+    RESOLVE(fopen);
+    RESOLVE(fread);
+    RESOLVE(fwrite);
+    RESOLVE(fflush);
+    RESOLVE(fclose);
+    RESOLVE(usleep);
+    RESOLVE(nanosleep);
+    RESOLVE(sleep);
+    // malloc最后解析，它非空即表示全部解析完成
+    RESOLVE(malloc);
+    resolving = 0;
+}
+
+#define ENSURE(name) do { if (!real_##name) resolveAll(); } while (0)
+
+// ---- 违规记录 ----
+
+typedef struct {
+    uintptr_t* frames;
+    int count;
+    int skip;
+} BacktraceState;
+
+static _Unwind_Reason_Code unwindCallback(struct _Unwind_Context* context, void* arg) {
+    BacktraceState* state = (BacktraceState*)arg;
+    uintptr_t pc = _Unwind_GetIP(context);
+    if (pc == 0) {
+        return _URC_END_OF_STACK;
+    }
+    if (state->skip > 0) {
+        state->skip--;
+        return _URC_NO_REASON;
+    }
+    state->frames[state->count++] = pc;
+    return state->count >= MAX_FRAMES ? _URC_END_OF_STACK : _URC_NO_REASON;
+}
+
+static void recordViolation(int kind, const char* function) {
+    if (!atomic_load_explicit(&keysReady, memory_order_acquire)) {
+        return;
+    }
+    const char* scope = (const char*)pthread_getspecific(scopeKey);
+    if (!scope || pthread_getspecific(hookKey)) {
+        return;
+    }
+    pthread_setspecific(hookKey, (void*)1);
+
+    atomic_fetch_add_explicit(&kindCounts[kind], 1, memory_order_relaxed);
+
+    uintptr_t frames[MAX_FRAMES];
+    BacktraceState state = { frames, 0, SKIP_FRAMES };
+    _Unwind_Backtrace(unwindCallback, &state);
+
+    // FNV-1a，类型也参与计算，同一位置的不同违规分别统计
+    uint64_t hash = 1469598103934665603ULL ^ (uint64_t)kind;
+    for (int i = 0; i < state.count; ++i) {
+        hash = (hash ^ frames[i]) * 1099511628211ULL;
+    }
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    int recorded = 0;
+    for (int probe = 0; probe < MAX_SITES; ++probe) {
+        Site* site = &sites[(hash + probe) % MAX_SITES];
+        uint64_t expected = 0;
+        if (atomic_compare_exchange_strong(&site->hash, &expected, hash)) {
+            site->kind = kind;
+            site->function = function;
+            site->scope = scope;
+            site->frameCount = state.count;
+            memcpy(site->frames, frames, sizeof(uintptr_t) * state.count);
+            atomic_store_explicit(&site->ready, 1, memory_order_release);
+        } else if (expected != hash) {
+            continue;
+        }
+        atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed);
+        recorded = 1;
+        break;
+    }
+    if (!recorded) {
+        atomic_fetch_add_explicit(&lostSites, 1, memory_order_relaxed);
+    }
+
+    pthread_setspecific(hookKey, NULL);
+}
+
+// ---- 导出接口 ----
+
+EXPORT const char* rt_sanitizer_enter(const char* scope) {
+    if (!atomic_load_explicit(&keysReady, memory_order_acquire)) {
+        return NULL;
+    }
+    const char* previous = (const char*)pthread_getspecific(scopeKey);
+    pthread_setspecific(scopeKey, scope);
+    return previous;
+}
+
+EXPORT void rt_sanitizer_exit(const char* previous) {
+    if (atomic_load_explicit(&keysReady, memory_order_acquire)) {
+        pthread_setspecific(scopeKey, previous);
+    }
+}
+
+EXPORT uint64_t rt_sanitizer_violation_count(void) {
+    uint64_t total = 0;
+    for (int i = 0; i < kKindCount; ++i) {
+        total += atomic_load_explicit(&kindCounts[i], memory_order_relaxed);
+    }
+    return total;
+}
+
+static void reportLine(const char* format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+#ifdef __ANDROID__
+    __android_log_write(ANDROID_LOG_WARN, "RtSanitizer", line);
+#else
+    fprintf(stderr, "RtSanitizer: %s\n", line);
+#endif
+}
+
+EXPORT void rt_sanitizer_report(void) {
+    const int keys = atomic_load_explicit(&keysReady, memory_order_acquire);
+    const void* hook = keys ? pthread_getspecific(hookKey) : NULL;
+    if (keys) {
+        pthread_setspecific(hookKey, (void*)1);
+    }
+
+    const uint64_t total = rt_sanitizer_violation_count();
+    reportLine("%llu real-time violations in audio callbacks", (unsigned long long)total);
+    for (int i = 0; i < kKindCount; ++i) {
+        const uint64_t count = atomic_load_explicit(&kindCounts[i], memory_order_relaxed);
+        if (count > 0) {
+            reportLine("  %-8s %llu", kKindNames[i], (unsigned long long)count);
+        }
+    }
+    for (int i = 0; i < MAX_SITES; ++i) {
+        const Site* site = &sites[i];
+        if (!atomic_load_explicit(&site->ready, memory_order_acquire)) {
+            continue;
+        }
+        reportLine("[%s] %s via %s() x%u", site->scope, kKindNames[site->kind], site->function,
+                   atomic_load_explicit(&site->count, memory_order_relaxed));
+        for (int f = 0; f < site->frameCount; ++f) {
+            Dl_info info;
+            const uintptr_t pc = site->frames[f];
+            if (dladdr((void*)pc, &info) && info.dli_fname) {
+                reportLine("    #%02d pc %p %s+0x%lx (%s)", f, (void*)pc, info.dli_fname,
+                           (unsigned long)(pc - (uintptr_t)info.dli_fbase),
+                           info.dli_sname ? info.dli_sname : "?");
+            } else {
+                reportLine("    #%02d pc %p", f, (void*)pc);
+            }
+        }
+    }
+    const uint32_t lost = atomic_load_explicit(&lostSites, memory_order_relaxed);
+    if (lost > 0) {
+        reportLine("%u violations not recorded, site table full", lost);
+    }
+
+    if (keys) {
+        pthread_setspecific(hookKey, hook);
+    }
+}
+
+__attribute__((constructor)) static void rtSanitizerInit(void) {
+    resolveAll();
+    if (pthread_key_create(&scopeKey, NULL) == 0 && pthread_key_create(&hookKey, NULL) == 0) {
+        atomic_store_explicit(&keysReady, 1, memory_order_release);
+    }
+}
+
+__attribute__((destructor)) static void rtSanitizerFini(void) {
+    if (rt_sanitizer_violation_count() > 0) {
+        rt_sanitizer_report();
+    }
+}
+
+// ---- 拦截函数 ----
+
+EXPORT void* malloc(size_t size) {
+    if (!real_malloc) {
+        resolveAll();
+        if (!real_malloc) {
+            return bootstrapAlloc(size);
+        }
+    }
+    recordViolation(kAlloc, "malloc");
+    return real_malloc(size);
+}
+
+EXPORT void* calloc(size_t count, size_t size) {
+    if (!real_calloc) {
+        resolveAll();
+        if (!real_calloc) {
+            // 静态区本身为零
+            return bootstrapAlloc(count * size);
+        }
+    }
+    recordViolation(kAlloc, "calloc");
+    return real_calloc(count, size);
+}
+
+EXPORT void* realloc(void* ptr, size_t size) {
+    ENSURE(realloc);
+    recordViolation(kAlloc, "realloc");
+    if (isBootstrap(ptr)) {
+        void* moved = real_malloc(size);
+        if (moved) {
+            const size_t available = (size_t)(bootstrapHeap + sizeof(bootstrapHeap) - (char*)ptr);
+            memcpy(moved, ptr, size < available ? size : available);
+        }
+        return moved;
+    }
+    return real_realloc(ptr, size);
+}
+
+EXPORT void free(void* ptr) {
+    if (!ptr || isBootstrap(ptr)) {
+        return;
+    }
+    ENSURE(free);
+    recordViolation(kFree, "free");
+    real_free(ptr);
+}
+
+EXPORT int posix_memalign(void** out, size_t alignment, size_t size) {
+    ENSURE(posix_memalign);
+    recordViolation(kAlloc, "posix_memalign");
+    return real_posix_memalign(out, alignment, size);
+}
+
+EXPORT void* memalign(size_t alignment, size_t size) {
+    ENSURE(memalign);
+    recordViolation(kAlloc, "memalign");
+    return real_memalign(alignment, size);
+}
+
+EXPORT void* aligned_alloc(size_t alignment, size_t size) {
+    ENSURE(aligned_alloc);
+    recordViolation(kAlloc, "aligned_alloc");
+    return real_aligned_alloc(alignment, size);
+}
+
+EXPORT int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    ENSURE(pthread_mutex_lock);
+    recordViolation(kLock, "pthread_mutex_lock");
+    return real_pthread_mutex_lock(mutex);
+}
+
+EXPORT int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+    ENSURE(pthread_rwlock_rdlock);
+    recordViolation(kLock, "pthread_rwlock_rdlock");
+    return real_pthread_rwlock_rdlock(lock);
+}
+
+EXPORT int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+    ENSURE(pthread_rwlock_wrlock);
+    recordViolation(kLock, "pthread_rwlock_wrlock");
+    return real_pthread_rwlock_wrlock(lock);
+}
+
+EXPORT int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    ENSURE(pthread_cond_wait);
+    recordViolation(kWait, "pthread_cond_wait");
+    return real_pthread_cond_wait(cond, mutex);
+}
+
+EXPORT int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* timeout) {
+    ENSURE(pthread_cond_timedwait);
+    recordViolation(kWait, "pthread_cond_timedwait");
+    return real_pthread_cond_timedwait(cond, mutex, timeout);
+}
+
+EXPORT int sem_wait(sem_t* sem) {
+    ENSURE(sem_wait);
+    recordViolation(kWait, "sem_wait");
+    return real_sem_wait(sem);
+}
+
+EXPORT int sem_timedwait(sem_t* sem, const struct timespec* timeout) {
+    ENSURE(sem_timedwait);
+    recordViolation(kWait, "sem_timedwait");
+    return real_sem_timedwait(sem, timeout);
+}
+
+EXPORT int open(const char* path, int flags, ...) {
+    ENSURE(open);
+    recordViolation(kFileIo, "open");
+    va_list args;
+    va_start(args, flags);
+    const int mode = (flags & (O_CREAT | O_TMPFILE)) ? va_arg(args, int) : 0;
+    va_end(args);
+    return real_open(path, flags, mode);
+}
+
+EXPORT int openat(int dirfd, const char* path, int flags, ...) {
+    ENSURE(openat);
+    recordViolation(kFileIo, "openat");
+    va_list args;
+    va_start(args, flags);
+    const int mode = (flags & (O_CREAT | O_TMPFILE)) ? va_arg(args, int) : 0;
+    va_end(args);
+    return real_openat(dirfd, path, flags, mode);
+}
+
+EXPORT int close(int fd) {
+    ENSURE(close);
+    recordViolation(kFileIo, "close");
+    return real_close(fd);
+}
+
+EXPORT ssize_t read(int fd, void* buffer, size_t size) {
+    ENSURE(read);
+    recordViolation(kFileIo, "read");
+    return real_read(fd, buffer, size);
+}
+
+EXPORT ssize_t write(int fd, const void* buffer, size_t size) {
+    ENSURE(write);
+    recordViolation(kFileIo, "write");
+    return real_write(fd, buffer, size);
+}
+
+EXPORT ssize_t pread(int fd, void* buffer, size_t size, off_t offset) {
+    ENSURE(pread);
+    recordViolation(kFileIo, "pread");
+    return real_pread(fd, buffer, size, offset);
+}
+
+EXPORT ssize_t pwrite(int fd, const void* buffer, size_t size, off_t offset) {
+    ENSURE(pwrite);
+    recordViolation(kFileIo, "pwrite");
+    return real_pwrite(fd, buffer, size, offset);
+}
+
+EXPORT ssize_t writev(int fd, const struct iovec* iov, int count) {
+    ENSURE(writev);
+    recordViolation(kFileIo, "writev");
+    return real_writev(fd, iov, count);
+}
+
+EXPORT int fsync(int fd) {
+    ENSURE(fsync);
+    recordViolation(kFileIo, "fsync");
+    return real_fsync(fd);
+}
+
+EXPORT int fdatasync(int fd) {
+    ENSURE(fdatasync);
+    recordViolation(kFileIo, "fdatasync");
+    return real_fdatasync(fd);
+}
+
+EXPORT FILE* fopen(const char* path, const char* mode) {
+    ENSURE(fopen);
+    recordViolation(kFileIo, "fopen");
+    return real_fopen(path, mode);
+}
+
+EXPORT size_t fread(void* buffer, size_t size, size_t count, FILE* stream) {
+    ENSURE(fread);
+    recordViolation(kFileIo, "fread");
+    return real_fread(buffer, size, count, stream);
+}
+
+EXPORT size_t fwrite(const void* buffer, size_t size, size_t count, FILE* stream) {
+    ENSURE(fwrite);
+    recordViolation(kFileIo, "fwrite");
+    return real_fwrite(buffer, size, count, stream);
+}
+
+EXPORT int fflush(FILE* stream) {
+    ENSURE(fflush);
+    recordViolation(kFileIo, "fflush");
+    return real_fflush(stream);
+}
+
+EXPORT int fclose(FILE* stream) {
+    ENSURE(fclose);
+    recordViolation(kFileIo, "fclose");
+    return real_fclose(stream);
+}
+
+EXPORT int usleep(useconds_t usec) {
+    ENSURE(usleep);
+    recordViolation(kSleep, "usleep");
+    return real_usleep(usec);
+}
+
+EXPORT int nanosleep(const struct timespec* request, struct timespec* remaining) {
+    ENSURE(nanosleep);
+    recordViolation(kSleep, "nanosleep");
+    return real_nanosleep(request, remaining);
+}
+
+EXPORT unsigned int sleep(unsigned int seconds) {
+    ENSURE(sleep);
+    recordViolation(kSleep, "sleep");
+    return real_sleep(seconds);
+}
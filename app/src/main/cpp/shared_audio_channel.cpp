@@ -0,0 +1,58 @@
+#include "shared_audio_channel.h"
+#include <cstring>
+
+SharedAudioChannel::SharedAudioChannel(size_t capacity, size_t bytesPerPoint)
+    : storage_(roundUpToPowerOfTwo(capacity))
+    , capacity_(storage_.capacity())
+    , mask_(capacity_ - 1)
+    , bytesPerPoint_(bytesPerPoint)
+    , writeSeq_(0)
+    , readSeq_(0)
+    , lostPoints_(0) {}
+
+size_t SharedAudioChannel::roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+size_t SharedAudioChannel::mappedSize() const {
+    return storage_.isMirrored() ? capacity_ * 2 : capacity_;
+}
+
+bool SharedAudioChannel::write(const void* data, int32_t numPoints) {
+    const size_t size = static_cast<size_t>(numPoints) * bytesPerPoint_;
+    const auto writeSeq = static_cast<size_t>(writeSeq_.load(std::memory_order_relaxed));
+    const auto readSeq = static_cast<size_t>(readSeq_.load(std::memory_order_acquire));
+    if (size > capacity_ - (writeSeq - readSeq)) {
+        // 读端跟不上（如界面在后台），丢弃新数据而不是覆盖读端正在访问的旧数据
+        lostPoints_.fetch_add(numPoints, std::memory_order_relaxed);
+        return false;
+    }
+
+    const auto* src = static_cast<const uint8_t*>(data);
+    uint8_t* buffer = storage_.data();
+    const size_t offset = writeSeq & mask_;
+    const size_t firstPart = storage_.contiguous(offset, size);
+    memcpy(buffer + offset, src, firstPart);
+    if (size > firstPart) {
+        memcpy(buffer, src + firstPart, size - firstPart);
+    }
+    writeSeq_.store(static_cast<int64_t>(writeSeq + size), std::memory_order_release);
+    return true;
+}
+
+size_t SharedAudioChannel::poll(size_t& offset) const {
+    const auto readSeq = static_cast<size_t>(readSeq_.load(std::memory_order_relaxed));
+    const auto writeSeq = static_cast<size_t>(writeSeq_.load(std::memory_order_acquire));
+    offset = readSeq & mask_;
+    // 容量为2的幂、写入为整点，非镜像模式下截断到末尾的长度也是整点
+    return storage_.contiguous(offset, writeSeq - readSeq);
+}
+
+void SharedAudioChannel::commit(size_t size) {
+    const int64_t readSeq = readSeq_.load(std::memory_order_relaxed);
+    readSeq_.store(readSeq + static_cast<int64_t>(size), std::memory_order_release);
+}
@@ -0,0 +1,74 @@
+#ifndef SHARED_AUDIO_CHANNEL_H
+#define SHARED_AUDIO_CHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "mirrored_buffer.h"
+
+/**
+ * @brief 原生层与Kotlin层共享的波形数据通道
+ * 数据单位为“点”：录音回调由PeakDecimator抽取的波形包络点，每点bytesPerPoint字节，与音频帧数无关。
+ * 存储由原生层持有，通过NewDirectByteBuffer直接暴露给Kotlin，Kotlin按界面刷新频率主动拉取，
+ * 不再为每段数据做JNI回调和数组拷贝。
+ * 写序号与读序号都是单调递增的字节计数：音频回调只修改writeSeq，Kotlin（通过JNI）只修改readSeq。
+ * 空间不足时丢弃本次写入的新数据，并累加lostPoints，读端可据此感知丢失的点数。
+ */
+class SharedAudioChannel {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 期望容量（字节），向上取整为2的幂
+     * @param bytesPerPoint 每个点的字节数，读写都按整点进行
+     */
+    SharedAudioChannel(size_t capacity, size_t bytesPerPoint);
+
+    SharedAudioChannel(const SharedAudioChannel&) = delete;
+    SharedAudioChannel& operator=(const SharedAudioChannel&) = delete;
+
+    /**
+     * @brief 写入整点数据（仅音频回调线程调用，不阻塞）
+     * @return 是否写入；空间不足时丢弃并计入lostPoints
+     */
+    bool write(const void* data, int32_t numPoints);
+
+    /**
+     * @brief 查询可连续读取的区域（仅读线程调用）
+     * @param offset 输出参数，区域在共享内存中的偏移
+     * @return 区域大小（字节），为整点
+     */
+    size_t poll(size_t& offset) const;
+
+    /**
+     * @brief 提交已读取的字节数（仅读线程调用）
+     */
+    void commit(size_t size);
+
+    /**
+     * @brief 共享内存起始地址，用于创建DirectByteBuffer
+     */
+    uint8_t* data() const { return storage_.data(); }
+
+    /**
+     * @brief 共享内存可访问的长度。镜像模式下为容量的2倍，poll返回的区域总在此范围内
+     */
+    size_t mappedSize() const;
+
+    int64_t writeSeq() const { return writeSeq_.load(std::memory_order_acquire); }
+    int64_t readSeq() const { return readSeq_.load(std::memory_order_acquire); }
+    int64_t lostPoints() const { return lostPoints_.load(std::memory_order_relaxed); }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value);
+
+    MirroredBuffer storage_;
+    const size_t capacity_;
+    const size_t mask_;
+    const size_t bytesPerPoint_;
+
+    alignas(64) std::atomic<int64_t> writeSeq_;
+    alignas(64) std::atomic<int64_t> readSeq_;
+    alignas(64) std::atomic<int64_t> lostPoints_;
+};
+
+#endif // SHARED_AUDIO_CHANNEL_H
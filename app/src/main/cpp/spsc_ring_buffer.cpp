@@ -0,0 +1,85 @@
+#include "spsc_ring_buffer.h"
+#include <algorithm>
+
+SpscRingBuffer::SpscRingBuffer(size_t capacity)
+    : storage_(roundUpToPowerOfTwo(capacity))
+    , capacity_(storage_.capacity())
+    , mask_(capacity_ - 1)
+    , buffer_(storage_.data())
+    , writeIndex_(0)
+    , readIndex_(0) {}
+
+SpscRingBuffer::~SpscRingBuffer() = default;
+
+size_t SpscRingBuffer::roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+bool SpscRingBuffer::write(const void* data, size_t size) {
+    // 写索引只由生产者修改，relaxed即可；读索引需acquire，保证消费者已读完旧数据
+    const size_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+    const size_t readIndex = readIndex_.load(std::memory_order_acquire);
+    if (size > capacity_ - (writeIndex - readIndex)) {
+        return false;
+    }
+
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    const size_t offset = writeIndex & mask_;
+    const size_t firstPart = storage_.contiguous(offset, size);
+    std::memcpy(buffer_ + offset, src, firstPart);
+    if (size > firstPart) {
+        std::memcpy(buffer_, src + firstPart, size - firstPart);
+    }
+
+    // release：数据写入对消费者可见后再发布新的写索引
+    writeIndex_.store(writeIndex + size, std::memory_order_release);
+    return true;
+}
+
+size_t SpscRingBuffer::read(void* data, size_t maxSize) {
+    const size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+    const size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    const size_t size = std::min(maxSize, writeIndex - readIndex);
+    if (size == 0) {
+        return 0;
+    }
+
+    uint8_t* dst = static_cast<uint8_t*>(data);
+    const size_t offset = readIndex & mask_;
+    const size_t firstPart = storage_.contiguous(offset, size);
+    std::memcpy(dst, buffer_ + offset, firstPart);
+    if (size > firstPart) {
+        std::memcpy(dst + firstPart, buffer_, size - firstPart);
+    }
+
+    readIndex_.store(readIndex + size, std::memory_order_release);
+    return size;
+}
+
+const uint8_t* SpscRingBuffer::peekRead(size_t& size) const {
+    const size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+    const size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    const size_t offset = readIndex & mask_;
+    size = storage_.contiguous(offset, writeIndex - readIndex);
+    return buffer_ + offset;
+}
+
+void SpscRingBuffer::commitRead(size_t size) {
+    const size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+    readIndex_.store(readIndex + size, std::memory_order_release);
+}
+
+size_t SpscRingBuffer::size() const {
+    // 先读读索引再读写索引，保证任意线程调用时差值不会为负
+    const size_t readIndex = readIndex_.load(std::memory_order_acquire);
+    const size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    return writeIndex - readIndex;
+}
+
+size_t SpscRingBuffer::available() const {
+    return capacity_ - size();
+}
@@ -0,0 +1,90 @@
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include "mirrored_buffer.h"
+
+/**
+ * @brief 无锁单生产者单消费者环形缓冲区
+ * 生产者（音频回调线程）与消费者线程之间无需互斥锁，写入端永不阻塞。
+ * 容量向上取整为2的幂，读写索引单调递增，通过掩码定位。
+ * 底层存储优先使用双重映射，此时读写与peekRead得到的区域总是连续的。
+ */
+class SpscRingBuffer {
+public:
+    /**
+     * @brief 构造函数
+     * @param capacity 期望容量（字节），实际容量向上取整为2的幂
+     */
+    explicit SpscRingBuffer(size_t capacity);
+
+    /**
+     * @brief 析构函数
+     */
+    ~SpscRingBuffer();
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /**
+     * @brief 写入数据（仅生产者线程调用）
+     * 空间不足时不写入任何数据，直接返回false
+     * @param data 数据指针
+     * @param size 数据大小（字节）
+     * @return 是否写入成功
+     */
+    bool write(const void* data, size_t size);
+
+    /**
+     * @brief 读取数据（仅消费者线程调用）
+     * @param data 目标缓冲区
+     * @param maxSize 最多读取的字节数
+     * @return 实际读取的字节数
+     */
+    size_t read(void* data, size_t maxSize);
+
+    /**
+     * @brief 获取可连续访问的可读区域（仅消费者调用），不拷贝数据
+     * 镜像模式下返回全部可读数据，否则截断到缓冲区末尾
+     * @param size 输出参数，区域大小（字节）
+     * @return 区域起始地址，在commitRead之前有效
+     */
+    const uint8_t* peekRead(size_t& size) const;
+
+    /**
+     * @brief 提交已消费的数据（仅消费者调用）
+     * @param size 已消费的字节数，不能超过peekRead返回的大小
+     */
+    void commitRead(size_t size);
+
+    /**
+     * @brief 当前可读字节数
+     */
+    size_t size() const;
+
+    /**
+     * @brief 当前可写字节数
+     */
+    size_t available() const;
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    static size_t roundUpToPowerOfTwo(size_t value);
+
+    MirroredBuffer storage_;
+    const size_t capacity_;
+    const size_t mask_;
+    uint8_t* buffer_;
+
+    // 读写索引分别独占缓存行，避免生产者与消费者之间的伪共享
+    alignas(kCacheLineSize) std::atomic<size_t> writeIndex_;
+    alignas(kCacheLineSize) std::atomic<size_t> readIndex_;
+};
+
+#endif // SPSC_RING_BUFFER_H
@@ -1,37 +1,30 @@
 #include "thread_safe_ring_buffer.h"
 
 ThreadSafeRingBuffer::ThreadSafeRingBuffer(size_t capacity)
-    : capacity_(capacity)
-    , buffer_(new uint8_t[capacity])
+    : storage_(capacity)
+    , capacity_(storage_.capacity())
+    , buffer_(storage_.data())
     , writePos_(0)
     , readPos_(0)
-    , size_(0)
-    , released_(false) {
+    , size_(0) {
 }
 
-ThreadSafeRingBuffer::~ThreadSafeRingBuffer() {
-    release();
-    delete[] buffer_;
-}
+ThreadSafeRingBuffer::~ThreadSafeRingBuffer() = default;
 
 bool ThreadSafeRingBuffer::write(const void* data, size_t size) {
-    if (size > capacity_) {
-        return false;
-    }
-
-    // 等待直到有足够空间
-    if (!waitForSpace(size)) {
+    // 检查是否有足够的空间
+    if (size > capacity_ - size_) {
         return false;
     }
 
     // 计算需要写入的数据量
-    size_t firstPart = std::min(size, capacity_ - writePos_);
+    size_t firstPart = storage_.contiguous(writePos_, size);
     size_t secondPart = size - firstPart;
 
     // 写入第一部分数据
     memcpy(buffer_ + writePos_, data, firstPart);
     
-    // 如果需要，写入第二部分数据（环绕到缓冲区开始）
+    // 如果需要，写入第二部分数据（环绕到缓冲区开始，镜像模式下不会发生）
     if (secondPart > 0) {
         memcpy(buffer_, static_cast<const uint8_t*>(data) + firstPart, secondPart);
     }
@@ -54,13 +47,13 @@ bool ThreadSafeRingBuffer::read(void* data, size_t size) {
     }
 
     // 计算需要读取的数据量
-    size_t firstPart = std::min(size, capacity_ - readPos_);
+    size_t firstPart = storage_.contiguous(readPos_, size);
     size_t secondPart = size - firstPart;
 
     // 读取第一部分数据
     memcpy(data, buffer_ + readPos_, firstPart);
     
-    // 如果需要，读取第二部分数据（环绕到缓冲区开始）
+    // 如果需要，读取第二部分数据（环绕到缓冲区开始，镜像模式下不会发生）
     if (secondPart > 0) {
         memcpy(static_cast<uint8_t*>(data) + firstPart, buffer_, secondPart);
     }
@@ -69,10 +62,42 @@ bool ThreadSafeRingBuffer::read(void* data, size_t size) {
     readPos_ = (readPos_ + size) % capacity_;
     size_ -= size;
 
-    spaceAvailable_.notify_one();
     return true;
 }
 
+RingBufferSpans ThreadSafeRingBuffer::peekReadable() const {
+    RingBufferSpans spans;
+    const size_t readable = size_;
+    const size_t readPos = readPos_;
+    spans.first = buffer_ + readPos;
+    spans.firstSize = storage_.contiguous(readPos, readable);
+    spans.secondSize = readable - spans.firstSize;
+    spans.second = spans.secondSize > 0 ? buffer_ : nullptr;
+    return spans;
+}
+
+void ThreadSafeRingBuffer::commitRead(size_t size) {
+    readPos_ = (readPos_ + size) % capacity_;
+    size_ -= size;
+}
+
+RingBufferSpans ThreadSafeRingBuffer::peekWritable() {
+    RingBufferSpans spans;
+    const size_t writable = capacity_ - size_;
+    const size_t writePos = writePos_;
+    spans.first = buffer_ + writePos;
+    spans.firstSize = storage_.contiguous(writePos, writable);
+    spans.secondSize = writable - spans.firstSize;
+    spans.second = spans.secondSize > 0 ? buffer_ : nullptr;
+    return spans;
+}
+
+void ThreadSafeRingBuffer::commitWrite(size_t size) {
+    // 先更新写入位置，再增加size_，保证消费者看到的数据已完整写入
+    writePos_ = (writePos_ + size) % capacity_;
+    size_ += size;
+}
+
 size_t ThreadSafeRingBuffer::size() const {
     return size_;
 }
@@ -80,19 +105,3 @@ size_t ThreadSafeRingBuffer::size() const {
 size_t ThreadSafeRingBuffer::capacity() const {
     return capacity_;
 }
-
-void ThreadSafeRingBuffer::release() {
-    if (!released_) {
-        released_ = true;
-        spaceAvailable_.notify_all();
-    }
-}
-
-bool ThreadSafeRingBuffer::waitForSpace(size_t size) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    auto predicate = [this, size]() {
-        return (capacity_ - size_) >= size || released_;
-    };
-    spaceAvailable_.wait(lock, predicate);
-    return !released_;
-} 
\ No newline at end of file
@@ -4,19 +4,33 @@
 #include <cstddef>
 #include <cstring>
 #include <algorithm>
-#include <mutex>
-#include <condition_variable>
 #include <atomic>
+#include "mirrored_buffer.h"
+
+/**
+ * @brief 环形缓冲区中一段连续区域的描述
+ * 由于数据可能环绕到缓冲区开头，最多由两段组成
+ */
+struct RingBufferSpans {
+    uint8_t* first = nullptr;   // 第一段起始地址
+    size_t firstSize = 0;       // 第一段大小（字节）
+    uint8_t* second = nullptr;  // 第二段起始地址（环绕部分，可能为空）
+    size_t secondSize = 0;      // 第二段大小（字节）
+
+    size_t total() const { return firstSize + secondSize; }
+};
 
 /**
  * @brief 线程安全的环形缓冲区实现
- * 用于音频数据的生产者-消费者模式
+ * 用于音频数据的生产者-消费者模式（单生产者单消费者），任何操作都不加锁、不阻塞，
+ * 音频回调中调用commitRead/read是安全的。生产者需要等待空间时应自行休眠，由消费者侧另行唤醒
+ * 底层存储优先使用双重映射，此时peek得到的区域只有一段
  */
 class ThreadSafeRingBuffer {
 public:
     /**
      * @brief 构造函数
-     * @param capacity 缓冲区容量（字节）
+     * @param capacity 缓冲区容量（字节），镜像模式下向上取整为页大小的整数倍
      */
     explicit ThreadSafeRingBuffer(size_t capacity);
     
@@ -27,6 +41,7 @@ public:
     
     /**
      * @brief 写入数据到缓冲区
+     * 空间不足时不写入任何数据，直接返回false
      * @param data 要写入的数据指针
      * @param size 要写入的数据大小（字节）
      * @return 是否写入成功
@@ -41,6 +56,31 @@ public:
      */
     bool read(void* data, size_t size);
     
+    /**
+     * @brief 获取可读区域（仅消费者调用），不拷贝数据
+     * 返回的内存在调用commitRead之前保持有效且不会被生产者覆盖
+     * @return 可读数据的两段区域
+     */
+    RingBufferSpans peekReadable() const;
+
+    /**
+     * @brief 提交已消费的数据，释放对应空间
+     * @param size 已消费的字节数，不能超过peekReadable返回的总大小
+     */
+    void commitRead(size_t size);
+
+    /**
+     * @brief 获取可写区域（仅生产者调用），可直接向其中填充数据（如fread）
+     * @return 空闲空间的两段区域
+     */
+    RingBufferSpans peekWritable();
+
+    /**
+     * @brief 提交已写入的数据，使其对消费者可见
+     * @param size 已写入的字节数，不能超过peekWritable返回的总大小
+     */
+    void commitWrite(size_t size);
+
     /**
      * @brief 获取当前缓冲区中的数据大小
      * @return 当前数据大小（字节）
@@ -53,37 +93,13 @@ public:
      */
     size_t capacity() const;
 
-    /**
-     * @brief 释放缓冲区，通知所有阻塞的写入操作退出
-     */
-    void release();
-
 private:
+    MirroredBuffer storage_; // 底层存储（可能为双重映射）
     const size_t capacity_;  // 缓冲区容量
     uint8_t* buffer_;       // 缓冲区数据
     std::atomic<size_t> writePos_;  // 写入位置
     std::atomic<size_t> readPos_;   // 读取位置
     std::atomic<size_t> size_;      // 当前数据大小
-    std::atomic<bool> released_;    // 是否已释放
-
-    mutable std::mutex mutex_;              // 互斥锁
-    std::condition_variable spaceAvailable_; // 空间可用的条件变量
-    std::condition_variable dataAvailable_;  // 数据可用的条件变量
-
-    /**
-     * @brief 等待直到缓冲区有足够空间
-     * @param size 需要的空间大小
-     * @return 是否成功等待（false表示被release）
-     */
-    bool waitForSpace(size_t size);
-
-    /**
-     * @brief 等待直到缓冲区有足够数据
-     * @param size 需要的数据大小
-     * @param timeout_ms 超时时间（毫秒），0表示无限等待
-     * @return 是否有足够数据
-     */
-    bool waitForData(size_t size);
 };
 
 #endif // THREAD_SAFE_RING_BUFFER_H 
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "time_stretcher.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TIME_STRETCHER_NEON 1
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define TIME_STRETCHER_SSE 1
+#endif
+
+constexpr float WsolaTimeStretcher::kMinSpeed;
+constexpr float WsolaTimeStretcher::kMaxSpeed;
+
+namespace {
+
+// 输出步长和搜索范围（毫秒）
+constexpr int32_t kHopMs = 12;
+constexpr int32_t kToleranceMs = 6;
+// 先按粗步长搜索，再在最优位置附近逐帧搜索
+constexpr int32_t kCoarseStep = 4;
+
+// 一次遍历同时计算a·b和a·a
+void dotAndEnergy(const float* a, const float* b, size_t n, float& dot, float& energy) {
+    size_t i = 0;
+    float d = 0.0f;
+    float e = 0.0f;
+#if defined(TIME_STRETCHER_NEON)
+    float32x4_t vd0 = vdupq_n_f32(0.0f), vd1 = vdupq_n_f32(0.0f);
+    float32x4_t ve0 = vdupq_n_f32(0.0f), ve1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t a0 = vld1q_f32(a + i);
+        const float32x4_t a1 = vld1q_f32(a + i + 4);
+        vd0 = vmlaq_f32(vd0, a0, vld1q_f32(b + i));
+        vd1 = vmlaq_f32(vd1, a1, vld1q_f32(b + i + 4));
+        ve0 = vmlaq_f32(ve0, a0, a0);
+        ve1 = vmlaq_f32(ve1, a1, a1);
+    }
+    float lanes[4];
+    vst1q_f32(lanes, vaddq_f32(vd0, vd1));
+    d = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    vst1q_f32(lanes, vaddq_f32(ve0, ve1));
+    e = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(TIME_STRETCHER_SSE)
+    __m128 vd0 = _mm_setzero_ps(), vd1 = _mm_setzero_ps();
+    __m128 ve0 = _mm_setzero_ps(), ve1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a0 = _mm_loadu_ps(a + i);
+        const __m128 a1 = _mm_loadu_ps(a + i + 4);
+        vd0 = _mm_add_ps(vd0, _mm_mul_ps(a0, _mm_loadu_ps(b + i)));
+        vd1 = _mm_add_ps(vd1, _mm_mul_ps(a1, _mm_loadu_ps(b + i + 4)));
+        ve0 = _mm_add_ps(ve0, _mm_mul_ps(a0, a0));
+        ve1 = _mm_add_ps(ve1, _mm_mul_ps(a1, a1));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(vd0, vd1));
+    d = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm_store_ps(lanes, _mm_add_ps(ve0, ve1));
+    e = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; ++i) {
+        d += a[i] * b[i];
+        e += a[i] * a[i];
+    }
+    dot = d;
+    energy = e;
+}
+
+} // namespace
+
+WsolaTimeStretcher::WsolaTimeStretcher(int32_t sampleRate, int32_t channelCount, bool isFloat)
+    : channelCount_(channelCount)
+    , isFloat_(isFloat)
+    , bytesPerFrame_(channelCount * (isFloat ? sizeof(float) : sizeof(int16_t)))
+    , hop_(std::max(64, sampleRate * kHopMs / 1000))
+    , tolerance_(std::max(kCoarseStep * 8, sampleRate * kToleranceMs / 1000))
+    // 一段最多需要：名义位置前进kMaxSpeed * Hs，上一段窗口2Hs，两侧搜索范围各一次
+    , capacity_(static_cast<size_t>(std::ceil(kMaxSpeed * hop_)) + 3 * hop_ + 4 * tolerance_ + 2 * kCoarseStep)
+    , speed_(1.0f)
+    , hopSpeed_(1.0f)
+    , input_(capacity_ * channelCount)
+    , mix_(capacity_)
+    , inputStart_(0)
+    , inputFrames_(0)
+    , readBuffer_(capacity_ * bytesPerFrame_)
+    , previous_(0)
+    , analysis_(0)
+    , output_(static_cast<size_t>(hop_) * channelCount)
+    , outputFrames_(0)
+    , outputRead_(0)
+    , fadeIn_(hop_) {
+    // 升余弦交叉淡化，淡入与淡出之和恒为1
+    for (int32_t i = 0; i < hop_; ++i) {
+        fadeIn_[i] = 0.5f - 0.5f * std::cos(static_cast<float>(M_PI) * (i + 0.5f) / hop_);
+    }
+    reset();
+}
+
+void WsolaTimeStretcher::setSpeed(float speed) {
+    speed_.store(std::max(kMinSpeed, std::min(speed, kMaxSpeed)), std::memory_order_relaxed);
+}
+
+void WsolaTimeStretcher::reset() {
+    inputStart_ = 0;
+    inputFrames_ = 0;
+    outputFrames_ = 0;
+    outputRead_ = 0;
+    // 虚拟的上一段窗口，使第一段恰好从输入起点开始
+    previous_ = -hop_;
+    analysis_ = 0;
+}
+
+int64_t WsolaTimeStretcher::requiredInputEnd() {
+    hopSpeed_ = speed_.load(std::memory_order_relaxed);
+    // 上一段窗口的后半
+    int64_t required = previous_ + 2 * hop_;
+    if (std::fabs(hopSpeed_ - 1.0f) >= 1e-3f) {
+        // 搜索范围内任意候选窗口的前半
+        required = std::max<int64_t>(required, std::llround(analysis_) + tolerance_ + kCoarseStep + hop_);
+    }
+    return required;
+}
+
+void WsolaTimeStretcher::appendInput(const uint8_t* data, size_t frames) {
+    float* dst = input_.data() + inputFrames_ * channelCount_;
+    const size_t samples = frames * channelCount_;
+    if (isFloat_) {
+        memcpy(dst, data, samples * sizeof(float));
+    } else {
+        const auto* pcm = reinterpret_cast<const int16_t*>(data);
+        for (size_t i = 0; i < samples; ++i) {
+            dst[i] = pcm[i] * (1.0f / 32768.0f);
+        }
+    }
+    float* mix = mix_.data() + inputFrames_;
+    if (channelCount_ == 1) {
+        memcpy(mix, dst, frames * sizeof(float));
+    } else {
+        for (size_t i = 0; i < frames; ++i) {
+            mix[i] = 0.5f * (dst[2 * i] + dst[2 * i + 1]);
+        }
+    }
+    inputFrames_ += frames;
+}
+
+void WsolaTimeStretcher::processHop() {
+    const bool natural = std::fabs(hopSpeed_ - 1.0f) < 1e-3f;
+    const int64_t continuation = previous_ + hop_;
+    const int64_t position = natural ? continuation : searchBestPosition(std::llround(analysis_));
+
+    // 上一段窗口的后半淡出，新窗口的前半淡入；选中自然延续时两者相同，直接拷贝
+    const float* tail = input_.data() + (continuation - inputStart_) * channelCount_;
+    const float* head = input_.data() + (position - inputStart_) * channelCount_;
+    float* out = output_.data();
+    if (position == continuation) {
+        memcpy(out, tail, output_.size() * sizeof(float));
+    } else {
+        for (int32_t i = 0; i < hop_; ++i) {
+            const float w = fadeIn_[i];
+            for (int32_t ch = 0; ch < channelCount_; ++ch) {
+                const int32_t s = i * channelCount_ + ch;
+                out[s] = tail[s] + (head[s] - tail[s]) * w;
+            }
+        }
+    }
+    outputFrames_ = hop_;
+    outputRead_ = 0;
+
+    previous_ = position;
+    analysis_ = natural ? static_cast<double>(position + hop_) : analysis_ + hopSpeed_ * hop_;
+
+    // 丢弃之后不再需要的输入：下一段的自然延续和搜索范围都在keepFrom之后
+    const int64_t keepFrom = std::max(inputStart_, std::min<int64_t>(previous_ + hop_,
+            std::llround(analysis_) - tolerance_ - kCoarseStep));
+    const size_t drop = static_cast<size_t>(keepFrom - inputStart_);
+    if (drop > 0) {
+        inputFrames_ -= drop;
+        memmove(input_.data(), input_.data() + drop * channelCount_, inputFrames_ * channelCount_ * sizeof(float));
+        memmove(mix_.data(), mix_.data() + drop, inputFrames_ * sizeof(float));
+        inputStart_ = keepFrom;
+    }
+}
+
+int64_t WsolaTimeStretcher::searchBestPosition(int64_t target) const {
+    const float* reference = mix_.data() + (previous_ + hop_ - inputStart_);
+    const int64_t low = std::max(target - tolerance_, inputStart_);
+    const int64_t high = std::max(low, std::min<int64_t>(target + tolerance_, inputEnd() - hop_));
+
+    int64_t best = low;
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (int64_t p = low; p <= high; p += kCoarseStep) {
+        const float score = similarity(p, reference);
+        if (score > bestScore) {
+            bestScore = score;
+            best = p;
+        }
+    }
+    const int64_t fineLow = std::max(low, best - kCoarseStep + 1);
+    const int64_t fineHigh = std::min(high, best + kCoarseStep - 1);
+    for (int64_t p = fineLow; p <= fineHigh; ++p) {
+        const float score = similarity(p, reference);
+        if (score > bestScore) {
+            bestScore = score;
+            best = p;
+        }
+    }
+    return best;
+}
+
+float WsolaTimeStretcher::similarity(int64_t position, const float* reference) const {
+    float dot = 0.0f;
+    float energy = 0.0f;
+    dotAndEnergy(mix_.data() + (position - inputStart_), reference, static_cast<size_t>(hop_), dot, energy);
+    // 参考段的能量对所有候选相同，只需按候选的能量归一化
+    return dot / std::sqrt(energy + 1e-9f);
+}
+
+void WsolaTimeStretcher::writeOutput(uint8_t* dst, size_t frames) {
+    const float* src = output_.data() + outputRead_ * channelCount_;
+    const size_t samples = frames * channelCount_;
+    if (isFloat_) {
+        memcpy(dst, src, samples * sizeof(float));
+    } else {
+        auto* pcm = reinterpret_cast<int16_t*>(dst);
+        for (size_t i = 0; i < samples; ++i) {
+            const float v = std::lrintf(src[i] * 32768.0f);
+            pcm[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(v, 32767.0f)));
+        }
+    }
+    outputRead_ += frames;
+}
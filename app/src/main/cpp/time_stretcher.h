@@ -0,0 +1,130 @@
+#ifndef TIME_STRETCHER_H
+#define TIME_STRETCHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief WSOLA变速不变调
+ * 输出按固定步长Hs逐段生成：每段是上一段窗口的后半与新选取窗口的前半交叉淡化的结果。
+ * 新窗口的名义位置每段前进speed * Hs，在名义位置±搜索范围内用归一化互相关找与上一段自然延续最相似的位置，
+ * 保证拼接处波形连续。互相关在各声道平均后的单声道数据上计算，点积和能量由NEON/SSE内核一次算出。
+ * 速度为1时直接取自然延续的位置，输出与输入逐样本相同。
+ * 所有缓冲区在构造时按最大速度分配，运行中改变速度不分配内存，可以在音频回调中使用。
+ */
+class WsolaTimeStretcher {
+public:
+    static constexpr float kMinSpeed = 0.5f;
+    static constexpr float kMaxSpeed = 3.0f;
+
+    /**
+     * @brief 构造函数
+     * @param sampleRate 采样率，决定窗口和搜索范围的长度
+     * @param channelCount 声道数（1或2）
+     * @param isFloat 输入输出是否为32位浮点，否则为16位整数
+     */
+    WsolaTimeStretcher(int32_t sampleRate, int32_t channelCount, bool isFloat);
+
+    WsolaTimeStretcher(const WsolaTimeStretcher&) = delete;
+    WsolaTimeStretcher& operator=(const WsolaTimeStretcher&) = delete;
+
+    /**
+     * @brief 设置播放速度（任意线程调用），超出[kMinSpeed, kMaxSpeed]时截断，下一段生效
+     */
+    void setSpeed(float speed);
+
+    float speed() const { return speed_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 已读入但还没有输出的输入帧数，即下一个输出帧相对于数据源读取位置的滞后
+     */
+    int64_t pendingInputFrames() const {
+        const int64_t next = outputRead_ < outputFrames_ ? previous_ + static_cast<int64_t>(outputRead_) : previous_ + hop_;
+        return std::max<int64_t>(0, inputEnd() - next);
+    }
+
+    /**
+     * @brief 清空缓冲的输入和输出（跳转后调用）
+     */
+    void reset();
+
+    /**
+     * @brief 生成输出（实时安全）
+     * @param out 输出缓冲区，格式与输入相同
+     * @param frames 需要的帧数
+     * @param reader 输入回调：size_t(void* dst, size_t maxFrames, bool& discontinuity)，
+     *               返回读到的帧数，0表示暂时没有数据或已结束；discontinuity为true表示数据从新位置开始，
+     *               此前缓冲的数据作废
+     * @return 实际输出的帧数，输入不足时小于frames
+     */
+    template <typename Reader>
+    size_t render(void* out, size_t frames, Reader&& reader) {
+        auto* dst = static_cast<uint8_t*>(out);
+        size_t produced = 0;
+        while (produced < frames) {
+            if (outputRead_ < outputFrames_) {
+                const size_t count = std::min(frames - produced, outputFrames_ - outputRead_);
+                writeOutput(dst + produced * bytesPerFrame_, count);
+                produced += count;
+                continue;
+            }
+            // 为下一段准备足够的输入，只读需要的量，数据源的位置不会超前太多
+            for (int64_t required = requiredInputEnd(); inputEnd() < required; required = requiredInputEnd()) {
+                bool discontinuity = false;
+                const size_t wanted = std::min(static_cast<size_t>(required - inputEnd()), capacity_ - inputFrames_);
+                const size_t count = reader(readBuffer_.data(), wanted, discontinuity);
+                if (discontinuity) {
+                    reset();
+                }
+                if (count == 0) {
+                    return produced;
+                }
+                appendInput(readBuffer_.data(), count);
+            }
+            processHop();
+        }
+        return produced;
+    }
+
+private:
+    int64_t inputEnd() const { return inputStart_ + static_cast<int64_t>(inputFrames_); }
+    int64_t requiredInputEnd();
+    void appendInput(const uint8_t* data, size_t frames);
+    void processHop();
+    int64_t searchBestPosition(int64_t target) const;
+    float similarity(int64_t position, const float* reference) const;
+    void writeOutput(uint8_t* dst, size_t frames);
+
+    const int32_t channelCount_;
+    const bool isFloat_;
+    const size_t bytesPerFrame_;
+    const int32_t hop_;        // 输出步长Hs，也是交叉淡化长度
+    const int32_t tolerance_;  // 搜索范围±
+    const size_t capacity_;    // 输入缓冲区容量（帧）
+
+    std::atomic<float> speed_;
+    float hopSpeed_;  // 本段使用的速度，准备输入时确定
+
+    // 输入：交错float和单声道混合，inputStart_为第一帧的绝对位置
+    std::vector<float> input_;
+    std::vector<float> mix_;
+    int64_t inputStart_;
+    size_t inputFrames_;
+    std::vector<uint8_t> readBuffer_;
+
+    // 上一段窗口的起点和下一段的名义位置（绝对帧位置）
+    int64_t previous_;
+    double analysis_;
+
+    // 输出：一段交错float
+    std::vector<float> output_;
+    size_t outputFrames_;
+    size_t outputRead_;
+
+    std::vector<float> fadeIn_;
+};
+
+#endif // TIME_STRETCHER_H
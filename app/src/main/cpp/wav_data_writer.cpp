@@ -0,0 +1,64 @@
+#include "wav_data_writer.h"
+#include "logging.h"
+
+#define LOG_TAG "WavDataWriter"
+
+static constexpr uint64_t kMaxRiffSize = 0xFFFFFFFFu;
+
+static void putLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+static void putLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+WavDataWriter::WavDataWriter(const char* filePath, const WavFormat& format)
+    : DataWriter(filePath)
+    , format_(format)
+    , rf64_(false) {
+    uint8_t header[kWavHeaderSize];
+    buildWavHeader(format_, header);
+    write(header, sizeof(header));
+}
+
+void WavDataWriter::updateHeader() {
+    if (!isOpen() || bytesWritten() < static_cast<int64_t>(kWavHeaderSize)) {
+        return;
+    }
+    const auto fileSize = static_cast<uint64_t>(bytesWritten());
+    const uint64_t riffSize = fileSize - 8;
+    const uint64_t dataSize = fileSize - kWavHeaderSize;
+
+    if (!rf64_ && riffSize <= kMaxRiffSize) {
+        uint8_t value[4];
+        putLE32(value, static_cast<uint32_t>(riffSize));
+        writeAt(kWavRiffSizeOffset, value, sizeof(value));
+        putLE32(value, static_cast<uint32_t>(dataSize));
+        writeAt(kWavDataSizeOffset, value, sizeof(value));
+        return;
+    }
+
+    // ds64: riffSize, dataSize, sampleCount, tableLength
+    uint8_t ds64[28] = {};
+    putLE64(ds64, riffSize);
+    putLE64(ds64 + 8, dataSize);
+    putLE64(ds64 + 16, dataSize / format_.bytesPerFrame());
+    writeAt(kWavDs64Offset, ds64, sizeof(ds64));
+
+    if (!rf64_) {
+        switchToRf64();
+    }
+}
+
+void WavDataWriter::switchToRf64() {
+    // 先写好ds64内容，再依次改写长度字段和块标识，任意时刻中断文件头都能被解析
+    uint8_t marker[4];
+    putLE32(marker, static_cast<uint32_t>(kMaxRiffSize));
+    writeAt(kWavDataSizeOffset, marker, sizeof(marker));
+    writeAt(kWavRiffSizeOffset, marker, sizeof(marker));
+    writeAt(kWavJunkIdOffset, "ds64", 4);
+    writeAt(0, "RF64", 4);
+    rf64_ = true;
+    LOGI("file exceeds 4GB, switched to RF64");
+}
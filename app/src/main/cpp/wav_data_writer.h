@@ -0,0 +1,31 @@
+#ifndef WAV_DATA_WRITER_H
+#define WAV_DATA_WRITER_H
+
+#include "data_writer.h"
+#include "wav_format.h"
+
+/**
+ * @brief WAV文件写入器
+ * 打开文件时先写入固定长度的文件头，之后每批数据落盘后原地更新长度字段，
+ * 即使录音过程中进程被杀，文件也是可以直接播放的WAV。
+ * 数据超过4GB时把RIFF改写为RF64，并把预留的JUNK块改写为ds64块。
+ */
+class WavDataWriter : public DataWriter {
+public:
+    /**
+     * @brief 构造函数
+     * @param filePath 文件路径
+     * @param format PCM格式
+     */
+    WavDataWriter(const char* filePath, const WavFormat& format);
+
+    void updateHeader() override;
+
+private:
+    void switchToRf64();
+
+    WavFormat format_;
+    bool rf64_;
+};
+
+#endif // WAV_DATA_WRITER_H
@@ -0,0 +1,146 @@
+#include "wav_format.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 0x0001;
+constexpr uint16_t kFormatIeeeFloat = 0x0003;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+constexpr size_t kHeaderProbeSize = 64 * 1024;
+
+// KSDATAFORMAT_SUBTYPE_xxx 的公共后缀，前两个字节为格式编号
+const uint8_t kSubFormatGuidTail[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+void put16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+}
+
+void put32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint16_t get16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t get32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+           | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t get64(const uint8_t* p) {
+    return static_cast<uint64_t>(get32(p)) | (static_cast<uint64_t>(get32(p + 4)) << 32);
+}
+
+} // namespace
+
+void buildWavHeader(const WavFormat& format, uint8_t* header) {
+    memset(header, 0, kWavHeaderSize);
+    const uint16_t blockAlign = static_cast<uint16_t>(format.bytesPerFrame());
+    const uint16_t bits = static_cast<uint16_t>(format.bitsPerSample());
+
+    memcpy(header, "RIFF", 4);
+    put32(header + kWavRiffSizeOffset, kWavHeaderSize - 8);
+    memcpy(header + 8, "WAVE", 4);
+
+    // JUNK块大小与ds64相同，文件超过4GB时原地改写为ds64
+    memcpy(header + kWavJunkIdOffset, "JUNK", 4);
+    put32(header + 16, 28);
+
+    uint8_t* fmt = header + 48;
+    memcpy(fmt, "fmt ", 4);
+    put32(fmt + 4, 40);
+    put16(fmt + 8, kFormatExtensible);
+    put16(fmt + 10, static_cast<uint16_t>(format.channelCount));
+    put32(fmt + 12, static_cast<uint32_t>(format.sampleRate));
+    put32(fmt + 16, static_cast<uint32_t>(format.sampleRate) * blockAlign);
+    put16(fmt + 20, blockAlign);
+    put16(fmt + 22, bits);
+    put16(fmt + 24, 22);          // cbSize
+    put16(fmt + 26, bits);        // wValidBitsPerSample
+    put32(fmt + 28, format.channelCount == 2 ? 0x3 : 0x4);  // 双声道为左右，单声道为中置
+    put16(fmt + 32, format.isFloat ? kFormatIeeeFloat : kFormatPcm);
+    memcpy(fmt + 34, kSubFormatGuidTail, sizeof(kSubFormatGuidTail));
+
+    memcpy(header + 96, "data", 4);
+    put32(header + kWavDataSizeOffset, 0);
+}
+
+bool parseWavHeader(const uint8_t* data, size_t size, WavInfo& info) {
+    if (size < 12 || memcmp(data + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    info = WavInfo();
+    if (memcmp(data, "RF64", 4) == 0) {
+        info.isRf64 = true;
+    } else if (memcmp(data, "RIFF", 4) != 0) {
+        return false;
+    }
+
+    bool hasFormat = false;
+    uint64_t ds64DataSize = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = data + pos;
+        const uint32_t chunkSize = get32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        const size_t bodyAvailable = size - pos - 8;
+
+        if (memcmp(chunk, "ds64", 4) == 0 && bodyAvailable >= 24) {
+            ds64DataSize = get64(body + 8);
+        } else if (memcmp(chunk, "fmt ", 4) == 0 && bodyAvailable >= 16) {
+            uint16_t tag = get16(body);
+            const uint16_t channels = get16(body + 2);
+            const uint32_t sampleRate = get32(body + 4);
+            const uint16_t bits = get16(body + 14);
+            if (tag == kFormatExtensible && chunkSize >= 40 && bodyAvailable >= 26) {
+                tag = get16(body + 24);
+            }
+            if (channels == 0 || sampleRate == 0) {
+                return false;
+            }
+            if (tag == kFormatPcm && bits == 16) {
+                info.format.isFloat = false;
+            } else if (tag == kFormatIeeeFloat && bits == 32) {
+                info.format.isFloat = true;
+            } else {
+                return false;
+            }
+            info.format.channelCount = channels;
+            info.format.sampleRate = static_cast<int32_t>(sampleRate);
+            hasFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!hasFormat) {
+                return false;
+            }
+            info.dataOffset = static_cast<int64_t>(pos + 8);
+            info.dataSize = (info.isRf64 && chunkSize == 0xFFFFFFFFu)
+                    ? static_cast<int64_t>(ds64DataSize) : static_cast<int64_t>(chunkSize);
+            return true;
+        }
+        // 块按偶数字节对齐
+        pos += 8 + static_cast<size_t>(chunkSize) + (chunkSize & 1u);
+    }
+    return false;
+}
+
+bool parseWavHeader(FILE* file, WavInfo& info) {
+    std::vector<uint8_t> head(kHeaderProbeSize);
+    if (fseek(file, 0, SEEK_SET) != 0) {
+        return false;
+    }
+    const size_t bytesRead = fread(head.data(), 1, head.size(), file);
+    return parseWavHeader(head.data(), bytesRead, info);
+}
+
+uint64_t audioDataSize(FILE* file, int64_t dataOffset, int64_t headerDataSize) {
+    fseeko(file, 0, SEEK_END);
+    const int64_t available = std::max<int64_t>(ftello(file) - dataOffset, 0);
+    fseeko(file, static_cast<off_t>(dataOffset), SEEK_SET);
+    return static_cast<uint64_t>(headerDataSize > 0 ? std::min(headerDataSize, available) : available);
+}
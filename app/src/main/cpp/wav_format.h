@@ -0,0 +1,67 @@
+#ifndef WAV_FORMAT_H
+#define WAV_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief WAV文件中的PCM格式描述
+ */
+struct WavFormat {
+    int32_t sampleRate = 48000;
+    int32_t channelCount = 1;
+    bool isFloat = false;   // true为32位浮点，false为16位整数
+
+    int32_t bitsPerSample() const { return isFloat ? 32 : 16; }
+    int32_t bytesPerFrame() const { return channelCount * bitsPerSample() / 8; }
+};
+
+/**
+ * @brief 解析WAV/RF64文件头得到的信息
+ */
+struct WavInfo {
+    WavFormat format;
+    int64_t dataOffset = 0;  // 音频数据在文件中的起始偏移
+    int64_t dataSize = 0;    // 头部记录的音频数据长度（字节）
+    bool isRf64 = false;
+};
+
+/**
+ * 录音时写入的固定长度文件头：RIFF + JUNK(为ds64预留) + fmt(WAVE_FORMAT_EXTENSIBLE) + data，
+ * 数据起始偏移为8字节对齐，便于直接映射文件后按样本访问
+ */
+constexpr size_t kWavHeaderSize = 104;
+constexpr size_t kWavRiffSizeOffset = 4;
+constexpr size_t kWavJunkIdOffset = 12;
+constexpr size_t kWavDs64Offset = 20;
+constexpr size_t kWavDataSizeOffset = 100;
+
+/**
+ * @brief 生成录音文件头，长度字段先填0，录制过程中再更新
+ * @param format PCM格式
+ * @param header 输出缓冲区，至少kWavHeaderSize字节
+ */
+void buildWavHeader(const WavFormat& format, uint8_t* header);
+
+/**
+ * @brief 从内存中解析WAV/RF64文件头（支持16位整数与32位浮点PCM）
+ * @param data 文件开头的数据
+ * @param size 数据大小
+ * @param info 输出的解析结果
+ * @return 是否为受支持的WAV文件
+ */
+bool parseWavHeader(const uint8_t* data, size_t size, WavInfo& info);
+
+/**
+ * @brief 从文件开头读取并解析WAV/RF64文件头，读取后文件位置不确定
+ */
+bool parseWavHeader(FILE* file, WavInfo& info);
+
+/**
+ * @brief 音频数据区长度，WAV和裸PCM（headerDataSize <= 0）通用，返回后文件位置在数据区起点
+ * 文件头的长度可能因异常退出而未包含最后一批数据，也可能大于实际文件，取两者中可信的一个
+ */
+uint64_t audioDataSize(FILE* file, int64_t dataOffset, int64_t headerDataSize);
+
+#endif // WAV_FORMAT_H
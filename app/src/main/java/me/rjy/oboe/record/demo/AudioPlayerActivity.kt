@@ -20,9 +20,11 @@ import androidx.compose.ui.Modifier
 import androidx.compose.ui.platform.LocalContext
 import androidx.compose.ui.res.stringResource
 import androidx.compose.ui.unit.dp
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 import me.rjy.oboe.record.demo.ui.WaveformPlayView
 import me.rjy.oboe.record.demo.ui.theme.OboeRecordDemoTheme
 import java.io.File
@@ -93,20 +95,47 @@ private fun AudioPlayerScreen(
     val context = LocalContext.current
     
     // 波形数据状态
-    val waveformData = remember { mutableStateOf<AudioDecoder.WaveformData?>(null) }
+    val waveformData = remember { mutableStateOf<RecorderViewModel.PlaybackWaveform?>(null) }
     val playbackProgress = remember { mutableFloatStateOf(0f) }
     
     
-    // 加载波形数据
+    // 加载波形数据：优先使用.peaks（首次打开时通过FFmpeg构建），失败时再用MediaCodec完整解码
     LaunchedEffect(filePath) {
         try {
+            val peaks = withContext(Dispatchers.IO) {
+                PeakPyramid.openOrBuild(File(filePath), null, context.cacheDir)
+            }
+            if (peaks != null) {
+                val (left, right) = peaks.overview(RecorderViewModel.MAX_WAVEFORM_POINTS)
+                waveformData.value = RecorderViewModel.PlaybackWaveform(
+                    leftChannel = left,
+                    rightChannel = right,
+                    totalSamples = peaks.totalFrames.toInt(),
+                    peaks = peaks
+                )
+                Log.d("AudioPlayerActivity", "Waveform loaded from peaks: frames=${peaks.totalFrames}, levels=${peaks.levelCount}")
+                return@LaunchedEffect
+            }
             val decoder = AudioDecoder()
-            waveformData.value = decoder.extractWaveform(filePath)
-            Log.d("AudioPlayerActivity", "Waveform data loaded: ${waveformData.value?.audioInfo}")
+            decoder.extractWaveform(filePath)?.let { data ->
+                waveformData.value = RecorderViewModel.PlaybackWaveform(
+                    leftChannel = data.leftChannel,
+                    rightChannel = data.rightChannel,
+                    totalSamples = data.audioInfo.totalSamples.toInt()
+                )
+                Log.d("AudioPlayerActivity", "Waveform data loaded: ${data.audioInfo}")
+            }
         } catch (e: Exception) {
             Log.e("AudioPlayerActivity", "Failed to load waveform data", e)
         }
     }
+
+    // 离开页面时释放.peaks映射
+    DisposableEffect(filePath) {
+        onDispose {
+            waveformData.value?.peaks?.close()
+        }
+    }
     
     // 更新播放进度
     LaunchedEffect(isPlaying.value, mediaPlayer, currentPosition.value, duration.value) {
@@ -241,14 +270,7 @@ private fun AudioPlayerScreen(
                 Spacer(modifier = Modifier.height(16.dp))
 
                 // 波形显示
-                waveformData.value?.let { data ->
-                    // 创建 PlaybackWaveform 数据
-                    val playbackWaveform = RecorderViewModel.PlaybackWaveform(
-                        leftChannel = data.leftChannel,
-                        rightChannel = data.rightChannel,
-                        totalSamples = data.audioInfo.totalSamples.toInt()
-                    )
-                    
+                waveformData.value?.let { playbackWaveform ->
                     WaveformPlayView(
                         waveform = playbackWaveform,
                         progress = playbackProgress.floatValue,
@@ -27,6 +27,7 @@ import androidx.compose.foundation.layout.fillMaxSize
 import androidx.compose.foundation.layout.fillMaxWidth
 import androidx.compose.foundation.layout.heightIn
 import androidx.compose.foundation.layout.padding
+import androidx.compose.foundation.layout.width
 import androidx.compose.foundation.lazy.LazyColumn
 import androidx.compose.foundation.lazy.items
 import androidx.compose.material.icons.Icons
@@ -41,8 +42,10 @@ import androidx.compose.material3.ExposedDropdownMenuBox
 import androidx.compose.material3.ExposedDropdownMenuDefaults
 import androidx.compose.material3.Icon
 import androidx.compose.material3.IconButton
+import androidx.compose.material3.LinearProgressIndicator
 import androidx.compose.material3.MaterialTheme
 import androidx.compose.material3.RadioButton
+import androidx.compose.material3.Slider
 import androidx.compose.material3.Surface
 import androidx.compose.material3.Switch
 import androidx.compose.material3.Text
@@ -182,6 +185,15 @@ class AudioRecorderActivity : ComponentActivity() {
                                             Box(modifier = Modifier.weight(1f)) { DataFormatSection(viewModel) }
                                             Box(modifier = Modifier.weight(1f)) { PlaybackMethodSection(viewModel) }
                                         }
+                                        if (viewModel.useOboe.value) {
+                                            Row(
+                                                horizontalArrangement = Arrangement.spacedBy(16.dp),
+                                                modifier = Modifier.fillMaxWidth()
+                                            ) {
+                                                Box(modifier = Modifier.weight(1f)) { RecordFileFormatSection(viewModel) }
+                                                Box(modifier = Modifier.weight(1f)) { PrerollSection(viewModel) }
+                                            }
+                                        }
                                     }
                                 } else {
                                     Column(
@@ -195,6 +207,10 @@ class AudioRecorderActivity : ComponentActivity() {
                                         ChannelSection(viewModel)
                                         SampleRateSection(viewModel)
                                         DataFormatSection(viewModel)
+                                        if (viewModel.useOboe.value) {
+                                            RecordFileFormatSection(viewModel)
+                                            PrerollSection(viewModel)
+                                        }
                                         PlaybackMethodSection(viewModel)
                                     }
                                 }
@@ -229,7 +245,11 @@ class AudioRecorderActivity : ComponentActivity() {
                                                 WaveformPlayView(
                                                     waveform = viewModel.playbackWaveform.value,
                                                     progress = viewModel.playbackProgress.value,
-                                                    modifier = Modifier.fillMaxWidth()
+                                                    modifier = Modifier.fillMaxWidth(),
+                                                    onSeek = viewModel::seekPlayback,
+                                                    onMarkLoop = viewModel::markLoopPoint,
+                                                    loop = viewModel.playbackLoop.value,
+                                                    loopMarker = viewModel.loopStartMarker.value
                                                 )
                                             } else {
                                                 // 录音状态：显示实时波形
@@ -263,7 +283,11 @@ class AudioRecorderActivity : ComponentActivity() {
                                             WaveformPlayView(
                                                 waveform = viewModel.playbackWaveform.value,
                                                 progress = viewModel.playbackProgress.value,
-                                                modifier = Modifier.fillMaxWidth()
+                                                modifier = Modifier.fillMaxWidth(),
+                                                onSeek = viewModel::seekPlayback,
+                                                onMarkLoop = viewModel::markLoopPoint,
+                                                loop = viewModel.playbackLoop.value,
+                                                loopMarker = viewModel.loopStartMarker.value
                                             )
                                         } else {
                                             // 录音状态：显示实时波形
@@ -275,6 +299,12 @@ class AudioRecorderActivity : ComponentActivity() {
                                         }
                                     }
 
+                                    if (viewModel.mixerTracks.value.isNotEmpty()) {
+                                        MixerSection(viewModel)
+                                    } else if (viewModel.pcmPlayingStatus.value) {
+                                        PlaybackSpeedSection(viewModel)
+                                    }
+
                                     // 使用新的操作按钮组件
                                     OperationButtons(
                                         viewModel = viewModel,
@@ -590,6 +620,90 @@ private fun RecordDeviceSection(viewModel: RecorderViewModel) {
     }
 }
 
+private val PLAYBACK_SPEEDS = listOf(0.5f, 0.75f, 1f, 1.5f, 2f, 3f)
+
+@Composable
+private fun PlaybackSpeedSection(viewModel: RecorderViewModel) {
+    Row(
+        verticalAlignment = Alignment.CenterVertically,
+        modifier = Modifier.fillMaxWidth()
+    ) {
+        Text(text = stringResource(id = R.string.main_playback_speed), style = MaterialTheme.typography.bodyMedium)
+        PLAYBACK_SPEEDS.forEach { speed ->
+            val selected = viewModel.playbackSpeed.floatValue == speed
+            TextButton(
+                onClick = { viewModel.setPlaybackSpeed(speed) },
+                contentPadding = PaddingValues(horizontal = 4.dp),
+                modifier = Modifier.weight(1f)
+            ) {
+                Text(
+                    text = "${speed}x".replace(".0x", "x"),
+                    style = MaterialTheme.typography.bodyMedium,
+                    color = if (selected) MaterialTheme.colorScheme.primary else MaterialTheme.colorScheme.onSurfaceVariant
+                )
+            }
+        }
+    }
+}
+
+// 混音试听：每条音轨的峰值表、静音、增益和声像，最上面是总输出的峰值表
+@Composable
+private fun MixerSection(viewModel: RecorderViewModel) {
+    Column(verticalArrangement = Arrangement.spacedBy(4.dp), modifier = Modifier.fillMaxWidth()) {
+        Row(verticalAlignment = Alignment.CenterVertically, modifier = Modifier.fillMaxWidth()) {
+            Text(
+                text = stringResource(id = R.string.main_mixer_master),
+                style = MaterialTheme.typography.bodyMedium,
+                modifier = Modifier.width(72.dp)
+            )
+            PeakMeter(viewModel.mixerMasterPeak.floatValue, Modifier.weight(1f))
+        }
+        viewModel.mixerTracks.value.forEachIndexed { index, track ->
+            Divider()
+            Row(verticalAlignment = Alignment.CenterVertically, modifier = Modifier.fillMaxWidth()) {
+                Text(
+                    text = track.name,
+                    style = MaterialTheme.typography.bodySmall,
+                    maxLines = 1,
+                    modifier = Modifier.weight(1f)
+                )
+                Checkbox(
+                    checked = track.muted,
+                    onCheckedChange = { viewModel.setMixerTrackMute(index, it) }
+                )
+                Text(text = stringResource(id = R.string.main_mixer_mute), style = MaterialTheme.typography.bodySmall)
+            }
+            PeakMeter(track.peak, Modifier.fillMaxWidth())
+            Row(verticalAlignment = Alignment.CenterVertically, modifier = Modifier.fillMaxWidth()) {
+                Text(text = stringResource(id = R.string.main_mixer_gain), style = MaterialTheme.typography.bodySmall)
+                Slider(
+                    value = track.gain,
+                    onValueChange = { viewModel.setMixerTrackGain(index, it) },
+                    valueRange = 0f..2f,
+                    modifier = Modifier.weight(1f)
+                )
+                Text(text = stringResource(id = R.string.main_mixer_pan), style = MaterialTheme.typography.bodySmall)
+                Slider(
+                    value = track.pan,
+                    onValueChange = { viewModel.setMixerTrackPan(index, it) },
+                    valueRange = -1f..1f,
+                    modifier = Modifier.weight(1f)
+                )
+            }
+        }
+    }
+}
+
+// 峰值表，超过满刻度（削波）时变为错误色
+@Composable
+private fun PeakMeter(peak: Float, modifier: Modifier = Modifier) {
+    LinearProgressIndicator(
+        progress = peak.coerceIn(0f, 1f),
+        color = if (peak >= 1f) MaterialTheme.colorScheme.error else MaterialTheme.colorScheme.primary,
+        modifier = modifier
+    )
+}
+
 @Composable
 private fun ChannelSection(viewModel: RecorderViewModel) {
     Row(
@@ -728,6 +842,77 @@ private fun DataFormatSection(viewModel: RecorderViewModel) {
     }
 }
 
+// Oboe录音的文件格式：WAV或实时压缩的FLAC
+@Composable
+private fun RecordFileFormatSection(viewModel: RecorderViewModel) {
+    Row(
+        verticalAlignment = Alignment.CenterVertically,
+        horizontalArrangement = Arrangement.SpaceBetween,
+        modifier = Modifier.fillMaxWidth()
+    ) {
+        Text(text = stringResource(id = R.string.main_record_file_format), style = MaterialTheme.typography.bodyMedium)
+        Row(
+            horizontalArrangement = Arrangement.Start,
+            verticalAlignment = Alignment.CenterVertically,
+            modifier = Modifier
+                .weight(1f)
+                .padding(start = 8.dp)
+        ) {
+            Row(
+                verticalAlignment = Alignment.CenterVertically,
+            ) {
+                RadioButton(
+                    selected = !viewModel.useFlac.value,
+                    onClick = { viewModel.setUseFlac(false) }
+                )
+                Text(
+                    text = "WAV",
+                    style = MaterialTheme.typography.bodyMedium,
+                    modifier = Modifier.clickable { viewModel.setUseFlac(false) }
+                )
+            }
+            Row(
+                verticalAlignment = Alignment.CenterVertically,
+            ) {
+                RadioButton(
+                    selected = viewModel.useFlac.value,
+                    onClick = { viewModel.setUseFlac(true) }
+                )
+                Text(
+                    text = "FLAC",
+                    style = MaterialTheme.typography.bodyMedium,
+                    modifier = Modifier.clickable { viewModel.setUseFlac(true) }
+                )
+            }
+        }
+    }
+}
+
+// 预录模式：持续缓存最近的录音，手动或电平触发时才保存事件前后的片段
+@Composable
+private fun PrerollSection(viewModel: RecorderViewModel) {
+    Row(
+        verticalAlignment = Alignment.CenterVertically,
+        horizontalArrangement = Arrangement.SpaceBetween,
+        modifier = Modifier.fillMaxWidth()
+    ) {
+        Text(text = stringResource(id = R.string.main_preroll), style = MaterialTheme.typography.bodyMedium)
+        Row(
+            horizontalArrangement = Arrangement.Start,
+            verticalAlignment = Alignment.CenterVertically,
+            modifier = Modifier
+                .weight(1f)
+                .padding(start = 8.dp)
+        ) {
+            Switch(
+                checked = viewModel.usePreroll.value,
+                onCheckedChange = { viewModel.setUsePreroll(it) },
+                enabled = !viewModel.recordingStatus.value
+            )
+        }
+    }
+}
+
 @Composable
 private fun EchoCancelSection(viewModel: RecorderViewModel) {
     Row(
@@ -863,9 +1048,9 @@ private fun PcmFileSelectDialog(
                                 )
                             }
                             Column {
-                                // 去掉文件名最后的日期部分和.pcm扩展名
+                                // 去掉文件名最后的日期部分和扩展名
                                 val displayName = fileInfo.name
-                                    .replace("_\\d{8}_\\d{6}\\.pcm$".toRegex(), "")
+                                    .replace("_\\d{8}_\\d{6}\\.(pcm|wav|flac|m4a|opus)$".toRegex(), "")
                                 Text(
                                     text = displayName,
                                     style = MaterialTheme.typography.bodyMedium,
@@ -899,6 +1084,15 @@ private fun PcmFileSelectDialog(
                     ) {
                         Text(stringResource(id = R.string.cancel))
                     }
+                    TextButton(
+                        onClick = {
+                            onDismissRequest()
+                            viewModel.mixSelectedFiles()
+                        },
+                        enabled = viewModel.selectedFiles.value.isNotEmpty()
+                    ) {
+                        Text(stringResource(id = R.string.main_mix_selected))
+                    }
                     Button(
                         onClick = {
                             viewModel.deleteSelectedFiles(context) {
@@ -914,6 +1108,15 @@ private fun PcmFileSelectDialog(
                     TextButton(onClick = onDismissRequest) {
                         Text(stringResource(id = R.string.cancel))
                     }
+                    Button(
+                        onClick = {
+                            onDismissRequest()
+                            viewModel.playAll()
+                        },
+                        enabled = viewModel.pcmFileList.value.isNotEmpty()
+                    ) {
+                        Text(stringResource(id = R.string.main_play_all))
+                    }
                 }
             }
         }
@@ -945,6 +1148,12 @@ private fun OperationButtons(
         ) {
             Text(text = if (viewModel.recordingStatus.value) stringResource(id = R.string.main_stop_recording) else stringResource(id = R.string.main_start_recording))
         }
+
+        if (viewModel.recordingStatus.value && viewModel.useOboe.value && viewModel.usePreroll.value) {
+            Button(onClick = { viewModel.triggerCapture() }) {
+                Text(text = stringResource(id = R.string.main_capture_event))
+            }
+        }
         
         Button(
             onClick = {
@@ -13,6 +13,10 @@ object LatencyEvents {
     @Volatile
     var configListener: ((String, String) -> Unit)? = null
 
+    // 测试进行中的临时结果：延迟(ms)、最高相关度/置信度、已检测窗口数
+    @Volatile
+    var provisionalListener: ((Double, Double, Int) -> Unit)? = null
+
     @JvmStatic
     fun notifyDetecting() {
         detectingListener?.invoke()
@@ -35,6 +39,11 @@ object LatencyEvents {
         listener?.invoke(outputPath, resultCode, avgDelayMs, delay1, corr1, delay2, corr2, delay3, corr3)
     }
 
+    @JvmStatic
+    fun notifyProvisional(delayMs: Double, correlation: Double, windowCount: Int) {
+        provisionalListener?.invoke(delayMs, correlation, windowCount)
+    }
+
     @JvmStatic
     fun notifyConfig(outputConfig: String, inputConfig: String) {
         configListener?.invoke(outputConfig, inputConfig)
@@ -73,6 +73,9 @@ class LatencyTesterActivity : ComponentActivity() {
         private const val ASSET_NUMBERS_FILE = "numbers_1_to_30.mp3"
         private const val OUTPUT_FILE_PREFIX = "numbers_1_to_30_latency_"
         private const val OUTPUT_FILE_EXT = ".m4a"
+        // 延迟检测方法，与native层DetectMode一致
+        const val DETECT_MODE_NCC = 0
+        const val DETECT_MODE_GCC_PHAT = 1
     }
 
     private external fun createLatencyTester(): Long
@@ -91,7 +94,10 @@ class LatencyTesterActivity : ComponentActivity() {
         inLowLatency: Boolean,
         inSampleRate: Int,
         inChannels: Int,
-        inFormatFloat: Boolean
+        inFormatFloat: Boolean,
+        detectMode: Int,
+        earlyStopWindows: Int,
+        earlyStopToleranceMs: Double
     ): Int
     private external fun stopLatencyTest(nativeHandle: Long): Int
 
@@ -131,6 +137,15 @@ class LatencyTesterActivity : ComponentActivity() {
                 val inChannels = remember { mutableStateOf(2) }
                 val inFormatFloat = remember { mutableStateOf(false) }
 
+                // 延迟检测方法，以及本次结果所用的方法（决定显示相关度还是置信度）
+                val detectMode = remember { mutableStateOf(DETECT_MODE_NCC) }
+                val resultDetectMode = remember { mutableStateOf(DETECT_MODE_NCC) }
+                // 提前结束：一致窗口数（0为关闭）和允许的延迟差
+                val earlyStopWindows = remember { mutableStateOf(0) }
+                val earlyStopToleranceMs = remember { mutableStateOf(1.0) }
+                // 测试进行中的临时结果：延迟(ms)和已检测窗口数
+                val provisionalDelay = remember { mutableStateOf<Pair<Double, Int>?>(null) }
+
                 // 实际生效配置展示
                 val actualOutConfig = remember { mutableStateOf<String?>(null) }
                 val actualInConfig = remember { mutableStateOf<String?>(null) }
@@ -186,6 +201,11 @@ class LatencyTesterActivity : ComponentActivity() {
                                 errorMessage.value = null
                             }
                         }
+                        LatencyEvents.provisionalListener = { delayMs, _, windowCount ->
+                            runOnUiThread {
+                                provisionalDelay.value = Pair(delayMs, windowCount)
+                            }
+                        }
                         LatencyEvents.configListener = { outCfg, inCfg ->
                             runOnUiThread {
                                 actualOutConfig.value = outCfg
@@ -197,6 +217,7 @@ class LatencyTesterActivity : ComponentActivity() {
                                 isBusy.value = false
                                 isRunning.value = false
                                 isDetecting.value = false
+                                provisionalDelay.value = null
                                 outputFilePath.value = path
                                 detectedDelay.value = if (avgDelay >= 0) avgDelay else null
                                 val windows = mutableListOf<Pair<Double, Double>>()
@@ -225,6 +246,8 @@ class LatencyTesterActivity : ComponentActivity() {
                         isBusy = isBusy,
                         detectedDelay = detectedDelay,
                         top3Windows = top3Windows,
+                        windowsShowConfidence = resultDetectMode.value == DETECT_MODE_GCC_PHAT,
+                        provisionalDelay = provisionalDelay,
                         isDetecting = isDetecting,
                         errorMessage = errorMessage,
                         outputFilePath = outputFilePath,
@@ -246,6 +269,8 @@ class LatencyTesterActivity : ComponentActivity() {
                             isDetecting.value = false
                             errorMessage.value = null
                             outputFilePath.value = null
+                            resultDetectMode.value = detectMode.value
+                            provisionalDelay.value = null
                             builtinAudioPath.value?.let { audioPath ->
                                 val outPath = deriveOutputPath()
                                 val code = startLatencyTest(
@@ -262,7 +287,10 @@ class LatencyTesterActivity : ComponentActivity() {
                                     inLowLatency.value,
                                     inSampleRate.value,
                                     inChannels.value,
-                                    inFormatFloat.value
+                                    inFormatFloat.value,
+                                    detectMode.value,
+                                    earlyStopWindows.value,
+                                    earlyStopToleranceMs.value
                                 )
                                 if (code == 0) isRunning.value = true
                             }
@@ -307,8 +335,11 @@ class LatencyTesterActivity : ComponentActivity() {
                             initialInSampleRate = inSampleRate.value,
                             initialInChannels = inChannels.value,
                             initialInFormatFloat = inFormatFloat.value,
+                            initialDetectMode = detectMode.value,
+                            initialEarlyStopWindows = earlyStopWindows.value,
+                            initialEarlyStopToleranceMs = earlyStopToleranceMs.value,
                             onDismiss = { showConfigDialog.value = false },
-                            onSave = { oEx, oLL, oSR, oCH, oFF, iEx, iLL, iSR, iCH, iFF ->
+                            onSave = { oEx, oLL, oSR, oCH, oFF, iEx, iLL, iSR, iCH, iFF, mode, esWindows, esTolerance ->
                                 outExclusive.value = oEx
                                 outLowLatency.value = oLL
                                 outSampleRate.value = oSR
@@ -319,6 +350,9 @@ class LatencyTesterActivity : ComponentActivity() {
                                 inSampleRate.value = iSR
                                 inChannels.value = iCH
                                 inFormatFloat.value = iFF
+                                detectMode.value = mode
+                                earlyStopWindows.value = esWindows
+                                earlyStopToleranceMs.value = esTolerance
                                 showConfigDialog.value = false
                             }
                         )
@@ -400,6 +434,8 @@ private fun LatencyTesterUI(
     isBusy: MutableState<Boolean>,
     detectedDelay: MutableState<Double?>,
     top3Windows: MutableState<List<Pair<Double, Double>>?>,
+    windowsShowConfidence: Boolean,
+    provisionalDelay: MutableState<Pair<Double, Int>?>,
     isDetecting: MutableState<Boolean>,
     errorMessage: MutableState<String?>,
     outputFilePath: MutableState<String?>,
@@ -467,6 +503,17 @@ private fun LatencyTesterUI(
             )
         }
 
+        provisionalDelay.value?.let { (delay, windows) ->
+            if (isRunning.value || isDetecting.value) {
+                Text(
+                    text = stringResource(R.string.provisional_delay, delay, windows),
+                    modifier = Modifier.padding(bottom = 8.dp),
+                    style = androidx.compose.material3.MaterialTheme.typography.bodyMedium,
+                    color = androidx.compose.material3.MaterialTheme.colorScheme.secondary
+                )
+            }
+        }
+
         if (isDetecting.value) {
             Text(
                 text = stringResource(R.string.detecting_latency),
@@ -496,7 +543,11 @@ private fun LatencyTesterUI(
             )
             windows.forEachIndexed { index, (d, c) ->
                 Text(
-                    text = stringResource(R.string.window_info, index + 1, d, c),
+                    text = if (windowsShowConfidence) {
+                        stringResource(R.string.window_info_confidence, index + 1, d, c)
+                    } else {
+                        stringResource(R.string.window_info, index + 1, d, c)
+                    },
                     modifier = Modifier.padding(vertical = 4.dp),
                     style = androidx.compose.material3.MaterialTheme.typography.bodyMedium
                 )
@@ -583,6 +634,9 @@ private fun ConfigDialog(
     initialInSampleRate: Int,
     initialInChannels: Int,
     initialInFormatFloat: Boolean,
+    initialDetectMode: Int,
+    initialEarlyStopWindows: Int,
+    initialEarlyStopToleranceMs: Double,
     onDismiss: () -> Unit,
     onSave: (
         outExclusive: Boolean,
@@ -594,7 +648,10 @@ private fun ConfigDialog(
         inLowLatency: Boolean,
         inSampleRate: Int,
         inChannels: Int,
-        inFormatFloat: Boolean
+        inFormatFloat: Boolean,
+        detectMode: Int,
+        earlyStopWindows: Int,
+        earlyStopToleranceMs: Double
     ) -> Unit,
 ) {
     // 使用弹窗内部的临时状态，保存才生效
@@ -609,6 +666,9 @@ private fun ConfigDialog(
     val inSampleRate = remember { mutableStateOf(initialInSampleRate) }
     val inChannels = remember { mutableStateOf(initialInChannels) }
     val inFormatFloat = remember { mutableStateOf(initialInFormatFloat) }
+    val detectMode = remember { mutableStateOf(initialDetectMode) }
+    val earlyStopWindows = remember { mutableStateOf(initialEarlyStopWindows) }
+    val earlyStopToleranceMs = remember { mutableStateOf(initialEarlyStopToleranceMs) }
 
     AlertDialog(
         onDismissRequest = onDismiss,
@@ -710,6 +770,51 @@ private fun ConfigDialog(
                         TextButton(onClick = { inFormatFloat.value = !inFormatFloat.value }) { Text(text = if (inFormatFloat.value) "float" else "short") }
                     }
                 }
+
+                Spacer(modifier = Modifier.height(6.dp))
+
+                // 延迟检测区块
+                Text(
+                    text = "延迟检测",
+                    modifier = Modifier.padding(bottom = 6.dp),
+                    style = androidx.compose.material3.MaterialTheme.typography.titleMedium,
+                    color = androidx.compose.material3.MaterialTheme.colorScheme.primary
+                )
+                Column(
+                    modifier = Modifier
+                        .fillMaxWidth()
+                        .border(
+                            width = 1.dp,
+                            color = androidx.compose.material3.MaterialTheme.colorScheme.outline,
+                            shape = RoundedCornerShape(8.dp)
+                        )
+                        .padding(6.dp)
+                ) {
+                    Row(verticalAlignment = Alignment.CenterVertically) {
+                        Text(text = "方法:", modifier = Modifier.padding(end = 8.dp))
+                        listOf(
+                            LatencyTesterActivity.DETECT_MODE_NCC to "NCC",
+                            LatencyTesterActivity.DETECT_MODE_GCC_PHAT to "GCC-PHAT"
+                        ).forEach { (mode, label) ->
+                            TextButton(onClick = { detectMode.value = mode }) { Text(text = if (detectMode.value == mode) "[$label]" else label) }
+                        }
+                    }
+                    // 测试中边录边检测，指定数量的高置信度窗口结果一致时提前结束
+                    Row(verticalAlignment = Alignment.CenterVertically) {
+                        Text(text = "提前结束:", modifier = Modifier.padding(end = 8.dp))
+                        listOf(0 to "关", 3 to "3窗口", 5 to "5窗口").forEach { (windows, label) ->
+                            TextButton(onClick = { earlyStopWindows.value = windows }) { Text(text = if (earlyStopWindows.value == windows) "[$label]" else label) }
+                        }
+                    }
+                    if (earlyStopWindows.value > 0) {
+                        Row(verticalAlignment = Alignment.CenterVertically) {
+                            Text(text = "允许偏差:", modifier = Modifier.padding(end = 8.dp))
+                            listOf(0.5, 1.0, 2.0).forEach { tolerance ->
+                                TextButton(onClick = { earlyStopToleranceMs.value = tolerance }) { Text(text = if (earlyStopToleranceMs.value == tolerance) "[${tolerance}ms]" else "${tolerance}ms") }
+                            }
+                        }
+                    }
+                }
             }
         },
         confirmButton = {
@@ -724,7 +829,10 @@ private fun ConfigDialog(
                     inLowLatency.value,
                     inSampleRate.value,
                     inChannels.value,
-                    inFormatFloat.value
+                    inFormatFloat.value,
+                    detectMode.value,
+                    earlyStopWindows.value,
+                    earlyStopToleranceMs.value
                 )
             }) { Text("保存") }
         },
@@ -0,0 +1,125 @@
+package me.rjy.oboe.record.demo
+
+import android.util.Log
+
+/**
+ * 多音轨混音播放：在一个Oboe输出流上同时播放多个录音，每条音轨有增益、声像和静音
+ * 添加音轨后start，播放完所有音轨后isFinished()为true；播放完或stop后再次start会从头播放
+ */
+class OboeMixer(audioApi: Int, deviceId: Int = -1) {
+    companion object {
+        private const val TAG = "OboeMixer"
+        const val MAX_TRACKS = 32
+
+        init {
+            System.loadLibrary("oboe_recorder_demo")
+        }
+    }
+
+    /**
+     * 混音耗时统计，耗时单位为微秒，占用为占回调时长的百分比
+     */
+    data class Stats(
+        val trackCount: Int,
+        val callCount: Long,
+        val avgMicros: Double,
+        val maxMicros: Double,
+        val maxLoadPercent: Double,
+        val avgMicrosPerTrack: Double,
+        val loadPercentPerTrack: Double
+    )
+
+    private var nativeMixer: Long = nativeCreate(audioApi, deviceId)
+    private var trackCount = 0
+
+    // 添加音轨，WAV和压缩格式以文件本身的格式为准；返回音轨序号，失败返回-1
+    fun addTrack(filePath: String, sampleRate: Int, isStereo: Boolean, isFloat: Boolean): Int {
+        if (nativeMixer == 0L) return -1
+        val track = nativeAddTrack(nativeMixer, filePath, sampleRate, isStereo, isFloat)
+        if (track >= 0) {
+            trackCount = track + 1
+        } else {
+            Log.w(TAG, "addTrack failed: $filePath")
+        }
+        return track
+    }
+
+    fun start(): Boolean {
+        if (nativeMixer == 0L) return false
+        return nativeStart(nativeMixer)
+    }
+
+    fun stop() {
+        if (nativeMixer != 0L) {
+            nativeStop(nativeMixer)
+        }
+    }
+
+    fun release() {
+        if (nativeMixer != 0L) {
+            nativeRelease(nativeMixer)
+            nativeMixer = 0
+        }
+    }
+
+    fun setTrackGain(track: Int, gain: Float) {
+        if (nativeMixer != 0L) nativeSetTrackGain(nativeMixer, track, gain)
+    }
+
+    // -1为最左，1为最右
+    fun setTrackPan(track: Int, pan: Float) {
+        if (nativeMixer != 0L) nativeSetTrackPan(nativeMixer, track, pan)
+    }
+
+    fun setTrackMute(track: Int, muted: Boolean) {
+        if (nativeMixer != 0L) nativeSetTrackMute(nativeMixer, track, muted)
+    }
+
+    fun setMasterGain(gain: Float) {
+        if (nativeMixer != 0L) nativeSetMasterGain(nativeMixer, gain)
+    }
+
+    // 上次读取以来的峰值：[0]为总输出，[1 + i]为第i条音轨
+    fun readPeaks(): FloatArray {
+        val peaks = FloatArray(trackCount + 1)
+        if (nativeMixer != 0L) {
+            nativeReadPeaks(nativeMixer, peaks)
+        }
+        return peaks
+    }
+
+    fun isFinished(): Boolean = nativeMixer != 0L && nativeIsFinished(nativeMixer)
+
+    fun getStats(): Stats {
+        val values = DoubleArray(7)
+        if (nativeMixer != 0L) {
+            nativeGetStats(nativeMixer, values)
+        }
+        return Stats(
+            values[0].toInt(), values[1].toLong(), values[2], values[3], values[4], values[5], values[6]
+        )
+    }
+
+    private external fun nativeCreate(audioApi: Int, deviceId: Int): Long
+    private external fun nativeRelease(nativeMixer: Long)
+    private external fun nativeAddTrack(
+        nativeMixer: Long,
+        filePath: String,
+        sampleRate: Int,
+        isStereo: Boolean,
+        isFloat: Boolean
+    ): Int
+    private external fun nativeStart(nativeMixer: Long): Boolean
+    private external fun nativeStop(nativeMixer: Long)
+    private external fun nativeSetTrackGain(nativeMixer: Long, track: Int, gain: Float)
+    private external fun nativeSetTrackPan(nativeMixer: Long, track: Int, pan: Float)
+    private external fun nativeSetTrackMute(nativeMixer: Long, track: Int, muted: Boolean)
+    private external fun nativeSetMasterGain(nativeMixer: Long, gain: Float)
+    private external fun nativeReadPeaks(nativeMixer: Long, out: FloatArray)
+    private external fun nativeIsFinished(nativeMixer: Long): Boolean
+    private external fun nativeGetStats(nativeMixer: Long, out: DoubleArray)
+
+    protected fun finalize() {
+        release()
+    }
+}
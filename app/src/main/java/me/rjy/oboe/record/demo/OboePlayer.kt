@@ -7,7 +7,9 @@ class OboePlayer(
     sampleRate: Int,
     isStereo: Boolean,
     isFloat: Boolean,
-    audioApi: Int
+    audioApi: Int,
+    useMmap: Boolean = true,
+    bufferCapacity: Int = 0  // 缓冲模式的缓冲区字节数，0为默认1MB，可按getPrefetchStats的数据调整
 ) {
     companion object {
         private const val TAG = "OboePlayer"
@@ -22,16 +24,57 @@ class OboePlayer(
         const val AUDIO_API_OPENSLES = 2
     }
 
+    /**
+     * 跳转统计，延迟为从请求跳转到新位置的声音被听到的估计时间
+     */
+    data class SeekStats(
+        val seekCount: Int,
+        val lastLatencyMs: Double,
+        val avgLatencyMs: Double,
+        val maxLatencyMs: Double
+    )
+
+    /**
+     * 缓冲模式（未使用内存映射）的预读统计，填充率为百分比
+     * 平均填充率长期很高、最低填充率也远离0时可以减小缓冲区，出现欠载时应增大
+     */
+    data class PrefetchStats(
+        val capacityBytes: Long,
+        val minFillPercent: Double,
+        val avgFillPercent: Double,
+        val underrunCount: Int,
+        val wakeCount: Int,
+        val readCount: Long,
+        val avgReadKB: Double,
+        val throughputMBps: Double
+    )
+
+    /**
+     * 正在从扬声器播出的位置，已按流时间戳扣除缓冲区和设备延迟
+     */
+    data class PresentationPosition(
+        val frame: Long,
+        val itemIndex: Int,
+        val progress: Float,
+        val latencyMs: Double,
+        val timestampValid: Boolean
+    )
+
     // 回调接口
     interface OnPlaybackCompleteListener {
         fun onPlaybackComplete()
+
+        // 播放列表中第index项（从0开始）的数据已读完，下一项无缝接续
+        fun onItemComplete(index: Int) {}
     }
 
     private var listener: OnPlaybackCompleteListener? = null
     private var nativePlayer: Long = 0 // 保存C++对象的指针
 
     init {
-        nativePlayer = createNativePlayer(filePath, sampleRate, isStereo, isFloat, audioApi)
+        nativePlayer = createNativePlayer(
+            filePath, sampleRate, isStereo, isFloat, audioApi, useMmap = useMmap, bufferCapacity = bufferCapacity
+        )
         if (nativePlayer == 0L) {
             throw RuntimeException("Failed to create native player")
         }
@@ -72,12 +115,81 @@ class OboePlayer(
         return nativeGetPlaybackProgress(nativePlayer)
     }
 
+    // 实际听到的位置，用于驱动波形光标；getPlaybackProgress超前一个缓冲区加设备延迟
+    fun getPresentationPosition(): PresentationPosition {
+        val values = DoubleArray(5)
+        if (nativePlayer != 0L) {
+            nativeGetPresentationPosition(nativePlayer, values)
+        }
+        return PresentationPosition(
+            values[0].toLong(), values[1].toInt(), values[2].toFloat(), values[3], values[4] != 0.0
+        )
+    }
+
+    // 总帧数，start之后有效
+    fun getTotalFrames(): Long {
+        if (nativePlayer == 0L) return 0
+        return nativeGetTotalFrames(nativePlayer)
+    }
+
+    fun seekToFrame(frame: Long) {
+        if (nativePlayer != 0L) {
+            nativeSeekToFrame(nativePlayer, frame)
+        }
+    }
+
+    // 循环播放[startFrame, endFrame)，endFrame <= startFrame时取消循环
+    fun setLoop(startFrame: Long, endFrame: Long) {
+        if (nativePlayer != 0L) {
+            nativeSetLoop(nativePlayer, startFrame, endFrame)
+        }
+    }
+
+    fun clearLoop() = setLoop(0, 0)
+
+    // 加入播放列表，当前文件读完后在同一个流上无缝接续；仅内存映射播放且格式与当前文件一致时成功
+    fun enqueue(filePath: String): Boolean {
+        if (nativePlayer == 0L) return false
+        return nativeEnqueue(nativePlayer, filePath)
+    }
+
+    // 变速不变调，范围0.5~3.0，播放中随时生效
+    fun setPlaybackSpeed(speed: Float) {
+        if (nativePlayer != 0L) {
+            nativeSetPlaybackSpeed(nativePlayer, speed)
+        }
+    }
+
+    fun getSeekStats(): SeekStats {
+        val values = DoubleArray(4)
+        if (nativePlayer != 0L) {
+            nativeGetSeekStats(nativePlayer, values)
+        }
+        return SeekStats(values[0].toInt(), values[1], values[2], values[3])
+    }
+
+    fun getPrefetchStats(): PrefetchStats {
+        val values = DoubleArray(8)
+        if (nativePlayer != 0L) {
+            nativeGetPrefetchStats(nativePlayer, values)
+        }
+        return PrefetchStats(
+            values[0].toLong(), values[1], values[2], values[3].toInt(),
+            values[4].toInt(), values[5].toLong(), values[6], values[7]
+        )
+    }
+
     // 供C++层调用的回调方法
     private fun onPlaybackComplete() {
         Log.d(TAG, "onPlaybackComplete")
         listener?.onPlaybackComplete()
     }
 
+    private fun onItemComplete(index: Int) {
+        Log.d(TAG, "onItemComplete $index")
+        listener?.onItemComplete(index)
+    }
+
     // Native方法声明
     private external fun createNativePlayer(
         filePath: String,
@@ -86,6 +198,8 @@ class OboePlayer(
         isFloat: Boolean,
         audioApi: Int,
         deviceId: Int = -1,
+        useMmap: Boolean = true,
+        bufferCapacity: Int = 0,
     ): Long
 
     private external fun nativeRelease(nativePlayer: Long)
@@ -93,6 +207,14 @@ class OboePlayer(
     private external fun nativeStop(nativePlayer: Long)
     private external fun setCallbackObject(callbackObject: Any)
     private external fun nativeGetPlaybackProgress(nativePlayer: Long): Float
+    private external fun nativeGetTotalFrames(nativePlayer: Long): Long
+    private external fun nativeSeekToFrame(nativePlayer: Long, frame: Long)
+    private external fun nativeSetLoop(nativePlayer: Long, startFrame: Long, endFrame: Long)
+    private external fun nativeEnqueue(nativePlayer: Long, filePath: String): Boolean
+    private external fun nativeSetPlaybackSpeed(nativePlayer: Long, speed: Float)
+    private external fun nativeGetSeekStats(nativePlayer: Long, out: DoubleArray)
+    private external fun nativeGetPresentationPosition(nativePlayer: Long, out: DoubleArray)
+    private external fun nativeGetPrefetchStats(nativePlayer: Long, out: DoubleArray)
 
     protected fun finalize() {
         release()
@@ -0,0 +1,144 @@
+package me.rjy.oboe.record.demo
+
+import android.util.Log
+import java.io.Closeable
+import java.io.File
+
+/**
+ * .peaks波形金字塔，native层mmap映射文件，任意缩放级别的查询耗时只与点数有关
+ * 录音时由native增量构建，其它文件首次打开时构建一次，之后直接复用
+ */
+class PeakPyramid private constructor(private var handle: Long) : Closeable {
+    val sampleRate: Int
+    val channelCount: Int
+    val totalFrames: Long
+    val levelCount: Int
+
+    init {
+        val info = LongArray(5)
+        nativeGetInfo(handle, info)
+        sampleRate = info[0].toInt()
+        channelCount = info[1].toInt()
+        totalFrames = info[2]
+        levelCount = info[3].toInt()
+    }
+
+    /**
+     * 查询[startFrame, endFrame)区间的波形，区间均分为pointCount段
+     * @param out 输出，布局为[点][声道]{min, max, rms}，长度不足时只填充前面的点
+     * @return 输出的点数，已关闭时为0
+     */
+    fun query(startFrame: Long, endFrame: Long, pointCount: Int, out: FloatArray): Int {
+        if (handle == 0L) return 0
+        return nativeQuery(handle, startFrame, endFrame, pointCount, out)
+    }
+
+    /**
+     * 转换为整个文件的正负交替包络，每段依次输出max和min，供WaveformPlayView的概览使用
+     */
+    fun overview(pointCount: Int): Pair<List<Float>, List<Float>?> {
+        val segments = (pointCount / 2).coerceAtLeast(1)
+        val values = FloatArray(segments * channelCount * 3)
+        val count = query(0, totalFrames, segments, values)
+        val left = ArrayList<Float>(count * 2)
+        val right = if (channelCount > 1) ArrayList<Float>(count * 2) else null
+        for (i in 0 until count) {
+            val base = i * channelCount * 3
+            left.add(values[base + 1])
+            left.add(values[base])
+            right?.add(values[base + 4])
+            right?.add(values[base + 3])
+        }
+        return Pair(left, right)
+    }
+
+    override fun close() {
+        if (handle != 0L) {
+            nativeClose(handle)
+            handle = 0L
+        }
+    }
+
+    companion object {
+        private const val TAG = "PeakPyramid"
+        const val SUFFIX = ".peaks"
+
+        init {
+            System.loadLibrary("oboe_recorder_demo")
+        }
+
+        // 录音文件旁的.peaks文件
+        fun sidecarOf(file: File): File = File(file.path + SUFFIX)
+
+        /**
+         * 打开文件对应的.peaks，不存在或比音频文件旧时先构建
+         * 必须在IO线程调用
+         * @param pcmParams 裸PCM/WAV的格式，为null时通过FFmpeg解码构建
+         * @param fallbackDir 音频文件所在目录不可写时存放.peaks的目录
+         */
+        fun openOrBuild(
+            file: File,
+            pcmParams: RecorderViewModel.PlaybackParams?,
+            fallbackDir: File? = null
+        ): PeakPyramid? {
+            val candidates = listOfNotNull(
+                sidecarOf(file),
+                fallbackDir?.let { File(it, "${file.name}.${file.path.hashCode().toUInt()}$SUFFIX") }
+            )
+            candidates.forEach { peaks ->
+                if (peaks.exists() && peaks.lastModified() >= file.lastModified()) {
+                    open(peaks)?.let { return it }
+                }
+            }
+
+            val start = System.nanoTime()
+            for (peaks in candidates) {
+                val built = if (pcmParams != null) {
+                    nativeBuildFromPcm(
+                        file.path,
+                        peaks.path,
+                        pcmParams.dataOffset,
+                        pcmParams.dataSize,
+                        pcmParams.sampleRate,
+                        if (pcmParams.isStereo) 2 else 1,
+                        pcmParams.isFloat
+                    )
+                } else {
+                    nativeBuildFromMedia(file.path, peaks.path)
+                }
+                if (built) {
+                    Log.d(TAG, "built ${peaks.name} in ${(System.nanoTime() - start) / 1_000_000}ms")
+                    return open(peaks)
+                }
+            }
+            Log.w(TAG, "Failed to build peaks for ${file.path}")
+            return null
+        }
+
+        fun open(peaks: File): PeakPyramid? {
+            val handle = nativeOpen(peaks.path)
+            return if (handle != 0L) PeakPyramid(handle) else null
+        }
+
+        @JvmStatic
+        private external fun nativeOpen(path: String): Long
+        @JvmStatic
+        private external fun nativeClose(handle: Long)
+        @JvmStatic
+        private external fun nativeGetInfo(handle: Long, info: LongArray)
+        @JvmStatic
+        private external fun nativeQuery(handle: Long, startFrame: Long, endFrame: Long, pointCount: Int, out: FloatArray): Int
+        @JvmStatic
+        private external fun nativeBuildFromPcm(
+            pcmPath: String,
+            peaksPath: String,
+            dataOffset: Long,
+            dataSize: Long,
+            sampleRate: Int,
+            channelCount: Int,
+            isFloat: Boolean
+        ): Boolean
+        @JvmStatic
+        private external fun nativeBuildFromMedia(inputPath: String, peaksPath: String): Boolean
+    }
+}
@@ -11,7 +11,9 @@ data class RecorderSettings(
     val isFloat: Boolean,
     val echoCanceler: Boolean,
     val audioSource: Int,
-    val audioApi: Int
+    val audioApi: Int,
+    val useFlac: Boolean,
+    val usePreroll: Boolean
 )
 
 object PreferenceManager {
@@ -24,6 +26,8 @@ object PreferenceManager {
     private const val KEY_ECHO_CANCELER = "echo_canceler"
     private const val KEY_AUDIO_SOURCE = "audio_source"
     private const val KEY_AUDIO_API = "audio_api"
+    private const val KEY_USE_FLAC = "use_flac"
+    private const val KEY_USE_PREROLL = "use_preroll"
 
     fun saveSettings(context: Context, settings: RecorderSettings) {
         context.getSharedPreferences(PREF_NAME, Context.MODE_PRIVATE).edit().apply {
@@ -35,6 +39,8 @@ object PreferenceManager {
             putBoolean(KEY_ECHO_CANCELER, settings.echoCanceler)
             putInt(KEY_AUDIO_SOURCE, settings.audioSource)
             putInt(KEY_AUDIO_API, settings.audioApi)
+            putBoolean(KEY_USE_FLAC, settings.useFlac)
+            putBoolean(KEY_USE_PREROLL, settings.usePreroll)
             apply()
         }
     }
@@ -49,7 +55,9 @@ object PreferenceManager {
             isFloat = prefs.getBoolean(KEY_IS_FLOAT, false),
             echoCanceler = prefs.getBoolean(KEY_ECHO_CANCELER, false),
             audioSource = prefs.getInt(KEY_AUDIO_SOURCE, MediaRecorder.AudioSource.DEFAULT),
-            audioApi = prefs.getInt(KEY_AUDIO_API, 0)
+            audioApi = prefs.getInt(KEY_AUDIO_API, 0),
+            useFlac = prefs.getBoolean(KEY_USE_FLAC, false),
+            usePreroll = prefs.getBoolean(KEY_USE_PREROLL, false)
         )
     }
 } 
\ No newline at end of file
@@ -21,8 +21,10 @@ import androidx.lifecycle.ViewModel
 import androidx.lifecycle.viewModelScope
 import kotlinx.coroutines.DelicateCoroutinesApi
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
 import kotlinx.coroutines.asCoroutineDispatcher
 import kotlinx.coroutines.delay
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.newSingleThreadContext
 import kotlinx.coroutines.withContext
@@ -44,12 +46,24 @@ class RecorderViewModel : ViewModel() {
     private var mediaPlayer: MediaPlayer? = null
     private var amplitudeCalculator: AmplitudeCalculator? = null
     private var oboePlayer: OboePlayer? = null
+    private var compressedPlayer: MediaPlayer? = null  // 播放FLAC等压缩格式的录音
+    private var playbackPeaks: PeakPyramid? = null  // 当前回放波形使用的.peaks，换文件时关闭
+    private var oboeMixer: OboeMixer? = null  // 多个录音同时试听
 
     @Volatile
     private var stopRecord = false
 
     @Volatile
     private var stopPlayPcm = false
+    // 连续播放：尚未交给播放器的文件，以及已加入播放列表、等待接续的下一个文件
+    private val pendingPlaylist = ArrayDeque<String>()
+    private var enqueuedPath: String? = null
+
+    // Oboe录音时与native共享的音频数据通道，按界面刷新频率拉取
+    private var audioChannelBuffer: ByteBuffer? = null
+    private var audioPollJob: Job? = null
+    private val audioPollState = LongArray(3)
+    private var reportedLostPoints = 0L
     val recordingStatus = mutableStateOf(false)
     val pcmPlayingStatus = mutableStateOf(false)
     val echoCanceler = mutableStateOf(false)
@@ -60,6 +74,8 @@ class RecorderViewModel : ViewModel() {
     val useOboePlayback = mutableStateOf(true)  // true使用oboe播放,false使用AudioTrack播放
     val selectedAudioSource = mutableIntStateOf(MediaRecorder.AudioSource.DEFAULT) // 选中的音频源
     val selectedAudioApi = mutableIntStateOf(0) // 选中的AudioApi: 0=Unspecified, 1=AAudio, 2=OpenSLES
+    val useFlac = mutableStateOf(false)  // Oboe录音时true保存为FLAC,false保存为WAV
+    val usePreroll = mutableStateOf(false)  // Oboe预录模式：只保存触发前后的录音
 
     // 波形数据
     private val _leftChannelBuffer = WaveformBuffer(150)
@@ -75,19 +91,36 @@ class RecorderViewModel : ViewModel() {
     data class PlaybackWaveform(
         val leftChannel: List<Float>,
         val rightChannel: List<Float>?,  // 单声道时为null
-        val totalSamples: Int
+        val totalSamples: Int,
+        val peaks: PeakPyramid? = null   // 有.peaks时波形视图支持缩放
     )
     val playbackWaveform = mutableStateOf<PlaybackWaveform?>(null)
     val playbackProgress = mutableFloatStateOf(0f)  // 0.0 ~ 1.0
+    // A/B循环区间（占全长的比例）：长按波形先标记起点再标记终点，再次长按取消
+    val playbackLoop = mutableStateOf<Pair<Float, Float>?>(null)
+    val loopStartMarker = mutableStateOf<Float?>(null)
+    // 播放速度，变速不变调，保留到下一次播放
+    val playbackSpeed = mutableFloatStateOf(1f)
+
+    // 混音试听的音轨状态，peak为最近一次刷新的峰值（0~1，超过1表示削波）
+    data class MixerTrackState(
+        val name: String,
+        val gain: Float = 1f,
+        val pan: Float = 0f,
+        val muted: Boolean = false,
+        val peak: Float = 0f
+    )
+    val mixerTracks = mutableStateOf<List<MixerTrackState>>(emptyList())
+    val mixerMasterPeak = mutableFloatStateOf(0f)
 
     // 更新振幅计算策略
     private fun updateAmplitudeCalculator() {
-        amplitudeCalculator = when {
-            isFloat.value && isStereo.value -> FloatStereoAmplitudeCalculator(samplesPerUpdate)
-            isFloat.value && !isStereo.value -> FloatMonoAmplitudeCalculator(samplesPerUpdate)
-            !isFloat.value && isStereo.value -> ShortStereoAmplitudeCalculator(samplesPerUpdate)
-            else -> ShortMonoAmplitudeCalculator(samplesPerUpdate)
-        }
+        amplitudeCalculator?.release()
+        amplitudeCalculator = NativeAmplitudeCalculator(
+            if (isStereo.value) 2 else 1,
+            isFloat.value,
+            samplesPerUpdate
+        )
     }
 
     // 计算一组采样的振幅
@@ -163,8 +196,15 @@ class RecorderViewModel : ViewModel() {
     data class PlaybackParams(
         val isStereo: Boolean,
         val sampleRate: Int,
-        val isFloat: Boolean
-    )
+        val isFloat: Boolean,
+        // 音频数据在文件中的偏移，裸PCM为0
+        val dataOffset: Long = 0,
+        // 音频数据长度，-1表示到文件末尾
+        val dataSize: Long = -1
+    ) {
+        fun dataLength(file: File): Long =
+            if (dataSize >= 0) dataSize else (file.length() - dataOffset).coerceAtLeast(0)
+    }
 
     init {
         // 加载保存的设置
@@ -182,6 +222,8 @@ class RecorderViewModel : ViewModel() {
         echoCanceler.value = settings.echoCanceler
         selectedAudioSource.intValue = settings.audioSource
         selectedAudioApi.intValue = settings.audioApi
+        useFlac.value = settings.useFlac
+        usePreroll.value = settings.usePreroll
         updateAmplitudeCalculator()
     }
 
@@ -194,7 +236,9 @@ class RecorderViewModel : ViewModel() {
             isFloat = isFloat.value,
             echoCanceler = echoCanceler.value,
             audioSource = selectedAudioSource.intValue,
-            audioApi = selectedAudioApi.intValue
+            audioApi = selectedAudioApi.intValue,
+            useFlac = useFlac.value,
+            usePreroll = usePreroll.value
         )
         PreferenceManager.saveSettings(context, settings)
     }
@@ -235,6 +279,7 @@ class RecorderViewModel : ViewModel() {
             return
         }
         sampleRate.intValue = value
+        updateAmplitudeCalculator()
         onSettingsChanged()
     }
 
@@ -271,6 +316,29 @@ class RecorderViewModel : ViewModel() {
         onSettingsChanged()
     }
 
+    fun setUseFlac(value: Boolean) {
+        if (recordingStatus.value) {
+            return
+        }
+        useFlac.value = value
+        onSettingsChanged()
+    }
+
+    fun setUsePreroll(value: Boolean) {
+        if (recordingStatus.value) {
+            return
+        }
+        usePreroll.value = value
+        onSettingsChanged()
+    }
+
+    // 预录模式下手动保存一次事件：触发前PREROLL_MS的历史加上之后的录音
+    fun triggerCapture() {
+        if (recordingStatus.value && useOboe.value && usePreroll.value) {
+            native_trigger_capture()
+        }
+    }
+
     fun refreshAudioDevices(context: Context) {
         val deviceList = mutableListOf<AudioDevice>()
 
@@ -444,8 +512,62 @@ class RecorderViewModel : ViewModel() {
         deviceId: Int,
         audioSource: Int,
         audioApi: Int,
+        framesPerPoint: Int,
+        prerollMs: Int,
+        triggerLevel: Float,
     ): Boolean
     private external fun native_stop_record()
+    private external fun native_trigger_capture(): Boolean
+    private external fun native_get_audio_buffer(): ByteBuffer?
+    // state: [0]可读区域偏移 [1]可读字节数 [2]累计丢失的波形点数
+    private external fun native_poll_audio(state: LongArray)
+    private external fun native_commit_audio(size: Int)
+
+    private fun startAudioChannelPolling() {
+        val buffer = native_get_audio_buffer() ?: return
+        audioChannelBuffer = buffer.order(ByteOrder.LITTLE_ENDIAN)
+        reportedLostPoints = 0
+        audioPollJob?.cancel()
+        audioPollJob = viewModelScope.launch(Dispatchers.Main) {
+            while (isActive) {
+                drainAudioChannel()
+                delay(AUDIO_POLL_PERIOD_MS)
+            }
+        }
+    }
+
+    private fun stopAudioChannelPolling() {
+        audioPollJob?.cancel()
+        audioPollJob = null
+        drainAudioChannel()
+        audioChannelBuffer = null
+    }
+
+    // 取出共享通道中native已抽取好的包络点，每个点为（左、右）两个float，单声道时右声道为NaN
+    private fun drainAudioChannel() {
+        val buffer = audioChannelBuffer ?: return
+        while (true) {
+            native_poll_audio(audioPollState)
+            val offset = audioPollState[0].toInt()
+            val size = audioPollState[1].toInt()
+            if (size <= 0) break
+
+            for (pos in offset until offset + size step 8) {
+                val leftAmplitude = buffer.getFloat(pos)
+                val rightAmplitude = buffer.getFloat(pos + 4)
+                _leftChannelBuffer.write(leftAmplitude)
+                // 单声道时左右声道使用相同数据
+                _rightChannelBuffer.write(if (rightAmplitude.isNaN()) leftAmplitude else rightAmplitude)
+            }
+            native_commit_audio(size)
+        }
+
+        val lostPoints = audioPollState[2]
+        if (lostPoints > reportedLostPoints) {
+            Log.w(TAG, "audio channel overflow, lost ${lostPoints - reportedLostPoints} waveform points")
+            reportedLostPoints = lostPoints
+        }
+    }
 
     @OptIn(DelicateCoroutinesApi::class)
     private fun startOboeRecord(pcmPath: String) {
@@ -460,7 +582,15 @@ class RecorderViewModel : ViewModel() {
                     selectedDeviceId.intValue,
                     selectedAudioSource.intValue,
                     selectedAudioApi.intValue,
+                    samplesPerUpdate,
+                    if (usePreroll.value) PREROLL_MS else 0,
+                    PREROLL_TRIGGER_LEVEL,
                 )
+                if (recordingStatus.value) {
+                    withContext(Dispatchers.Main) {
+                        startAudioChannelPolling()
+                    }
+                }
                 // 初始化失败时清空波形数据
                 _leftChannelBuffer.clear()
                 _rightChannelBuffer.clear()
@@ -477,6 +607,7 @@ class RecorderViewModel : ViewModel() {
     fun stopRecord() {
         stopRecord = true
         if (useOboe.value) {
+            stopAudioChannelPolling()
             native_stop_record()
             recordingStatus.value = false
             // 移除停止录音时清空波形数据的代码
@@ -494,9 +625,23 @@ class RecorderViewModel : ViewModel() {
         }
     }
 
-    // 从文件名解析播放参数
-    private fun parsePlaybackParams(fileName: String): PlaybackParams {
+    // 解析播放参数：WAV文件读取文件头，裸PCM从文件名解析
+    private fun parsePlaybackParams(file: File): PlaybackParams {
+        if (file.name.endsWith(".wav")) {
+            WavHeader.read(file)?.let { info ->
+                return PlaybackParams(
+                    isStereo = info.channelCount == 2,
+                    sampleRate = info.sampleRate,
+                    isFloat = info.isFloat,
+                    dataOffset = info.dataOffset,
+                    dataSize = info.dataSize
+                )
+            }
+            Log.w(TAG, "invalid wav header: ${file.name}")
+        }
+
         // 默认参数
+        val fileName = file.name
         var isStereo = false
         var sampleRate = 48000
         var isFloat = false
@@ -524,9 +669,19 @@ class RecorderViewModel : ViewModel() {
     fun playPcm(pcmPath: String) {
         Log.d(TAG, "playPcm $pcmPath")
 
-        // 从文件名解析播放参数
-        val fileName = File(pcmPath).name
-        val playbackParams = parsePlaybackParams(fileName)
+        if (COMPRESSED_FILE_EXTENSIONS.any { pcmPath.endsWith(it, ignoreCase = true) }) {
+            if (useOboePlayback.value) {
+                // Oboe播放时由FFmpeg边解码边播放，格式以文件为准
+                loadWaveformFromMedia(pcmPath)
+                playbackProgress.floatValue = 0f
+                startOboePlayback(pcmPath, PlaybackParams(isStereo = true, sampleRate = 48000, isFloat = true))
+            } else {
+                startCompressedPlayback(pcmPath)
+            }
+            return
+        }
+
+        val playbackParams = parsePlaybackParams(File(pcmPath))
         
         // 加载波形数据
         loadWaveformFromPcm(pcmPath, playbackParams)
@@ -558,11 +713,29 @@ class RecorderViewModel : ViewModel() {
                         pcmPlayingStatus.value = false
                         playbackWaveform.value = null
                         playbackProgress.floatValue = 0f
+                        resetLoop()
+                        logSeekStats()
+                        logPrefetchStats()
                         oboePlayer?.release()
                         oboePlayer = null
+                        enqueuedPath = null
+                        // 未能无缝接续的文件（格式不同等）重新打开流播放
+                        pendingPlaylist.removeFirstOrNull()?.let { playPcm(it) }
+                    }
+                }
+
+                override fun onItemComplete(index: Int) {
+                    viewModelScope.launch(Dispatchers.Main) {
+                        val next = enqueuedPath ?: return@launch
+                        enqueuedPath = null
+                        loadWaveformFromPcm(next, parsePlaybackParams(File(next)))
+                        playbackProgress.floatValue = 0f
+                        resetLoop()
+                        enqueueNextPlaylistItem()
                     }
                 }
             })
+            setPlaybackSpeed(playbackSpeed.floatValue)
         }
 
         // 开始播放
@@ -576,11 +749,12 @@ class RecorderViewModel : ViewModel() {
                 oboePlayer?.release()
                 oboePlayer = null
             } else {
+                enqueueNextPlaylistItem()
                 // 启动进度更新协程
                 viewModelScope.launch {
                     while (pcmPlayingStatus.value) {
                         oboePlayer?.let { player ->
-                            playbackProgress.floatValue = player.getPlaybackProgress()
+                            playbackProgress.floatValue = player.getPresentationPosition().progress
                         }
                         delay(20) // 每100毫秒更新一次
                     }
@@ -596,14 +770,251 @@ class RecorderViewModel : ViewModel() {
         }
     }
 
+    // 压缩格式交给系统解码器播放，波形通过MediaCodec解码提取
+    private fun startCompressedPlayback(path: String) {
+        stopPlayPcm = false
+        pcmPlayingStatus.value = true
+        playbackProgress.floatValue = 0f
+
+        loadWaveformFromMedia(path)
+
+        val player = MediaPlayer()
+        compressedPlayer = player
+        try {
+            player.setDataSource(path)
+            player.setOnCompletionListener { stopCompressedPlayback() }
+            player.prepare()
+            if (playbackSpeed.floatValue != 1f) {
+                player.playbackParams = player.playbackParams.setSpeed(playbackSpeed.floatValue)
+            }
+            player.start()
+            viewModelScope.launch {
+                while (pcmPlayingStatus.value && compressedPlayer === player) {
+                    val duration = player.duration
+                    if (duration > 0) {
+                        playbackProgress.floatValue = player.currentPosition.toFloat() / duration
+                    }
+                    delay(20)
+                }
+            }
+        } catch (e: Exception) {
+            Log.e(TAG, "Compressed playback failed", e)
+            stopCompressedPlayback()
+        }
+    }
+
+    // 压缩格式的波形：优先使用.peaks，失败时通过MediaCodec解码提取
+    private fun loadWaveformFromMedia(path: String) {
+        viewModelScope.launch {
+            val peaks = withContext(Dispatchers.IO) { PeakPyramid.openOrBuild(File(path), null) }
+            if (peaks != null) {
+                showPeaks(peaks)
+                return@launch
+            }
+            AudioDecoder().extractWaveform(path, MAX_WAVEFORM_POINTS)?.let { data ->
+                playbackWaveform.value = PlaybackWaveform(
+                    leftChannel = data.leftChannel,
+                    rightChannel = data.rightChannel,
+                    totalSamples = data.audioInfo.totalSamples.toInt()
+                )
+            }
+        }
+    }
+
+    private fun stopCompressedPlayback() {
+        compressedPlayer?.release()
+        compressedPlayer = null
+        pcmPlayingStatus.value = false
+        playbackWaveform.value = null
+        playbackProgress.floatValue = 0f
+        resetLoop()
+    }
+
     private fun stopPlayback() {
         stopPlayPcm = true
+        pendingPlaylist.clear()
+        enqueuedPath = null
         oboePlayer?.stop()
+        logSeekStats()
+        logPrefetchStats()
         oboePlayer?.release()
         oboePlayer = null
         pcmPlayingStatus.value = false
         playbackWaveform.value = null
         playbackProgress.floatValue = 0f
+        resetLoop()
+    }
+
+    // 按列表顺序连续播放所有PCM/WAV文件，Oboe播放时文件之间无缝接续
+    fun playAll() {
+        val paths = pcmFileList.value.map { it.file.absolutePath }
+        if (paths.isEmpty()) return
+        pendingPlaylist.clear()
+        if (useOboePlayback.value) {
+            pendingPlaylist.addAll(paths.drop(1))
+        }
+        playPcm(paths.first())
+    }
+
+    // 把选中的录音（如近场和远场麦克风）放在一个输出流上同时播放
+    fun mixSelectedFiles() {
+        val files = selectedFiles.value.sortedBy { it.name }.take(OboeMixer.MAX_TRACKS)
+        selectedFiles.value = emptySet()
+        isEditMode.value = false
+        if (files.isEmpty()) return
+        stopPcm()
+
+        val mixer = OboeMixer(selectedAudioApi.intValue)
+        val tracks = mutableListOf<MixerTrackState>()
+        files.forEach { file ->
+            val params = if (COMPRESSED_FILE_EXTENSIONS.any { file.name.endsWith(it, ignoreCase = true) }) {
+                PlaybackParams(isStereo = true, sampleRate = 48000, isFloat = true)
+            } else {
+                parsePlaybackParams(file)
+            }
+            if (mixer.addTrack(file.absolutePath, params.sampleRate, params.isStereo, params.isFloat) >= 0) {
+                tracks.add(MixerTrackState(file.nameWithoutExtension))
+            }
+        }
+        if (tracks.isEmpty() || !mixer.start()) {
+            Log.e(TAG, "Failed to start mixer")
+            mixer.release()
+            return
+        }
+        oboeMixer = mixer
+        mixerTracks.value = tracks
+        stopPlayPcm = false
+        pcmPlayingStatus.value = true
+
+        // 刷新峰值表，峰值按界面刷新间隔衰减，播放完所有音轨后停止
+        viewModelScope.launch {
+            while (oboeMixer === mixer) {
+                val peaks = mixer.readPeaks()
+                mixerMasterPeak.floatValue = maxOf(peaks[0], mixerMasterPeak.floatValue * 0.8f)
+                mixerTracks.value = mixerTracks.value.mapIndexed { index, track ->
+                    track.copy(peak = maxOf(peaks[index + 1], track.peak * 0.8f))
+                }
+                if (mixer.isFinished()) {
+                    stopMixer()
+                    break
+                }
+                delay(50)
+            }
+        }
+    }
+
+    fun setMixerTrackGain(index: Int, gain: Float) {
+        oboeMixer?.setTrackGain(index, gain)
+        updateMixerTrack(index) { it.copy(gain = gain) }
+    }
+
+    fun setMixerTrackPan(index: Int, pan: Float) {
+        oboeMixer?.setTrackPan(index, pan)
+        updateMixerTrack(index) { it.copy(pan = pan) }
+    }
+
+    fun setMixerTrackMute(index: Int, muted: Boolean) {
+        oboeMixer?.setTrackMute(index, muted)
+        updateMixerTrack(index) { it.copy(muted = muted) }
+    }
+
+    private fun updateMixerTrack(index: Int, update: (MixerTrackState) -> MixerTrackState) {
+        mixerTracks.value = mixerTracks.value.mapIndexed { i, track -> if (i == index) update(track) else track }
+    }
+
+    private fun stopMixer() {
+        val mixer = oboeMixer ?: return
+        oboeMixer = null
+        mixer.stop()
+        val stats = mixer.getStats()
+        Log.d(TAG, "mixer: tracks=${stats.trackCount} avg=${"%.1f".format(stats.avgMicros)}us " +
+                "max=${"%.1f".format(stats.maxMicros)}us maxLoad=${"%.1f".format(stats.maxLoadPercent)}% " +
+                "perTrack=${"%.2f".format(stats.avgMicrosPerTrack)}us (${"%.2f".format(stats.loadPercentPerTrack)}%)")
+        mixer.release()
+        mixerTracks.value = emptyList()
+        mixerMasterPeak.floatValue = 0f
+        pcmPlayingStatus.value = false
+    }
+
+    // 提前把下一个文件交给播放器映射和预读，一次只预备一个
+    private fun enqueueNextPlaylistItem() {
+        val player = oboePlayer ?: return
+        val next = pendingPlaylist.firstOrNull() ?: return
+        if (player.enqueue(next)) {
+            pendingPlaylist.removeFirst()
+            enqueuedPath = next
+        }
+    }
+
+    // 点击波形跳转，fraction为占全长的比例
+    fun seekPlayback(fraction: Float) {
+        val target = fraction.coerceIn(0f, 1f)
+        oboePlayer?.let { player ->
+            player.seekToFrame((player.getTotalFrames() * target.toDouble()).toLong())
+            playbackProgress.floatValue = target
+            return
+        }
+        compressedPlayer?.let { player ->
+            player.seekTo((player.duration * target).toInt())
+            playbackProgress.floatValue = target
+        }
+    }
+
+    fun setPlaybackSpeed(speed: Float) {
+        playbackSpeed.floatValue = speed
+        oboePlayer?.setPlaybackSpeed(speed)
+        compressedPlayer?.let { player ->
+            try {
+                player.playbackParams = player.playbackParams.setSpeed(speed)
+            } catch (e: IllegalStateException) {
+                Log.w(TAG, "Failed to set playback speed", e)
+            }
+        }
+    }
+
+    // 长按波形设置A/B循环，仅Oboe播放支持
+    fun markLoopPoint(fraction: Float) {
+        val player = oboePlayer ?: return
+        val start = loopStartMarker.value
+        when {
+            playbackLoop.value != null -> {
+                player.clearLoop()
+                resetLoop()
+            }
+            start == null -> loopStartMarker.value = fraction.coerceIn(0f, 1f)
+            else -> {
+                val end = fraction.coerceIn(0f, 1f)
+                val loop = if (start <= end) start to end else end to start
+                val totalFrames = player.getTotalFrames().toDouble()
+                player.setLoop((loop.first * totalFrames).toLong(), (loop.second * totalFrames).toLong())
+                playbackLoop.value = loop
+                loopStartMarker.value = null
+            }
+        }
+    }
+
+    private fun resetLoop() {
+        playbackLoop.value = null
+        loopStartMarker.value = null
+    }
+
+    private fun logSeekStats() {
+        val stats = oboePlayer?.getSeekStats() ?: return
+        if (stats.seekCount > 0) {
+            Log.d(TAG, "seek latency: count=${stats.seekCount} last=${"%.1f".format(stats.lastLatencyMs)}ms " +
+                    "avg=${"%.1f".format(stats.avgLatencyMs)}ms max=${"%.1f".format(stats.maxLatencyMs)}ms")
+        }
+    }
+
+    // 缓冲模式的预读统计，用于按设备确定缓冲区大小
+    private fun logPrefetchStats() {
+        val stats = oboePlayer?.getPrefetchStats() ?: return
+        if (stats.readCount > 0) {
+            Log.d(TAG, "prefetch: capacity=${stats.capacityBytes / 1024}KB " +
+                    "fill min=${"%.1f".format(stats.minFillPercent)}% avg=${"%.1f".format(stats.avgFillPercent)}% " +
+                    "underruns=${stats.underrunCount} wakes=${stats.wakeCount} reads=${stats.readCount} " +
+                    "avgRead=${"%.0f".format(stats.avgReadKB)}KB throughput=${"%.1f".format(stats.throughputMBps)}MB/s")
+        }
     }
 
     @OptIn(DelicateCoroutinesApi::class)
@@ -641,6 +1052,7 @@ class RecorderViewModel : ViewModel() {
         pcmPlayingStatus.value = true
         viewModelScope.launch(newSingleThreadContext("play-pcm-thread")) {
             val fi = FileInputStream(pcmPath)
+            fi.skipFully(playbackParams.dataOffset)
             val buffer = if (playbackParams.isFloat) {
                 ByteArray(size = bufferSizeInBytes)
             } else {
@@ -648,11 +1060,11 @@ class RecorderViewModel : ViewModel() {
             }
             var count: Int
             var totalBytesRead = 0L
-            val totalBytes = File(pcmPath).length()
+            val totalBytes = playbackParams.dataLength(File(pcmPath))
             audioTrack.play()
 
-            while (!stopPlayPcm) {
-                count = fi.read(buffer)
+            while (!stopPlayPcm && totalBytesRead < totalBytes) {
+                count = fi.read(buffer, 0, minOf(buffer.size.toLong(), totalBytes - totalBytesRead).toInt())
                 if (count > 0) {
                     totalBytesRead += count
                     // 更新播放进度
@@ -692,9 +1104,15 @@ class RecorderViewModel : ViewModel() {
 
     fun stopPcm() {
         stopPlayPcm = true
+        if (oboeMixer != null) {
+            stopMixer()
+        }
         if (oboePlayer != null) {
             stopPlayback()
         }
+        if (compressedPlayer != null) {
+            stopCompressedPlayback()
+        }
     }
 
     private fun getOutChannel(channel: Int): Int {
@@ -737,23 +1155,8 @@ class RecorderViewModel : ViewModel() {
         // 添加日期到最后
         parts.add(dateStr)
 
-        return parts.joinToString("_") + ".pcm"
-    }
 
-    // 供native层调用的方法，用于处理音频数据
-    @Keep
-    private fun onAudioData(audioData: ByteArray, size: Int) {
-        val buffer = ByteBuffer.wrap(audioData)
-        calculateAmplitude(buffer, size) { leftAmplitude, rightAmplitude ->
-            viewModelScope.launch(Dispatchers.Main) {
-                _leftChannelBuffer.write(leftAmplitude)
-                if (rightAmplitude != null) {
-                    _rightChannelBuffer.write(rightAmplitude)
-                } else {
-                    _rightChannelBuffer.write(leftAmplitude)  // 单声道时左右声道使用相同数据
-                }
-            }
-        }
+        return parts.joinToString("_") + extension
     }
 
     // 供native层调用的方法，用于处理错误
@@ -789,7 +1192,7 @@ class RecorderViewModel : ViewModel() {
     fun refreshPcmFileList(context: Context) {
         val filesDir = context.filesDir
         val files = filesDir.listFiles { file ->
-            file.isFile && file.name.endsWith(".pcm")
+            file.isFile && RECORD_FILE_EXTENSIONS.any { file.name.endsWith(it) }
         } ?: emptyArray()
         
         pcmFileList.value = files.map { file ->
@@ -825,6 +1228,7 @@ class RecorderViewModel : ViewModel() {
     fun deleteSelectedFiles(context: Context, onAllFilesDeleted: () -> Unit) {
         selectedFiles.value.forEach { file ->
             file.delete()
+            PeakPyramid.sidecarOf(file).delete()
         }
         // 刷新文件列表
         refreshPcmFileList(context)
@@ -838,12 +1242,31 @@ class RecorderViewModel : ViewModel() {
         }
     }
 
-    // 从PCM文件加载波形数据
+    // 用.peaks显示回放波形，并关闭上一个文件的.peaks（在主线程调用）
+    private fun showPeaks(peaks: PeakPyramid) {
+        playbackPeaks?.close()
+        playbackPeaks = peaks
+        val (left, right) = peaks.overview(MAX_WAVEFORM_POINTS)
+        playbackWaveform.value = PlaybackWaveform(
+            leftChannel = left,
+            rightChannel = right,
+            totalSamples = peaks.totalFrames.toInt(),
+            peaks = peaks
+        )
+    }
+
+    // 从PCM文件加载波形数据，优先使用.peaks，构建失败时直接扫描整个文件
     private fun loadWaveformFromPcm(pcmPath: String, playbackParams: PlaybackParams) {
         viewModelScope.launch(Dispatchers.IO) {
             try {
                 val file = File(pcmPath)
-                val totalBytes = file.length()
+                val peaks = PeakPyramid.openOrBuild(file, playbackParams)
+                if (peaks != null) {
+                    withContext(Dispatchers.Main) { showPeaks(peaks) }
+                    return@launch
+                }
+
+                val totalBytes = playbackParams.dataLength(file)
                 val bytesPerSample = if (playbackParams.isFloat) 4 else 2
                 val channelCount = if (playbackParams.isStereo) 2 else 1
                 val totalSamples = (totalBytes / (bytesPerSample * channelCount)).toInt()
@@ -854,28 +1277,39 @@ class RecorderViewModel : ViewModel() {
                 val rightChannel = if (playbackParams.isStereo) mutableListOf<Float>() else null
 
                 // 创建合适的振幅计算器
-                val amplitudeCalculator = when {
-                    playbackParams.isFloat && playbackParams.isStereo -> FloatStereoAmplitudeCalculator(samplesPerPixel)
-                    playbackParams.isFloat && !playbackParams.isStereo -> FloatMonoAmplitudeCalculator(samplesPerPixel)
-                    !playbackParams.isFloat && playbackParams.isStereo -> ShortStereoAmplitudeCalculator(samplesPerPixel)
-                    else -> ShortMonoAmplitudeCalculator(samplesPerPixel)
-                }
-                
-                FileInputStream(file).use { fis ->
-                    val buffer = ByteArray(samplesPerPixel * bytesPerSample * channelCount)
-                    
-                    while (true) {
-                        val bytesRead = fis.read(buffer)
-                        if (bytesRead <= 0) break
-                        
-                        val byteBuffer = ByteBuffer.wrap(buffer, 0, bytesRead)
-                        amplitudeCalculator.calculateAmplitude(byteBuffer, bytesRead) { left, right ->
-                            leftChannel.add(left)
-                            right?.let { rightChannel?.add(it) }
+                val amplitudeCalculator = NativeAmplitudeCalculator(channelCount, playbackParams.isFloat, samplesPerPixel)
+
+                try {
+                    FileInputStream(file).use { fis ->
+                        fis.skipFully(playbackParams.dataOffset)
+                        val channel = fis.channel
+                        // 直接读入DirectByteBuffer交给native计算，大小为整帧
+                        val bytesPerFrame = bytesPerSample * channelCount
+                        val buffer = ByteBuffer.allocateDirect(WAVEFORM_READ_CHUNK_BYTES / bytesPerFrame * bytesPerFrame)
+                        var remaining = totalBytes
+
+                        while (remaining > 0) {
+                            buffer.clear()
+                            buffer.limit(minOf(buffer.capacity().toLong(), remaining).toInt())
+                            while (buffer.hasRemaining() && channel.read(buffer) > 0) {
+                                // 读满为止，保证每次送入的数据按帧对齐
+                            }
+                            val bytesRead = buffer.position()
+                            if (bytesRead <= 0) break
+                            remaining -= bytesRead
+
+                            amplitudeCalculator.calculateAmplitude(buffer, bytesRead) { left, right ->
+                                leftChannel.add(left)
+                                right?.let { rightChannel?.add(it) }
+                            }
+                            if (bytesRead < buffer.limit()) break
                         }
                     }
+                } finally {
+                    amplitudeCalculator.release()
                 }
-                
+
+
                 withContext(Dispatchers.Main) {
                     playbackWaveform.value = PlaybackWaveform(
                         leftChannel = leftChannel,
@@ -889,10 +1323,28 @@ class RecorderViewModel : ViewModel() {
         }
     }
 
+    // 跳过文件头，skip可能一次跳不完
+    private fun FileInputStream.skipFully(count: Long) {
+        var remaining = count
+        while (remaining > 0) {
+            val skipped = skip(remaining)
+            if (skipped <= 0) break
+            remaining -= skipped
+        }
+    }
+
     override fun onCleared() {
         super.onCleared()
         oboePlayer?.release()
         oboePlayer = null
+        oboeMixer?.release()
+        oboeMixer = null
+        compressedPlayer?.release()
+        compressedPlayer = null
+        amplitudeCalculator?.release()
+        amplitudeCalculator = null
+        playbackPeaks?.close()
+        playbackPeaks = null
     }
 
     companion object {
@@ -901,5 +1353,16 @@ class RecorderViewModel : ViewModel() {
         const val SAMPLE_UPDATE_PERIOD_MS = 10
         // 最大波形点数
         const val MAX_WAVEFORM_POINTS = 1000
+        // 加载回放波形时每次读取的字节数
+        private const val WAVEFORM_READ_CHUNK_BYTES = 256 * 1024
+        // 录音时拉取共享通道数据的周期，与屏幕刷新频率相当，单位：毫秒
+        private const val AUDIO_POLL_PERIOD_MS = 16L
+        // 预录时长，单位：毫秒
+        private const val PREROLL_MS = 10_000
+        // 预录模式下自动触发的峰值电平（约-12dBFS），设为0则只能手动触发
+        private const val PREROLL_TRIGGER_LEVEL = 0.25f
+        // 录音文件列表中显示的扩展名
+        private val RECORD_FILE_EXTENSIONS = listOf(".pcm", ".wav", ".flac", ".m4a", ".opus")
+        private val COMPRESSED_FILE_EXTENSIONS = listOf(".flac", ".m4a", ".opus", ".ogg", ".mp3", ".aac")
     }
 }
\ No newline at end of file
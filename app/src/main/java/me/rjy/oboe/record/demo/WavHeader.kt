@@ -0,0 +1,97 @@
+package me.rjy.oboe.record.demo
+
+import java.io.File
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+// WAV/RF64文件头解析，只支持16位整数与32位浮点PCM
+object WavHeader {
+    private const val FORMAT_PCM = 0x0001
+    private const val FORMAT_IEEE_FLOAT = 0x0003
+    private const val FORMAT_EXTENSIBLE = 0xFFFE
+    private const val PROBE_SIZE = 64 * 1024
+
+    data class Info(
+        val sampleRate: Int,
+        val channelCount: Int,
+        val isFloat: Boolean,
+        // 音频数据在文件中的偏移
+        val dataOffset: Long,
+        // 音频数据长度，已按文件实际大小截断
+        val dataSize: Long
+    )
+
+    fun read(file: File): Info? {
+        return try {
+            RandomAccessFile(file, "r").use { raf ->
+                val head = ByteArray(minOf(PROBE_SIZE.toLong(), raf.length()).toInt())
+                raf.readFully(head)
+                parse(ByteBuffer.wrap(head).order(ByteOrder.LITTLE_ENDIAN), raf.length())
+            }
+        } catch (e: Exception) {
+            null
+        }
+    }
+
+    private fun parse(buffer: ByteBuffer, fileLength: Long): Info? {
+        if (buffer.limit() < 12 || tag(buffer, 8) != "WAVE") return null
+        val isRf64 = when (tag(buffer, 0)) {
+            "RF64" -> true
+            "RIFF" -> false
+            else -> return null
+        }
+
+        var sampleRate = 0
+        var channelCount = 0
+        var isFloat = false
+        var hasFormat = false
+        var ds64DataSize = 0L
+        var pos = 12
+        while (pos + 8 <= buffer.limit()) {
+            val chunkSize = buffer.getInt(pos + 4).toLong() and 0xFFFFFFFFL
+            val body = pos + 8
+            val bodyAvailable = buffer.limit() - body
+            when (tag(buffer, pos)) {
+                "ds64" -> if (bodyAvailable >= 24) ds64DataSize = buffer.getLong(body + 8)
+                "fmt " -> {
+                    if (bodyAvailable < 16) return null
+                    var formatTag = buffer.getShort(body).toInt() and 0xFFFF
+                    channelCount = buffer.getShort(body + 2).toInt() and 0xFFFF
+                    sampleRate = buffer.getInt(body + 4)
+                    val bits = buffer.getShort(body + 14).toInt() and 0xFFFF
+                    if (formatTag == FORMAT_EXTENSIBLE && chunkSize >= 40 && bodyAvailable >= 26) {
+                        formatTag = buffer.getShort(body + 24).toInt() and 0xFFFF
+                    }
+                    isFloat = when {
+                        formatTag == FORMAT_PCM && bits == 16 -> false
+                        formatTag == FORMAT_IEEE_FLOAT && bits == 32 -> true
+                        else -> return null
+                    }
+                    if (channelCount !in 1..2 || sampleRate <= 0) return null
+                    hasFormat = true
+                }
+                "data" -> {
+                    if (!hasFormat) return null
+                    val dataOffset = body.toLong()
+                    val available = (fileLength - dataOffset).coerceAtLeast(0)
+                    val headerSize = if (isRf64 && chunkSize == 0xFFFFFFFFL) ds64DataSize else chunkSize
+                    // 录音异常中断时文件头可能落后于实际数据，长度为0时以文件大小为准
+                    val dataSize = if (headerSize > 0) minOf(headerSize, available) else available
+                    return Info(sampleRate, channelCount, isFloat, dataOffset, dataSize)
+                }
+            }
+            // 块按偶数字节对齐
+            val next = body + chunkSize + (chunkSize and 1L)
+            if (next > buffer.limit()) break
+            pos = next.toInt()
+        }
+        return null
+    }
+
+    private fun tag(buffer: ByteBuffer, offset: Int): String {
+        val bytes = ByteArray(4)
+        for (i in 0 until 4) bytes[i] = buffer.get(offset + i)
+        return String(bytes, Charsets.US_ASCII)
+    }
+}
@@ -1,24 +1,37 @@
 package me.rjy.oboe.record.demo.ui
 
 import androidx.compose.foundation.Canvas
+import androidx.compose.foundation.gestures.detectTapGestures
+import androidx.compose.foundation.gestures.detectTransformGestures
 import androidx.compose.foundation.layout.fillMaxWidth
 import androidx.compose.foundation.layout.height
 import androidx.compose.material3.MaterialTheme
 import androidx.compose.runtime.Composable
+import androidx.compose.runtime.getValue
+import androidx.compose.runtime.mutableFloatStateOf
+import androidx.compose.runtime.remember
+import androidx.compose.runtime.setValue
 import androidx.compose.ui.Modifier
 import androidx.compose.ui.geometry.Offset
+import androidx.compose.ui.geometry.Size
 import androidx.compose.ui.graphics.Color
 import androidx.compose.ui.graphics.Path
 import androidx.compose.ui.graphics.drawscope.DrawScope
 import androidx.compose.ui.graphics.drawscope.Stroke
+import androidx.compose.ui.input.pointer.pointerInput
 import androidx.compose.ui.unit.dp
+import me.rjy.oboe.record.demo.PeakPyramid
 import me.rjy.oboe.record.demo.RecorderViewModel.PlaybackWaveform
 
 @Composable
 fun WaveformPlayView(
     waveform: PlaybackWaveform?,
     progress: Float,
-    modifier: Modifier = Modifier
+    modifier: Modifier = Modifier,
+    onSeek: ((Float) -> Unit)? = null,       // 点击跳转，参数为占全长的比例
+    onMarkLoop: ((Float) -> Unit)? = null,   // 长按标记循环起点/终点
+    loop: Pair<Float, Float>? = null,        // 当前循环区间
+    loopMarker: Float? = null                // 已标记、尚未确定终点的循环起点
 ) {
     val primaryColor = MaterialTheme.colorScheme.primary
     val secondaryColor = MaterialTheme.colorScheme.secondary
@@ -28,10 +41,52 @@ fun WaveformPlayView(
     // 根据是否是立体声来决定总高度
     val totalHeight = if (waveform?.rightChannel.isNullOrEmpty()) channelHeight else channelHeight * 2
 
+    // 有.peaks时支持双指缩放和平移：zoom为放大倍数，windowStart为可见窗口起点占全长的比例
+    val peaks = waveform?.peaks
+    var zoom by remember(peaks) { mutableFloatStateOf(1f) }
+    var windowStart by remember(peaks) { mutableFloatStateOf(0f) }
+    val zoomModifier = if (peaks != null && peaks.totalFrames > 0) {
+        Modifier.pointerInput(peaks) {
+            // 最多放大到每个像素一帧
+            val maxZoom = (peaks.totalFrames.toFloat() / size.width).coerceAtLeast(1f)
+            detectTransformGestures { centroid, pan, gestureZoom, _ ->
+                val oldSpan = 1f / zoom
+                val newZoom = (zoom * gestureZoom).coerceIn(1f, maxZoom)
+                val newSpan = 1f / newZoom
+                // 手指下的位置保持不动，同时跟随平移
+                val fraction = centroid.x / size.width
+                val anchor = windowStart + fraction * oldSpan
+                windowStart = (anchor - fraction * newSpan - pan.x / size.width * newSpan)
+                    .coerceIn(0f, 1f - newSpan)
+                zoom = newZoom
+            }
+        }
+    } else {
+        Modifier
+    }
+    val tapModifier = if (onSeek != null || onMarkLoop != null) {
+        Modifier.pointerInput(onSeek, onMarkLoop) {
+            // 点击位置换算为全长的比例，缩放时只映射可见窗口
+            val toFraction = { x: Float ->
+                val span = if (peaks != null) 1f / zoom else 1f
+                val start = if (peaks != null) windowStart else 0f
+                (start + x / size.width * span).coerceIn(0f, 1f)
+            }
+            detectTapGestures(
+                onTap = { offset -> onSeek?.invoke(toFraction(offset.x)) },
+                onLongPress = { offset -> onMarkLoop?.invoke(toFraction(offset.x)) }
+            )
+        }
+    } else {
+        Modifier
+    }
+
     Canvas(
         modifier = modifier
             .fillMaxWidth()
             .height(totalHeight)  // 在这里指定固定高度
+            .then(zoomModifier)
+            .then(tapModifier)
     ) {
         if (waveform == null) return@Canvas
 
@@ -45,6 +100,33 @@ fun WaveformPlayView(
             height / 2
         }
 
+        if (peaks != null && peaks.totalFrames > 0) {
+            // 按像素查询可见窗口的波形，金字塔自动选取合适的精度
+            val span = 1f / zoom
+            val startFrame = (windowStart.toDouble() * peaks.totalFrames).toLong()
+            val endFrame = ((windowStart + span).toDouble() * peaks.totalFrames).toLong()
+            val pointCount = width.toInt().coerceAtLeast(1)
+            val values = FloatArray(pointCount * peaks.channelCount * 3)
+            val count = peaks.query(startFrame, endFrame, pointCount, values)
+
+            drawPeaks(values, count, peaks, 0, primaryColor, 0f, centerY)
+            if (peaks.channelCount > 1) {
+                drawPeaks(values, count, peaks, 1, secondaryColor, centerY, centerY)
+            }
+
+            drawLoop(loop, loopMarker, windowStart, span, progressColor)
+            val progressX = (progress - windowStart) / span * width
+            if (progressX in 0f..width) {
+                drawLine(
+                    color = progressColor,
+                    start = Offset(progressX, 0f),
+                    end = Offset(progressX, height),
+                    strokeWidth = 2f
+                )
+            }
+            return@Canvas
+        }
+
         // 绘制左声道波形
         drawWaveform(
             amplitudes = waveform.leftChannel,
@@ -65,6 +147,8 @@ fun WaveformPlayView(
             }
         }
 
+        drawLoop(loop, loopMarker, 0f, 1f, progressColor)
+
         // 绘制播放进度线
         val progressX = width * progress
         drawLine(
@@ -103,4 +187,71 @@ private fun DrawScope.drawWaveform(
         color = color.copy(alpha = 0.5f),
         style = Stroke(width = 1f)
     )
-} 
\ No newline at end of file
+} 
+
+// 每个像素画一条min到max的竖线，再用实色画出±rms
+private fun DrawScope.drawPeaks(
+    values: FloatArray,
+    count: Int,
+    peaks: PeakPyramid,
+    channel: Int,
+    color: Color,
+    startY: Float,
+    height: Float
+) {
+    if (count <= 0) return
+
+    val centerY = startY + height / 2
+    val pointWidth = size.width / count
+    val stride = peaks.channelCount * 3
+    for (i in 0 until count) {
+        val base = i * stride + channel * 3
+        val x = i * pointWidth
+        drawLine(
+            color = color.copy(alpha = 0.5f),
+            start = Offset(x, centerY - values[base + 1] * height / 2),
+            end = Offset(x, centerY - values[base] * height / 2),
+            strokeWidth = 1f
+        )
+        val rms = values[base + 2] * height / 2
+        drawLine(
+            color = color,
+            start = Offset(x, centerY - rms),
+            end = Offset(x, centerY + rms),
+            strokeWidth = 1f
+        )
+    }
+}
+
+// 循环区间画成半透明背景，只标记了起点时画一条竖线
+private fun DrawScope.drawLoop(
+    loop: Pair<Float, Float>?,
+    marker: Float?,
+    windowStart: Float,
+    span: Float,
+    color: Color
+) {
+    val width = size.width
+    loop?.let { (start, end) ->
+        val left = ((start - windowStart) / span * width).coerceIn(0f, width)
+        val right = ((end - windowStart) / span * width).coerceIn(0f, width)
+        if (right > left) {
+            drawRect(
+                color = color.copy(alpha = 0.15f),
+                topLeft = Offset(left, 0f),
+                size = Size(right - left, size.height)
+            )
+        }
+    }
+    marker?.let {
+        val x = (it - windowStart) / span * width
+        if (x in 0f..width) {
+            drawLine(
+                color = color.copy(alpha = 0.6f),
+                start = Offset(x, 0f),
+                end = Offset(x, size.height),
+                strokeWidth = 4f
+            )
+        }
+    }
+}